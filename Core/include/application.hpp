@@ -18,6 +18,11 @@ public:
     /// This is valid once @ref Application::Application "the Application constructor" has been called
     XNOR_ENGINE static inline std::filesystem::path executablePath;
 
+    /// @brief Path of the JSON file the @ref RenderStats "render stats" of the last frame are written to when the Application is destroyed
+    ///
+    /// This is set with the <c>--render-stats \<path\></c> command line argument, and nothing is written if it is empty
+    XNOR_ENGINE static inline std::filesystem::path renderStatsPath;
+
     /// @brief Current Application instance.
     XNOR_ENGINE static inline Application* applicationInstance = nullptr;
     
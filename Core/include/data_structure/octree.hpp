@@ -17,7 +17,7 @@ template<class T>
 class Octree
 {
 public:
-    bool_t draw;
+    bool_t draw = false;
     
     void Update(std::vector<ObjectBounding<T>>& data);
     
@@ -55,7 +55,7 @@ private:
     
     OctreeNode<T> m_MotherNode;
 
-    size_t m_HandleSize;
+    size_t m_HandleSize = 0;
 };
 
 template <class T>
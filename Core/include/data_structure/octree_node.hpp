@@ -62,7 +62,7 @@ public:
 
 private:    
     Octans m_ActiveOctans = Zero;
-    std::array<OctreeNode*, NbrOfChild> m_Child;
+    std::array<OctreeNode*, NbrOfChild> m_Child {};
     
     
     void DivideAndAdd(ObjectBounding<T>& objectBounding);
@@ -104,13 +104,11 @@ OctreeNode<T>::OctreeNode(ObjectBounding<T> objectBounding)
 template <class T>
 OctreeNode<T>::~OctreeNode()
 {
+    // Cleared children are kept for the next update, so they are deleted even when inactive
     for (size_t i = 0; i < m_Child.size(); i++)
     {
-        if (IsOctanValid(m_ActiveOctans, static_cast<uint32_t>(i)))
-        {
-            delete m_Child[i];
-            m_Child[i] = nullptr;
-        }
+        delete m_Child[i];
+        m_Child[i] = nullptr;
     }
 }
 template <class T>
@@ -0,0 +1,115 @@
+#pragma once
+
+#include "core.hpp"
+#include "scene/component.hpp"
+
+/// @file character_controller.hpp
+/// @brief Defines the XnorCore::CharacterController class
+
+namespace JPH
+{
+    class CharacterVirtual;
+}
+
+BEGIN_XNOR_CORE
+
+/// @brief Capsule shaped character that moves by querying the physics world instead of being simulated as a rigid body
+///
+/// Characters don't have a body, so they are a lot cheaper than a dynamic collider, can walk up steps and stick to slopes.
+/// All the characters of the scene are updated in parallel by the physics world
+class CharacterController : public Component
+{
+    REFLECTABLE_IMPL(CharacterController)
+
+public:
+    /// @brief Offset of the capsule from the entity position
+    Vector3 center = Vector3::Zero();
+
+    /// @brief Height of the cylinder part of the capsule
+    float_t height = 1.f;
+    /// @brief Radius of the capsule
+    float_t radius = 0.3f;
+
+    /// @brief Maximum angle of a slope the character can walk on, in degrees
+    float_t maxSlopeAngle = 50.f;
+    /// @brief Maximum height of a step the character can walk up
+    float_t stepHeight = 0.4f;
+
+    /// @brief Mass of the character, used when pushing dynamic bodies
+    float_t mass = 70.f;
+    /// @brief Maximum force the character can push dynamic bodies with
+    float_t maxStrength = 100.f;
+
+    /// @brief Whether the gravity is applied to the character
+    bool_t useGravity = true;
+
+    XNOR_ENGINE CharacterController() = default;
+    XNOR_ENGINE ~CharacterController() override;
+
+    /// @brief Copies the settings of a character controller, the copy creates its own character in Awake
+    /// @param other Character controller
+    XNOR_ENGINE CharacterController(const CharacterController& other);
+
+    /// @brief Takes the character of another character controller, which is left without one
+    /// @param other Character controller
+    XNOR_ENGINE CharacterController(CharacterController&& other) noexcept;
+
+    /// @brief Copies the settings of a character controller and destroys the current character, a new one is created in Awake
+    /// @param other Character controller
+    /// @returns This
+    XNOR_ENGINE CharacterController& operator=(const CharacterController& other);
+
+    /// @brief Destroys the current character and takes the one of another character controller, which is left without one
+    /// @param other Character controller
+    /// @returns This
+    XNOR_ENGINE CharacterController& operator=(CharacterController&& other) noexcept;
+
+    /// @brief Awake function
+    XNOR_ENGINE void Awake() override;
+
+    /// @brief Pre-function
+    XNOR_ENGINE void PrePhysics() override;
+    /// @brief Post-function
+    XNOR_ENGINE void PostPhysics() override;
+
+    /// @brief Sets the velocity the character should move with, the vertical part is ignored if the gravity is used
+    /// @param velocity Velocity
+    XNOR_ENGINE void SetVelocity(const Vector3& velocity);
+
+    /// @brief Gets the velocity the character moved with during the last physics update
+    /// @returns Velocity
+    [[nodiscard]]
+    XNOR_ENGINE Vector3 GetVelocity() const;
+
+    /// @brief Makes the character jump during the next physics update if it is on the ground
+    /// @param speed Vertical speed
+    XNOR_ENGINE void Jump(float_t speed);
+
+    /// @brief Gets whether the character is standing on the ground
+    /// @returns Is grounded
+    [[nodiscard]]
+    XNOR_ENGINE bool_t IsGrounded() const;
+
+private:
+    /// @brief Owned character, destroyed with the controller
+    JPH::CharacterVirtual* m_Character = nullptr;
+
+    Vector3 m_DesiredVelocity = Vector3::Zero();
+
+    float_t m_JumpSpeed = 0.f;
+
+    void DestroyCharacter();
+};
+
+END_XNOR_CORE
+
+REFL_AUTO(type(XnorCore::CharacterController, bases<XnorCore::Component>),
+    field(center),
+    field(height, XnorCore::Reflection::Range(0.f, 100.f)),
+    field(radius, XnorCore::Reflection::Range(0.01f, 100.f)),
+    field(maxSlopeAngle, XnorCore::Reflection::Range(0.f, 90.f)),
+    field(stepHeight, XnorCore::Reflection::Range(0.f, 10.f)),
+    field(mass, XnorCore::Reflection::Range(0.f, 10000.f)),
+    field(maxStrength, XnorCore::Reflection::Range(0.f, 10000.f)),
+    field(useGravity)
+)
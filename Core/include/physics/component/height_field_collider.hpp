@@ -0,0 +1,66 @@
+#pragma once
+
+#include "core.hpp"
+#include "physics/component/collider.hpp"
+#include "resource/texture.hpp"
+#include "scene/component.hpp"
+#include "utils/pointer.hpp"
+
+/// @file height_field_collider.hpp
+/// @brief Defines the XnorCore::HeightFieldCollider class
+
+BEGIN_XNOR_CORE
+
+/// @brief Static terrain collider created from a height map
+///
+/// Unlike a MeshCollider, which is a convex hull, this follows the actual shape of the terrain and only needs a single body
+class HeightFieldCollider : public Collider
+{
+    REFLECTABLE_IMPL(HeightFieldCollider)
+
+public:
+    /// @brief Height map, only the first channel is used. The height field is square so only the top left part of a non-square texture is used
+    Pointer<Texture> heightMap;
+
+    /// @brief Distance between two samples on the X and Z axes, multiplied by the scaling of the entity
+    float_t sampleSpacing = 1.f;
+    /// @brief Height of a sample with the maximum value, multiplied by the scaling of the entity
+    float_t heightScale = 1.f;
+
+    /// @brief Size of the blocks culled by the acceleration structure, in samples. Bigger blocks use less memory but make queries slower
+    uint32_t blockSize = 4;
+    /// @brief Number of bits used to compress each sample
+    uint32_t bitsPerSample = 8;
+
+    /// @brief Optional material map, the first channel of each texel is the material index of the matching cell
+    ///
+    /// The index of the hit cell is reported by PhysicsWorld::Raycast. The friction is set per collider, so the materials don't change the contact response
+    Pointer<Texture> materialMap;
+    /// @brief Number of materials referenced by the material map
+    uint32_t materialCount = 1;
+
+    XNOR_ENGINE HeightFieldCollider() = default;
+    XNOR_ENGINE ~HeightFieldCollider() override = default;
+
+    DEFAULT_COPY_MOVE_OPERATIONS(HeightFieldCollider)
+
+    /// @brief Awake function
+    XNOR_ENGINE void Awake() override;
+
+    /// @brief Gets the number of samples on each side of the height field that will be created from the height map
+    /// @returns Sample count, 0 if the height map is too small
+    [[nodiscard]]
+    XNOR_ENGINE uint32_t GetSampleCount() const;
+};
+
+END_XNOR_CORE
+
+REFL_AUTO(type(XnorCore::HeightFieldCollider, bases<XnorCore::Collider>),
+    field(heightMap),
+    field(sampleSpacing, XnorCore::Reflection::Range(0.01f, 100.f)),
+    field(heightScale, XnorCore::Reflection::Range(0.f, 10000.f)),
+    field(blockSize, XnorCore::Reflection::Range(2u, 8u)),
+    field(bitsPerSample, XnorCore::Reflection::Range(1u, 8u)),
+    field(materialMap),
+    field(materialCount, XnorCore::Reflection::Range(1u, 256u))
+)
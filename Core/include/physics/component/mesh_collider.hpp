@@ -18,8 +18,8 @@ public:
     XNOR_ENGINE MeshCollider() = default; 
     XNOR_ENGINE ~MeshCollider() override = default;
 
-    /// @brief Begin function
-    XNOR_ENGINE void Begin() override;
+    /// @brief Awake function
+    XNOR_ENGINE void Awake() override;
     /// @brief Update function
     XNOR_ENGINE void Update() override;
     
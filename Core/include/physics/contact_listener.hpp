@@ -2,6 +2,11 @@
 
 #include "core.hpp"
 
+#include <array>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
 #include <Jolt/Jolt.h>
 #include <Jolt/Physics/Collision/ContactListener.h>
 
@@ -13,7 +18,14 @@ BEGIN_XNOR_CORE
 class ContactListenerImpl final : public JPH::ContactListener
 {
 public:
+    /// @brief Allocates one event buffer per thread of the job system
+    /// @param threadCount Maximum number of threads running the physics jobs at the same time
+    void Initialize(size_t threadCount);
+
     void ProcessEvents();
+
+    /// @brief Releases the event buffers of all the threads
+    void Clear();
     
 private:
     JPH::ValidateResult OnContactValidate(const JPH::Body& inBody1, const JPH::Body& inBody2, JPH::RVec3Arg inBaseOffset, const JPH::CollideShapeResult& inCollisionResult) override;
@@ -44,8 +56,25 @@ private:
         EventCount
     };
 
-    std::mutex m_EventsMutex;
-    std::array<std::vector<EventInfo>, EventCount> m_Events;
+    /// @brief Events recorded by a single thread during a physics step
+    struct EventBuffer
+    {
+        std::array<std::vector<EventInfo>, EventCount> events;
+    };
+
+    /// @brief Gets the event buffer of the calling thread
+    EventBuffer& GetThreadBuffer();
+
+    /// @brief Invokes the events of a type recorded in a buffer and clears them
+    static void DispatchEvents(EventBuffer* buffer, CollisionEvent event);
+
+    /// @brief One buffer per job system thread, indexed by JobSystem::GetThreadIndex
+    std::vector<EventBuffer> m_Buffers;
+
+    /// @brief Only locked by the threads outside the job system, which shouldn't step the physics in practice
+    std::mutex m_OverflowBuffersMutex;
+    /// @brief Buffers of the threads outside the job system, the map nodes don't move so the references given to the threads stay valid
+    std::unordered_map<size_t, EventBuffer> m_OverflowBuffers;
 };
 
 END_XNOR_CORE
@@ -2,12 +2,16 @@
 
 #include "core.hpp"
 
+#include <string>
 #include <unordered_map>
+#include <vector>
 
 #include <Jolt/Jolt.h>
 #include <Jolt/Core/JobSystemThreadPool.h>
 #include <Jolt/Physics/PhysicsSystem.h>
+#include <Jolt/Physics/Character/CharacterVirtual.h>
 
+#include <Maths/calc.hpp>
 #include <Maths/quaternion.hpp>
 #include <Maths/vector3.hpp>
 
@@ -50,6 +54,57 @@ public:
         Vector3 offsetShape;
     };
 
+    /// @brief Height field creation info
+    struct HeightFieldCreationInfo
+    {
+        /// @brief Height samples, sampleCount * sampleCount values in row major order
+        const float_t* samples = nullptr;
+        /// @brief Number of samples on each side of the height field
+        uint32_t sampleCount = 0;
+
+        /// @brief Distance between two samples on the X and Z axes
+        float_t sampleSpacing = 1.f;
+        /// @brief Scale applied to the height samples
+        float_t heightScale = 1.f;
+
+        /// @brief Size of the blocks the acceleration structure culls, in samples
+        uint32_t blockSize = 4;
+        /// @brief Number of bits used to compress each sample, in the range [1, 8]
+        uint32_t bitsPerSample = 8;
+
+        /// @brief Optional material indices, (sampleCount - 1) * (sampleCount - 1) values
+        const uint8_t* materialIndices = nullptr;
+        /// @brief Number of materials referenced by materialIndices
+        uint32_t materialCount = 0;
+
+        /// @brief Key used to cache the cooked shape, the shape isn't cached if it is empty
+        std::string cacheKey;
+    };
+
+    /// @brief Character creation info
+    struct CharacterCreationInfo
+    {
+        /// @brief Position
+        Vector3 position;
+        /// @brief Rotation
+        Quaternion rotation;
+
+        /// @brief Height of the cylinder part of the capsule
+        float_t height = 1.f;
+        /// @brief Radius of the capsule
+        float_t radius = 0.3f;
+
+        /// @brief Maximum angle of a slope the character can walk on, in radians
+        float_t maxSlopeAngle = 50.f * Calc::Deg2Rad;
+        /// @brief Maximum height of a step the character can walk up
+        float_t stepHeight = 0.4f;
+
+        /// @brief Mass of the character, used when pushing dynamic bodies
+        float_t mass = 70.f;
+        /// @brief Maximum force the character can push dynamic bodies with
+        float_t maxStrength = 100.f;
+    };
+
     /// @brief Raycast result
     struct RaycastResult
     {
@@ -61,6 +116,8 @@ public:
         Vector3 normal;
         /// @brief Distance between cast and collision
         float_t distance{};
+        /// @brief Material index of the hit cell of a height field, 0 for the other shapes
+        uint32_t materialIndex = 0;
     };
 
     [[nodiscard]]
@@ -86,6 +143,40 @@ public:
     /// @param gravity Gravity
     XNOR_ENGINE static void SetGravity(const Vector3& gravity);
 
+    /// @brief Gets the gravity
+    /// @returns Gravity
+    [[nodiscard]]
+    XNOR_ENGINE static Vector3 GetGravity();
+
+    /// @brief Saves the full state of the physics world (bodies, velocities, contacts and constraints) in memory
+    /// @param state Saved state
+    XNOR_ENGINE static void SaveState(std::string* state);
+
+    /// @brief Restores a state saved with SaveState in place, the world must still contain the same bodies
+    /// @param state Saved state
+    /// @returns Whether the state could be restored
+    XNOR_ENGINE static bool_t RestoreState(const std::string& state);
+
+    /// @brief Saves the current state of the physics world as the snapshot, replacing the previous one
+    XNOR_ENGINE static void TakeSnapshot();
+
+    /// @brief Restores the snapshot taken with TakeSnapshot
+    ///
+    /// Only the bodies are rolled back, the entities follow them at the next Scene::PostPhysics
+    /// @returns Whether the snapshot could be restored
+    XNOR_ENGINE static bool_t RestoreSnapshot();
+
+    /// @brief Discards the current snapshot, should be called once the bodies it was taken with are destroyed
+    XNOR_ENGINE static void ClearSnapshot();
+
+    /// @brief Starts a body batch, every body created until EndBodyBatch is called will be created but not yet added to the world
+    ///
+    /// This should be used when creating a lot of bodies at once, e.g. when a scene is loaded
+    XNOR_ENGINE static void BeginBodyBatch();
+
+    /// @brief Ends a body batch, adds all the pending bodies to the world at once and optimizes the broad phase
+    XNOR_ENGINE static void EndBodyBatch();
+
     /// @brief Creates a sphere body
     /// @param info Body creation info
     /// @param radius Radius
@@ -102,6 +193,32 @@ public:
     [[nodiscard]]
     XNOR_ENGINE static JPH::Character* CreateCharacter(const BodyCreationInfo& info, const JPH::CharacterSettings& settings);
 
+    /// @brief Creates a virtual character, which isn't a body but moves by querying the world
+    ///
+    /// Virtual characters are updated in parallel batches at the end of each physics update
+    /// @param info Character creation info
+    /// @returns Created character
+    [[nodiscard]]
+    XNOR_ENGINE static JPH::CharacterVirtual* CreateCharacterVirtual(const CharacterCreationInfo& info);
+
+    /// @brief Destroys a virtual character created with CreateCharacterVirtual
+    /// @param character Character
+    XNOR_ENGINE static void DestroyCharacterVirtual(JPH::CharacterVirtual* character);
+
+    /// @brief Moves all the virtual characters according to their linear velocity, spreading them over the physics jobs
+    /// @param deltaTime Delta time
+    XNOR_ENGINE static void UpdateCharacters(float_t deltaTime);
+
+    /// @brief Gets the number of virtual characters in the world
+    /// @returns Character count
+    [[nodiscard]]
+    XNOR_ENGINE static size_t GetCharacterCount();
+
+    /// @brief Gets the time the last UpdateCharacters call took
+    /// @returns Time in milliseconds
+    [[nodiscard]]
+    XNOR_ENGINE static float_t GetCharacterUpdateTime();
+
     /// @brief Creates a capsule body
     /// @param info Body creation info
     /// @param height Height
@@ -117,6 +234,19 @@ public:
     [[nodiscard]]
     XNOR_ENGINE static uint32_t CreateConvexHull(const BodyCreationInfo& info, const std::vector<Vertex>& vertices);
 
+    /// @brief Creates a static height field body
+    ///
+    /// The scaling of the body scales the sample spacing on the X and Z axes and the heights on the Y axis.
+    /// Each material index gets its own material so a raycast can report it, the contact response doesn't depend on it as the friction is set per body
+    /// @param info Body creation info
+    /// @param heightField Height field creation info
+    /// @returns Created body id
+    [[nodiscard]]
+    XNOR_ENGINE static uint32_t CreateHeightField(const BodyCreationInfo& info, const HeightFieldCreationInfo& heightField);
+
+    /// @brief Releases all the cooked shapes that are cached
+    XNOR_ENGINE static void ClearShapeCache();
+
     /// @brief Destroys a body
     /// @param bodyId Body ID
     XNOR_ENGINE static void DestroyBody(uint32_t bodyId);
@@ -210,6 +340,21 @@ public:
     XNOR_ENGINE static void SetInverseMass(uint32_t bodyId, float_t invertedMass);
 
 private:
+    /// @brief A virtual character with its own update settings
+    struct CharacterEntry
+    {
+        /// @brief Character
+        JPH::CharacterVirtual* character = nullptr;
+        /// @brief Update settings
+        JPH::CharacterVirtual::ExtendedUpdateSettings updateSettings;
+    };
+
+    /// @brief Minimum number of characters a job updates, below that scheduling the job costs more than it saves
+    static constexpr size_t MinCharactersPerJob = 16;
+
+    /// @brief Size of the temp allocator of each character job
+    static constexpr JPH::uint CharacterAllocatorSize = 1024 * 1024;
+
     XNOR_ENGINE static void TraceImpl(const char_t* format, ...);
 
     [[nodiscard]]
@@ -217,6 +362,24 @@ private:
 
     static inline std::unordered_map<uint32_t, Collider*> m_BodyMap;
 
+    /// @brief Cooked shapes, shared between all the bodies created with the same cache key
+    static inline std::unordered_map<std::string, JPH::ShapeRefC> m_ShapeCache;
+
+    /// @brief Materials of the height field cells, the material at an index is used by every height field for that material index
+    static inline JPH::PhysicsMaterialList m_HeightFieldMaterials;
+
+    /// @brief State saved by TakeSnapshot
+    static inline std::string m_Snapshot;
+
+    /// @brief Virtual characters, stored contiguously so they can be split in batches
+    static inline std::vector<CharacterEntry> m_Characters;
+    /// @brief One temp allocator per character job as they aren't thread safe
+    static inline std::vector<JPH::TempAllocatorImpl*> m_CharacterAllocators;
+    static inline float_t m_CharacterUpdateTime = 0.f;
+
+    static inline bool_t m_IsBatching = false;
+    static inline std::vector<JPH::BodyID> m_PendingBodies;
+
     XNOR_ENGINE static inline JPH::PhysicsSystem* m_PhysicsSystem;
     XNOR_ENGINE static inline JPH::TempAllocatorImpl* m_Allocator;
     XNOR_ENGINE static inline JPH::JobSystemThreadPool* m_JobSystem;
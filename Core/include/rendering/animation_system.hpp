@@ -0,0 +1,89 @@
+#pragma once
+
+#include <vector>
+
+#include "core.hpp"
+#include "rendering/frustum.hpp"
+
+/// @file animation_system.hpp
+/// @brief Defines the XnorCore::AnimationSystem class
+
+BEGIN_XNOR_CORE
+
+class Scene;
+class SkinnedMeshRenderer;
+struct RenderedView;
+
+/// @brief Update rates of the animations depending on how visible they are
+struct AnimationLodSettings
+{
+    /// @brief Distance up to which the animations are updated every frame
+    float_t fullRateDistance = 20.f;
+    /// @brief Distance from which the animations are updated at the lowest rate
+    float_t minRateDistance = 80.f;
+    /// @brief Number of frames between two updates at the lowest rate
+    uint32_t maxUpdateInterval = 4;
+    /// @brief Number of frames between two updates of the animations outside the view
+    uint32_t offscreenUpdateInterval = 8;
+};
+
+/// @brief Evaluates the animations of all the skinned meshes of a scene
+///
+/// The animations are evaluated in parallel on the job system. Distant and off-screen meshes are updated less often,
+/// so the animation cost depends on the visible characters rather than on the total number of characters
+class AnimationSystem
+{
+    STATIC_CLASS(AnimationSystem)
+
+public:
+    /// @brief Update rates used when a mesh allows its animation to be updated less often
+    XNOR_ENGINE static inline AnimationLodSettings lodSettings;
+
+    /// @brief Whether to lower the update rate of distant and off-screen animations
+    XNOR_ENGINE static inline bool_t enableLod = true;
+
+    /// @brief Evaluates the animations of a scene that are due this frame
+    ///
+    /// A mesh is updated at the rate of the closest view it is in, so a character seen from any of the editor viewports keeps animating smoothly
+    /// @param scene Scene
+    /// @param views Views used to compute the distance and visibility of the meshes, if empty every animation is updated every frame
+    /// @param deltaTime Time elapsed since the last frame
+    XNOR_ENGINE static void Update(Scene& scene, const std::vector<RenderedView>& views, float_t deltaTime);
+
+    /// @brief Computes the number of frames between two updates of an animation
+    /// @param distance Distance between the mesh and the camera
+    /// @param isVisible Whether the mesh is in the view
+    /// @param settings Update rates
+    /// @returns Update interval, 1 to update every frame
+    [[nodiscard]]
+    XNOR_ENGINE static uint32_t ComputeUpdateInterval(float_t distance, bool_t isVisible, const AnimationLodSettings& settings);
+
+    /// @brief Gets the number of animated meshes during the last update
+    /// @returns Mesh count
+    [[nodiscard]]
+    XNOR_ENGINE static size_t GetAnimatedCount();
+
+    /// @brief Gets the number of animations that were evaluated during the last update
+    /// @returns Evaluated count
+    [[nodiscard]]
+    XNOR_ENGINE static size_t GetEvaluatedCount();
+
+    /// @brief Gets the time spent during the last update
+    /// @returns Time in milliseconds
+    [[nodiscard]]
+    XNOR_ENGINE static float_t GetUpdateTime();
+
+private:
+    /// @brief Animating a skeleton is cheap, so a job has to evaluate a few of them to be worth scheduling
+    static constexpr size_t MinAnimationsPerJob = 4;
+
+    XNOR_ENGINE static inline std::vector<SkinnedMeshRenderer*> m_Renderers;
+
+    XNOR_ENGINE static inline std::vector<SkinnedMeshRenderer*> m_DueRenderers;
+
+    XNOR_ENGINE static inline std::vector<Frustum> m_Frusta;
+
+    XNOR_ENGINE static inline float_t m_UpdateTime = 0.f;
+};
+
+END_XNOR_CORE
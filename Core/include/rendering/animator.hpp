@@ -3,13 +3,24 @@
 #include "core.hpp"
 #include "rhi_typedef.hpp"
 #include "Maths/matrix.hpp"
+#include "rendering/pose.hpp"
 #include "reflection/reflection.hpp"
+#include "resource/animation.hpp"
 #include "utils/list.hpp"
 #include "utils/pointer.hpp"
 
 BEGIN_XNOR_CORE
 
-class Animation;
+class BoneMask;
+
+/// @brief How an animation layer is combined with the layers below it
+enum class AnimationLayerMode
+{
+    /// @brief The layer pose replaces the pose below it, according to the layer weight
+    Override,
+    /// @brief The layer pose is added on top of the pose below it, the layer animation must be an additive one
+    Additive
+};
 
 class Animator final
 {
@@ -27,13 +38,60 @@ public:
 
     XNOR_ENGINE void Animate();
 
+    /// @brief Advances the animation by a given time and evaluates the pose
+    ///
+    /// Animators don't share any state, so several of them can be evaluated at the same time on different threads
+    /// @param deltaTime Time elapsed since the last evaluation
+    XNOR_ENGINE void Animate(float_t deltaTime);
+
     XNOR_ENGINE void SetCrossFadeDelta(float_t delta);
 
+    /// @brief Adds a layer blended on top of the animation and of the cross fade, layers are applied in the order they were added
+    ///
+    /// The source animator is animated by this one, so it must not be animated elsewhere
+    /// @param source Animator of the layer, must use the same skeleton
+    /// @param mode Blend mode
+    /// @param weight Weight of the layer
+    /// @param mask Optional per-bone weights, must stay alive while the layer is used
+    /// @returns Layer index
+    XNOR_ENGINE size_t AddLayer(Animator* source, AnimationLayerMode mode, float_t weight = 1.f, const BoneMask* mask = nullptr);
+
+    /// @brief Sets the weight of a layer
+    /// @param layer Layer index
+    /// @param weight Weight
+    XNOR_ENGINE void SetLayerWeight(size_t layer, float_t weight);
+
+    /// @brief Removes all the layers
+    XNOR_ENGINE void ClearLayers();
+
+    /// @brief Gets the local pose computed during the last evaluation, with the blends and layers applied
+    /// @returns Local pose
+    [[nodiscard]]
+    XNOR_ENGINE const Pose& GetLocalPose() const;
+
+    /// @brief Gets the model-space pose computed during the last evaluation
+    /// @returns Model-space pose
+    [[nodiscard]]
+    XNOR_ENGINE const Pose& GetModelPose() const;
+
     [[nodiscard]]
     XNOR_ENGINE const List<Matrix>& GetMatrices() const;
     
 private:
-    XNOR_ENGINE void UpdateTime();
+    /// @brief Animation layer
+    struct AnimationLayer
+    {
+        /// @brief Animator of the layer
+        Animator* source = nullptr;
+        /// @brief Blend mode
+        AnimationLayerMode mode = AnimationLayerMode::Override;
+        /// @brief Weight
+        float_t weight = 1.f;
+        /// @brief Per-bone weights, can be nullptr
+        const BoneMask* mask = nullptr;
+    };
+
+    XNOR_ENGINE void UpdateTime(float_t deltaTime);
     
     Pointer<Animation> m_Animation;
     
@@ -45,16 +103,31 @@ private:
 
     size_t m_FrameCount;
 
-    mutable List<Matrix> m_FinalMatrices = List<Matrix>(MaxBones);
-    
-    List<Vector3> m_Positions = List<Vector3>(MaxBones);
-    
-    List<Quaternion> m_Rotations = List<Quaternion>(MaxBones);
+    /// @brief Channel of each skeleton bone in the current animation, owned by the animation
+    const List<int32_t>* m_ChannelBindings = nullptr;
+
+    /// @brief Keys used by the last sample of each bone
+    List<Animation::ChannelCursor> m_ChannelCursors;
+
+    /// @brief Skinning palette uploaded to the GPU, indexed by bone id
+    mutable List<Matrix> m_FinalMatrices;
+
+    /// @brief Transform of each bone relative to its parent, reused every frame
+    Pose m_LocalPose;
+
+    /// @brief Parent of each bone in the poses, -1 for a root
+    List<int32_t> m_BoneParents;
+
+    /// @brief Transform of each bone relative to the model, reused every frame
+    Pose m_ModelPose;
 
     float_t m_CrossFadeT = 0.f;
     
     Animator* m_BlendTarget = nullptr;
 
+    /// @brief Layers applied on top of the animation
+    List<AnimationLayer> m_Layers;
+
     bool_t m_IsFinished = false;
 };
 
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "core.hpp"
+#include "utils/list.hpp"
+
+/// @file bone_mask.hpp
+/// @brief Defines the XnorCore::BoneMask class
+
+BEGIN_XNOR_CORE
+
+class Skeleton;
+
+/// @brief Weight of each bone of a skeleton in a blend, used to restrict an animation layer to a part of the body
+///
+/// The weights are padded like a Pose, so they can be read by the SIMD blending kernels
+class BoneMask
+{
+public:
+    XNOR_ENGINE BoneMask() = default;
+    XNOR_ENGINE explicit BoneMask(size_t boneCount, float_t weight = 1.f);
+    XNOR_ENGINE ~BoneMask() = default;
+
+    DEFAULT_COPY_MOVE_OPERATIONS(BoneMask)
+
+    /// @brief Resizes the mask and sets the weight of all the bones
+    /// @param boneCount Bone count
+    /// @param weight Weight of every bone
+    XNOR_ENGINE void Reset(size_t boneCount, float_t weight = 1.f);
+
+    /// @brief Gets the number of bones of the mask
+    /// @returns Bone count
+    [[nodiscard]]
+    XNOR_ENGINE size_t GetBoneCount() const;
+
+    /// @brief Sets the weight of a bone
+    /// @param bone Bone index
+    /// @param weight Weight, between 0 and 1
+    XNOR_ENGINE void SetWeight(size_t bone, float_t weight);
+
+    /// @brief Sets the weight of a bone and of all its descendants
+    /// @param skeleton Skeleton the mask is used with
+    /// @param bone Index of the root bone of the branch
+    /// @param weight Weight, between 0 and 1
+    XNOR_ENGINE void SetBranchWeight(const Skeleton& skeleton, size_t bone, float_t weight);
+
+    /// @brief Gets the weight of a bone
+    /// @param bone Bone index
+    /// @returns Weight
+    [[nodiscard]]
+    XNOR_ENGINE float_t GetWeight(size_t bone) const;
+
+    /// @brief Gets the weights of all the bones, padded to Pose::GetPaddedCount
+    /// @returns Weights
+    [[nodiscard]]
+    XNOR_ENGINE const float_t* GetWeights() const;
+
+private:
+    size_t m_BoneCount = 0;
+
+    List<float_t> m_Weights;
+};
+
+END_XNOR_CORE
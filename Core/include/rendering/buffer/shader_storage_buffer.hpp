@@ -0,0 +1,49 @@
+﻿#pragma once
+
+#include "core.hpp"
+
+/// @file shader_storage_buffer.hpp
+/// @brief Defines the XnorCore::ShaderStorageBuffer class
+
+BEGIN_XNOR_CORE
+
+/// @brief Encapsulates a shader storage buffer, which is used to send large or unsized arrays of data in shaders
+class ShaderStorageBuffer
+{
+public:
+    ShaderStorageBuffer();
+    ~ShaderStorageBuffer();
+
+    DEFAULT_COPY_MOVE_OPERATIONS(ShaderStorageBuffer)
+
+    /// @brief Allocates the buffer on the GPU, any previous storage is released so the buffer needs to be bound again
+    /// @param size Data size
+    /// @param data Data
+    void Allocate(size_t size, const void* data);
+
+    /// @brief Updates the data of the buffer on the GPU
+    /// @param size Data size
+    /// @param offset Data offset
+    /// @param data Data
+    void Update(size_t size, size_t offset, const void* data) const;
+
+    /// @brief Binds the storage buffer
+    /// @param index Index
+    void Bind(uint32_t index) const;
+
+    /// @brief Gets the allocated size
+    /// @returns Size in bytes
+    [[nodiscard]]
+    size_t GetSize() const;
+
+    /// @brief Gets the buffer id, which changes when the buffer is reallocated
+    /// @returns Id
+    [[nodiscard]]
+    uint32_t GetId() const;
+    
+private:
+    uint32_t m_Id;
+    size_t m_Size = 0;
+};
+
+END_XNOR_CORE
@@ -1,6 +1,7 @@
 ﻿#pragma once
 
 #include <array>
+#include <Maths/matrix.hpp>
 #include <Maths/vector3.hpp>
 
 #include "core.hpp"
@@ -37,9 +38,15 @@ public:
 
     void UpdateFromCamera(const Camera& camera, float_t aspect);
 
+    /// @brief Extracts the planes of the frustum from a view projection matrix, works for any projection
+    /// @param viewProjection View projection matrix
+    void UpdateFromMatrix(const Matrix& viewProjection);
+
     bool_t IsOnFrustum(const Bound& bound) const;
 
 private:
+    void SetPlane(Face face, const Vector4& coefficients);
+
     void UpdateCameraPerspective(const Camera& camera, float_t aspect);
 
     void UpdateCameraOrthoGraphic(const Camera& camera, float_t aspect);
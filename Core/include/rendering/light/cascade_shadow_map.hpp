@@ -20,6 +20,13 @@ public:
     DEFAULT_COPY_MOVE_OPERATIONS(CascadeShadowMap)
 
     XNOR_ENGINE void GetCascadeCameras(std::vector<Camera>* cameras ,const Camera&  viewPortCamera, Vector3 lightDir, Vector2i screenSize);
+
+    /// @brief Gets the depth range of the view covered by a cascade
+    /// @param index Cascade index
+    /// @param viewPortCamera Viewport camera
+    /// @param cascadeNear Near distance of the cascade
+    /// @param cascadeFar Far distance of the cascade
+    XNOR_ENGINE void GetCascadeRange(size_t index, const Camera& viewPortCamera, float_t* cascadeNear, float_t* cascadeFar) const;
     
     XNOR_ENGINE void SetCascadeLevel(const std::array<float, DirectionalCascadeLevel>& cascadeLevel);
 
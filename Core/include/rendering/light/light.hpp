@@ -30,11 +30,23 @@ public:
     /// @brief Far clipping of the light
     float_t far = 1000.f;
 
-    XNOR_ENGINE Light() = default;
+    /// @brief Creates a light and registers it to the LightManager
+    XNOR_ENGINE Light();
     
-    XNOR_ENGINE ~Light() override = default;
+    /// @brief Unregisters the light from the LightManager
+    XNOR_ENGINE ~Light() override;
 
-    DEFAULT_COPY_MOVE_OPERATIONS(Light)
+#ifndef SWIG
+    /// @brief Creates a copy of a light and registers it to the LightManager
+    XNOR_ENGINE Light(const Light& other);
+
+    /// @brief Moves a light and registers the new one to the LightManager
+    XNOR_ENGINE Light(Light&& other) noexcept;
+
+    XNOR_ENGINE Light& operator=(const Light& other) = default;
+
+    XNOR_ENGINE Light& operator=(Light&& other) noexcept = default;
+#endif
 };
 
 END_XNOR_CORE
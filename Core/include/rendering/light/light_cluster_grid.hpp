@@ -0,0 +1,112 @@
+﻿#pragma once
+
+#include <array>
+#include <vector>
+
+#include <Maths/vector3.hpp>
+#include <Maths/vector4.hpp>
+
+#include "core.hpp"
+#include "rendering/camera.hpp"
+#include "rendering/rhi_typedef.hpp"
+
+/// @file light_cluster_grid.hpp
+/// @brief Defines the XnorCore::LightClusterGrid class
+
+BEGIN_XNOR_CORE
+
+/// @brief Bounding sphere of a light binned in a LightClusterGrid
+struct ClusteredLight
+{
+    /// @brief Sphere center
+    Vector3 position;
+    /// @brief Sphere radius
+    float_t radius = 0.f;
+};
+
+/// @brief Bins lights in view space clusters, so that a fragment only shades the lights that can reach it
+///
+/// The view is split in tiles on the screen and in slices along the depth, growing exponentially from the near plane so that the
+/// clusters keep a similar shape. The slices are binned in parallel on the job system, each slice only writing its own clusters.
+/// The clusters then reference ranges of a single light index array, in the order of the slices.
+/// An orthographic camera uses a single cluster holding all the lights.
+class LightClusterGrid
+{
+public:
+    /// @brief Number of tiles along the screen width
+    static constexpr uint32_t TileCountX = 16;
+    /// @brief Number of tiles along the screen height
+    static constexpr uint32_t TileCountY = 9;
+    /// @brief Number of depth slices
+    static constexpr uint32_t SliceCount = 24;
+    /// @brief Number of clusters of a perspective camera
+    static constexpr uint32_t ClusterCount = TileCountX * TileCountY * SliceCount;
+
+    XNOR_ENGINE LightClusterGrid() = default;
+    XNOR_ENGINE ~LightClusterGrid() = default;
+
+    DEFAULT_COPY_MOVE_OPERATIONS(LightClusterGrid)
+
+    /// @brief Bins lights in the clusters of a camera
+    /// @param camera Camera
+    /// @param aspect Viewport aspect ratio
+    /// @param lights Light bounding spheres, their index in this list is the one stored in the clusters
+    XNOR_ENGINE void Build(const Camera& camera, float_t aspect, const std::vector<ClusteredLight>& lights);
+
+    /// @brief Gets the grid header to upload along the clusters
+    /// @returns Header
+    [[nodiscard]]
+    XNOR_ENGINE const GpuLightClusterData& GetGpuData() const;
+
+    /// @brief Gets the light range of each cluster
+    /// @returns Clusters
+    [[nodiscard]]
+    XNOR_ENGINE const std::vector<LightClusterRange>& GetClusters() const;
+
+    /// @brief Gets the light indices referenced by the clusters
+    /// @returns Light indices
+    [[nodiscard]]
+    XNOR_ENGINE const std::vector<uint32_t>& GetLightIndices() const;
+
+    /// @brief Gets the cluster containing a world position, the same way the lit shaders do
+    /// @param position World position
+    /// @returns Cluster index
+    [[nodiscard]]
+    XNOR_ENGINE uint32_t GetClusterIndex(Vector3 position) const;
+
+    /// @brief Computes the bounding sphere of a spot light cone
+    /// @param position Light position
+    /// @param direction Normalized light direction
+    /// @param angle Half angle of the cone, in radians
+    /// @param range Light range
+    /// @returns Bounding sphere
+    [[nodiscard]]
+    XNOR_ENGINE static ClusteredLight GetSpotLightBounds(Vector3 position, Vector3 direction, float_t angle, float_t range);
+
+private:
+    struct ClusterEntry
+    {
+        uint32_t cluster;
+        uint32_t light;
+    };
+
+    GpuLightClusterData m_GpuData;
+
+    std::vector<LightClusterRange> m_Clusters;
+    std::vector<uint32_t> m_LightIndices;
+
+    /// @brief Lights in view space, x and y along the camera right and up axes, z along its front axis, w the radius
+    std::vector<Vector4> m_ViewLights;
+
+    std::array<float_t, SliceCount + 1> m_SliceDepths {};
+
+    // Written by the job binning each slice
+    std::array<std::vector<ClusterEntry>, SliceCount> m_SliceEntries;
+    std::array<std::vector<uint32_t>, SliceCount> m_SliceIndices;
+
+    XNOR_ENGINE void BinSlice(uint32_t slice);
+
+    XNOR_ENGINE void GetTileRange(float_t center, float_t radius, float_t minDepth, float_t maxDepth, float_t tanHalfFov, uint32_t tileCount, uint32_t* first, uint32_t* last) const;
+};
+
+END_XNOR_CORE
@@ -0,0 +1,115 @@
+﻿#pragma once
+
+#include <unordered_map>
+
+#include "core.hpp"
+
+/// @file shadow_cache.hpp
+/// @brief Defines the XnorCore::ShadowCache class
+
+BEGIN_XNOR_CORE
+
+/// @brief Number of shadow views updated or skipped by a ShadowCache during a frame
+struct ShadowCacheStats
+{
+    /// @brief Views whose static base map was rendered again
+    size_t fullUpdates = 0;
+    /// @brief Views that only composited their dynamic casters on top of the cached base map
+    size_t dynamicUpdates = 0;
+    /// @brief Views left untouched
+    size_t skippedUpdates = 0;
+};
+
+/// @brief Decides which shadow views have to be rendered again
+///
+/// A shadow view is a cascade, a spot light or a point light cube face. Its static casters are rendered in a cached base map,
+/// which is only rendered again when the static signature of the view changes. The signature covers the light view and the
+/// static casters in range, so moving the light or one of these casters invalidates it. Dynamic casters are composited on top of a copy
+/// of the base map each frame they are in range, and once more after they left to erase them.
+/// The state of a view that isn't used for MaxUnusedFrames frames is dropped, so removed lights don't stay in the cache.
+class ShadowCache
+{
+public:
+    /// @brief Work a shadow view needs this frame
+    enum class Update
+    {
+        /// @brief The shadow map is still valid
+        None,
+        /// @brief The base map is valid, the dynamic casters have to be composited on top of it
+        Dynamic,
+        /// @brief The base map has to be rendered again, then the dynamic casters composited on top of it
+        Full
+    };
+
+    /// @brief Initial value of a static signature
+    static constexpr uint64_t SignatureSeed = 14695981039346656037ull;
+
+    /// @brief Number of frames a view can go without being used before its state is dropped
+    static constexpr uint64_t MaxUnusedFrames = 300;
+
+    XNOR_ENGINE ShadowCache() = default;
+    XNOR_ENGINE ~ShadowCache() = default;
+
+    DEFAULT_COPY_MOVE_OPERATIONS(ShadowCache)
+
+    /// @brief Begins a frame, which resets the frame stats and drops the views unused for more than MaxUnusedFrames frames
+    ///
+    /// Called once per application frame, the viewports rendered during a frame share the views that don't depend on the camera
+    XNOR_ENGINE void BeginFrame();
+
+    /// @brief Gets the work a shadow view needs this frame and remembers its new state
+    /// @param viewId Id of the view, stable across frames
+    /// @param staticSignature Signature of the light view and the static casters in range
+    /// @param hasDynamicCasters Whether dynamic casters are in range this frame
+    /// @returns Update
+    [[nodiscard]]
+    XNOR_ENGINE Update GetUpdate(uint32_t viewId, uint64_t staticSignature, bool_t hasDynamicCasters);
+
+    /// @brief Gets the work a shadow view needs this frame, without remembering anything, so that the update can be deferred
+    /// @param viewId Id of the view, stable across frames
+    /// @param staticSignature Signature of the light view and the static casters in range
+    /// @param hasDynamicCasters Whether dynamic casters are in range this frame
+    /// @returns Update
+    [[nodiscard]]
+    XNOR_ENGINE Update PeekUpdate(uint32_t viewId, uint64_t staticSignature, bool_t hasDynamicCasters) const;
+
+    /// @brief Marks a view as used this frame without updating it, so that its state is kept while its update is deferred
+    /// @param viewId Id of the view
+    XNOR_ENGINE void Touch(uint32_t viewId);
+
+    /// @brief Invalidates all the views, so that they are all rendered again
+    XNOR_ENGINE void Invalidate();
+
+    /// @brief Gets the stats of the current frame
+    /// @returns Stats
+    [[nodiscard]]
+    XNOR_ENGINE const ShadowCacheStats& GetStats() const;
+
+    /// @brief Gets the number of views whose state is cached
+    /// @returns View count
+    [[nodiscard]]
+    XNOR_ENGINE size_t GetViewCount() const;
+
+    /// @brief Adds data to a static signature
+    /// @param signature Signature
+    /// @param data Data
+    /// @param size Data size
+    /// @returns New signature
+    [[nodiscard]]
+    XNOR_ENGINE static uint64_t Hash(uint64_t signature, const void* data, size_t size);
+
+private:
+    struct View
+    {
+        uint64_t staticSignature = 0;
+        bool_t hadDynamicCasters = false;
+        uint64_t lastUsedFrame = 0;
+    };
+
+    std::unordered_map<uint32_t, View> m_Views;
+    uint64_t m_Frame = 0;
+
+    ShadowCacheStats m_Stats;
+};
+
+END_XNOR_CORE
@@ -0,0 +1,128 @@
+﻿#pragma once
+
+#include <unordered_map>
+#include <vector>
+
+#include "core.hpp"
+
+/// @file shadow_scheduler.hpp
+/// @brief Defines the XnorCore::ShadowScheduler class
+
+BEGIN_XNOR_CORE
+
+/// @brief Maximum amount of shadow work per frame, a limit of 0 means no limit
+struct ShadowBudget
+{
+    /// @brief Maximum number of shadow views rendered per frame
+    uint32_t maxViews = 0;
+    /// @brief Maximum estimated cost rendered per frame, in draw calls
+    float_t maxCost = 0.f;
+};
+
+/// @brief Shadow view that needs to be rendered this frame
+struct ShadowViewRequest
+{
+    /// @brief Id of the view, stable across frames
+    uint32_t viewId = 0;
+    /// @brief Part of the screen the light covers, between 0 and 1
+    float_t screenCoverage = 0.f;
+    /// @brief Distance from the viewer to the light
+    float_t distance = 0.f;
+    /// @brief Estimated cost of the view, in draw calls
+    float_t cost = 1.f;
+    /// @brief Minimum number of frames between two updates of the view
+    uint32_t updateInterval = 1;
+};
+
+/// @brief Number of shadow views scheduled or deferred during a frame
+struct ShadowSchedulerStats
+{
+    /// @brief Views rendered this frame
+    size_t scheduledViews = 0;
+    /// @brief Views that needed an update but were left for a later frame
+    size_t deferredViews = 0;
+    /// @brief Estimated cost of the views rendered this frame
+    float_t scheduledCost = 0.f;
+};
+
+/// @brief Spreads the shadow view updates over several frames to fit a budget
+///
+/// The views that need an update are submitted each frame, then scheduled by priority until the budget is spent. The priority grows
+/// with the screen coverage of the light and the number of frames since the view was last rendered, and decreases with the distance
+/// to the light, so a deferred view always ends up being rendered. A view is not scheduled again before its update interval elapsed,
+/// and a view that was never rendered is always scheduled since its shadow map holds nothing yet.
+/// Several viewports can be rendered during a frame, their requests are scheduled one after the other without beginning a new frame,
+/// so the update intervals count frames rather than viewports and a view is only rendered once per frame for all of them.
+/// The scheduler only depends on the submitted requests and its own frame counter, so its decisions are reproducible.
+class ShadowScheduler
+{
+public:
+    XNOR_ENGINE ShadowScheduler() = default;
+    XNOR_ENGINE ~ShadowScheduler() = default;
+
+    DEFAULT_COPY_MOVE_OPERATIONS(ShadowScheduler)
+
+    /// @brief Begins a frame, which clears the requests and resets the frame stats
+    XNOR_ENGINE void BeginFrame();
+
+    /// @brief Clears the requests without beginning a frame, to schedule the views of another viewport rendered during the same frame
+    XNOR_ENGINE void ClearRequests();
+
+    /// @brief Submits a view that needs an update this frame
+    /// @param request Request
+    /// @returns Index of the request, to be passed to IsScheduled
+    XNOR_ENGINE size_t Submit(const ShadowViewRequest& request);
+
+    /// @brief Chooses the views rendered this frame and remembers them as updated
+    /// @param budget Budget
+    XNOR_ENGINE void Schedule(const ShadowBudget& budget);
+
+    /// @brief Gets whether a request was scheduled this frame
+    /// @param requestIndex Index returned by Submit
+    /// @returns Whether the view has to be rendered
+    [[nodiscard]]
+    XNOR_ENGINE bool_t IsScheduled(size_t requestIndex) const;
+
+    /// @brief Forgets when the views were last rendered, so that they are all treated as new
+    XNOR_ENGINE void Reset();
+
+    /// @brief Forgets when a view was last rendered, so that it is treated as new, used when a view is given to another light
+    /// @param viewId Id of the view
+    XNOR_ENGINE void Forget(uint32_t viewId);
+
+    /// @brief Gets the stats of the current frame
+    /// @returns Stats
+    [[nodiscard]]
+    XNOR_ENGINE const ShadowSchedulerStats& GetStats() const;
+
+    /// @brief Computes the priority of a request
+    /// @param request Request
+    /// @param staleness Number of frames since the view was last rendered
+    /// @returns Priority, higher is rendered first
+    [[nodiscard]]
+    XNOR_ENGINE static float_t GetPriority(const ShadowViewRequest& request, uint32_t staleness);
+
+private:
+    static constexpr float_t CoverageWeight = 4.f;
+    static constexpr float_t DistanceFalloff = 0.1f;
+
+    struct Candidate
+    {
+        size_t requestIndex = 0;
+        float_t priority = 0.f;
+        bool_t isNew = false;
+    };
+
+    std::vector<ShadowViewRequest> m_Requests;
+    std::vector<bool_t> m_Scheduled;
+    std::vector<Candidate> m_Candidates;
+
+    /// @brief Frame each view was last rendered at
+    std::unordered_map<uint32_t, uint64_t> m_LastUpdates;
+
+    uint64_t m_Frame = 0;
+
+    ShadowSchedulerStats m_Stats;
+};
+
+END_XNOR_CORE
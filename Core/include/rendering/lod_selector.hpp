@@ -0,0 +1,103 @@
+﻿#pragma once
+
+#include <array>
+#include <unordered_map>
+#include <vector>
+
+#include "core.hpp"
+#include "rendering/camera.hpp"
+#include "resource/model.hpp"
+#include "utils/bound.hpp"
+
+/// @file lod_selector.hpp
+/// @brief Defines the XnorCore::LodSelector class
+
+BEGIN_XNOR_CORE
+
+class StaticMeshRenderer;
+
+/// @brief Screen sizes at which the meshes switch detail levels
+struct MeshLodSettings
+{
+    /// @brief Screen size under which each detail level is replaced by the next one, as the fraction of the view height covered by the bounding sphere
+    std::array<float_t, Model::MaxLodCount - 1> screenSizes = { 0.3f, 0.15f, 0.06f };
+    /// @brief Fraction of a screen size a mesh must go past before switching, so a mesh near a threshold doesn't switch every frame
+    float_t hysteresis = 0.15f;
+    /// @brief Number of levels added to the detail level of the shadow casters, their triangles are only seen through the shadow maps
+    uint32_t shadowLodBias = 1;
+};
+
+/// @brief Selects the detail level of the static meshes of a view from their size on screen
+///
+/// The level selected for each mesh is kept from one frame to the next, a mesh only switches level once its screen size went past
+/// a threshold by the hysteresis margin. A selector must therefore be used for a single view.
+class LodSelector
+{
+public:
+    XNOR_ENGINE LodSelector() = default;
+
+    XNOR_ENGINE ~LodSelector() = default;
+
+    DEFAULT_COPY_MOVE_OPERATIONS(LodSelector)
+
+    /// @brief Starts the selection of a new frame, forgetting the meshes that weren't selected during the previous one
+    XNOR_ENGINE void BeginFrame();
+
+    /// @brief Selects the detail level of a mesh
+    /// @param meshRenderer Mesh renderer, its mesh must be valid
+    /// @param camera Camera of the view
+    /// @param settings Screen sizes of the detail levels
+    /// @returns Detail level, 0 being the full detail, to clamp to the level count of each model of the mesh
+    XNOR_ENGINE uint32_t Select(const StaticMeshRenderer& meshRenderer, const Camera& camera, const MeshLodSettings& settings);
+
+    /// @brief Selects the detail level of a mesh seen from several cameras, from its largest size on screen
+    /// @param meshRenderer Mesh renderer, its mesh must be valid
+    /// @param cameras Cameras of the views, must not be empty
+    /// @param settings Screen sizes of the detail levels
+    /// @returns Detail level, 0 being the full detail, to clamp to the level count of each model of the mesh
+    XNOR_ENGINE uint32_t Select(const StaticMeshRenderer& meshRenderer, const std::vector<Camera>& cameras, const MeshLodSettings& settings);
+
+    /// @brief Computes the fraction of the view height covered by a bound
+    /// @param camera Camera of the view
+    /// @param bound World space bound
+    /// @returns Screen size, greater than 1 if the bound covers the whole view
+    [[nodiscard]]
+    XNOR_ENGINE static float_t ComputeScreenSize(const Camera& camera, const Bound& bound);
+
+    /// @brief Computes the largest fraction of the view height covered by a bound among several cameras
+    /// @param cameras Cameras of the views
+    /// @param bound World space bound
+    /// @returns Screen size, 0 if there is no camera
+    [[nodiscard]]
+    XNOR_ENGINE static float_t ComputeScreenSize(const std::vector<Camera>& cameras, const Bound& bound);
+
+    /// @brief Computes the detail level of a mesh from its screen size
+    /// @param screenSize Screen size, see ComputeScreenSize
+    /// @param currentLod Detail level of the mesh during the previous frame
+    /// @param lodCount Number of detail levels of the mesh
+    /// @param settings Screen sizes of the detail levels
+    /// @returns Detail level
+    [[nodiscard]]
+    XNOR_ENGINE static uint32_t ComputeLod(float_t screenSize, uint32_t currentLod, uint32_t lodCount, const MeshLodSettings& settings);
+
+    /// @brief Gets the number of triangles of a mesh at a detail level
+    /// @param meshRenderer Mesh renderer, its mesh must be valid
+    /// @param lod Detail level, clamped to the level count of each model
+    /// @returns Triangle count
+    [[nodiscard]]
+    XNOR_ENGINE static size_t GetTriangleCount(const StaticMeshRenderer& meshRenderer, uint32_t lod);
+
+private:
+    struct Selection
+    {
+        uint32_t lod = 0;
+        uint32_t frame = 0;
+    };
+
+    std::unordered_map<const StaticMeshRenderer*, Selection> m_Selections;
+    uint32_t m_Frame = 0;
+
+    XNOR_ENGINE uint32_t SelectFromScreenSize(const StaticMeshRenderer& meshRenderer, float_t screenSize, const MeshLodSettings& settings);
+};
+
+END_XNOR_CORE
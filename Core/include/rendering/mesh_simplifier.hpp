@@ -0,0 +1,43 @@
+﻿#pragma once
+
+#include <vector>
+
+#include "core.hpp"
+#include "rendering/vertex.hpp"
+
+/// @file mesh_simplifier.hpp
+/// @brief Defines the XnorCore::MeshSimplifier class
+
+BEGIN_XNOR_CORE
+
+/// @brief Reduces the triangle count of a mesh with edge collapses ordered by quadric error
+///
+/// Each collapse moves a vertex onto one of its neighbors, so the simplified triangles reference the original vertices and keep their
+/// attributes. The vertices sharing a position with different attributes, such as the ones on a texture seam, and the vertices on
+/// the border of the mesh never move, so the simplified mesh keeps its silhouette and its texture mapping.
+class MeshSimplifier
+{
+    STATIC_CLASS(MeshSimplifier)
+
+public:
+    /// @brief Simplifies a triangle list
+    /// @param vertices Vertices
+    /// @param indices Triangle list indices
+    /// @param targetIndexCount Index count to reach, the result is bigger if the mesh can't be simplified that much
+    /// @param result Simplified triangle list indices, in the same vertices
+    XNOR_ENGINE static void Simplify(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, size_t targetIndexCount, std::vector<uint32_t>* result);
+
+    /// @brief Keeps only the vertices used by a triangle list
+    /// @param vertices Vertices
+    /// @param indices Triangle list indices
+    /// @param usedVertices Used vertices, in the order of their first use
+    /// @param remappedIndices Indices in the used vertices
+    XNOR_ENGINE static void CompactVertices(
+        const std::vector<Vertex>& vertices,
+        const std::vector<uint32_t>& indices,
+        std::vector<Vertex>* usedVertices,
+        std::vector<uint32_t>* remappedIndices
+    );
+};
+
+END_XNOR_CORE
@@ -0,0 +1,96 @@
+﻿#pragma once
+
+#include <vector>
+
+#include "core.hpp"
+#include "rendering/frustum.hpp"
+#include "utils/bound.hpp"
+
+/// @file multi_view_culler.hpp
+/// @brief Defines the XnorCore::MultiViewCuller class
+
+BEGIN_XNOR_CORE
+
+/// @brief Work done by the last call to MultiViewCuller::Cull
+struct MultiViewCullerStats
+{
+    /// @brief Number of views
+    size_t views = 0;
+    /// @brief Number of candidates
+    size_t candidates = 0;
+    /// @brief Chunk bounds tested against a frustum
+    size_t chunkTests = 0;
+    /// @brief Candidate bounds tested against a frustum, culling each view on its own tests views * candidates bounds
+    size_t boundTests = 0;
+};
+
+/// @brief Culls a set of bounds against many views at once
+///
+/// The candidates are sorted along a Morton curve and grouped in chunks of nearby bounds. Each chunk is tested once against all the
+/// frusta, which gives a bitmask of the views it may be seen from, then its bounds are only tested against those views. The result is
+/// a visibility bitmask per candidate, expanded afterward into a list per view. The chunks are culled on the JobSystem.
+class MultiViewCuller
+{
+public:
+    /// @brief Number of candidates per chunk
+    static constexpr size_t ChunkSize = 32;
+
+    XNOR_ENGINE MultiViewCuller() = default;
+
+    XNOR_ENGINE ~MultiViewCuller() = default;
+
+    DEFAULT_COPY_MOVE_OPERATIONS(MultiViewCuller)
+
+    /// @brief Culls the candidates against every view, replacing the previous results
+    /// @param frusta View frusta
+    /// @param bounds Bounds, indexed by the candidates
+    /// @param candidates Indices of the bounds to cull
+    XNOR_ENGINE void Cull(const std::vector<Frustum>& frusta, const std::vector<Bound>& bounds, const std::vector<uint32_t>& candidates);
+
+    /// @brief Gets the candidates visible from a view
+    /// @param view View index in the frusta given to Cull
+    /// @returns Indices of the bounds, in the order of the candidates
+    [[nodiscard]]
+    XNOR_ENGINE const std::vector<uint32_t>& GetVisible(size_t view) const;
+
+    /// @brief Gets whether a candidate is visible from a view
+    /// @param candidate Candidate index in the candidates given to Cull
+    /// @param view View index in the frusta given to Cull
+    /// @returns Visible
+    [[nodiscard]]
+    XNOR_ENGINE bool_t IsVisible(size_t candidate, size_t view) const;
+
+    /// @brief Gets the work done by the last call to Cull
+    /// @returns Stats
+    [[nodiscard]]
+    XNOR_ENGINE const MultiViewCullerStats& GetStats() const;
+
+private:
+    /// @brief Candidate in the Morton order of the center of its bound
+    struct SortedCandidate
+    {
+        uint32_t mortonCode;
+        /// @brief Position in the candidates given to Cull
+        uint32_t candidate;
+    };
+
+    // Number of 64 bits words in a view mask
+    size_t m_MaskWordCount = 0;
+
+    // Sorted by code, then by position
+    std::vector<SortedCandidate> m_SortedCandidates;
+    std::vector<uint64_t> m_ChunkMasks;
+    std::vector<size_t> m_ChunkBoundTests;
+    // View mask of each candidate, in the order of the candidates
+    std::vector<uint64_t> m_Masks;
+
+    std::vector<std::vector<uint32_t>> m_Visible;
+
+    MultiViewCullerStats m_Stats;
+
+    XNOR_ENGINE void SortCandidates(const std::vector<Bound>& bounds, const std::vector<uint32_t>& candidates);
+
+    XNOR_ENGINE void CullChunk(const std::vector<Frustum>& frusta, const std::vector<Bound>& bounds, const std::vector<uint32_t>& candidates, size_t chunk);
+};
+
+END_XNOR_CORE
@@ -0,0 +1,165 @@
+﻿#pragma once
+
+#include <limits>
+#include <vector>
+
+#include <Maths/matrix.hpp>
+#include <Maths/vector2.hpp>
+#include <Maths/vector2i.hpp>
+#include <Maths/vector4.hpp>
+
+#include "core.hpp"
+#include "rendering/vertex.hpp"
+#include "utils/bound.hpp"
+
+/// @file occlusion_culler.hpp
+/// @brief Defines the XnorCore::OcclusionCuller class
+
+BEGIN_XNOR_CORE
+
+/// @brief Work done by an OcclusionCuller since the last call to OcclusionCuller::Begin
+struct OcclusionCullerStats
+{
+    /// @brief Occluder meshes rasterized
+    size_t occluders = 0;
+    /// @brief Occluder triangles rasterized, the ones crossing the camera plane are skipped
+    size_t rasterizedTriangles = 0;
+};
+
+/// @brief Culls the bounds hidden behind occluders, entirely on the CPU
+///
+/// The occluders of a view are rasterized with SSE into a low resolution depth buffer, 4 pixels at a time. A hierarchy of min and max
+/// depths is then built from it, each level half the size of the previous one. A bound is tested from the coarsest level its screen
+/// rectangle fits in: a texel hides it if the bound is behind its max depth, and shows it if the bound is in front of its min depth,
+/// otherwise its children are tested. The depth is the normalized device z, smaller is closer.
+///
+/// The rasterization is conservative: a pixel only gets the depth of an occluder if the occluder covers all of it, and gets the farthest
+/// depth of the occluder over the pixel. The edges shared by two triangles of an occluder that cover both sides of it are sampled at
+/// the pixel centers instead. The pixels crossing them are covered by the triangles around as long as they are entirely inside the
+/// silhouette edges nearby.
+class OcclusionCuller
+{
+public:
+    /// @brief Width of the depth buffer, a multiple of the SIMD width
+    static constexpr int32_t Width = 256;
+    /// @brief Height of the depth buffer
+    static constexpr int32_t Height = 128;
+    /// @brief Depth of the pixels no occluder covers
+    static constexpr float_t FarDepth = std::numeric_limits<float_t>::max();
+
+    XNOR_ENGINE OcclusionCuller() = default;
+
+    XNOR_ENGINE ~OcclusionCuller() = default;
+
+    DEFAULT_COPY_MOVE_OPERATIONS(OcclusionCuller)
+
+    /// @brief Clears the depth buffer to start rasterizing the occluders of a view
+    /// @param viewProjection View projection matrix of the view
+    XNOR_ENGINE void Begin(const Matrix& viewProjection);
+
+    /// @brief Rasterizes an occluder in the depth buffer
+    /// @param vertices Vertices, in model space
+    /// @param indices Triangle list indices
+    /// @param modelMatrix Model matrix
+    XNOR_ENGINE void RasterizeOccluder(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, const Matrix& modelMatrix);
+
+    /// @brief Builds the depth hierarchy once all the occluders are rasterized
+    XNOR_ENGINE void End();
+
+    /// @brief Gets whether a bound is hidden by the occluders, a bound outside of the view or crossing the camera plane is never occluded
+    /// @param bound World bound
+    /// @returns Occluded
+    [[nodiscard]]
+    XNOR_ENGINE bool_t IsOccluded(const Bound& bound) const;
+
+    /// @brief Gets the depth of a pixel
+    /// @param x Pixel column
+    /// @param y Pixel row, from the bottom
+    /// @returns Depth, or FarDepth if no occluder covers it
+    [[nodiscard]]
+    XNOR_ENGINE float_t GetDepth(int32_t x, int32_t y) const;
+
+    /// @brief Gets the number of levels of the depth hierarchy
+    /// @returns Level count
+    [[nodiscard]]
+    XNOR_ENGINE size_t GetLevelCount() const;
+
+    /// @brief Gets the work done since the last call to Begin
+    /// @returns Stats
+    [[nodiscard]]
+    XNOR_ENGINE const OcclusionCullerStats& GetStats() const;
+
+private:
+    /// @brief Level of the depth hierarchy
+    struct DepthLevel
+    {
+        int32_t width = 0;
+        int32_t height = 0;
+        std::vector<float_t> minDepth;
+        std::vector<float_t> maxDepth;
+    };
+
+    /// @brief Edge of a triangle of the current occluder
+    struct OccluderEdge
+    {
+        /// @brief Welded ids of both ends, the smallest one in the high bits
+        uint64_t key;
+        /// @brief Index of the first index of the triangle
+        size_t triangle;
+        /// @brief Edge of the triangle, going from its vertex edge to its vertex (edge + 1) % 3
+        uint32_t edge;
+        /// @brief Whether the opposite vertex of the triangle is on the left of the edge going from the smallest id to the largest one
+        bool_t isLeft;
+    };
+
+    /// @brief Silhouette edge of the current occluder, in screen space
+    struct SilhouetteEdge
+    {
+        Vector2 min;
+        Vector2 max;
+        /// @brief Plane of the weight of the opposite vertex of its triangle, as dx, dy, offset and the smallest weight of the pixels entirely inside
+        Vector4 plane;
+    };
+
+    Matrix m_ViewProjection;
+
+    // The occluders are rasterized in the max depths of the first level, both depths are the same at full resolution
+    std::vector<DepthLevel> m_Levels;
+    // Screen position and depth of the vertices of the current occluder, w is the clip w
+    std::vector<Vector4> m_ScreenVertices;
+    // Id of the first vertex with the same position, for each vertex of the current occluder
+    std::vector<uint32_t> m_PositionIds;
+    std::vector<uint32_t> m_SortedVertices;
+    // Edges of the current occluder, sorted by key
+    std::vector<OccluderEdge> m_Edges;
+    std::vector<SilhouetteEdge> m_SilhouetteEdges;
+    // Planes of the silhouette edges near the triangle being rasterized
+    std::vector<Vector4> m_SilhouettePlanes;
+
+    OcclusionCullerStats m_Stats;
+
+    XNOR_ENGINE void WeldVertices(const std::vector<Vertex>& vertices);
+
+    [[nodiscard]]
+    XNOR_ENGINE OccluderEdge GetEdge(const std::vector<uint32_t>& indices, size_t triangle, uint32_t edge) const;
+
+    /// @brief Gets whether another triangle covers the other side of an edge
+    [[nodiscard]]
+    XNOR_ENGINE bool_t IsInteriorEdge(const OccluderEdge& edge) const;
+
+    /// @brief Rasterizes a triangle, its edges a -> b, b -> c and c -> a are interior if bits 0, 1 and 2 of interiorEdges are set
+    ///
+    /// The pixels must also be entirely inside the given silhouette planes, see SilhouetteEdge::plane
+    XNOR_ENGINE void RasterizeTriangle(
+        const Vector4& a,
+        const Vector4& b,
+        const Vector4& c,
+        uint32_t interiorEdges,
+        const std::vector<Vector4>& silhouettePlanes
+    );
+
+    [[nodiscard]]
+    XNOR_ENGINE bool_t IsTexelOccluded(size_t level, int32_t x, int32_t y, Vector2i pixelMin, Vector2i pixelMax, float_t minZ, float_t maxZ) const;
+};
+
+END_XNOR_CORE
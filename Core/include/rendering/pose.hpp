@@ -0,0 +1,105 @@
+#pragma once
+
+#include <array>
+
+#include "core.hpp"
+#include "Maths/quaternion.hpp"
+#include "Maths/vector3.hpp"
+#include "utils/list.hpp"
+
+/// @file pose.hpp
+/// @brief Defines the XnorCore::Pose class
+
+BEGIN_XNOR_CORE
+
+/// @brief Local transforms of the bones of a skeleton, stored as a structure of arrays
+///
+/// Each component of the transforms has its own contiguous array, so a pose can be processed several bones at a time.
+/// The arrays are padded to a multiple of SimdWidth bones with identity transforms, so SIMD kernels never need a scalar tail.
+/// The arrays are only reallocated when the pose grows, so a pose reused every frame doesn't allocate
+class Pose
+{
+public:
+    /// @brief Number of components of a translation
+    static constexpr size_t TranslationComponents = 3;
+    /// @brief Number of components of a rotation
+    static constexpr size_t RotationComponents = 4;
+    /// @brief Number of bones processed at once by the SIMD kernels
+    static constexpr size_t SimdWidth = 4;
+
+    /// @brief Rounds a bone count up to a multiple of SimdWidth
+    /// @param boneCount Bone count
+    /// @returns Padded bone count
+    [[nodiscard]]
+    XNOR_ENGINE static size_t GetPaddedCount(size_t boneCount);
+
+    XNOR_ENGINE Pose() = default;
+    XNOR_ENGINE explicit Pose(size_t boneCount);
+    XNOR_ENGINE ~Pose() = default;
+
+    DEFAULT_COPY_MOVE_OPERATIONS(Pose)
+
+    /// @brief Resizes the pose, new bones and the padding past the last bone have an identity transform
+    /// @param boneCount Bone count
+    XNOR_ENGINE void Resize(size_t boneCount);
+
+    /// @brief Gets the number of bones of the pose
+    /// @returns Bone count
+    [[nodiscard]]
+    XNOR_ENGINE size_t GetBoneCount() const;
+
+    /// @brief Gets the size of the component arrays, which is the bone count rounded up to a multiple of SimdWidth
+    /// @returns Padded bone count
+    [[nodiscard]]
+    XNOR_ENGINE size_t GetPaddedBoneCount() const;
+
+    /// @brief Sets the translation of a bone
+    /// @param bone Bone index
+    /// @param translation Translation
+    XNOR_ENGINE void SetTranslation(size_t bone, const Vector3& translation);
+
+    /// @brief Gets the translation of a bone
+    /// @param bone Bone index
+    /// @returns Translation
+    [[nodiscard]]
+    XNOR_ENGINE Vector3 GetTranslation(size_t bone) const;
+
+    /// @brief Sets the rotation of a bone
+    /// @param bone Bone index
+    /// @param rotation Rotation
+    XNOR_ENGINE void SetRotation(size_t bone, const Quaternion& rotation);
+
+    /// @brief Gets the rotation of a bone
+    /// @param bone Bone index
+    /// @returns Rotation
+    [[nodiscard]]
+    XNOR_ENGINE Quaternion GetRotation(size_t bone) const;
+
+    /// @brief Gets the array of a translation component for all the bones
+    /// @param component Component index, 0 for x, 1 for y and 2 for z
+    /// @returns Component array
+    [[nodiscard]]
+    XNOR_ENGINE float_t* GetTranslations(size_t component);
+
+    /// @copydoc GetTranslations(size_t)
+    [[nodiscard]]
+    XNOR_ENGINE const float_t* GetTranslations(size_t component) const;
+
+    /// @brief Gets the array of a rotation component for all the bones
+    /// @param component Component index, 0 for x, 1 for y, 2 for z and 3 for w
+    /// @returns Component array
+    [[nodiscard]]
+    XNOR_ENGINE float_t* GetRotations(size_t component);
+
+    /// @copydoc GetRotations(size_t)
+    [[nodiscard]]
+    XNOR_ENGINE const float_t* GetRotations(size_t component) const;
+
+private:
+    size_t m_BoneCount = 0;
+
+    std::array<List<float_t>, TranslationComponents> m_Translations;
+    std::array<List<float_t>, RotationComponents> m_Rotations;
+};
+
+END_XNOR_CORE
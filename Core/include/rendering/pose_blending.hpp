@@ -0,0 +1,63 @@
+#pragma once
+
+#include "core.hpp"
+
+/// @file pose_blending.hpp
+/// @brief Defines the XnorCore::PoseBlending class
+
+BEGIN_XNOR_CORE
+
+class BoneMask;
+class Pose;
+
+/// @brief Blends poses using SIMD kernels
+///
+/// The kernels process Pose::SimdWidth bones at once using the structure of arrays layout of the poses. Rotations are blended with
+/// a normalized linear interpolation, after flipping the rotations that are in the opposite hemisphere so the shortest path is taken.
+/// The result can be one of the blended poses
+class PoseBlending
+{
+    STATIC_CLASS(PoseBlending)
+
+public:
+    /// @brief Interpolates between two poses, used for cross fades and override layers
+    /// @param a Start pose
+    /// @param b End pose, must have the same bone count as @p a
+    /// @param weight Interpolation factor, 0 gives @p a and 1 gives @p b
+    /// @param mask Optional per-bone multiplier of the weight, ignored if it doesn't cover all the bones
+    /// @param result Blended pose
+    XNOR_ENGINE static void Blend(const Pose& a, const Pose& b, float_t weight, const BoneMask* mask, Pose* result);
+
+    /// @brief Applies an additive pose on top of a base pose
+    ///
+    /// The additive translations are added to the base ones, and the additive rotations are applied after the base ones in the bone space
+    /// @param base Base pose
+    /// @param additive Additive pose, as computed by ComputeAdditive, must have the same bone count as @p base
+    /// @param weight Amount of the additive pose to apply
+    /// @param mask Optional per-bone multiplier of the weight, ignored if it doesn't cover all the bones
+    /// @param result Blended pose
+    XNOR_ENGINE static void BlendAdditive(const Pose& base, const Pose& additive, float_t weight, const BoneMask* mask, Pose* result);
+
+    /// @brief Blends any number of poses together according to their weights
+    /// @param poses Poses, must all have the same bone count
+    /// @param weights Weight of each pose, they are normalized so they don't need to sum to 1
+    /// @param poseCount Number of poses
+    /// @param result Blended pose
+    XNOR_ENGINE static void BlendWeighted(const Pose* const* poses, const float_t* weights, size_t poseCount, Pose* result);
+
+    /// @brief Computes the difference between a pose and a reference pose, to be used as an additive pose
+    /// @param pose Pose
+    /// @param reference Reference pose, usually the first frame of the additive animation, must have the same bone count as @p pose
+    /// @param result Additive pose
+    XNOR_ENGINE static void ComputeAdditive(const Pose& pose, const Pose& reference, Pose* result);
+
+    /// @brief Converts a local pose to a model-space pose by applying the transform of each bone parent
+    ///
+    /// Groups of bones whose parents all come before the group are transformed at once, the other ones bone by bone
+    /// @param local Local pose
+    /// @param parents Parent index of each bone, -1 for a root, a parent must come before its children
+    /// @param model Model-space pose, can't be @p local
+    XNOR_ENGINE static void ComputeModelPose(const Pose& local, const int32_t* parents, Pose* model);
+};
+
+END_XNOR_CORE
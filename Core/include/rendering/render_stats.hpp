@@ -0,0 +1,144 @@
+﻿#pragma once
+
+#include <atomic>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "core.hpp"
+
+/// @file render_stats.hpp
+/// @brief Defines the XnorCore::RenderStats class
+
+BEGIN_XNOR_CORE
+
+/// @brief Work submitted to the rendering API
+struct RenderCounters
+{
+    /// @brief Draw calls
+    uint64_t drawCalls = 0;
+    /// @brief Triangles of the draw calls
+    uint64_t triangles = 0;
+    /// @brief Changes of the fixed function state, such as the depth test, the blending, the culling, the viewport or the framebuffer
+    uint64_t stateChanges = 0;
+    /// @brief Shader programs bound
+    uint64_t shaderBinds = 0;
+    /// @brief Textures and images bound
+    uint64_t textureBinds = 0;
+    /// @brief Writes to a GPU buffer
+    uint64_t bufferUploads = 0;
+    /// @brief Bytes written to the GPU buffers
+    uint64_t uploadedBytes = 0;
+};
+
+/// @brief Work submitted by a pass during a frame
+struct PassRenderStats
+{
+    /// @brief Name given to RenderStats::BeginPass
+    std::string name;
+    /// @brief Counters
+    RenderCounters counters;
+};
+
+/// @brief Work submitted during a frame
+struct FrameRenderStats
+{
+    /// @brief Index of the frame
+    uint64_t frame = 0;
+    /// @brief Counters of all the passes
+    RenderCounters total;
+    /// @brief Counters of each pass, in the order they first ran, the first one holds the work done outside of any pass
+    std::vector<PassRenderStats> passes;
+};
+
+/// @brief Counts the work the Rhi submits to the rendering API, per pass and per frame
+///
+/// The Rhi increments the counters of the current pass with relaxed atomic additions, so counting costs next to nothing and may
+/// happen on any thread. The counters are moved to the pass they belong to when a pass begins or ends, so the work of a nested pass
+/// isn't counted by its parent. A frame ends when the buffers are swapped, its counters can then be read with GetLastFrame.
+class RenderStats
+{
+    STATIC_CLASS(RenderStats)
+
+public:
+    /// @brief Name of the pass holding the work done outside of any pass
+    static constexpr const char_t* OtherPassName = "Other";
+
+    /// @brief Counts a draw call
+    /// @param triangleCount Triangles drawn
+    XNOR_ENGINE static void AddDrawCall(uint64_t triangleCount);
+
+    /// @brief Counts a change of the fixed function state
+    XNOR_ENGINE static void AddStateChange();
+
+    /// @brief Counts a shader program bind
+    XNOR_ENGINE static void AddShaderBind();
+
+    /// @brief Counts a texture or image bind
+    XNOR_ENGINE static void AddTextureBind();
+
+    /// @brief Counts a write to a GPU buffer
+    /// @param size Bytes written
+    XNOR_ENGINE static void AddBufferUpload(size_t size);
+
+    /// @brief Begins a pass, the work submitted until the matching EndPass is counted in it
+    ///
+    /// The passes with the same name are merged, so a pass running once per view is reported once per frame
+    ///
+    /// @param name Pass name
+    XNOR_ENGINE static void BeginPass(const char_t* name);
+
+    /// @brief Ends the current pass, the work is then counted in its parent
+    XNOR_ENGINE static void EndPass();
+
+    /// @brief Ends the current frame, its counters replace the ones of the last frame
+    XNOR_ENGINE static void EndFrame();
+
+    /// @brief Gets the counters of the last frame
+    /// @returns Frame counters
+    [[nodiscard]]
+    XNOR_ENGINE static const FrameRenderStats& GetLastFrame();
+
+    /// @brief Adds a set of counters to another one
+    /// @param counters Counters to add to
+    /// @param other Counters to add
+    XNOR_ENGINE static void Accumulate(RenderCounters* counters, const RenderCounters& other);
+
+    /// @brief Writes the counters of a frame as JSON
+    /// @param frameStats Frame counters
+    /// @returns JSON text
+    [[nodiscard]]
+    XNOR_ENGINE static std::string ToJson(const FrameRenderStats& frameStats);
+
+    /// @brief Writes the counters of the last frame to a JSON file
+    /// @param filepath File path
+    /// @returns Whether the file could be written
+    XNOR_ENGINE static bool_t SaveJson(const std::filesystem::path& filepath);
+
+private:
+    // Zero initialized, like every std::atomic since C++20
+    struct AtomicCounters
+    {
+        std::atomic<uint64_t> drawCalls;
+        std::atomic<uint64_t> triangles;
+        std::atomic<uint64_t> stateChanges;
+        std::atomic<uint64_t> shaderBinds;
+        std::atomic<uint64_t> textureBinds;
+        std::atomic<uint64_t> bufferUploads;
+        std::atomic<uint64_t> uploadedBytes;
+    };
+
+    // Work submitted since the current pass began or resumed
+    XNOR_ENGINE static inline AtomicCounters m_Counters;
+
+    XNOR_ENGINE static inline FrameRenderStats m_CurrentFrame;
+    XNOR_ENGINE static inline FrameRenderStats m_LastFrame;
+
+    // Indices of the running passes in m_CurrentFrame, the innermost last
+    XNOR_ENGINE static inline std::vector<size_t> m_PassStack;
+
+    /// @brief Moves the counters to the current pass
+    XNOR_ENGINE static void Flush();
+};
+
+END_XNOR_CORE
@@ -1,18 +1,31 @@
 ﻿#pragma once
 
+#include <array>
+#include <limits>
 #include <map>
+#include <mutex>
+#include <vector>
 
 #include "core.hpp"
+#include "data_structure/octree.hpp"
 #include "rendering/light/directional_light.hpp"
 #include "rendering/light/point_light.hpp"
 #include "rendering/light/spot_light.hpp"
 #include "rendering/camera.hpp"
 #include "rendering/frame_buffer.hpp"
+#include "rendering/frustum.hpp"
 #include "rendering/light/cascade_shadow_map.hpp"
+#include "rendering/light/light_cluster_grid.hpp"
+#include "rendering/light/shadow_cache.hpp"
+#include "rendering/light/shadow_scheduler.hpp"
+#include "rendering/multi_view_culler.hpp"
 #include "resource/model.hpp"
 #include "resource/shader.hpp"
 #include "resource/texture.hpp"
 #include "scene/scene.hpp"
+#include "scene/component/skinned_mesh_renderer.hpp"
+#include "scene/component/static_mesh_renderer.hpp"
+#include "utils/bound.hpp"
 
 /// @file light_manager.hpp
 /// @brief Defines the XnorCore::LightManager class.
@@ -31,7 +44,24 @@ private:
 
     static constexpr float_t LightThreshold = 30.f;
     static constexpr TextureInternalFormat::TextureInternalFormat ShadowDepthTextureInternalFormat = TextureInternalFormat::DepthComponent32F;
+
+    /// @brief Shadow cache id of the first spot light view, the directional cascades come first
+    static constexpr uint32_t SpotLightViewOffset = DirectionalCascadeLevel + 1;
+    /// @brief Shadow cache id of the first point light face
+    static constexpr uint32_t PointLightViewOffset = SpotLightViewOffset + MaxSpotLightShadows;
+
+    /// @brief Minimum number of frames between two updates of each cascade, the far cascades cover more of the scene for less of the screen
+    static constexpr std::array<uint32_t, DirectionalCascadeLevel + 1> CascadeUpdateIntervals = { 1, 1, 2, 4, 8 };
 public:
+    /// @brief Whether the shadow maps are cached between frames, see ShadowCache
+    XNOR_ENGINE static inline bool_t enableShadowCache = true;
+
+    /// @brief Whether the casters are culled against all the shadow views at once, see MultiViewCuller, instead of once per view
+    XNOR_ENGINE static inline bool_t enableMultiViewCulling = true;
+
+    /// @brief Shadow work allowed per frame, the views over budget are updated in a later frame, see ShadowScheduler
+    XNOR_ENGINE static inline ShadowBudget shadowBudget;
+
     XNOR_ENGINE LightManager() = default;
 
     XNOR_ENGINE ~LightManager();
@@ -41,10 +71,37 @@ public:
     /// @brief Initializes the light manager resources
     XNOR_ENGINE void InitResources();
 
-    /// @brief Computes the internal lights to send to the GPU
+    /// @brief Registers a light, only the registered lights are rendered, can be called from any thread
+    ///
+    /// The lights of every scene share the registry, each frame only renders the lights of the scene it is given
+    /// @param light Light
+    XNOR_ENGINE static void RegisterLight(const Light* light);
+
+    /// @brief Unregisters a light, can be called from any thread
+    /// @param light Light
+    XNOR_ENGINE static void UnregisterLight(const Light* light);
+
+    /// @brief Gets a copy of the registered lights of every scene, in no particular order
+    /// @returns Lights
+    [[nodiscard]]
+    XNOR_ENGINE static std::vector<const Light*> GetRegisteredLights();
+
+    /// @brief Culls the registered lights of the scene against the view and computes the visible ones to send to the GPU
+    ///
+    /// The shadow views to update are chosen here, and rendered by RenderShadows
     /// @param scene Concerned scene
+    /// @param viewport Concerned viewport
     /// @param renderer Concerned renderer
     XNOR_ENGINE void BeginFrame(const Scene& scene, const Viewport& viewport, Renderer& renderer);
+
+    /// @brief Renders the shadow views chosen by BeginFrame
+    /// @param renderer Concerned renderer
+    XNOR_ENGINE void RenderShadows(Renderer& renderer);
+
+    /// @brief Gets the skinned casters of the shadow views rendered by RenderShadows
+    /// @returns Indices in MeshesDrawer::GetSkinnedMeshes, in increasing order
+    [[nodiscard]]
+    XNOR_ENGINE const std::vector<uint32_t>& GetShadowSkinnedCasters() const;
     
     /// @brief End frame
     /// @param scene Concerned scene
@@ -67,6 +124,16 @@ public:
     /// @brief Binds the shadow map
     XNOR_ENGINE void UnBindShadowMap() const;
 
+    /// @brief Gets the shadow cache stats of the last frame
+    /// @returns Stats
+    [[nodiscard]]
+    XNOR_ENGINE const ShadowCacheStats& GetShadowCacheStats() const;
+
+    /// @brief Gets the shadow scheduler stats of the last frame
+    /// @returns Stats
+    [[nodiscard]]
+    XNOR_ENGINE const ShadowSchedulerStats& GetShadowSchedulerStats() const;
+
 private:
     enum class RenderingLight
     {
@@ -82,6 +149,71 @@ private:
         RenderingLight type;
     };
 
+    /// @brief Shadow casters drawn in a view, as indices in MeshesDrawer::GetStaticMeshes and MeshesDrawer::GetSkinnedMeshes
+    struct ShadowCasters
+    {
+        std::vector<uint32_t> staticCasters;
+        std::vector<uint32_t> skinnedCasters;
+    };
+
+    /// @brief Shadow map layer rendered from a single camera
+    struct ShadowView
+    {
+        const Camera* camera = nullptr;
+        Vector2i size;
+        Texture* shadowMap = nullptr;
+        Texture* staticShadowMap = nullptr;
+        uint32_t layer = 0;
+        bool_t isPointLightFace = false;
+        // Whether the static casters are rendered in a base map kept by the shadow cache
+        bool_t isCached = true;
+        // Only used by the cascades, whether the shadow map holds the cascade of another viewport
+        bool_t isOverwritten = false;
+    };
+
+    /// @brief Volume a caster must reach on top of the frustum of a shadow view
+    enum class ShadowVolume
+    {
+        /// @brief The shadow of the caster reaches the slice of the view a cascade is sampled in
+        CascadeReceiver,
+        /// @brief The caster is within the cone of a spot light
+        Cone,
+        /// @brief The caster is within the range of a point light
+        Sphere
+    };
+
+    /// @brief Shadow view of the frame, gathered before the casters of all the views are culled at once
+    struct ShadowViewSetup
+    {
+        Camera camera;
+        Frustum frustum;
+        ShadowView view;
+        ShadowViewRequest request;
+        Matrix lightSpaceMatrix;
+        bool_t hasLightSpaceMatrix = false;
+        Matrix* gpuLightSpaceMatrix = nullptr;
+        ShadowVolume volume = ShadowVolume::Sphere;
+        // Only used by the cascades
+        Frustum receiverFrustum;
+        Vector3 shadowOffset;
+        // Only used by the spot lights, in radians
+        float_t coneAngle = 0.f;
+    };
+
+    /// @brief Shadow view waiting for the scheduler
+    struct PendingShadowView
+    {
+        Camera camera;
+        ShadowView view;
+        ShadowCasters casters;
+        uint32_t viewId = 0;
+        uint64_t staticSignature = 0;
+        size_t requestIndex = 0;
+        Matrix lightSpaceMatrix;
+        // Matrix sampled by the shaders, only updated along with the shadow map
+        Matrix* gpuLightSpaceMatrix = nullptr;
+    };
+
     struct RenderingLightStruct
     {
         float_t scaleFactor = 2.f;
@@ -116,26 +248,138 @@ private:
     Texture* m_DepthBufferForPointLightPass = nullptr;
     Texture* m_DirectionalShadowMaps = nullptr;
 
-    mutable std::vector<const PointLight*> m_PointLights;
-    mutable std::vector<const SpotLight*> m_SpotLights;
-    mutable std::vector<const DirectionalLight*> m_DirectionalLights;
+    // Base maps holding only the static casters, see ShadowCache
+    Texture* m_DirectionalStaticShadowMaps = nullptr;
+    Texture* m_SpotLightStaticShadowMapTextureArray = nullptr;
+    Texture* m_PointLightStaticShadowMapCubemapArray = nullptr;
+
+    // Lights can be created while loading a scene on another thread, the registry and its version are guarded by the mutex
+    XNOR_ENGINE static inline std::mutex m_RegistryMutex;
+    XNOR_ENGINE static inline std::vector<const Light*> m_RegisteredLights;
+    // Incremented each time a light is registered or unregistered
+    XNOR_ENGINE static inline uint64_t m_RegistryVersion = 0;
+
+    // Registered lights of the rendered scene, sorted by type, only rebuilt when the registry or the scene changes
+    uint64_t m_RegisteredLightsVersion = std::numeric_limits<uint64_t>::max();
+    const Scene* m_RegisteredLightsScene = nullptr;
+    std::vector<const Light*> m_SceneLights;
+    std::vector<const PointLight*> m_RegisteredPointLights;
+    std::vector<const SpotLight*> m_RegisteredSpotLights;
+    std::vector<const DirectionalLight*> m_RegisteredDirectionalLights;
+
+    // Bounds of the enabled lights and the spatial index built from them, only rebuilt when a light moved or changed
+    std::vector<ObjectBounding<const PointLight>> m_PointLightBounds;
+    std::vector<ObjectBounding<const SpotLight>> m_SpotLightBounds;
+    std::vector<ObjectBounding<const PointLight>> m_NewPointLightBounds;
+    std::vector<ObjectBounding<const SpotLight>> m_NewSpotLightBounds;
+    Octree<const PointLight> m_PointLightOctree;
+    Octree<const SpotLight> m_SpotLightOctree;
+
+    // Lights visible in the current view, the only ones sent to the GPU
+    std::vector<const PointLight*> m_PointLights;
+    std::vector<const SpotLight*> m_SpotLights;
+    std::vector<const DirectionalLight*> m_DirectionalLights;
+
+    // Light owning each shadow map slot, a light keeps its slot while it stays visible so that its cached maps stay valid
+    std::array<const PointLight*, MaxPointLightShadows> m_PointLightShadowOwners {};
+    std::array<const SpotLight*, MaxSpotLightShadows> m_SpotLightShadowOwners {};
+    std::vector<uint32_t> m_ReassignedShadowSlots;
+
+    // Light data of the frame, uploaded to the light storage buffers
+    std::vector<PointLightData> m_PointLightData;
+    std::vector<SpotLightData> m_SpotLightData;
+    std::vector<DirectionalLightData> m_DirectionalLightData;
+
+    // Bounding spheres of the point lights then the spot lights, in the order of the light index buffer
+    std::vector<ClusteredLight> m_ClusteredLights;
+    LightClusterGrid m_LightClusterGrid;
+
+    // World bounds of the meshes of the frame, in the order of the meshes drawer
+    std::vector<Bound> m_StaticCasterBounds;
+    std::vector<Bound> m_SkinnedCasterBounds;
+
+    // Every caster of the scene, then the ones of the current view
+    ShadowCasters m_SceneCasters;
+    ShadowCasters m_ViewCasters;
+
+    // Shadow views of the frame, kept across frames to avoid reallocating them
+    std::vector<ShadowViewSetup> m_ShadowViewSetups;
+    size_t m_ShadowViewCount = 0;
+    std::vector<Frustum> m_ShadowFrusta;
+    MultiViewCuller m_StaticCasterCuller;
+    MultiViewCuller m_SkinnedCasterCuller;
+
+    ShadowCache m_ShadowCache;
+    ShadowScheduler m_ShadowScheduler;
+
+    // Application frame the shadow scheduler is at, the viewports rendered during a frame share its update intervals
+    uint64_t m_ShadowFrame = std::numeric_limits<uint64_t>::max();
+
+    // Viewport each cascade of the shadow map was last rendered for, only compared and never dereferenced
+    std::array<const Viewport*, DirectionalCascadeLevel + 1> m_CascadeViewports {};
+
+    // The viewports share the cascade maps, which are too large to have a copy per viewport. Only the cascades of the first viewport
+    // of the frame are cached, the other viewports render theirs from scratch so that they don't invalidate its base maps
+    const Viewport* m_CachedCascadeViewport = nullptr;
+
+    // Kept across frames to reuse the caster lists
+    std::vector<PendingShadowView> m_PendingViews;
+    size_t m_PendingViewCount = 0;
+
+    // Skinned casters of the scheduled views, their palettes must be uploaded before the views are rendered
+    std::vector<uint32_t> m_ShadowSkinnedCasters;
     
     CascadeShadowMap m_CascadeShadowMap;
     
     
-    XNOR_ENGINE void FecthLightInfo() const;
+    XNOR_ENGINE void UpdateRegisteredLights(const Scene& scene);
+
+    XNOR_ENGINE void UpdateLightOctrees();
+
+    XNOR_ENGINE void CullLights(const Viewport& viewport);
+
+    XNOR_ENGINE void FecthLightInfo();
+
+    XNOR_ENGINE void BuildLightClusters(const Viewport& viewport);
+
+    XNOR_ENGINE void ComputeShadow(const Viewport& viewport, const Renderer& renderer);
+
+    XNOR_ENGINE void ComputeShadowDirLight(const Viewport& viewport);
 
-    XNOR_ENGINE void ComputeShadow(const Scene& scene, const Viewport& viewport, Renderer& renderer);
+    XNOR_ENGINE void ComputeShadowSpotLight(const Camera& viewPortCamera);
 
-    XNOR_ENGINE void ComputeShadowDirLight(const Scene& scene, const Camera& viewPortCamera, Vector2i viewportSize, Renderer& renderer);
+    XNOR_ENGINE void ComputeShadowPointLight(const Camera& viewPortCamera);
 
-    XNOR_ENGINE void ComputeShadowSpotLight(const Scene& scene, Renderer& renderer);
+    XNOR_ENGINE void PrepareShadowCasters(const Renderer& renderer);
 
-    XNOR_ENGINE void ComputeShadowPointLight(const Scene& scene, Renderer& renderer);
+    XNOR_ENGINE ShadowViewSetup& AddShadowView();
+
+    XNOR_ENGINE void CullShadowViews(const Renderer& renderer);
+
+    [[nodiscard]]
+    XNOR_ENGINE static bool_t IsInShadowVolume(const ShadowViewSetup& setup, const Bound& bound);
+
+    XNOR_ENGINE void SubmitShadowView(const Renderer& renderer, const ShadowView& view, ShadowViewRequest request, const Matrix* lightSpaceMatrix, Matrix* gpuLightSpaceMatrix);
+
+    XNOR_ENGINE void RenderShadowView(Renderer& renderer, const PendingShadowView& pendingView);
+
+    XNOR_ENGINE void GetCasterSignature(const ShadowView& view, const Renderer& renderer, uint64_t* staticSignature) const;
     
     XNOR_ENGINE void GetDistanceFromCamera(std::map<float_t, GizmoLight>* sortedLight, const Camera& camera) const;
 
     XNOR_ENGINE void GetPointLightDirection(size_t index, Vector3* front,Vector3* up) const;
+
+    /// @brief Gets the sphere lit by a point light
+    /// @param light Light
+    /// @returns Sphere
+    [[nodiscard]]
+    XNOR_ENGINE static ClusteredLight GetLightSphere(const PointLight& light);
+
+    /// @brief Gets a sphere enclosing the cone lit by a spot light
+    /// @param light Light
+    /// @returns Sphere
+    [[nodiscard]]
+    XNOR_ENGINE static ClusteredLight GetLightSphere(const SpotLight& light);
     
     XNOR_ENGINE void InitShadowMap();
 
@@ -1,6 +1,9 @@
 ﻿#pragma once
 #include "core.hpp"
 #include "rendering/frustum.hpp"
+#include "rendering/lod_selector.hpp"
+#include "rendering/view_visibility.hpp"
+#include "rendering/render_systems/skinning_pass.hpp"
 
 #include "scene/scene.hpp"
 #include "scene/component/skinned_mesh_renderer.hpp"
@@ -9,9 +12,29 @@
 BEGIN_XNOR_CORE
 class Renderer;
 
+/// @brief Triangles drawn by the shadow casters during a frame
+struct ShadowCasterStats
+{
+    /// @brief Casters drawn, a caster is counted once per shadow view
+    size_t casters = 0;
+    /// @brief Triangles of the casters at their full detail
+    size_t fullDetailTriangles = 0;
+    /// @brief Triangles of the casters at their selected detail level
+    size_t triangles = 0;
+};
+
 class MeshesDrawer
 {
 public:
+    /// @brief Whether the skinned meshes are skinned once per frame for the shadow and depth passes, which then draw them as static geometry
+    XNOR_ENGINE static inline bool_t enableSkinningPass = false;
+
+    /// @brief Whether the static meshes are drawn at a detail level depending on their size on screen
+    XNOR_ENGINE static inline bool_t enableLod = true;
+
+    /// @brief Screen sizes at which the static meshes switch detail levels
+    XNOR_ENGINE static inline MeshLodSettings lodSettings;
+
     XNOR_ENGINE MeshesDrawer();
 
     XNOR_ENGINE ~MeshesDrawer();
@@ -21,35 +44,123 @@ public:
     XNOR_ENGINE void InitResources();
     void DrawAabb(const Pointer<Mesh> cube) const;
 
+    /// @brief Gathers the meshes of the scene, once per frame for all the viewports
+    /// @param scene Scene
+    /// @param renderer Renderer
     XNOR_ENGINE void BeginFrame(const Scene& scene, const Renderer& renderer);
+
+    /// @brief Uploads the bone palettes of the skinned meshes drawn by a viewport, and skins them if the skinning pass is enabled
+    ///
+    /// The skinned meshes outside the view that cast no shadow in a shadow view rendered for it are skipped
+    /// @param visibility Visibility of the viewport
+    /// @param shadowCasters Skinned casters of the shadow views rendered for the viewport, as indices in GetSkinnedMeshes
+    XNOR_ENGINE void PrepareSkinnedMeshes(const ViewVisibility& visibility, const std::vector<uint32_t>& shadowCasters);
     
     XNOR_ENGINE void EndFrame();
     
-    // Render All the animated mesh only work on Deferred Rendering
-    XNOR_ENGINE void RenderAnimation() const;
-
-    XNOR_ENGINE void RenderAnimationNonShaded(const Scene& scene) const;
-
-    XNOR_ENGINE void RenderStaticMesh(const MaterialType material,const Camera& camera, const Frustum& frustum, const Scene& scene) const;
-
-    XNOR_ENGINE void RenderStaticMeshNonShaded(const Camera& camera, const Frustum& frustum, const Scene& scene) const;
+    // Render All the visible animated mesh only work on Deferred Rendering
+    // The meshes outside the view are skipped, their bones aren't uploaded either
+    XNOR_ENGINE void RenderAnimation(const ViewVisibility& visibility) const;
+
+    // When the skinning pass ran this frame, the skinned meshes are drawn from the skinned vertex cache
+    // and must be drawn with the static version of the shader
+    XNOR_ENGINE void RenderAnimationNonShaded(const ViewVisibility& visibility, const Scene& scene) const;
+
+    /// @brief Gets whether the skinned meshes of this frame were skinned by the skinning pass
+    /// @returns Whether RenderAnimationNonShaded draws from the skinned vertex cache
+    [[nodiscard]]
+    XNOR_ENGINE bool_t UsesSkinningPass() const;
+
+    /// @brief Selects the detail level of the visible static meshes of a viewport
+    /// @param camera Camera of the viewport
+    /// @param lodSelector Selector of the viewport, which remembers the levels of its meshes across frames
+    /// @param visibility Visibility of the viewport
+    XNOR_ENGINE void SelectLods(const Camera& camera, LodSelector* lodSelector, ViewVisibility* visibility);
+
+    /// @brief Selects the detail level of the static meshes as shadow casters, once per frame for all the viewports since they share the shadow maps
+    ///
+    /// The level of a mesh comes from its largest size in the views, plus the shadow bias
+    /// @param cameras Cameras of the views, must not be empty
+    XNOR_ENGINE void SelectShadowLods(const std::vector<Camera>& cameras);
+
+    /// @brief Draws the visible static meshes of a material type, binding their material
+    /// @param visibility Visibility of the view
+    /// @param materialType Bin of the visibility to draw
+    /// @param scene Scene of the meshes
+    XNOR_ENGINE void RenderStaticMesh(const ViewVisibility& visibility, MaterialType materialType, const Scene& scene) const;
+
+    /// @brief Draws every visible static mesh of a view without binding their material
+    /// @param visibility Visibility of the view
+    /// @param scene Scene of the meshes
+    XNOR_ENGINE void RenderStaticMeshNonShaded(const ViewVisibility& visibility, const Scene& scene) const;
+
+    /// @brief Draws shadow casters that were already culled, without any further culling
+    /// @param casters Indices of the casters in GetStaticMeshes
+    XNOR_ENGINE void RenderStaticCasters(const std::vector<uint32_t>& casters) const;
+
+    /// @brief Draws skinned shadow casters that were already culled, without any further culling
+    /// @param casters Indices of the casters in GetSkinnedMeshes
+    XNOR_ENGINE void RenderSkinnedCasters(const std::vector<uint32_t>& casters) const;
+
+    /// @brief Gets the static meshes of the frame
+    /// @returns Static mesh renderers
+    [[nodiscard]]
+    XNOR_ENGINE const std::vector<const StaticMeshRenderer*>& GetStaticMeshes() const;
+
+    /// @brief Gets the skinned meshes of the frame
+    /// @returns Skinned mesh renderers
+    [[nodiscard]]
+    XNOR_ENGINE const std::vector<const SkinnedMeshRenderer*>& GetSkinnedMeshes() const;
+
+    /// @brief Gets the detail level a static mesh is drawn at as a shadow caster
+    /// @param index Index of the mesh in GetStaticMeshes
+    /// @returns Detail level
+    [[nodiscard]]
+    XNOR_ENGINE uint32_t GetShadowLod(uint32_t index) const;
+
+    /// @brief Gets the triangles drawn by the shadow casters since the beginning of the frame
+    /// @returns Stats
+    [[nodiscard]]
+    XNOR_ENGINE const ShadowCasterStats& GetShadowCasterStats() const;
 
 
 
 private:
-    SkinnedMeshGpuData* m_SkinnedMeshGpuData = nullptr;
-
     Pointer<Shader> m_SkinnedShader;
 
     Pointer<Shader> m_GizmoShader;
     
     std::vector<const SkinnedMeshRenderer*> m_SkinnedRender;
 
+    /// @brief Skinning palettes of the skinned meshes drawn by the viewport, packed to be uploaded at once
+    List<Matrix> m_BonePalettes;
+
+    /// @brief Index of the palette of each skinned mesh in m_BonePalettes, only meaningful for the drawn ones
+    std::vector<uint32_t> m_BoneOffsets;
+
+    // Skinned meshes drawn by the viewport, as indices in m_SkinnedRender in increasing order
+    std::vector<bool_t> m_IsSkinnedMeshDrawn;
+    std::vector<uint32_t> m_DrawnSkinnedMeshes;
+
     std::vector<const StaticMeshRenderer*> m_StaticMeshs;
+
+    // Detail levels of the static meshes as shadow casters, indexed like m_StaticMeshs
+    LodSelector m_ShadowLodSelector;
+    std::vector<uint32_t> m_ShadowLods;
+
+    mutable ShadowCasterStats m_ShadowCasterStats;
+
+    SkinningPass m_SkinningPass;
+
+    bool_t m_UsesSkinningPass = false;
     
 
 
     XNOR_ENGINE void PrepareOctree(const Scene& scene);
+
+    XNOR_ENGINE void PrepareBonePalettes();
+
+    XNOR_ENGINE void DrawSkinnedMeshNonShaded(size_t index, uint64_t meshRenderIndex) const;
     
 };
 
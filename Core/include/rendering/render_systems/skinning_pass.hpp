@@ -0,0 +1,62 @@
+﻿#pragma once
+
+#include <vector>
+
+#include "core.hpp"
+#include "rendering/vertex.hpp"
+#include "resource/compute_shader.hpp"
+#include "scene/component/skinned_mesh_renderer.hpp"
+
+/// @file skinning_pass.hpp
+/// @brief Defines the XnorCore::SkinningPass class
+
+BEGIN_XNOR_CORE
+
+/// @brief Skins the vertices of the skinned meshes drawn by a viewport in a compute shader
+///
+/// The result is written in the skinned vertex cache of the Rhi, so that the shadow and depth passes
+/// draw the skinned meshes as static geometry instead of skinning them again for each light and cascade
+class SkinningPass
+{
+    /// @brief Number of vertices skinned by a work group, must match the compute shader
+    static constexpr uint32_t WorkGroupSize = 64;
+
+    /// @brief Binding of the source vertices in the compute shader
+    static constexpr uint32_t SourceVertexBinding = 6;
+
+public:
+    DEFAULT_COPY_MOVE_OPERATIONS(SkinningPass)
+
+    XNOR_ENGINE SkinningPass() = default;
+    XNOR_ENGINE ~SkinningPass() = default;
+
+    /// @brief Initializes the skinning pass
+    XNOR_ENGINE void Init();
+
+    /// @brief Skins all the models of the drawn skinned meshes in the skinned vertex cache
+    /// @param renderers Skinned mesh renderers
+    /// @param drawnRenderers Indices of the drawn renderers, the others aren't skinned and have no vertices in the cache
+    /// @param boneOffsets Offset of the palette of each renderer in the bone palette buffer
+    XNOR_ENGINE void Compute(const std::vector<const SkinnedMeshRenderer*>& renderers, const std::vector<uint32_t>& drawnRenderers, const std::vector<uint32_t>& boneOffsets);
+
+    /// @brief Gets the index of the first cached vertex of a renderer, the vertices of its models follow each other from there
+    /// @param rendererIndex Index of the renderer in the list given to Compute
+    /// @returns Base vertex
+    [[nodiscard]]
+    XNOR_ENGINE uint32_t GetBaseVertex(size_t rendererIndex) const;
+
+    /// @brief Skins vertices on the CPU the same way the compute shader does, used as a reference to validate it
+    /// @param vertices Source vertices
+    /// @param vertexCount Number of vertices
+    /// @param boneMatrices Skinning palette
+    /// @param boneCount Number of matrices in the palette
+    /// @param output Skinned vertices, must hold @p vertexCount vertices
+    XNOR_ENGINE static void SkinVertices(const Vertex* vertices, size_t vertexCount, const Matrix* boneMatrices, size_t boneCount, SkinnedVertex* output);
+
+private:
+    Pointer<ComputeShader> m_SkinningShader = nullptr;
+
+    std::vector<uint32_t> m_BaseVertices;
+};
+
+END_XNOR_CORE
@@ -1,10 +1,17 @@
 #pragma once
 
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
 #include <Maths/vector4.hpp>
 
 #include "core.hpp"
 #include "frustum.hpp"
+#include "lod_selector.hpp"
 #include "material.hpp"
+#include "occlusion_culler.hpp"
+#include "view_visibility.hpp"
 #include "viewport.hpp"
 #include "render_systems/gui_pass.hpp"
 #include "render_systems/light_manager.hpp"
@@ -22,6 +29,15 @@ class SpotLight;
 class PointLight;
 class StaticMeshRenderer;
 
+/// @brief View of a viewport rendered during a frame
+struct RenderedView
+{
+    /// @brief Camera of the viewport
+    Camera camera;
+    /// @brief Aspect ratio of the viewport
+    float_t aspect = 1.f;
+};
+
 /// @brief Handles rendering a scene given a RendererContext
 class Renderer
 {
@@ -40,6 +56,9 @@ public:
     GuiPass guiPass;
 
     XNOR_ENGINE static inline bool_t IsCsm = false;
+
+    /// @brief Whether the meshes hidden behind the occluders of the viewport are skipped, see OcclusionCuller
+    XNOR_ENGINE static inline bool_t enableOcclusionCulling = true;
     
     XNOR_ENGINE Renderer() = default;
     XNOR_ENGINE ~Renderer() = default;
@@ -55,25 +74,39 @@ public:
     XNOR_ENGINE void RenderViewport(const Viewport& viewport, const Scene& scene);
 
     /// @brief Renders a scene without shading , calling begin and endfrane 
-    /// @param camera Camera
+    /// @param viewport Viewport whose camera the scene is seen from
     /// @param renderPassBeginInfo Render pass begin info
     /// @param renderPass Render pass
     /// @param shaderToUseStatic Shader to use
     /// @param scene Scene to render
     /// @param drawEditorUi Whether to draw the editor only UI
-    XNOR_ENGINE void ZPass(const Scene& scene, const Camera& camera, const RenderPassBeginInfo& renderPassBeginInfo, const RenderPass& renderPass,
+    XNOR_ENGINE void ZPass(const Scene& scene, const Viewport& viewport, const RenderPassBeginInfo& renderPassBeginInfo, const RenderPass& renderPass,
                            const Pointer<Shader>& shaderToUseStatic, const Pointer<Shader> shaderToUseSkinned, bool_t drawEditorUi);
 
     /// @brief Renders a scene without shading
-    /// @param cameraData Camera
+    ///
+    /// After the viewport was rendered during the frame, its visibility is reused instead of traversing the octree again
+    /// @param viewport Viewport whose camera the scene is seen from
     /// @param renderPassBeginInfo Render pass begin info
     /// @param renderPass Render pass
     /// @param shaderToUseStatic Shader to use
     /// @param scene Scene to render
     /// @param drawEditorUi Whether to draw the editor only UI
-    XNOR_ENGINE void RenderNonShadedPass(const Scene& scene, const Camera& cameraData, const RenderPassBeginInfo& renderPassBeginInfo, const RenderPass& renderPass,
+    XNOR_ENGINE void RenderNonShadedPass(const Scene& scene, const Viewport& viewport, const RenderPassBeginInfo& renderPassBeginInfo, const RenderPass& renderPass,
                                          const Pointer<Shader>& shaderToUseStatic, const Pointer<Shader>& shaderToUseSkinned, bool_t drawEditorUi);
 
+    /// @brief Renders shadow casters already culled for a view, without shading
+    /// @param camera Shadow view camera
+    /// @param renderPassBeginInfo Render pass begin info
+    /// @param renderPass Render pass
+    /// @param shaderToUseStatic Shader to use for the static meshes
+    /// @param shaderToUseSkinned Shader to use for the skinned meshes
+    /// @param staticCasters Indices of the static casters in MeshesDrawer::GetStaticMeshes
+    /// @param skinnedCasters Indices of the skinned casters in MeshesDrawer::GetSkinnedMeshes
+    XNOR_ENGINE void RenderShadowCasters(const Camera& camera, const RenderPassBeginInfo& renderPassBeginInfo, const RenderPass& renderPass,
+                                         const Pointer<Shader>& shaderToUseStatic, const Pointer<Shader>& shaderToUseSkinned,
+                                         const std::vector<uint32_t>& staticCasters, const std::vector<uint32_t>& skinnedCasters);
+
     /// @brief Renders a scene without shading
     /// @param cameraData Camera
     /// @param renderPassBeginInfo Render pass begin info
@@ -87,11 +120,40 @@ public:
 
     /// @brief Swaps the front and back buffer.
     XNOR_ENGINE void SwapBuffers() const;
+
+    /// @brief Gets the views of the viewports rendered during the last frame, the editor renders several viewports per frame
+    /// @returns Views, empty before the first frame
+    [[nodiscard]]
+    XNOR_ENGINE const std::vector<RenderedView>& GetRenderedViews() const;
     
     XNOR_ENGINE static inline bool_t isCsm = false;
 
 private:
+    /// @brief State a viewport keeps across frames
+    struct ViewportState
+    {
+        /// @brief Visibility of the last render, which every pass of the viewport draws from
+        ViewVisibility visibility;
+        LodSelector lodSelector;
+        RenderedView view;
+        /// @brief Application frame the viewport was last rendered at
+        uint64_t frame = 0;
+    };
+
      mutable Frustum m_Frustum;
+
+     // Keyed by viewport, a viewport that isn't rendered during a frame is forgotten
+     std::unordered_map<const Viewport*, ViewportState> m_ViewportStates;
+     std::vector<RenderedView> m_RenderedViews;
+     std::vector<Camera> m_ActiveCameras;
+     // Application frame the frame wide work was last done at
+     uint64_t m_Frame = std::numeric_limits<uint64_t>::max();
+
+     // Visibility of the last pass without shading of a viewport that wasn't rendered during the frame
+     ViewVisibility m_NonShadedVisibility;
+
+     // Depth of the occluders of the viewport
+     OcclusionCuller m_OcclusionCuller;
     
      Pointer<Shader> m_GBufferShader;
      Pointer<Shader> m_GBufferShaderLit;
@@ -107,21 +169,30 @@ private:
     /// @param scene The scene
     XNOR_ENGINE void BeginFrame(const Scene& scene, const Viewport& viewport);
 
+    /// @brief Does the work shared by all the viewports of a frame, when the first one is rendered
+    /// @param scene The scene
+    /// @param viewport First viewport of the frame
+    /// @param frame Application frame
+    XNOR_ENGINE void BeginApplicationFrame(const Scene& scene, const Viewport& viewport, uint64_t frame);
+
     /// @brief stuff made at the end of the frame
     /// @param scene The scene
     XNOR_ENGINE void EndFrame(const Scene& scene);
+
+    /// @brief Rasterizes the occluders inside the view frustum in the occlusion culler
+    /// @param camera Camera
+    /// @param viewportSize Viewport size
+    XNOR_ENGINE void RasterizeOccluders(const Camera& camera, Vector2i viewportSize);
     
     
     XNOR_ENGINE void BindCamera(const Camera& camera, const Vector2i screenSize) const;
     
     XNOR_ENGINE void InitResources();
     
-    XNOR_ENGINE void DrawMeshRendersByType(MaterialType materialType , const Scene& scene) const;
-    
 
-    XNOR_ENGINE void DeferredRendering(const Camera& camera, const Scene& scene, const ViewportData& viewportData, const Vector2i viewportSize) const;
+    XNOR_ENGINE void DeferredRendering(const Camera& camera, const Scene& scene, const ViewVisibility& visibility, const ViewportData& viewportData, const Vector2i viewportSize) const;
     
-    XNOR_ENGINE void ForwardPass(const Scene& scene,
+    XNOR_ENGINE void ForwardPass(const Scene& scene, const ViewVisibility& visibility,
         const Viewport& viewport, Vector2i viewportSize, bool_t isEditor) const;
     
 };
@@ -7,6 +7,7 @@
 #include "material.hpp"
 #include "rhi_typedef.hpp"
 #include "vertex.hpp"
+#include "buffer/shader_storage_buffer.hpp"
 #include "buffer/uniform_buffer.hpp"
 #include "render_systems/skybox_parser.hpp"
 
@@ -57,6 +58,17 @@ public:
 	/// @param drawMode Draw mode
 	/// @param modelId Model id
 	XNOR_ENGINE static void DrawModel(ENUM_VALUE(DrawMode) drawMode, uint32_t modelId); 
+
+	/// @brief Draws a model with the vertices of the skinned vertex cache instead of its own
+	/// @param drawMode Draw mode
+	/// @param modelId Model id, only its indices are used
+	/// @param baseVertex Index of the first vertex of the model in the cache
+	XNOR_ENGINE static void DrawSkinnedModel(ENUM_VALUE(DrawMode) drawMode, uint32_t modelId, uint32_t baseVertex);
+
+	/// @brief Binds the vertex buffer of a model as a storage buffer, so that a compute shader can read its vertices
+	/// @param modelId Model id
+	/// @param index Storage buffer binding
+	XNOR_ENGINE static void BindModelVertices(uint32_t modelId, uint32_t index);
 	
 	XNOR_ENGINE static void DrawArray(DrawMode::DrawMode drawMode,uint32_t first, uint32_t count);
 	
@@ -134,6 +146,14 @@ public:
 	XNOR_ENGINE static void BlitFrameBuffer(uint32_t readBuffer, uint32_t targetBuffer, Vector2i srcTopLeft, Vector2i srcBottomRight,
 		Vector2i targetTopLeft, Vector2i targetBottomRight, BufferFlag::BufferFlag bufferFlag, TextureFiltering::TextureFiltering textureFiltering);
 
+	/// @brief Copies a layer of a texture array in another texture array with the same format and size
+	/// @param sourceId Source texture id
+	/// @param targetId Target texture id
+	/// @param textureType Type of both textures, the layers of a cube map array are its layer-faces
+	/// @param size Size of a layer
+	/// @param layer Layer to copy
+	XNOR_ENGINE static void CopyTextureLayer(uint32_t sourceId, uint32_t targetId, TextureType::TextureType textureType, Vector2i size, uint32_t layer);
+
 	/// @brief Binds a framebuffer
 	/// @param frameBufferId Framebuffer id
 	XNOR_ENGINE static void BindFrameBuffer(uint32_t frameBufferId);
@@ -205,13 +225,55 @@ public:
 	/// @param cameraUniformData Data
 	XNOR_ENGINE static void UpdateCameraUniform(const CameraUniformData& cameraUniformData);
 
-	/// @brief Updates the animation UniformBuffer
-	/// @param skinnedMeshGPUData Data
-	XNOR_ENGINE static void UpdateAnimationUniform(const SkinnedMeshGpuData& skinnedMeshGPUData);
+	/// @brief Uploads the skinning palettes of all the skinned meshes of the frame at once
+	/// 
+	/// The palettes are packed one after the other, each draw then selects its own with ModelUniformData::boneOffset.
+	/// The storage buffer grows as needed, so there is no limit on the number of bones
+	/// 
+	/// @param boneMatrices Bone matrices of all the palettes
+	/// @param boneCount Total number of bone matrices
+	XNOR_ENGINE static void UpdateBonePalettes(const Matrix* boneMatrices, size_t boneCount);
+
+	/// @brief Makes sure the skinned vertex cache can hold a number of vertices
+	/// 
+	/// The cache holds the SkinnedVertex written by the skinning pass, it is rewritten every frame so its content is not kept when it grows
+	/// 
+	/// @param vertexCount Number of vertices
+	XNOR_ENGINE static void ReserveSkinnedVertices(size_t vertexCount);
 
 	/// @brief Updates the light UniformBuffer
 	/// @param lightData Data
 	XNOR_ENGINE static void UpdateLight(const GpuLightData& lightData);
+
+	/// @brief Updates the light storage buffers
+	/// @param pointLights Point lights
+	/// @param pointLightCount Number of point lights
+	/// @param spotLights Spot lights
+	/// @param spotLightCount Number of spot lights
+	/// @param directionalLights Directional lights
+	/// @param directionalLightCount Number of directional lights
+	XNOR_ENGINE static void UpdateLightArrays(
+		const PointLightData* pointLights,
+		size_t pointLightCount,
+		const SpotLightData* spotLights,
+		size_t spotLightCount,
+		const DirectionalLightData* directionalLights,
+		size_t directionalLightCount
+	);
+
+	/// @brief Updates the light cluster grid storage buffers
+	/// @param clusterData Grid header
+	/// @param clusters Light range of each cluster
+	/// @param clusterCount Number of clusters
+	/// @param lightIndices Light indices referenced by the clusters
+	/// @param lightIndexCount Number of light indices
+	XNOR_ENGINE static void UpdateLightClusters(
+		const GpuLightClusterData& clusterData,
+		const LightClusterRange* clusters,
+		size_t clusterCount,
+		const uint32_t* lightIndices,
+		size_t lightIndexCount
+	);
 	
 	/// @brief Binds a Material
 	/// @param material Material
@@ -314,7 +376,14 @@ private:
 	XNOR_ENGINE static inline UniformBuffer* m_ModelUniform = nullptr;
 	XNOR_ENGINE static inline UniformBuffer* m_LightUniform = nullptr;
 	XNOR_ENGINE static inline UniformBuffer* m_MaterialUniform = nullptr;
-	XNOR_ENGINE static inline UniformBuffer* m_AnimationBuffer = nullptr;
+	XNOR_ENGINE static inline ShaderStorageBuffer* m_BonePaletteBuffer = nullptr;
+	XNOR_ENGINE static inline ShaderStorageBuffer* m_SkinnedVertexBuffer = nullptr;
+	XNOR_ENGINE static inline ShaderStorageBuffer* m_PointLightBuffer = nullptr;
+	XNOR_ENGINE static inline ShaderStorageBuffer* m_SpotLightBuffer = nullptr;
+	XNOR_ENGINE static inline ShaderStorageBuffer* m_DirectionalLightBuffer = nullptr;
+	XNOR_ENGINE static inline ShaderStorageBuffer* m_LightClusterBuffer = nullptr;
+	XNOR_ENGINE static inline ShaderStorageBuffer* m_LightIndexBuffer = nullptr;
+	XNOR_ENGINE static inline uint32_t m_SkinnedVertexArray = 0;
 	
 	XNOR_ENGINE static inline bool_t m_Blending = false;
 	
@@ -323,6 +392,35 @@ private:
 	XNOR_ENGINE static inline bool_t m_Depth = true;
 
 	static constexpr int32_t NullUniformLocation = -1;
+
+	/// @brief Binding of the bone palette storage buffer in the skinned shaders
+	static constexpr uint32_t BonePaletteBinding = 5;
+
+	/// @brief Number of bone matrices the bone palette buffer is created with
+	static constexpr size_t InitialBonePaletteSize = 1024;
+
+	/// @brief Binding of the skinned vertex cache storage buffer in the skinning compute shader
+	static constexpr uint32_t SkinnedVertexBinding = 7;
+
+	/// @brief Number of vertices the skinned vertex cache is created with
+	static constexpr size_t InitialSkinnedVertexCount = 16384;
+
+	// Bindings of the light storage buffers in the lit shaders
+	static constexpr uint32_t PointLightBinding = 8;
+	static constexpr uint32_t SpotLightBinding = 9;
+	static constexpr uint32_t DirectionalLightBinding = 10;
+	static constexpr uint32_t LightClusterBinding = 11;
+	static constexpr uint32_t LightIndexBinding = 12;
+
+	/// @brief Size the light storage buffers are created with
+	static constexpr size_t InitialLightBufferSize = 4096;
+
+	/// @brief Uploads data to a storage buffer, growing it if needed
+	/// @param buffer Buffer
+	/// @param binding Binding of the buffer
+	/// @param size Data size
+	/// @param data Data
+	XNOR_ENGINE static void UpdateStorageBuffer(ShaderStorageBuffer* buffer, uint32_t binding, size_t size, const void* data);
 	
 	XNOR_ENGINE static inline std::unordered_map<uint32_t, ShaderInternal> m_ShaderMap;
 	
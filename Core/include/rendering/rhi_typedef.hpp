@@ -16,14 +16,10 @@ BEGIN_XNOR_CORE
 
 class Framebuffer;
 
-/// @brief Maximum amount of spot lights that can exists in a same scene
-static constexpr uint32_t MaxSpotLights = 50;
-/// @brief Maximum amount of point lights that can exists in a same scene
-static constexpr uint32_t MaxPointLights = 50;
-/// @brief Maximum amount of directional lights that can exists in a same scene
-static constexpr uint32_t MaxDirectionalLights = 1;
-
-static constexpr uint32_t MaxBones = 100;
+/// @brief Maximum amount of spot lights casting shadows in a same scene, there is no limit on the lights themselves
+static constexpr uint32_t MaxSpotLightShadows = 50;
+/// @brief Maximum amount of point lights casting shadows in a same scene, there is no limit on the lights themselves
+static constexpr uint32_t MaxPointLightShadows = 50;
 
 static constexpr size_t DirectionalCascadeLevelAllocation = 12;
 static constexpr size_t DirectionalCascadeLevel = 4;
@@ -366,6 +362,11 @@ struct ModelUniformData
 	Matrix normalInvertMatrix = Matrix::Identity();
 
 	uint64_t meshRenderIndex = 0;
+
+	/// @brief Index of the first matrix of the skinning palette in the bone palette buffer
+	uint32_t boneOffset = 0;
+	/// @brief Number of matrices in the skinning palette
+	uint32_t boneCount = 0;
 };
 
 /// @brief Uniform type for Shader
@@ -511,7 +512,7 @@ struct ShaderCreateInfo
 #pragma warning(push)
 #pragma warning(disable : 4324)
 
-/// @brief Point light UniformBuffer data
+/// @brief Point light storage buffer data
 struct ALIGNAS(16) PointLightData
 {
 	/// @brief Color
@@ -524,9 +525,11 @@ struct ALIGNAS(16) PointLightData
 	float_t radius{};
 	/// @brief CastShadow
 	int32_t isCastingShadow = 0;
+	/// @brief Layer of the shadow cubemap in the cubemap array
+	int32_t shadowIndex = -1;
 };
 
-/// @brief Spot light UniformBuffer data
+/// @brief Spot light storage buffer data
 struct ALIGNAS(16) SpotLightData
 {
 	/// @brief Color
@@ -544,9 +547,13 @@ struct ALIGNAS(16) SpotLightData
 	
 	/// @brief CastShadow
 	int32_t isCastingShadow = 0;
+	/// @brief Layer of the shadow map in the spot light shadow map array
+	int32_t shadowIndex = -1;
+	/// @brief Range, the light is ignored further than it
+	float_t radius{};
 };
 
-/// @brief Directional light UniformBuffer data
+/// @brief Directional light storage buffer data, only the first directional light can cast shadows
 struct ALIGNAS(16) DirectionalLightData
 {
 	/// @brief Color
@@ -564,35 +571,68 @@ struct ALIGNAS(16) DirectionalLightData
 	float_t cascadePlaneDistance[DirectionalCascadeLevel];
 };
 
-/// @brief Light UniformBuffer data
+/// @brief Light UniformBuffer data, the lights themselves are in storage buffers
 struct ALIGNAS(16) GpuLightData
 {
 	/// @brief Number of active point lights
 	uint32_t nbrOfPointLight{};
 	/// @brief Number of active spot lights
 	uint32_t nbrOfSpotLight{};
+	/// @brief Number of active directional lights
+	uint32_t nbrOfDirLight{};
+	/// @brief Padding, the matrices are 16 bytes aligned on the GPU
+	uint32_t padding{};
 	
-	/// @brief Point light data
-	PointLightData pointLightData[MaxPointLights];
-	/// @brief Spot light data
-	SpotLightData spotLightData[MaxSpotLights];
-	/// @brief Directional light data
-	DirectionalLightData directionalData[MaxDirectionalLights];
-	
-	/// @brief LightSpaceMatrix for shadowMapping
-	Matrix spotLightSpaceMatrix[MaxSpotLights];
+	/// @brief LightSpaceMatrix for shadowMapping, indexed by SpotLightData::shadowIndex
+	Matrix spotLightSpaceMatrix[MaxSpotLightShadows];
 
 	/// @brief Light space matrix
 	Matrix dirLightSpaceMatrix[DirectionalCascadeLevelAllocation];
-	
-	/// @brief Number of active directional lights shoul be 0 or 1
-	uint32_t nbrOfDirLight{};
 };
 
-/// @brief UniformBuffer data for animation
-struct ALIGNAS(16) SkinnedMeshGpuData
+/// @brief Light cluster grid storage buffer header, followed by a LightClusterRange per cluster
+///
+/// The view is split in tiles on the screen and in slices along the depth, growing exponentially from the near plane.
+/// Fragments find their cluster by projecting their position on the camera axes, the same way the grid was built
+struct ALIGNAS(16) GpuLightClusterData
+{
+	/// @brief Camera position
+	Vector4 cameraPosition;
+	/// @brief Camera right axis
+	Vector4 cameraRight;
+	/// @brief Camera up axis
+	Vector4 cameraUp;
+	/// @brief Camera front axis
+	Vector4 cameraFront;
+
+	/// @brief Tangent of the horizontal half field of view
+	float_t tanHalfFovX{};
+	/// @brief Tangent of the vertical half field of view
+	float_t tanHalfFovY{};
+	/// @brief Depth of the first slice
+	float_t near{};
+	/// @brief Slice count divided by log(far / near)
+	float_t sliceScale{};
+
+	/// @brief Number of tiles along the screen width
+	uint32_t tileCountX{};
+	/// @brief Number of tiles along the screen height
+	uint32_t tileCountY{};
+	/// @brief Number of depth slices
+	uint32_t sliceCount{};
+	/// @brief Padding
+	uint32_t padding{};
+};
+
+/// @brief Lights of a cluster, as a range in the light index storage buffer
+///
+/// The indices below the point light count are point lights, the others are spot lights offset by the point light count
+struct LightClusterRange
 {
-	Matrix boneMatrices[MaxBones];
+	/// @brief First index
+	uint32_t offset{};
+	/// @brief Number of indices
+	uint32_t count{};
 };
 
 #pragma warning(pop) // 4324
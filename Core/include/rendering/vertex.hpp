@@ -3,9 +3,10 @@
 #include "core.hpp"
 #include "Maths/vector2.hpp"
 #include "Maths/vector3.hpp"
+#include "Maths/vector4.hpp"
 
 /// @file vertex.hpp
-/// @brief Defines the XnorCore::Vertex class.
+/// @brief Defines the XnorCore::Vertex and XnorCore::SkinnedVertex classes.
 
 BEGIN_XNOR_CORE
 
@@ -29,4 +30,13 @@ struct Vertex
 	float_t boneWeight[MaxBoneWeight] = {};
 };
 
+/// @brief Vertex written by the skinning pass, laid out to be shared by a storage buffer and a vertex buffer
+struct SkinnedVertex
+{
+	/// @brief Skinned position, w is always 1
+	Vector4 position;
+	/// @brief Skinned normal, w is always 0
+	Vector4 normal;
+};
+
 END_XNOR_CORE
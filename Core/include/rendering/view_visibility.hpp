@@ -0,0 +1,110 @@
+﻿#pragma once
+
+#include <array>
+#include <vector>
+
+#include "core.hpp"
+#include "data_structure/octree.hpp"
+#include "rendering/frustum.hpp"
+#include "rendering/lod_selector.hpp"
+#include "rendering/material.hpp"
+#include "rendering/occlusion_culler.hpp"
+
+/// @file view_visibility.hpp
+/// @brief Defines the XnorCore::ViewVisibility class
+
+BEGIN_XNOR_CORE
+
+class StaticMeshRenderer;
+class SkinnedMeshRenderer;
+
+/// @brief Work done by the visibility passes of a view
+struct ViewVisibilityStats
+{
+    /// @brief Number of octree traversals, one per call to ViewVisibility::Compute
+    size_t traversals = 0;
+    /// @brief Octree nodes tested against the frustum
+    size_t testedNodes = 0;
+    /// @brief Meshes tested against the frustum
+    size_t testedMeshes = 0;
+    /// @brief Meshes inside the frustum but hidden by the occluders
+    size_t occludedMeshes = 0;
+    /// @brief Meshes found visible
+    size_t visibleMeshes = 0;
+    /// @brief Triangles of the visible static meshes at their full detail
+    size_t fullDetailTriangles = 0;
+    /// @brief Triangles of the visible static meshes at their selected detail level
+    size_t triangles = 0;
+};
+
+/// @brief Meshes visible from a view, sorted in a bin per pass
+///
+/// The visibility of a view is computed once per frame by traversing the scene octree, then every pass of the view draws from its bin
+/// instead of culling the scene again. The opaque meshes are drawn in the G-buffer pass, the lit ones in the forward pass, and the
+/// passes without shading such as picking draw both. The shadow views don't use it, their casters are culled by the LightManager.
+/// The meshes inside the frustum can also be tested against the depth hierarchy of an OcclusionCuller. The static meshes are drawn at
+/// their full detail unless SelectLods picks a detail level for each of them.
+class ViewVisibility
+{
+public:
+    /// @brief Number of static mesh bins, one per MaterialType
+    static constexpr size_t BinCount = static_cast<size_t>(MaterialType::Lit) + 1;
+
+    XNOR_ENGINE ViewVisibility() = default;
+
+    XNOR_ENGINE ~ViewVisibility() = default;
+
+    DEFAULT_COPY_MOVE_OPERATIONS(ViewVisibility)
+
+    /// @brief Computes the visible meshes of a view, replacing the previous ones
+    /// @param frustum View frustum
+    /// @param octree Static meshes of the scene
+    /// @param skinnedMeshes Skinned meshes of the frame
+    /// @param occlusionCuller Occluders of the view, the meshes are only frustum culled if null
+    XNOR_ENGINE void Compute(
+        const Frustum& frustum,
+        Octree<const StaticMeshRenderer>* octree,
+        const std::vector<const SkinnedMeshRenderer*>& skinnedMeshes,
+        const OcclusionCuller* occlusionCuller = nullptr
+    );
+
+    /// @brief Selects the detail level of the visible static meshes
+    /// @param camera Camera of the view
+    /// @param lodSelector Selector of the view
+    /// @param settings Screen sizes of the detail levels
+    XNOR_ENGINE void SelectLods(const Camera& camera, LodSelector* lodSelector, const MeshLodSettings& settings);
+
+    /// @brief Gets the visible static meshes of a material type
+    /// @param materialType Material type
+    /// @returns Static mesh renderers
+    [[nodiscard]]
+    XNOR_ENGINE const std::vector<const StaticMeshRenderer*>& GetStaticMeshes(MaterialType materialType) const;
+
+    /// @brief Gets the detail level of the visible static meshes of a material type
+    /// @param materialType Material type
+    /// @returns Detail levels, in the order of GetStaticMeshes
+    [[nodiscard]]
+    XNOR_ENGINE const std::vector<uint32_t>& GetStaticMeshLods(MaterialType materialType) const;
+
+    /// @brief Gets the visible skinned meshes
+    /// @returns Indices in the skinned meshes given to Compute
+    [[nodiscard]]
+    XNOR_ENGINE const std::vector<uint32_t>& GetSkinnedMeshes() const;
+
+    /// @brief Gets the work done since the last call to ResetStats
+    /// @returns Stats
+    [[nodiscard]]
+    XNOR_ENGINE const ViewVisibilityStats& GetStats() const;
+
+    /// @brief Resets the stats
+    XNOR_ENGINE void ResetStats();
+
+private:
+    std::array<std::vector<const StaticMeshRenderer*>, BinCount> m_StaticMeshes;
+    std::array<std::vector<uint32_t>, BinCount> m_StaticMeshLods;
+    std::vector<uint32_t> m_SkinnedMeshes;
+
+    ViewVisibilityStats m_Stats;
+};
+
+END_XNOR_CORE
@@ -1,6 +1,9 @@
 #pragma once
 
 #include <array>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "core.hpp"
 #include "skeleton.hpp"
@@ -8,7 +11,9 @@
 #include "file/file.hpp"
 #include "rendering/bone.hpp"
 #include "rendering/rhi_typedef.hpp"
+#include "resource/animation_compression.hpp"
 #include "resource/resource.hpp"
+#include "utils/guid.hpp"
 #include "utils/list.hpp"
 
 BEGIN_XNOR_CORE
@@ -26,6 +31,20 @@ public:
         float_t time{};
     };
 
+    /// @brief Last keys used to sample each property of a channel
+    ///
+    /// Consecutive samples of a playing animation are usually between the same keys or the next ones, so keeping the last keys
+    /// avoids searching for them. Any time can still be sampled with a cursor, it falls back to a binary search
+    struct ChannelCursor
+    {
+        /// @brief Last translation key
+        uint32_t translationKey = 0;
+        /// @brief Last rotation key
+        uint32_t rotationKey = 0;
+        /// @brief Last scaling key
+        uint32_t scalingKey = 0;
+    };
+
     Pointer<Skeleton> skeleton;
 
     /// @brief Allowed extensions for animations.
@@ -64,14 +83,153 @@ public:
     [[nodiscard]]
     XNOR_ENGINE float_t GetFrameDuration() const;
 
+    /// @brief Gets the key frames of the channel animating a bone
+    ///
+    /// The raw key frames are released by Compress, so this gives nullptr once the animation is compressed, SampleChannel should be used instead
+    /// @param bone Bone
+    /// @param keyFrames Key frames, nullptr if the bone isn't animated or if the animation is compressed
     XNOR_ENGINE void GetBoneKeyFrame(const Bone& bone, const List<Animation::KeyFrame>** keyFrames) const;
 
+    /// @brief Gets the channel animating each bone of a skeleton
+    ///
+    /// The bones are matched by name only the first time a skeleton is used, the result is cached so sampling can index the channels directly
+    /// @param boneSkeleton Skeleton
+    /// @returns Channel index of each bone, in the same order as the skeleton bones, -1 if the bone isn't animated
+    [[nodiscard]]
+    XNOR_ENGINE const List<int32_t>& GetChannelBindings(const Skeleton& boneSkeleton) const;
+
+    /// @brief Gets the key frames of a channel
+    ///
+    /// The raw key frames are released by Compress, so this gives an empty list once the animation is compressed, SampleChannel should be used instead
+    /// @param channel Channel index
+    /// @returns Key frames
+    [[nodiscard]]
+    XNOR_ENGINE const List<KeyFrame>& GetChannel(size_t channel) const;
+
+    /// @brief Gets the number of channels, i.e. the number of animated bones
+    /// @returns Channel count
+    [[nodiscard]]
+    XNOR_ENGINE size_t GetChannelCount() const;
+
+    /// @brief Compresses the key frames, the raw key frames are released afterwards and can't be read with GetChannel or GetBoneKeyFrame anymore
+    ///
+    /// Constant properties are stored once, keys that can be interpolated from their neighbors within the error bounds are removed,
+    /// rotations are packed with the smallest three method and vectors are quantized to 16 bits in the range of their channel,
+    /// or to 32 bits when 16 bits can't reach the error bound over that range
+    /// @param settings Error bounds
+    XNOR_ENGINE void Compress(const AnimationCompressionSettings& settings);
+
+    /// @brief Gets whether the animation is compressed, in which case GetChannel can't be used
+    /// @returns Is compressed
+    [[nodiscard]]
+    XNOR_ENGINE bool_t IsCompressed() const;
+
+    /// @brief Samples the transform of a channel, works for both raw and compressed animations
+    /// @param channel Channel index
+    /// @param time Time in seconds
+    /// @param translation Sampled translation, can be nullptr
+    /// @param rotation Sampled rotation, can be nullptr
+    /// @param scaling Sampled scaling, can be nullptr
+    XNOR_ENGINE void SampleChannel(size_t channel, float_t time, Vector3* translation, Quaternion* rotation, Vector3* scaling) const;
+
+    /// @brief Samples the transform of a channel, starting the key search from the keys used by the previous sample
+    /// @param channel Channel index
+    /// @param time Time in seconds
+    /// @param cursor Keys used by the previous sample of this channel, updated with the keys used by this one
+    /// @param translation Sampled translation, can be nullptr
+    /// @param rotation Sampled rotation, can be nullptr
+    /// @param scaling Sampled scaling, can be nullptr
+    XNOR_ENGINE void SampleChannel(size_t channel, float_t time, ChannelCursor* cursor, Vector3* translation, Quaternion* rotation, Vector3* scaling) const;
+
+    /// @brief Gets the memory used to store the key frames
+    /// @returns Size in bytes
+    [[nodiscard]]
+    XNOR_ENGINE size_t GetKeyFrameMemorySize() const;
+
 private:
+    /// @brief Compressed keys of one property of a channel
+    struct CompressedTrack
+    {
+        /// @brief Index of the first key in the key arrays
+        uint32_t firstKey = 0;
+        /// @brief Number of keys, 0 if the property is constant
+        uint32_t keyCount = 0;
+        /// @brief Index of the first packed value in the value array
+        uint32_t firstValue = 0;
+        /// @brief Whether the vectors are packed with PackVectorWide, when 16 bits can't reach the error bound over the range of the track
+        bool_t isWide = false;
+        /// @brief Whether the key times are quantized with QuantizeWide, when 16 bits can't place them precisely enough over the time range of the track
+        bool_t isTimeWide = false;
+        /// @brief Time of the first key in ticks
+        float_t startTime = 0.f;
+        /// @brief Time between the first and the last key in ticks
+        float_t timeExtent = 0.f;
+        /// @brief Minimum of the quantization range, or the value if the property is constant
+        Vector3 min;
+        /// @brief Size of the quantization range
+        Vector3 extent;
+    };
+
+    /// @brief Compressed channel
+    struct CompressedChannel
+    {
+        /// @brief Translation keys
+        CompressedTrack translation;
+        /// @brief Rotation keys
+        CompressedTrack rotation;
+        /// @brief Scaling keys
+        CompressedTrack scaling;
+        /// @brief Value of the rotation if it is constant
+        Quaternion constantRotation = Quaternion::Identity();
+    };
+
     float_t m_Duration;
     float_t m_Framerate;
     float_t m_FrameDuration;
     size_t m_FrameCount;
-    std::unordered_map<std::string, List<KeyFrame>> m_KeyFrames;
+
+    /// @brief Key frames of each channel
+    List<List<KeyFrame>> m_Channels;
+    /// @brief Channel index of each animated bone name
+    std::unordered_map<std::string, int32_t> m_ChannelIndices;
+    /// @brief Channel bindings of each skeleton this animation was sampled with
+    mutable std::unordered_map<Guid, List<int32_t>> m_ChannelBindings;
+
+    bool_t m_IsCompressed = false;
+    /// @brief Compressed channels, replace m_Channels once compressed
+    List<CompressedChannel> m_CompressedChannels;
+    /// @brief Times of the keys of all the compressed tracks, quantized over the time range of their track, one value per key or WideSize for the tracks with wide times
+    List<uint16_t> m_KeyTimes;
+    /// @brief Packed values of the keys of all the compressed tracks, PackedSize values per key or WidePackedSize for the wide tracks
+    List<uint16_t> m_KeyValues;
+
+    XNOR_ENGINE void CompressVectorTrack(const List<KeyFrame>& keyFrames, Vector3 KeyFrame::* property, float_t maxError, CompressedTrack* track);
+
+    XNOR_ENGINE void CompressRotationTrack(const List<KeyFrame>& keyFrames, float_t maxError, CompressedTrack* track, Quaternion* constant);
+
+    XNOR_ENGINE void AddKeys(const List<KeyFrame>& keyFrames, const std::vector<uint32_t>& keptKeys, const std::vector<uint16_t>& packedValues, CompressedTrack* track);
+
+    /// @brief Gets the time of a key of a compressed track
+    /// @param track Track
+    /// @param key Key index in the track
+    /// @returns Time in ticks
+    [[nodiscard]]
+    XNOR_ENGINE float_t GetCompressedKeyTime(const CompressedTrack& track, uint32_t key) const;
+
+    /// @brief Finds the key before a time in a compressed track
+    /// @param track Track
+    /// @param keyTime Time in ticks
+    /// @param cursor Key found by the previous search in this track
+    /// @param t Interpolation factor towards the next key
+    /// @returns Key index in the track
+    [[nodiscard]]
+    XNOR_ENGINE uint32_t FindCompressedKey(const CompressedTrack& track, float_t keyTime, uint32_t* cursor, float_t* t) const;
+
+    [[nodiscard]]
+    XNOR_ENGINE Vector3 SampleVectorTrack(const CompressedTrack& track, float_t keyTime, uint32_t* cursor) const;
+
+    [[nodiscard]]
+    XNOR_ENGINE Quaternion SampleRotationTrack(const CompressedTrack& track, const Quaternion& constant, float_t keyTime, uint32_t* cursor) const;
 
 };
 
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <Maths/calc.hpp>
+#include <Maths/quaternion.hpp>
+#include <Maths/vector3.hpp>
+
+#include "core.hpp"
+
+/// @file animation_compression.hpp
+/// @brief Defines the XnorCore::AnimationCompression class
+
+BEGIN_XNOR_CORE
+
+/// @brief Error bounds used when compressing an animation
+struct AnimationCompressionSettings
+{
+    /// @brief Maximum distance between a compressed translation and the original one
+    float_t maxTranslationError = 0.0005f;
+    /// @brief Maximum angle between a compressed rotation and the original one, in radians
+    float_t maxRotationError = 0.05f * Calc::Deg2Rad;
+    /// @brief Maximum distance between a compressed scaling and the original one
+    float_t maxScalingError = 0.0005f;
+};
+
+/// @brief Provides the quantization functions used by compressed animations
+class AnimationCompression
+{
+    STATIC_CLASS(AnimationCompression)
+
+public:
+    /// @brief Number of values a quantized vector or rotation is stored in
+    static constexpr size_t PackedSize = 3;
+    /// @brief Number of values a vector quantized with PackVectorWide is stored in
+    static constexpr size_t WidePackedSize = 6;
+    /// @brief Number of values a value quantized with QuantizeWide is stored in
+    static constexpr size_t WideSize = 2;
+
+    /// @brief Quantizes a value to 16 bits in a known range
+    /// @param value Value
+    /// @param min Minimum of the range
+    /// @param extent Size of the range
+    /// @returns Quantized value
+    [[nodiscard]]
+    XNOR_ENGINE static uint16_t Quantize(float_t value, float_t min, float_t extent);
+
+    /// @brief Restores a value quantized with Quantize
+    /// @param value Quantized value
+    /// @param min Minimum of the range
+    /// @param extent Size of the range
+    /// @returns Value
+    [[nodiscard]]
+    XNOR_ENGINE static float_t Dequantize(uint16_t value, float_t min, float_t extent);
+
+    /// @brief Quantizes a value to 32 bits in a known range, for the ranges too large for Quantize to be precise enough
+    /// @param value Value
+    /// @param min Minimum of the range
+    /// @param extent Size of the range
+    /// @param packed Quantized value, must hold WideSize values
+    XNOR_ENGINE static void QuantizeWide(float_t value, float_t min, float_t extent, uint16_t* packed);
+
+    /// @brief Restores a value quantized with QuantizeWide
+    /// @param packed Quantized value
+    /// @param min Minimum of the range
+    /// @param extent Size of the range
+    /// @returns Value
+    [[nodiscard]]
+    XNOR_ENGINE static float_t DequantizeWide(const uint16_t* packed, float_t min, float_t extent);
+
+    /// @brief Quantizes each component of a vector to 16 bits in a known range
+    /// @param vector Vector
+    /// @param min Minimum of the range
+    /// @param extent Size of the range
+    /// @param packed Quantized components, must hold PackedSize values
+    XNOR_ENGINE static void PackVector(const Vector3& vector, const Vector3& min, const Vector3& extent, uint16_t* packed);
+
+    /// @brief Restores a vector quantized with PackVector
+    /// @param packed Quantized components
+    /// @param min Minimum of the range
+    /// @param extent Size of the range
+    /// @returns Vector
+    [[nodiscard]]
+    XNOR_ENGINE static Vector3 UnpackVector(const uint16_t* packed, const Vector3& min, const Vector3& extent);
+
+    /// @brief Quantizes each component of a vector to 32 bits in a known range, for the ranges too large for PackVector to be precise enough
+    /// @param vector Vector
+    /// @param min Minimum of the range
+    /// @param extent Size of the range
+    /// @param packed Quantized components, must hold WidePackedSize values
+    XNOR_ENGINE static void PackVectorWide(const Vector3& vector, const Vector3& min, const Vector3& extent, uint16_t* packed);
+
+    /// @brief Restores a vector quantized with PackVectorWide
+    /// @param packed Quantized components
+    /// @param min Minimum of the range
+    /// @param extent Size of the range
+    /// @returns Vector
+    [[nodiscard]]
+    XNOR_ENGINE static Vector3 UnpackVectorWide(const uint16_t* packed, const Vector3& min, const Vector3& extent);
+
+    /// @brief Packs a rotation using the smallest three method
+    ///
+    /// The largest component is dropped and recomputed from the others, which are stored on 15 bits each along with the index of the dropped one
+    /// @param rotation Normalized rotation
+    /// @param packed Packed rotation, must hold PackedSize values
+    XNOR_ENGINE static void PackRotation(const Quaternion& rotation, uint16_t* packed);
+
+    /// @brief Restores a rotation packed with PackRotation
+    /// @param packed Packed rotation
+    /// @returns Rotation
+    [[nodiscard]]
+    XNOR_ENGINE static Quaternion UnpackRotation(const uint16_t* packed);
+
+    /// @brief Normalized linear interpolation between two rotations, taking the shortest path
+    /// @param a Start rotation
+    /// @param b End rotation
+    /// @param t Interpolation factor
+    /// @returns Rotation
+    [[nodiscard]]
+    XNOR_ENGINE static Quaternion Nlerp(const Quaternion& a, const Quaternion& b, float_t t);
+
+    /// @brief Computes the angle between two rotations
+    /// @param a First rotation
+    /// @param b Second rotation
+    /// @returns Angle in radians
+    [[nodiscard]]
+    XNOR_ENGINE static float_t AngleBetween(const Quaternion& a, const Quaternion& b);
+};
+
+END_XNOR_CORE
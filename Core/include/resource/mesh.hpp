@@ -54,9 +54,15 @@ public:
     [[nodiscard]]
     XNOR_ENGINE Pointer<Animation> GetAnimation(size_t id);
 
+    /// @brief Gets the bind pose bounding boxes of the vertices influenced by each bone, for all the models of the mesh
+    /// @returns Bone bounding boxes, empty if the mesh isn't skinned
+    [[nodiscard]]
+    XNOR_ENGINE const List<BoneAabb>& GetBoneAabbs() const;
+
 private:
     List<Pointer<Animation>> m_Animations;
     List<Pointer<Skeleton>> m_Skeletons;
+    List<BoneAabb> m_BoneAabbs;
 
     static std::string GetTextureFileName(const std::string& textureName,const std::string& textureFormat);
 
@@ -65,6 +71,8 @@ private:
     void LoadTexture(const aiScene& scene);
 
     void ComputeAabb();
+
+    void ComputeBoneAabbs();
 };
 
 END_XNOR_CORE
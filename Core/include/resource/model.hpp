@@ -16,6 +16,15 @@
 
 BEGIN_XNOR_CORE
 
+/// @brief Bounding box of the vertices influenced by a bone in bind pose
+struct BoneAabb
+{
+    /// @brief Index of the bone in the bone palette
+    uint32_t boneId = 0;
+    /// @brief Bounding box of the vertices, in model space
+    Bound aabb;
+};
+
 /// @brief Holds the necessary information to draw a 3D model.
 class Model final : public Resource
 {
@@ -81,6 +90,9 @@ public:
         ".xgl",
         ".zgl"
     };*/
+    /// @brief Maximum number of detail levels of a model, including the full detail one
+    static constexpr size_t MaxLodCount = 4;
+
     Bound aabb;
     
     // Use the base class' constructors
@@ -113,19 +125,62 @@ public:
     [[nodiscard]]
     XNOR_ENGINE uint32_t GetId() const;
 
+    /// @brief Gets the number of detail levels of the model, 1 if it only has its full detail
+    /// @return Detail level count
+    [[nodiscard]]
+    XNOR_ENGINE size_t GetLodCount() const;
+
+    /// @brief Gets the id of a detail level of the model
+    /// @param lod Detail level, 0 being the full detail, clamped to the last level
+    /// @return Model id
+    [[nodiscard]]
+    XNOR_ENGINE uint32_t GetLodId(size_t lod) const;
+
+    /// @brief Gets the number of triangles of a detail level of the model
+    /// @param lod Detail level, 0 being the full detail, clamped to the last level
+    /// @return Triangle count
+    [[nodiscard]]
+    XNOR_ENGINE size_t GetTriangleCount(size_t lod) const;
+
 #ifndef SWIG
     /// @brief Gets the vertices of the model
     /// @return Vertices
     [[nodiscard]]
     const std::vector<Vertex>& GetVertices() const;
+
+    /// @brief Gets the triangle list indices of the model
+    /// @return Indices
+    [[nodiscard]]
+    const std::vector<uint32_t>& GetIndices() const;
+
+    /// @brief Gets the bounding boxes of the vertices influenced by each bone, only the bones that influence at least one vertex are listed
+    /// @return Bone bounding boxes
+    [[nodiscard]]
+    const std::vector<BoneAabb>& GetBoneAabbs() const;
 #endif
     
 private:
+    /// @brief Simplified version of the model
+    struct Lod
+    {
+        std::vector<Vertex> vertices;
+        std::vector<uint32_t> indices;
+        uint32_t modelId = 0;
+    };
+
     XNOR_ENGINE void ComputeAabb(const aiAABB& assimpAabb);
+
+    XNOR_ENGINE void ComputeBoneAabbs(uint32_t boneCount);
+
+    XNOR_ENGINE void GenerateLods();
     
     std::vector<Vertex> m_Vertices;
+    std::vector<BoneAabb> m_BoneAabbs;
     std::vector<uint32_t> m_Indices;
     uint32_t m_ModelId = 0;
+
+    // Detail levels after the full detail one, from the most to the least detailed
+    std::vector<Lod> m_Lods;
     
 };
 
@@ -107,6 +107,11 @@ public:
     [[nodiscard]]
     XNOR_ENGINE int32_t GetChannels() const;
 
+    /// @brief Gets the type of each channel of the loaded data, HDR images are loaded as floats and the others as unsigned bytes
+    /// @return Data type
+    [[nodiscard]]
+    XNOR_ENGINE ENUM_VALUE(DataType) GetDataType() const;
+
     /// @brief Binds the texture
     /// @param index Index
     XNOR_ENGINE void BindTexture(uint32_t index) const;
@@ -149,6 +154,7 @@ private:
     ENUM_VALUE(TextureWrapping) m_TextureWrapping = TextureWrapping::Repeat;
     ENUM_VALUE(TextureInternalFormat) m_TextureInternalFormat = TextureInternalFormat::Rgba8;
     ENUM_VALUE(TextureFormat) m_TextureFormat = TextureFormat::Rgb;
+    ENUM_VALUE(DataType) m_DataType = DataType::UnsignedByte;
 };
 
 END_XNOR_CORE
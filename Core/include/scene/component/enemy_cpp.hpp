@@ -2,6 +2,7 @@
 #include "core.hpp"
 #include "skinned_mesh_renderer.hpp"
 #include "physics/component/capsule_collider.hpp"
+#include "physics/component/character_controller.hpp"
 #include "resource/animation.hpp"
 #include "scene/component.hpp"
 #include "utils/coroutine.hpp"
@@ -44,6 +45,8 @@ private:
 
     CapsuleCollider* capsule = nullptr;
 
+    CharacterController* m_Controller = nullptr;
+
     float_t m_MoveSpeed = 1.f;
 
     float_t KillY = -1000.f;
@@ -66,6 +69,11 @@ private:
     
     XNOR_ENGINE void Move() const;
 
+    [[nodiscard]]
+    XNOR_ENGINE Vector3 GetVelocity() const;
+
+    XNOR_ENGINE void SetVelocity(const Vector3& velocity) const;
+
     // Return The forward Vector
     XNOR_ENGINE void LookAtPlayer();
 
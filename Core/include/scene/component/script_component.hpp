@@ -1,7 +1,11 @@
 #pragma once
 
 #include "core.hpp"
+
+#include <unordered_map>
+
 #include "Coral/ManagedObject.hpp"
+#include "Coral/Type.hpp"
 #include "csharp/dotnet_assembly.hpp"
 #include "physics/component/collider.hpp"
 #include "reflection/reflection.hpp"
@@ -19,11 +23,17 @@ class ScriptComponent : public Component
     REFLECTABLE_IMPL(ScriptComponent)
 
 public:
-    ScriptComponent() = default;
-
     /// @brief Creates and initializes a new ScriptComponent from the given managed type name and assembly.
     XNOR_ENGINE static ScriptComponent* New(const std::string& managedTypeName, const DotnetAssembly* assembly);
 
+    /// @brief Destroys the managed wrapper cached for the given Collider, if any. Should be called when a Collider is destroyed.
+    XNOR_ENGINE static void ReleaseColliderWrapper(const Collider* collider);
+
+    /// @brief Destroys all the cached managed types and wrappers. Should be called before the .NET assemblies are unloaded.
+    XNOR_ENGINE static void ReleaseManagedCache();
+
+    ScriptComponent() = default;
+
     /// @brief Destroys this ScriptComponent in the .NET runtime.
     XNOR_ENGINE void Destroy() override;
 
@@ -53,11 +63,48 @@ protected:
     XNOR_ENGINE virtual void OnCollisionExit(Collider* self, Collider* other);
     
 private:
+    /// @brief Collision events forwarded to the managed method of the same name
+    enum class CollisionEvent : uint8_t
+    {
+        TriggerEnter,
+        TriggerStay,
+        TriggerExit,
+        CollisionEnter,
+        CollisionStay,
+        CollisionExit,
+
+        Count
+    };
+
+    /// @brief Cached managed Collider type, only resolved once instead of on every collision event
+    XNOR_ENGINE static inline Coral::Type* m_ColliderType = nullptr;
+    /// @brief Cached managed CollisionData type, only resolved once instead of on every collision event
+    XNOR_ENGINE static inline Coral::Type* m_CollisionDataType = nullptr;
+
+    /// @brief Pool of managed Collider wrappers, they don't own the native memory so they can be reused for every event
+    XNOR_ENGINE static inline std::unordered_map<const Collider*, Coral::ManagedObject> m_ColliderWrappers;
+
+    /// @brief Native storage the managed CollisionData wrapper points to, the data of each event is copied in it before invoking the managed method
+    XNOR_ENGINE static inline CollisionData m_CollisionDataStorage;
+    /// @brief Single managed CollisionData wrapper, pointing to @ref m_CollisionDataStorage
+    XNOR_ENGINE static inline Coral::ManagedObject m_CollisionDataWrapper;
+    /// @brief Whether @ref m_CollisionDataWrapper has been created
+    XNOR_ENGINE static inline bool_t m_HasCollisionDataWrapper = false;
+
+    /// @brief Resolves the managed types used by the collision events if they aren't already
+    static void CacheManagedTypes();
+
+    /// @brief Gets the pooled managed wrapper of a Collider, creating it the first time
+    static Coral::ManagedObject& GetColliderWrapper(Collider* collider);
+
+    /// @brief Gets the managed CollisionData wrapper after copying @p data in its native storage
+    static Coral::ManagedObject& GetCollisionDataWrapper(const CollisionData& data);
+
     Coral::ManagedObject m_ManagedObject;
 
-    void InvokeCollisionEvent(const std::string& functionName, Collider* self, Collider* other, const CollisionData& data);
+    void InvokeCollisionEvent(CollisionEvent event, Collider* self, Collider* other, const CollisionData& data);
 
-    void InvokeCollisionExitEvent(const std::string& functionName, Collider* self, Collider* other);
+    void InvokeCollisionExitEvent(CollisionEvent event, Collider* self, Collider* other);
 
     // The DotnetRuntime class needs to have access to the m_ManagedObject field
     friend class DotnetRuntime;
@@ -33,6 +33,9 @@ public:
     /// @brief Whether to draw the model AABB box
     bool_t drawModelAabb = false;
 
+    /// @brief Whether the animation can be updated less often when the mesh is far away or outside the view
+    bool_t animationLod = true;
+
     XNOR_ENGINE void StartAnimation(const Pointer<Animation>& animation);
     XNOR_ENGINE void StartBlending(const Pointer<Animation>& animation);
     XNOR_ENGINE void SetCrossFadeDelta(float_t delta);
@@ -41,11 +44,37 @@ public:
 
     XNOR_ENGINE const List<Matrix>& GetMatrices() const;
 
+    /// @brief Accumulates the time elapsed since the last evaluation and tells whether the animation is due
+    /// @param deltaTime Time elapsed since the last frame
+    /// @param updateInterval Number of frames between two evaluations
+    /// @returns Whether Animate needs to be called this frame
+    XNOR_ENGINE bool_t ScheduleAnimation(float_t deltaTime, uint32_t updateInterval);
+
+    /// @brief Evaluates the animation with the time accumulated since the last evaluation, can be called from a worker thread
+    XNOR_ENGINE void Animate();
+
+    /// @brief Gets the world space bounding box of the mesh in its last evaluated pose
+    /// @param bound Result
+    XNOR_ENGINE void GetAabb(Bound* bound) const;
+
 private:
     Animator m_Animator;
     Animator m_TargetAnimator;
 
-    AnimationMontage* m_CurrentMontage;
+    AnimationMontage* m_CurrentMontage = nullptr;
+
+    /// @brief Time elapsed since the last evaluation
+    float_t m_PendingDeltaTime = 0.f;
+    /// @brief Number of frames since the last evaluation
+    uint32_t m_FramesSinceAnimation = 0;
+    /// @brief Whether the animation was evaluated at least once
+    bool_t m_HasAnimated = false;
+
+    /// @brief Model space bounding box of the last evaluated pose
+    Bound m_PoseAabb;
+
+    /// @brief Computes the bounding box of the pose from the bone palette
+    void ComputePoseAabb();
 };
 
 END_XNOR_CORE
@@ -56,5 +85,6 @@ REFL_AUTO(
     field(mesh),
     field(material),
     field(drawModelAabb),
+    field(animationLod),
     field(m_Animator)
 );
@@ -25,6 +25,9 @@ public:
 
     /// @brief Whether to draw the model AABB box
     bool_t drawModelAabb = false;
+
+    /// @brief Whether the mesh hides the meshes behind it, see OcclusionCuller
+    bool_t isOccluder = false;
     
     XNOR_ENGINE StaticMeshRenderer() = default;
 
@@ -42,5 +45,6 @@ REFL_AUTO(
     type(XnorCore::StaticMeshRenderer, bases<XnorCore::Component>),
     field(mesh),
     field(material),
-    field(drawModelAabb)
+    field(drawModelAabb),
+    field(isOccluder)
 );
@@ -13,6 +13,12 @@ class XNOR_ENGINE Bound
 {
 public:
     static Bound GetAabbFromTransform(const Bound& bound,const Transform& transform);
+
+    /// @brief Computes the AABB enclosing a bound transformed by a matrix
+    /// @param bound Bound
+    /// @param matrix Affine transformation
+    /// @returns Transformed AABB
+    static Bound GetAabbFromMatrix(const Bound& bound, const Matrix& matrix);
     
      /// @brief The extents of the Bounding Box. This is half size of the Bounds.
     Vector3 extents;
@@ -46,6 +52,22 @@ public:
     [[nodiscard]]
     bool_t Countain(const Bound& otherBound) const;
 
+    /// @brief Checks whether this bound intersects a sphere
+    /// @param sphereCenter Sphere center
+    /// @param radius Sphere radius
+    /// @returns Whether they intersect
+    [[nodiscard]]
+    bool_t IntersectSphere(Vector3 sphereCenter, float_t radius) const;
+
+    /// @brief Checks whether this bound may intersect a cone, the test is conservative so it can return true for a bound near the cone
+    /// @param apex Cone apex
+    /// @param direction Normalized cone axis
+    /// @param angle Half angle of the cone, in radians
+    /// @param range Cone range from the apex
+    /// @returns Whether they may intersect
+    [[nodiscard]]
+    bool_t IntersectCone(Vector3 apex, Vector3 direction, float_t angle, float_t range) const;
+
     [[nodiscard]]
     bool_t IsOnPlane(const Plane& plane) const;
 
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+
+#include "core.hpp"
+
+/// @file delegate.hpp
+/// @brief Defines the XnorCore::Delegate class.
+
+BEGIN_XNOR_CORE
+
+template <typename>
+class Delegate;
+
+/// @brief Callable object stored inline, unlike @c std::function it never allocates
+///
+/// The callable is stored in a fixed size buffer, a callable that doesn't fit is a compilation error instead of a heap allocation.
+/// This makes delegates cheap to copy and to call, so they can be stored in flat arrays that are walked every frame
+/// 
+/// @tparam ReturnT Return type
+/// @tparam Args Arguments
+template <typename ReturnT, typename... Args>
+class Delegate<ReturnT(Args...)>
+{
+public:
+    /// @brief Size of the buffer the callable is stored in, enough for a lambda capturing a few pointers
+    static constexpr size_t BufferSize = 6 * sizeof(void*);
+
+    /// @brief Creates an empty delegate
+    Delegate() = default;
+
+    /// @brief Creates a delegate from a callable
+    /// @tparam FunctionT Callable type, must fit in BufferSize bytes
+    /// @param function Callable
+    template <typename FunctionT, typename = std::enable_if_t<!std::is_same_v<std::decay_t<FunctionT>, Delegate>>>
+    Delegate(FunctionT&& function);  // NOLINT(google-explicit-constructor)
+
+    ~Delegate();
+
+    Delegate(const Delegate& other);
+
+    Delegate(Delegate&& other) noexcept;
+
+    Delegate& operator=(const Delegate& other);
+
+    Delegate& operator=(Delegate&& other) noexcept;
+
+    /// @brief Calls the callable, the delegate must not be empty
+    /// @param args Arguments
+    /// @returns Callable result
+    ReturnT Invoke(Args... args) const;
+
+    /// @brief Calls the callable, the delegate must not be empty. Effectively the same as calling @c Invoke.
+    ReturnT operator()(Args... args) const;
+
+    /// @brief Gets whether the delegate holds a callable
+    [[nodiscard]]
+    bool_t IsBound() const;
+
+    /// @brief Destroys the callable
+    void Reset();
+
+private:
+    enum class Operation
+    {
+        Copy,
+        Move,
+        Destroy
+    };
+
+    using InvokeFunctionT = ReturnT(*)(void* storage, Args... args);
+    using ManageFunctionT = void(*)(Operation operation, void* destination, void* source);
+
+    alignas(std::max_align_t) mutable std::byte m_Storage[BufferSize];
+
+    InvokeFunctionT m_Invoke = nullptr;
+    ManageFunctionT m_Manage = nullptr;
+
+    template <typename FunctionT>
+    static ReturnT InvokeCallable(void* storage, Args... args);
+
+    template <typename FunctionT>
+    static void ManageCallable(Operation operation, void* destination, void* source);
+};
+
+END_XNOR_CORE
+
+#include "utils/delegate.inl"
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+
+#include "core.hpp"
+
+/// @file job_system.hpp
+/// @brief Defines the XnorCore::JobSystem class
+
+namespace JPH
+{
+    class JobSystemThreadPool;
+}
+
+BEGIN_XNOR_CORE
+
+/// @brief Runs engine work on a pool of worker threads
+///
+/// The work is split into batches of contiguous indices, one job per batch. If the job system isn't initialized the work runs on the calling thread,
+/// so systems using it can be tested without starting the workers. The physics runs its jobs on the same thread pool
+class JobSystem
+{
+    STATIC_CLASS(JobSystem)
+
+public:
+    /// @brief Function processing the indices in [first, last)
+    using BatchFunction = std::function<void(size_t first, size_t last)>;
+
+    /// @brief Starts the worker threads
+    XNOR_ENGINE static void Initialize();
+
+    /// @brief Stops the worker threads
+    XNOR_ENGINE static void Destroy();
+
+    /// @brief Gets whether the worker threads are started
+    /// @returns Is initialized
+    [[nodiscard]]
+    XNOR_ENGINE static bool_t IsInitialized();
+
+    /// @brief Gets the maximum number of batches that can run at the same time, including the calling thread
+    /// @returns Concurrency
+    [[nodiscard]]
+    XNOR_ENGINE static size_t GetMaxConcurrency();
+
+    /// @brief Gets a fixed index for the calling thread, for the systems keeping one buffer per thread running jobs
+    ///
+    /// Indices are handed out in the order the threads first ask for one and stay the same until the job system is initialized again.
+    /// The workers and the thread waiting on the jobs fit in [0, GetMaxConcurrency()), any other thread gets an index past it
+    /// @returns Thread index
+    [[nodiscard]]
+    XNOR_ENGINE static size_t GetThreadIndex();
+
+    /// @brief Gets the thread pool the jobs run on, for the systems scheduling Jolt jobs themselves
+    /// @returns Thread pool, nullptr if the job system isn't initialized
+    [[nodiscard]]
+    XNOR_ENGINE static JPH::JobSystemThreadPool* GetThreadPool();
+
+    /// @brief Processes a range of indices in parallel and waits for all of it to be done
+    /// @param count Number of indices
+    /// @param minBatchSize Minimum number of indices per batch, to avoid scheduling jobs that are cheaper than their overhead
+    /// @param function Function called for each batch, must be thread safe
+    XNOR_ENGINE static void ParallelFor(size_t count, size_t minBatchSize, const BatchFunction& function);
+
+private:
+    XNOR_ENGINE static inline JPH::JobSystemThreadPool* m_ThreadPool = nullptr;
+
+    XNOR_ENGINE static inline std::atomic<size_t> m_NextThreadIndex = 0;
+    // Incremented each time the pool is started, so the threads of a previous pool don't keep their index
+    XNOR_ENGINE static inline std::atomic<uint32_t> m_ThreadIndexGeneration = 0;
+};
+
+END_XNOR_CORE
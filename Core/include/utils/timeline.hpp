@@ -1,30 +1,62 @@
 #pragma once
 
-#include <map>
-
 #include "core.hpp"
-#include "event.hpp"
+#include "utils/delegate.hpp"
+#include "utils/list.hpp"
+
+/// @file timeline.hpp
+/// @brief Defines the XnorCore::Timeline class.
 
 BEGIN_XNOR_CORE
 
-template <typename... Args>
-struct TimelineEvents
+/// @brief Event of a timeline, its callbacks are stored in the flat callback arrays of the timeline
+struct TimelineEvent
 {
-    Event<Args...> begin;
-    Event<float_t, Args...> update;
-    Event<Args...> ended;
+    /// @brief Time at which the event begins
+    float_t when = 0.f;
+    /// @brief Duration of the event, during which its update callbacks are called
     float_t duration = 0.f;
+
+    /// @brief Index of the first begin callback
+    uint32_t firstBegin = 0;
+    /// @brief Number of begin callbacks
+    uint32_t beginCount = 0;
+    /// @brief Index of the first update callback
+    uint32_t firstUpdate = 0;
+    /// @brief Number of update callbacks
+    uint32_t updateCount = 0;
+    /// @brief Index of the first end callback
+    uint32_t firstEnd = 0;
+    /// @brief Number of end callbacks
+    uint32_t endCount = 0;
 };
 
+/// @brief Callback of a timeline event
+/// @tparam FunctionT Callback type
+template <typename FunctionT>
+struct TimelineCallback
+{
+    /// @brief Time of the event the callback belongs to
+    float_t when = 0.f;
+    /// @brief Callback
+    FunctionT function;
+};
+
+/// @brief Sequence of timed events
+///
+/// The events and their callbacks are kept in flat arrays sorted by time, which are only rebuilt when events are added.
+/// Playing the timeline walks these arrays with a cursor and calls the callbacks through delegates, so it never allocates
+/// 
+/// @tparam Args Arguments of the callbacks
 template <typename... Args>
 class Timeline
 {
     REFLECTABLE_IMPL(Timeline)
     
 public:
-    using BeginFunctionT = typename Event<Args...>::StdFunctionT;
-    using UpdateFunctionT = typename Event<float_t, Args...>::StdFunctionT;
-    using EndFunctionT = typename Event<Args...>::StdFunctionT;
+    using BeginFunctionT = Delegate<void(Args...)>;
+    using UpdateFunctionT = Delegate<void(float_t, Args...)>;
+    using EndFunctionT = Delegate<void(Args...)>;
 
     Timeline() = default;
     explicit Timeline(float_t duration);
@@ -32,9 +64,20 @@ public:
 
     DEFAULT_COPY_MOVE_OPERATIONS(Timeline)
     
+    /// @brief Starts playing the timeline from the beginning
     void Start();
+
+    /// @brief Advances the timeline by the frame delta time
+    /// @param args Callback arguments
+    /// @returns Whether the timeline ended
     bool_t Update(Args&&... args);
 
+    /// @brief Advances the timeline by a given time
+    /// @param deltaTime Time elapsed since the last update
+    /// @param args Callback arguments
+    /// @returns Whether the timeline ended
+    bool_t Advance(float_t deltaTime, Args&&... args);
+
     void SetEventDuration(float_t when, float_t duration);
     void AddBeginEvent(float_t when, BeginFunctionT function);
     void AddUpdateEvent(float_t when, UpdateFunctionT function);
@@ -44,23 +87,43 @@ public:
     float_t GetDuration() const;
     void SetDuration(float_t duration);
 
+    /// @brief Gets the events, sorted by time
+    /// @returns Events
+    [[nodiscard]]
+    const List<TimelineEvent>& GetEvents() const;
+
 private:
-    std::map<float_t, TimelineEvents<Args...>> m_Events;
+    List<TimelineEvent> m_Events;
+    List<TimelineCallback<BeginFunctionT>> m_BeginCallbacks;
+    List<TimelineCallback<UpdateFunctionT>> m_UpdateCallbacks;
+    List<TimelineCallback<EndFunctionT>> m_EndCallbacks;
+
     float_t m_Duration = 0.f;
     float_t m_Time = 0.f;
     float_t m_CurrentEventDuration = 0.f;
 
-    typename decltype(m_Events)::iterator m_CurrentEvent;
-    typename decltype(m_Events)::iterator m_NextEvent;
+    /// @brief Index of the event that is playing
+    size_t m_CurrentEvent = 0;
+    /// @brief Index of the next event to begin
+    size_t m_NextEvent = 0;
     bool_t m_HasCurrentEvent = false;
+
+    /// @brief Whether the callback ranges of the events are up to date
+    bool_t m_IsCompiled = true;
+
+    TimelineEvent& GetOrAddEvent(float_t when);
+
+    template <typename FunctionT>
+    void AddCallback(List<TimelineCallback<FunctionT>>& callbacks, float_t when, FunctionT&& function);
+
+    /// @brief Computes the range of callbacks of each event
+    void Compile();
 };
 
 END_XNOR_CORE
 
-REFL_AUTO(template((typename... Args), (XnorCore::TimelineEvents<Args...>)),
-    field(begin),
-    field(update),
-    field(ended),
+REFL_AUTO(type(XnorCore::TimelineEvent),
+    field(when),
     field(duration)
 )
 
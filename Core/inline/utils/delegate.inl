@@ -0,0 +1,138 @@
+#pragma once
+
+#include <new>
+#include <utility>
+
+BEGIN_XNOR_CORE
+
+template <typename ReturnT, typename... Args>
+template <typename FunctionT, typename>
+Delegate<ReturnT(Args...)>::Delegate(FunctionT&& function)
+{
+    using CallableT = std::decay_t<FunctionT>;
+
+    static_assert(sizeof(CallableT) <= BufferSize, "The callable doesn't fit in the delegate buffer, capture less data or capture it by pointer");
+    static_assert(alignof(CallableT) <= alignof(std::max_align_t), "The callable is over-aligned");
+
+    new (m_Storage) CallableT(std::forward<FunctionT>(function));
+
+    m_Invoke = &InvokeCallable<CallableT>;
+    m_Manage = &ManageCallable<CallableT>;
+}
+
+template <typename ReturnT, typename... Args>
+Delegate<ReturnT(Args...)>::~Delegate()
+{
+    Reset();
+}
+
+template <typename ReturnT, typename... Args>
+Delegate<ReturnT(Args...)>::Delegate(const Delegate& other)
+    : m_Invoke(other.m_Invoke), m_Manage(other.m_Manage)
+{
+    if (m_Manage)
+        m_Manage(Operation::Copy, m_Storage, other.m_Storage);
+}
+
+template <typename ReturnT, typename... Args>
+Delegate<ReturnT(Args...)>::Delegate(Delegate&& other) noexcept
+    : m_Invoke(other.m_Invoke), m_Manage(other.m_Manage)
+{
+    if (m_Manage)
+        m_Manage(Operation::Move, m_Storage, other.m_Storage);
+
+    other.Reset();
+}
+
+template <typename ReturnT, typename... Args>
+Delegate<ReturnT(Args...)>& Delegate<ReturnT(Args...)>::operator=(const Delegate& other)
+{
+    if (this == &other)
+        return *this;
+
+    Reset();
+
+    m_Invoke = other.m_Invoke;
+    m_Manage = other.m_Manage;
+
+    if (m_Manage)
+        m_Manage(Operation::Copy, m_Storage, other.m_Storage);
+
+    return *this;
+}
+
+template <typename ReturnT, typename... Args>
+Delegate<ReturnT(Args...)>& Delegate<ReturnT(Args...)>::operator=(Delegate&& other) noexcept
+{
+    if (this == &other)
+        return *this;
+
+    Reset();
+
+    m_Invoke = other.m_Invoke;
+    m_Manage = other.m_Manage;
+
+    if (m_Manage)
+        m_Manage(Operation::Move, m_Storage, other.m_Storage);
+
+    other.Reset();
+
+    return *this;
+}
+
+template <typename ReturnT, typename... Args>
+ReturnT Delegate<ReturnT(Args...)>::Invoke(Args... args) const
+{
+    return m_Invoke(m_Storage, std::forward<Args>(args)...);
+}
+
+template <typename ReturnT, typename... Args>
+ReturnT Delegate<ReturnT(Args...)>::operator()(Args... args) const
+{
+    return Invoke(std::forward<Args>(args)...);
+}
+
+template <typename ReturnT, typename... Args>
+bool_t Delegate<ReturnT(Args...)>::IsBound() const
+{
+    return m_Invoke != nullptr;
+}
+
+template <typename ReturnT, typename... Args>
+void Delegate<ReturnT(Args...)>::Reset()
+{
+    if (m_Manage)
+        m_Manage(Operation::Destroy, m_Storage, nullptr);
+
+    m_Invoke = nullptr;
+    m_Manage = nullptr;
+}
+
+template <typename ReturnT, typename... Args>
+template <typename FunctionT>
+ReturnT Delegate<ReturnT(Args...)>::InvokeCallable(void* const storage, Args... args)
+{
+    return (*std::launder(static_cast<FunctionT*>(storage)))(std::forward<Args>(args)...);
+}
+
+template <typename ReturnT, typename... Args>
+template <typename FunctionT>
+void Delegate<ReturnT(Args...)>::ManageCallable(const Operation operation, void* const destination, void* const source)
+{
+    switch (operation)
+    {
+        case Operation::Copy:
+            new (destination) FunctionT(*std::launder(static_cast<const FunctionT*>(source)));
+            break;
+
+        case Operation::Move:
+            new (destination) FunctionT(std::move(*std::launder(static_cast<FunctionT*>(source))));
+            break;
+
+        case Operation::Destroy:
+            std::launder(static_cast<FunctionT*>(destination))->~FunctionT();
+            break;
+    }
+}
+
+END_XNOR_CORE
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <algorithm>
+
 #include "input/time.hpp"
 #include "utils/logger.hpp"
 
@@ -14,46 +16,69 @@ Timeline<Args...>::Timeline(const float_t duration)
 template <typename... Args>
 void Timeline<Args...>::Start()
 {
+    if (!m_IsCompiled)
+        Compile();
+
     m_Time = 0.f;
-    m_CurrentEvent = m_Events.begin();
-    m_NextEvent = m_Events.begin();
+    m_CurrentEventDuration = 0.f;
+    m_CurrentEvent = 0;
+    m_NextEvent = 0;
     m_HasCurrentEvent = false;
 }
 
 template <typename... Args>
 bool_t Timeline<Args...>::Update(Args&&... args)
 {
-    m_Time += Time::GetDeltaTime();
-    m_CurrentEventDuration += Time::GetDeltaTime();
+    return Advance(Time::GetDeltaTime(), std::forward<Args>(args)...);
+}
+
+template <typename... Args>
+bool_t Timeline<Args...>::Advance(const float_t deltaTime, Args&&... args)
+{
+    if (!m_IsCompiled)
+        Compile();
+
+    m_Time += deltaTime;
+    m_CurrentEventDuration += deltaTime;
 
     if (m_Time >= m_Duration)
         return true;
 
     if (m_HasCurrentEvent)
     {
-        const float_t eventDuration = m_CurrentEvent->second.duration;
-        if (m_CurrentEventDuration >= eventDuration)
+        const TimelineEvent& event = m_Events[m_CurrentEvent];
+
+        if (m_CurrentEventDuration >= event.duration)
         {
-            m_CurrentEvent->second.ended.Invoke(std::forward<Args>(args)...);
+            for (uint32_t i = 0; i < event.endCount; i++)
+                m_EndCallbacks[event.firstEnd + i].function.Invoke(std::forward<Args>(args)...);
+
             m_HasCurrentEvent = false;
         }
         else
         {
-            m_CurrentEvent->second.update.Invoke(m_CurrentEventDuration / eventDuration, std::forward<Args>(args)...);
+            const float_t t = m_CurrentEventDuration / event.duration;
+
+            for (uint32_t i = 0; i < event.updateCount; i++)
+                m_UpdateCallbacks[event.firstUpdate + i].function.Invoke(t, std::forward<Args>(args)...);
         }
     }
 
-    if (m_NextEvent == m_Events.end())
+    if (m_NextEvent >= m_Events.GetSize())
         return false;
 
-    if (m_NextEvent->first <= m_Time)
+    const TimelineEvent& nextEvent = m_Events[m_NextEvent];
+
+    if (nextEvent.when <= m_Time)
     {
         m_CurrentEvent = m_NextEvent;
+        m_CurrentEventDuration = 0.f;
         m_HasCurrentEvent = true;
 
-        m_CurrentEvent->second.begin.Invoke(std::forward<Args>(args)...);
+        for (uint32_t i = 0; i < nextEvent.beginCount; i++)
+            m_BeginCallbacks[nextEvent.firstBegin + i].function.Invoke(std::forward<Args>(args)...);
 
-        ++m_NextEvent;
+        m_NextEvent++;
     }
 
     return false;
@@ -62,11 +87,11 @@ bool_t Timeline<Args...>::Update(Args&&... args)
 template <typename... Args>
 void Timeline<Args...>::SetEventDuration(const float_t when, const float_t duration)
 {
-    m_Events[when].duration = duration;
+    GetOrAddEvent(when).duration = duration;
 }
 
 template <typename... Args>
-void Timeline<Args...>::AddBeginEvent(const float_t when, const BeginFunctionT function)
+void Timeline<Args...>::AddBeginEvent(const float_t when, BeginFunctionT function)
 {
     if (when >= m_Duration)
     {
@@ -74,11 +99,12 @@ void Timeline<Args...>::AddBeginEvent(const float_t when, const BeginFunctionT f
         return;
     }
 
-    m_Events[when].begin += function;
+    GetOrAddEvent(when);
+    AddCallback(m_BeginCallbacks, when, std::move(function));
 }
 
 template <typename... Args>
-void Timeline<Args...>::AddUpdateEvent(const float_t when, const UpdateFunctionT function)
+void Timeline<Args...>::AddUpdateEvent(const float_t when, UpdateFunctionT function)
 {
     if (when >= m_Duration)
     {
@@ -86,11 +112,12 @@ void Timeline<Args...>::AddUpdateEvent(const float_t when, const UpdateFunctionT
         return;
     }
 
-    m_Events[when].update += function;
+    GetOrAddEvent(when);
+    AddCallback(m_UpdateCallbacks, when, std::move(function));
 }
 
 template <typename... Args>
-void Timeline<Args...>::AddEndEvent(const float_t when, const EndFunctionT function)
+void Timeline<Args...>::AddEndEvent(const float_t when, EndFunctionT function)
 {
     if (when >= m_Duration)
     {
@@ -98,7 +125,8 @@ void Timeline<Args...>::AddEndEvent(const float_t when, const EndFunctionT funct
         return;
     }
 
-    m_Events[when].ended += function;
+    GetOrAddEvent(when);
+    AddCallback(m_EndCallbacks, when, std::move(function));
 }
 
 template <typename... Args>
@@ -118,4 +146,68 @@ void Timeline<Args...>::SetDuration(const float_t duration)
     m_Duration = duration;
 }
 
+template <typename... Args>
+const List<TimelineEvent>& Timeline<Args...>::GetEvents() const
+{
+    return m_Events;
+}
+
+template <typename... Args>
+TimelineEvent& Timeline<Args...>::GetOrAddEvent(const float_t when)
+{
+    auto&& it = std::ranges::lower_bound(m_Events, when, {}, &TimelineEvent::when);
+
+    if (it != m_Events.end() && it->when == when)
+        return *it;
+
+    m_IsCompiled = false;
+
+    const size_t index = static_cast<size_t>(it - m_Events.begin());
+    m_Events.Insert({ .when = when }, index);
+
+    return m_Events[index];
+}
+
+template <typename... Args>
+template <typename FunctionT>
+void Timeline<Args...>::AddCallback(List<TimelineCallback<FunctionT>>& callbacks, const float_t when, FunctionT&& function)
+{
+    // Inserting after the callbacks with the same time keeps them in the order they were added
+    auto&& it = std::ranges::upper_bound(callbacks, when, {}, &TimelineCallback<FunctionT>::when);
+    const size_t index = static_cast<size_t>(it - callbacks.begin());
+
+    callbacks.Insert({ .when = when, .function = std::move(function) }, index);
+
+    m_IsCompiled = false;
+}
+
+template <typename... Args>
+void Timeline<Args...>::Compile()
+{
+    // The events and the callbacks are sorted by time, so the ranges are found by walking all the arrays once
+    uint32_t begin = 0;
+    uint32_t update = 0;
+    uint32_t end = 0;
+
+    for (TimelineEvent& event : m_Events)
+    {
+        event.firstBegin = begin;
+        while (begin < m_BeginCallbacks.GetSize() && m_BeginCallbacks[begin].when == event.when)
+            begin++;
+        event.beginCount = begin - event.firstBegin;
+
+        event.firstUpdate = update;
+        while (update < m_UpdateCallbacks.GetSize() && m_UpdateCallbacks[update].when == event.when)
+            update++;
+        event.updateCount = update - event.firstUpdate;
+
+        event.firstEnd = end;
+        while (end < m_EndCallbacks.GetSize() && m_EndCallbacks[end].when == event.when)
+            end++;
+        event.endCount = end - event.firstEnd;
+    }
+
+    m_IsCompiled = true;
+}
+
 END_XNOR_CORE
@@ -1,14 +1,18 @@
 ﻿#include "application.hpp"
 
+#include <cstring>
+
 #include "screen.hpp"
 #include "csharp/dotnet_runtime.hpp"
 #include "file/file_manager.hpp"
 #include "input/input.hpp"
 #include "physics/physics_world.hpp"
+#include "rendering/render_stats.hpp"
 #include "rendering/rhi.hpp"
 #include "resource/resource_manager.hpp"
 
 #include "audio/audio.hpp"
+#include "utils/job_system.hpp"
 #include "utils/message_box.hpp"
 #include "world/world.hpp"
 
@@ -21,13 +25,21 @@ void Application::Exit(const int32_t code)
 	std::exit(code);  // NOLINT(concurrency-mt-unsafe)
 }
 
-Application::Application(const int32_t, const char_t* const* const argv)
+Application::Application(const int32_t argc, const char_t* const* const argv)
 {
     applicationInstance = this;
 
 	executablePath = argv[0];
 
+	for (int32_t i = 1; i < argc - 1; i++)
+	{
+		if (std::strcmp(argv[i], "--render-stats") == 0)
+			renderStatsPath = argv[i + 1];
+	}
+
 	Logger::Start();
+
+	JobSystem::Initialize();
     
     Window::Initialize();
 
@@ -74,10 +86,15 @@ Application::~Application()
 	DotnetRuntime::Shutdown();
 
 	PhysicsWorld::Destroy();
+
+	JobSystem::Destroy();
 	
     ResourceManager::UnloadAll();
 	
 	Audio::Shutdown();
+
+	if (!renderStatsPath.empty())
+		RenderStats::SaveJson(renderStatsPath);
 	
 	Rhi::Shutdown();
 
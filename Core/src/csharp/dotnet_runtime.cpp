@@ -8,6 +8,7 @@
 #include "Coral/GC.hpp"
 #include "csharp/dotnet_constants.hpp"
 #include "reflection/dotnet_reflection.hpp"
+#include "scene/component/script_component.hpp"
 #include "utils/message_box.hpp"
 #include "utils/windows.hpp"
 
@@ -118,6 +119,9 @@ DotnetAssembly* DotnetRuntime::GetGameAssembly() { return GetAssembly(Dotnet::Ga
 void DotnetRuntime::UnloadAllAssemblies(const bool_t reloadContext)
 {
     Logger::LogInfo("Unloading {} .NET assemblies", m_LoadedAssemblies.size());
+
+    // The cached managed types and wrappers belong to the assembly load context we are about to unload
+    ScriptComponent::ReleaseManagedCache();
     
     GcCollect();
     
@@ -0,0 +1,146 @@
+#include "physics/component/character_controller.hpp"
+
+#include <utility>
+
+#include "input/time.hpp"
+#include "physics/physics_world.hpp"
+#include "scene/entity.hpp"
+
+using namespace XnorCore;
+
+CharacterController::~CharacterController()
+{
+    DestroyCharacter();
+}
+
+CharacterController::CharacterController(const CharacterController& other)
+    : CharacterController()
+{
+    *this = other;
+}
+
+CharacterController::CharacterController(CharacterController&& other) noexcept
+    : CharacterController()
+{
+    *this = std::move(other);
+}
+
+CharacterController& CharacterController::operator=(const CharacterController& other)
+{
+    if (this == &other)
+        return *this;
+
+    Component::operator=(other);
+
+    center = other.center;
+    height = other.height;
+    radius = other.radius;
+    maxSlopeAngle = other.maxSlopeAngle;
+    stepHeight = other.stepHeight;
+    mass = other.mass;
+    maxStrength = other.maxStrength;
+    useGravity = other.useGravity;
+
+    m_DesiredVelocity = other.m_DesiredVelocity;
+    m_JumpSpeed = other.m_JumpSpeed;
+
+    // A character is destroyed by its controller, so two controllers can't share one
+    DestroyCharacter();
+
+    return *this;
+}
+
+CharacterController& CharacterController::operator=(CharacterController&& other) noexcept
+{
+    if (this == &other)
+        return *this;
+
+    *this = static_cast<const CharacterController&>(other);
+    m_Character = std::exchange(other.m_Character, nullptr);
+
+    return *this;
+}
+
+void CharacterController::Awake()
+{
+    DestroyCharacter();
+
+    const Transform& t = entity->transform;
+
+    const PhysicsWorld::CharacterCreationInfo info = {
+        .position = t.GetPosition() + center,
+        .rotation = t.GetRotation().Normalized(),
+        .height = height,
+        .radius = radius,
+        .maxSlopeAngle = maxSlopeAngle * Calc::Deg2Rad,
+        .stepHeight = stepHeight,
+        .mass = mass,
+        .maxStrength = maxStrength
+    };
+
+    m_Character = PhysicsWorld::CreateCharacterVirtual(info);
+}
+
+void CharacterController::PrePhysics()
+{
+    if (m_Character == nullptr)
+        return;
+
+    // Gameplay code can move the entity, so the transform is the source of truth before the update
+    m_Character->SetPosition(PhysicsWorld::ToJph(entity->transform.GetPosition() + center));
+    m_Character->SetRotation(PhysicsWorld::ToJph(entity->transform.GetRotation().Normalized()));
+
+    Vector3 velocity = m_DesiredVelocity;
+
+    if (useGravity)
+    {
+        // Keep falling while in the air, but don't accumulate speed while standing on the ground
+        velocity.y = IsGrounded() ? m_JumpSpeed : GetVelocity().y;
+        velocity += PhysicsWorld::GetGravity() * Time::GetDeltaTime<float_t>();
+    }
+
+    m_JumpSpeed = 0.f;
+
+    m_Character->SetLinearVelocity(PhysicsWorld::ToJph(velocity));
+}
+
+void CharacterController::PostPhysics()
+{
+    if (m_Character == nullptr)
+        return;
+
+    entity->transform.SetPosition(PhysicsWorld::FromJph(m_Character->GetPosition()) - center);
+}
+
+void CharacterController::SetVelocity(const Vector3& velocity)
+{
+    m_DesiredVelocity = velocity;
+}
+
+Vector3 CharacterController::GetVelocity() const
+{
+    if (m_Character == nullptr)
+        return Vector3::Zero();
+
+    return PhysicsWorld::FromJph(m_Character->GetLinearVelocity());
+}
+
+void CharacterController::Jump(const float_t speed)
+{
+    if (IsGrounded())
+        m_JumpSpeed = speed;
+}
+
+bool_t CharacterController::IsGrounded() const
+{
+    return m_Character != nullptr && m_Character->GetGroundState() == JPH::CharacterBase::EGroundState::OnGround;
+}
+
+void CharacterController::DestroyCharacter()
+{
+    if (m_Character == nullptr)
+        return;
+
+    PhysicsWorld::DestroyCharacterVirtual(m_Character);
+    m_Character = nullptr;
+}
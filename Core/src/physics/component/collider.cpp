@@ -3,6 +3,7 @@
 #include "input/input.hpp"
 #include "physics/physics_world.hpp"
 #include "scene/entity.hpp"
+#include "scene/component/script_component.hpp"
 #include "serialization/serializer.hpp"
 
 using namespace XnorCore;
@@ -12,6 +13,8 @@ Collider::~Collider()
 {
     if (!JPH::BodyID(m_BodyId).IsInvalid())
         PhysicsWorld::DestroyBody(m_BodyId);
+
+    ScriptComponent::ReleaseColliderWrapper(this);
 }
 
 
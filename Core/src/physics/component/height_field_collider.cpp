@@ -0,0 +1,126 @@
+#include "physics/component/height_field_collider.hpp"
+
+#include <algorithm>
+#include <format>
+#include <limits>
+#include <vector>
+
+#include "physics/physics_world.hpp"
+#include "scene/entity.hpp"
+#include "utils/logger.hpp"
+
+using namespace XnorCore;
+
+void HeightFieldCollider::Awake()
+{
+    if (!heightMap)
+    {
+        Logger::LogError("A height field collider component must have a height map");
+        return;
+    }
+
+    const uint32_t sampleCount = GetSampleCount();
+    if (sampleCount == 0)
+    {
+        Logger::LogError("Height map {} is too small for a block size of {}", heightMap->GetName(), blockSize);
+        return;
+    }
+
+    const Vector2i textureSize = heightMap->GetSize();
+    const int32_t channels = heightMap->GetChannels();
+    const bool_t isFloat = heightMap->GetDataType() == DataType::Float;
+
+    std::vector<float_t> samples(static_cast<size_t>(sampleCount) * sampleCount);
+
+    for (uint32_t y = 0; y < sampleCount; y++)
+    {
+        for (uint32_t x = 0; x < sampleCount; x++)
+        {
+            const size_t texel = (static_cast<size_t>(y) * textureSize.x + x) * channels;
+
+            if (isFloat)
+                samples[y * sampleCount + x] = heightMap->GetData<float_t>()[texel];
+            else
+                samples[y * sampleCount + x] = static_cast<float_t>(heightMap->GetData<uint8_t>()[texel]) / static_cast<float_t>(std::numeric_limits<uint8_t>::max());
+        }
+    }
+
+    std::vector<uint8_t> materialIndices;
+
+    if (materialMap)
+    {
+        const Vector2i materialSize = materialMap->GetSize();
+        const int32_t materialChannels = materialMap->GetChannels();
+        const uint32_t cellCount = sampleCount - 1;
+
+        if (materialSize.x < static_cast<int32_t>(cellCount) || materialSize.y < static_cast<int32_t>(cellCount))
+        {
+            Logger::LogWarning("Material map {} is smaller than the height field, materials are ignored", materialMap->GetName());
+        }
+        else
+        {
+            materialIndices.resize(static_cast<size_t>(cellCount) * cellCount);
+
+            for (uint32_t y = 0; y < cellCount; y++)
+            {
+                for (uint32_t x = 0; x < cellCount; x++)
+                {
+                    const size_t texel = (static_cast<size_t>(y) * materialSize.x + x) * materialChannels;
+                    materialIndices[y * cellCount + x] = std::min(materialMap->GetData<uint8_t>()[texel], static_cast<uint8_t>(materialCount - 1));
+                }
+            }
+        }
+    }
+
+    const Transform& t = entity->transform;
+
+    const PhysicsWorld::BodyCreationInfo info = {
+        .collider = this,
+        .position = t.GetPosition() + center,
+        .rotation = t.GetRotation(),
+        .scaling = t.GetScale(),
+        .isTrigger = m_IsTrigger,
+        .isStatic = true
+    };
+
+    // Every collider using the same height map with the same settings shares a single cooked shape
+    const PhysicsWorld::HeightFieldCreationInfo heightField = {
+        .samples = samples.data(),
+        .sampleCount = sampleCount,
+        .sampleSpacing = sampleSpacing,
+        .heightScale = heightScale,
+        .blockSize = blockSize,
+        .bitsPerSample = bitsPerSample,
+        .materialIndices = materialIndices.empty() ? nullptr : materialIndices.data(),
+        .materialCount = materialIndices.empty() ? 0 : materialCount,
+        .cacheKey = std::format(
+            "{};{};{};{};{};{};{};{}",
+            heightMap->GetName(),
+            sampleCount,
+            sampleSpacing,
+            heightScale,
+            blockSize,
+            bitsPerSample,
+            materialIndices.empty() ? "" : materialMap->GetName(),
+            materialCount
+        )
+    };
+
+    m_BodyId = PhysicsWorld::CreateHeightField(info, heightField);
+}
+
+uint32_t HeightFieldCollider::GetSampleCount() const
+{
+    if (!heightMap || blockSize == 0)
+        return 0;
+
+    const Vector2i size = heightMap->GetSize();
+    const uint32_t side = static_cast<uint32_t>(std::max(std::min(size.x, size.y), 0));
+
+    // Jolt requires the sample count to be a multiple of the block size, with at least 2 blocks on each side
+    const uint32_t sampleCount = side - side % blockSize;
+    if (sampleCount / blockSize < 2)
+        return 0;
+
+    return sampleCount;
+}
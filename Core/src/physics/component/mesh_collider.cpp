@@ -4,13 +4,14 @@
 
 #include "physics/physics_world.hpp"
 #include "scene/entity.hpp"
-#include "..\..\..\include\scene\component\static_mesh_renderer.hpp"
+#include "scene/component/static_mesh_renderer.hpp"
 
 using namespace XnorCore;
 
 
-void MeshCollider::Begin()
+void MeshCollider::Awake()
 {
+    // Created in Awake like the other colliders, so the body is added with the rest of the scene in the batch around Scene::Awake
     StaticMeshRenderer* renderer;
     if (!entity->TryGetComponent<StaticMeshRenderer>(&renderer))
     {
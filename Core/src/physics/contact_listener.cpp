@@ -3,52 +3,93 @@
 #include "Jolt/Physics/Body/Body.h"
 #include "physics/physics_world.hpp"
 #include "physics/data/collision_data.hpp"
+#include "utils/job_system.hpp"
 #include "utils/logger.hpp"
 
 using namespace XnorCore;
 
+void ContactListenerImpl::Initialize(const size_t threadCount)
+{
+    m_Buffers.clear();
+    m_Buffers.resize(threadCount);
+}
+
 void ContactListenerImpl::ProcessEvents()
 {
+    // This is called after the physics step, so no job thread can write to the buffers anymore
+    // The thread buffers are merged per event type to keep all the enter events before the stay and exit ones
     for (size_t i = 0; i < EventCount; i++)
     {
-        for (size_t j = 0; j < m_Events[i].size(); j++)
-        {
-            const EventInfo& info = m_Events[i][j];
+        const CollisionEvent event = static_cast<CollisionEvent>(i);
+
+        for (EventBuffer& buffer : m_Buffers)
+            DispatchEvents(&buffer, event);
+
+        for (auto&& entry : m_OverflowBuffers)
+            DispatchEvents(&entry.second, event);
+    }
+}
 
-            switch (i)
-            {
-                case TriggerEnter:
-                    info.self->onTriggerEnter.Invoke(info.self, info.other, info.data);
-                    break;
+void ContactListenerImpl::DispatchEvents(EventBuffer* const buffer, const CollisionEvent event)
+{
+    std::vector<EventInfo>& events = buffer->events[event];
+
+    for (size_t i = 0; i < events.size(); i++)
+    {
+        const EventInfo& info = events[i];
+
+        switch (event)
+        {
+            case TriggerEnter:
+                info.self->onTriggerEnter.Invoke(info.self, info.other, info.data);
+                break;
 
-                case TriggerStay:
-                    info.self->onTriggerStay.Invoke(info.self, info.other, info.data);
-                    break;
+            case TriggerStay:
+                info.self->onTriggerStay.Invoke(info.self, info.other, info.data);
+                break;
 
-                case TriggerExit:
-                    info.self->onTriggerExit.Invoke(info.self, info.other);
-                    break;
+            case TriggerExit:
+                info.self->onTriggerExit.Invoke(info.self, info.other);
+                break;
 
-                case CollisionEnter:
-                    info.self->onCollisionEnter.Invoke(info.self, info.other, info.data);
-                    break;
+            case CollisionEnter:
+                info.self->onCollisionEnter.Invoke(info.self, info.other, info.data);
+                break;
 
-                case CollisionStay:
-                    info.self->onCollisionStay.Invoke(info.self, info.other, info.data);
-                    break;
+            case CollisionStay:
+                info.self->onCollisionStay.Invoke(info.self, info.other, info.data);
+                break;
 
-                case CollisionExit:
-                    info.self->onCollisionExit.Invoke(info.self, info.other);
-                    break;
+            case CollisionExit:
+                info.self->onCollisionExit.Invoke(info.self, info.other);
+                break;
 
-                default:
-                    break;
-            }
+            default:
+                break;
         }
     }
 
-    for (size_t i = 0; i < EventCount; i++)
-        m_Events[i].clear();
+    // Clearing keeps the capacity, so the buffers stop allocating once they reached their steady state size
+    events.clear();
+}
+
+void ContactListenerImpl::Clear()
+{
+    m_Buffers.clear();
+
+    std::scoped_lock lock(m_OverflowBuffersMutex);
+    m_OverflowBuffers.clear();
+}
+
+ContactListenerImpl::EventBuffer& ContactListenerImpl::GetThreadBuffer()
+{
+    // The physics jobs run on the job system, so the threads recording events are its workers and the thread stepping the physics
+    const size_t thread = JobSystem::GetThreadIndex();
+    if (thread < m_Buffers.size())
+        return m_Buffers[thread];
+
+    std::scoped_lock lock(m_OverflowBuffersMutex);
+    return m_OverflowBuffers[thread];
 }
 
 JPH::ValidateResult ContactListenerImpl::OnContactValidate(
@@ -75,30 +116,33 @@ void ContactListenerImpl::OnContactAdded(
     Collider* const c1 = PhysicsWorld::GetColliderFromId(bodyId1);
     Collider* const c2 = PhysicsWorld::GetColliderFromId(bodyId2);
 
+    // Bodies created without a collider, e.g. from headless tests, don't have any event to call
+    if (c1 == nullptr || c2 == nullptr)
+        return;
+
     const CollisionData data = {
         .penetrationDepth = inManifold.mPenetrationDepth,
         .normal = Vector3(inManifold.mWorldSpaceNormal.GetX(), inManifold.mWorldSpaceNormal.GetY(), inManifold.mWorldSpaceNormal.GetZ())
     };
 
+    EventBuffer& buffer = GetThreadBuffer();
+
     if (inBody1.IsSensor() && !inBody2.IsSensor())
     {
-        std::scoped_lock lock(m_EventsMutex);
         // Body 1 is the trigger, so body 2 entered in it
-        m_Events[TriggerEnter].emplace_back(c1, c2, data);
+        buffer.events[TriggerEnter].emplace_back(c1, c2, data);
     }
     else if (!inBody1.IsSensor() && inBody2.IsSensor())
     {
-        std::scoped_lock lock(m_EventsMutex);
         // Body 2 is the trigger, so body 1 entered in it
-        m_Events[TriggerEnter].emplace_back(c2, c1, data);
+        buffer.events[TriggerEnter].emplace_back(c2, c1, data);
     }
     else if (!inBody1.IsSensor() && !inBody2.IsSensor())
     {
-        std::scoped_lock lock(m_EventsMutex);
         // Both body aren't triggers, so it's a normal collision
         // We call the events of both of them unlike the triggers
-        m_Events[CollisionEnter].emplace_back(c1, c2, data);
-        m_Events[CollisionEnter].emplace_back(c2, c1, data);
+        buffer.events[CollisionEnter].emplace_back(c1, c2, data);
+        buffer.events[CollisionEnter].emplace_back(c2, c1, data);
     }
     else
     {
@@ -118,30 +162,33 @@ void ContactListenerImpl::OnContactPersisted(
     Collider* const c1 = PhysicsWorld::GetColliderFromId(bodyId1);
     Collider* const c2 = PhysicsWorld::GetColliderFromId(bodyId2);
 
+    // Bodies created without a collider, e.g. from headless tests, don't have any event to call
+    if (c1 == nullptr || c2 == nullptr)
+        return;
+
     const CollisionData data = {
         .penetrationDepth = inManifold.mPenetrationDepth,
         .normal = Vector3(inManifold.mWorldSpaceNormal.GetX(), inManifold.mWorldSpaceNormal.GetY(), inManifold.mWorldSpaceNormal.GetZ())
     };
+
+    EventBuffer& buffer = GetThreadBuffer();
     
     if (inBody1.IsSensor() && !inBody2.IsSensor())
     {
-        std::scoped_lock lock(m_EventsMutex);
         // Body 1 is the trigger, so body 2 entered in it
-        m_Events[TriggerStay].emplace_back(c1, c2, data);
+        buffer.events[TriggerStay].emplace_back(c1, c2, data);
     }
     else if (!inBody1.IsSensor() && inBody2.IsSensor())
     {
-        std::scoped_lock lock(m_EventsMutex);
         // Body 2 is the trigger, so body 1 entered in it
-        m_Events[TriggerStay].emplace_back(c2, c1, data);
+        buffer.events[TriggerStay].emplace_back(c2, c1, data);
     }
     else if (!inBody1.IsSensor() && !inBody2.IsSensor())
     {
-        std::scoped_lock lock(m_EventsMutex);
         // Both body aren't triggers, so it's a normal collision
         // We call the events of both of them unlike the triggers
-        m_Events[CollisionStay].emplace_back(c1, c2, data);
-        m_Events[CollisionStay].emplace_back(c2, c1, data);
+        buffer.events[CollisionStay].emplace_back(c1, c2, data);
+        buffer.events[CollisionStay].emplace_back(c2, c1, data);
     }
     else
     {
@@ -161,25 +208,24 @@ void ContactListenerImpl::OnContactRemoved(const JPH::SubShapeIDPair& inSubShape
     
     if (c1 == nullptr || c2 == nullptr)
         return;
+
+    EventBuffer& buffer = GetThreadBuffer();
     
     if (c1->IsTrigger() && !c2->IsTrigger())
     {
-        std::scoped_lock lock(m_EventsMutex);
         // Body 1 is the trigger, so body 2 entered in it
-        m_Events[TriggerExit].emplace_back(c1, c2, data);
+        buffer.events[TriggerExit].emplace_back(c1, c2, data);
     }
     else if (!c1->IsTrigger() && c2->IsTrigger())
     {
-        std::scoped_lock lock(m_EventsMutex);
         // Body 2 is the trigger, so body 1 entered in it
-        m_Events[TriggerExit].emplace_back(c2, c1, data);
+        buffer.events[TriggerExit].emplace_back(c2, c1, data);
     }
     else if (!c1->IsTrigger() && !c2->IsTrigger())
     {
-        std::scoped_lock lock(m_EventsMutex);
         // Both body aren't triggers, so it's a normal collision
         // We call the events of both of them unlike the triggers
-        m_Events[CollisionExit].emplace_back(c1, c2, data);
-        m_Events[CollisionExit].emplace_back(c2, c1, data);
+        buffer.events[CollisionExit].emplace_back(c1, c2, data);
+        buffer.events[CollisionExit].emplace_back(c2, c1, data);
     }
 }
@@ -1,6 +1,9 @@
 #include "physics/physics_world.hpp"
 
+#include <algorithm>
+#include <chrono>
 #include <cstdarg>
+#include <format>
 
 #include <Jolt/Jolt.h>
 #include <Jolt/RegisterTypes.h>
@@ -8,16 +11,20 @@
 #include <Jolt/Core/TempAllocator.h>
 #include <Jolt/Physics/Body/BodyCreationSettings.h>
 #include <Jolt/Physics/Collision/CastResult.h>
+#include <Jolt/Physics/Collision/PhysicsMaterialSimple.h>
 #include <Jolt/Physics/Collision/RayCast.h>
 #include <Jolt/Physics/Collision/Shape/BoxShape.h>
 #include <Jolt/Physics/Collision/Shape/CapsuleShape.h>
 #include <Jolt/Physics/Collision/Shape/ConvexHullShape.h>
+#include <Jolt/Physics/Collision/Shape/HeightFieldShape.h>
 #include <Jolt/Physics/Collision/Shape/SphereShape.h>
 #include <Jolt/Physics/Collision/Shape/CompoundShape.h>
+#include <Jolt/Physics/StateRecorderImpl.h>
 
 #include "input/time.hpp"
 #include "jolt/Physics/Character/Character.h"
 #include "Maths/matrix.hpp"
+#include "utils/job_system.hpp"
 #include "utils/logger.hpp"
 
 using namespace XnorCore;
@@ -73,14 +80,19 @@ void PhysicsWorld::Initialize()
     // malloc / free.
     m_Allocator = new JPH::TempAllocatorImpl(10 * 1024 * 1024);
     
-    // We need a job system that will execute physics jobs on multiple threads. Typically
-    // you would implement the JobSystem interface yourself and let Jolt Physics run on top
-    // of your own job scheduler. JobSystemThreadPool is an example implementation.
-    m_JobSystem = new JPH::JobSystemThreadPool(JPH::cMaxPhysicsJobs, JPH::cMaxPhysicsBarriers, static_cast<int32_t>(std::thread::hardware_concurrency()) - 1);
+    // The physics jobs run on the engine thread pool, so they don't compete with the animation and rendering jobs for the cores.
+    // Starting it here is a no-op if the application already did
+    JobSystem::Initialize();
+    m_JobSystem = JobSystem::GetThreadPool();
+
+    // Characters are updated by several jobs at once, and temp allocators can't be shared between threads
+    m_CharacterAllocators.resize(m_JobSystem->GetMaxConcurrency());
+    for (JPH::TempAllocatorImpl*& allocator : m_CharacterAllocators)
+        allocator = new JPH::TempAllocatorImpl(CharacterAllocatorSize);
 
     // This is the max amount of rigid bodies that you can add to the physics system. If you try to add more you'll get an error.
-    // Note: This value is low because this is a simple test. For a real project use something in the order of 65536.
-    constexpr JPH::uint maxBodies = 1024;
+    // Levels can contain thousands of static colliders so we use the value recommended for a real project.
+    constexpr JPH::uint maxBodies = 65536;
 
     // This determines how many mutexes to allocate to protect rigid bodies from concurrent access. Set it to 0 for the default settings.
     constexpr JPH::uint numBodyMutexes = 0;
@@ -88,13 +100,11 @@ void PhysicsWorld::Initialize()
     // This is the max amount of body pairs that can be queued at any time (the broad phase will detect overlapping
     // body pairs based on their bounding boxes and will insert them into a queue for the narrowphase). If you make this buffer
     // too small the queue will fill up and the broad phase jobs will start to do narrow phase work. This is slightly less efficient.
-    // Note: This value is low because this is a simple test. For a real project use something in the order of 65536.
-    constexpr JPH::uint maxBodyPairs = 1024;
+    constexpr JPH::uint maxBodyPairs = 65536;
 
     // This is the maximum size of the contact constraint buffer. If more contacts (collisions between bodies) are detected than this
     // number then these contacts will be ignored and bodies will start interpenetrating / fall through the world.
-    // Note: This value is low because this is a simple test. For a real project use something in the order of 10240.
-    constexpr JPH::uint maxContactConstraints = 1024;
+    constexpr JPH::uint maxContactConstraints = 10240;
 
     // Now we can create the actual physics system.
     m_PhysicsSystem = new JPH::PhysicsSystem();
@@ -108,6 +118,7 @@ void PhysicsWorld::Initialize()
     // A contact listener gets notified when bodies (are about to) collide, and when they separate again.
     // Note that this is called from a job so whatever you do here needs to be thread safe.
     // Registering one is entirely optional.
+    m_ContactListener.Initialize(static_cast<size_t>(m_JobSystem->GetMaxConcurrency()));
     m_PhysicsSystem->SetContactListener(&m_ContactListener);
 
     // The main way to interact with the bodies in the physics system is through the body interface. There is a locking and a non-locking
@@ -119,9 +130,25 @@ void PhysicsWorld::Initialize()
 
 void PhysicsWorld::Destroy()
 {
+    ClearShapeCache();
+    m_HeightFieldMaterials.clear();
+
+    for (const CharacterEntry& entry : m_Characters)
+        delete entry.character;
+    m_Characters.clear();
+
+    for (const JPH::TempAllocatorImpl* const allocator : m_CharacterAllocators)
+        delete allocator;
+    m_CharacterAllocators.clear();
+
     delete m_Allocator;
-    delete m_JobSystem;
     delete m_PhysicsSystem;
+
+    // The thread pool belongs to the JobSystem and outlives the physics world
+    m_JobSystem = nullptr;
+
+    // The event buffers only hold events of the destroyed physics system
+    m_ContactListener.Clear();
     
     // Unregisters all types with the factory and cleans up the default material
     JPH::UnregisterTypes();
@@ -134,6 +161,7 @@ void PhysicsWorld::Destroy()
 void PhysicsWorld::Update(const float_t deltaTime)
 {
     m_PhysicsSystem->Update(deltaTime, 1, m_Allocator, m_JobSystem);
+    UpdateCharacters(deltaTime);
     m_ContactListener.ProcessEvents();
 }
 
@@ -142,6 +170,83 @@ void PhysicsWorld::SetGravity(const Vector3& gravity)
     m_PhysicsSystem->SetGravity(JPH::Vec3Arg(gravity.x, gravity.y, gravity.z));
 }
 
+Vector3 PhysicsWorld::GetGravity()
+{
+    return FromJph(m_PhysicsSystem->GetGravity());
+}
+
+void PhysicsWorld::SaveState(std::string* const state)
+{
+    JPH::StateRecorderImpl recorder;
+    m_PhysicsSystem->SaveState(recorder);
+
+    *state = recorder.GetData();
+}
+
+bool_t PhysicsWorld::RestoreState(const std::string& state)
+{
+    JPH::StateRecorderImpl recorder;
+    recorder.WriteBytes(state.data(), state.size());
+    recorder.Rewind();
+
+    if (!m_PhysicsSystem->RestoreState(recorder))
+    {
+        Logger::LogError("[Physics] - Couldn't restore the physics state, the bodies don't match the saved ones");
+        return false;
+    }
+
+    return true;
+}
+
+void PhysicsWorld::TakeSnapshot()
+{
+    SaveState(&m_Snapshot);
+}
+
+bool_t PhysicsWorld::RestoreSnapshot()
+{
+    if (m_Snapshot.empty())
+    {
+        Logger::LogWarning("[Physics] - Trying to restore a snapshot but none was taken");
+        return false;
+    }
+
+    return RestoreState(m_Snapshot);
+}
+
+void PhysicsWorld::ClearSnapshot()
+{
+    m_Snapshot.clear();
+}
+
+void PhysicsWorld::BeginBodyBatch()
+{
+    m_IsBatching = true;
+    m_PendingBodies.clear();
+}
+
+void PhysicsWorld::EndBodyBatch()
+{
+    m_IsBatching = false;
+
+    if (m_PendingBodies.empty())
+        return;
+
+    const int32_t count = static_cast<int32_t>(m_PendingBodies.size());
+
+    // Inserting all the bodies at once lets Jolt build a single tree per broad phase layer instead of
+    // inserting them one by one, which is a lot faster for big scenes
+    const JPH::BodyInterface::AddState state = m_BodyInterface->AddBodiesPrepare(m_PendingBodies.data(), count);
+    m_BodyInterface->AddBodiesFinalize(m_PendingBodies.data(), count, state, JPH::EActivation::Activate);
+
+    m_PendingBodies.clear();
+
+    // The broad phase trees are unbalanced after a big insertion, so the first queries would be slow without this
+    m_PhysicsSystem->OptimizeBroadPhase();
+
+    Logger::LogDebug("[Physics] - Added {} bodies in batch", count);
+}
+
 uint32_t PhysicsWorld::CreateSphere(const BodyCreationInfo& info, const float_t radius)
 {
     JPH::BodyCreationSettings settings(new JPH::SphereShape(radius), ToJph(info.position), JPH::Quat::sIdentity(), JPH::EMotionType::Dynamic, Layers::MOVING);
@@ -167,6 +272,104 @@ JPH::Character* PhysicsWorld::CreateCharacter(const BodyCreationInfo& info, cons
     return c;
 }
 
+JPH::CharacterVirtual* PhysicsWorld::CreateCharacterVirtual(const CharacterCreationInfo& info)
+{
+    JPH::CharacterVirtualSettings settings;
+    settings.mShape = new JPH::CapsuleShape(info.height * 0.5f, info.radius);
+    settings.mMaxSlopeAngle = info.maxSlopeAngle;
+    settings.mMass = info.mass;
+    settings.mMaxStrength = info.maxStrength;
+    // Only contacts below the center of the bottom sphere of the capsule can support the character
+    settings.mSupportingVolume = JPH::Plane(JPH::Vec3::sAxisY(), info.height * 0.5f);
+
+    JPH::CharacterVirtual* const character = new JPH::CharacterVirtual(&settings, ToJph(info.position), ToJph(info.rotation), m_PhysicsSystem);
+
+    CharacterEntry entry = {
+        .character = character
+    };
+    entry.updateSettings.mWalkStairsStepUp = JPH::Vec3(0.f, info.stepHeight, 0.f);
+    entry.updateSettings.mStickToFloorStepDown = JPH::Vec3(0.f, -info.stepHeight, 0.f);
+
+    m_Characters.push_back(entry);
+
+    return character;
+}
+
+void PhysicsWorld::DestroyCharacterVirtual(JPH::CharacterVirtual* const character)
+{
+    const decltype(m_Characters)::iterator it = std::ranges::find(m_Characters, character, &CharacterEntry::character);
+
+    if (it == m_Characters.end())
+    {
+        Logger::LogWarning("[Physics] - Trying to destroy a character that doesn't exist");
+        return;
+    }
+
+    // The order doesn't matter, so swap with the last one to keep the storage contiguous
+    *it = m_Characters.back();
+    m_Characters.pop_back();
+
+    delete character;
+}
+
+void PhysicsWorld::UpdateCharacters(const float_t deltaTime)
+{
+    auto&& start = std::chrono::system_clock::now();
+
+    const size_t count = m_Characters.size();
+
+    if (count == 0)
+    {
+        m_CharacterUpdateTime = 0.f;
+        return;
+    }
+
+    const size_t jobCount = std::clamp<size_t>(count / MinCharactersPerJob, 1, m_CharacterAllocators.size());
+    const size_t charactersPerJob = (count + jobCount - 1) / jobCount;
+
+    const JPH::Vec3 gravity = m_PhysicsSystem->GetGravity();
+    const JPH::DefaultBroadPhaseLayerFilter broadPhaseLayerFilter = m_PhysicsSystem->GetDefaultBroadPhaseLayerFilter(Layers::MOVING);
+    const JPH::DefaultObjectLayerFilter objectLayerFilter = m_PhysicsSystem->GetDefaultLayerFilter(Layers::MOVING);
+    const JPH::BodyFilter bodyFilter;
+    const JPH::ShapeFilter shapeFilter;
+
+    JPH::JobSystem::Barrier* const barrier = m_JobSystem->CreateBarrier();
+
+    for (size_t i = 0; i < jobCount; i++)
+    {
+        const size_t first = i * charactersPerJob;
+        const size_t last = std::min(first + charactersPerJob, count);
+        JPH::TempAllocatorImpl* const allocator = m_CharacterAllocators[i];
+
+        // Characters only read the other bodies and lock the ones they push, so they can safely move concurrently
+        const JPH::JobHandle job = m_JobSystem->CreateJob("UpdateCharacters", JPH::Color::sCyan, [&, first, last, allocator]
+        {
+            for (size_t j = first; j < last; j++)
+            {
+                const CharacterEntry& entry = m_Characters[j];
+                entry.character->ExtendedUpdate(deltaTime, gravity, entry.updateSettings, broadPhaseLayerFilter, objectLayerFilter, bodyFilter, shapeFilter, *allocator);
+            }
+        });
+
+        barrier->AddJob(job);
+    }
+
+    m_JobSystem->WaitForJobs(barrier);
+    m_JobSystem->DestroyBarrier(barrier);
+
+    m_CharacterUpdateTime = std::chrono::duration<float_t, std::milli>(std::chrono::system_clock::now() - start).count();
+}
+
+size_t PhysicsWorld::GetCharacterCount()
+{
+    return m_Characters.size();
+}
+
+float_t PhysicsWorld::GetCharacterUpdateTime()
+{
+    return m_CharacterUpdateTime;
+}
+
 uint32_t PhysicsWorld::CreateCapsule(const BodyCreationInfo& info, const float_t height, const float_t radius)
 {
     const JPH::CapsuleShapeSettings capsuleSettings(height, radius);
@@ -203,9 +406,79 @@ uint32_t PhysicsWorld::CreateConvexHull(const BodyCreationInfo& info, const std:
     return CreateBody(info, settings);
 }
 
+uint32_t PhysicsWorld::CreateHeightField(const BodyCreationInfo& info, const HeightFieldCreationInfo& heightField)
+{
+    JPH::ShapeRefC shape;
+
+    // The scaling is baked in the shape, so bodies with a different scaling can't share it
+    const Vector3& scaling = info.scaling;
+    const std::string cacheKey = heightField.cacheKey.empty() ? std::string() : std::format("{};{};{};{}", heightField.cacheKey, scaling.x, scaling.y, scaling.z);
+
+    const decltype(m_ShapeCache)::const_iterator cached = cacheKey.empty() ? m_ShapeCache.cend() : m_ShapeCache.find(cacheKey);
+
+    if (cached != m_ShapeCache.cend())
+    {
+        shape = cached->second;
+    }
+    else
+    {
+        // Center the height field on the body position
+        const float_t halfExtent = static_cast<float_t>(heightField.sampleCount - 1) * heightField.sampleSpacing * 0.5f;
+
+        JPH::PhysicsMaterialList materials;
+        if (heightField.materialIndices != nullptr)
+        {
+            for (uint32_t i = static_cast<uint32_t>(m_HeightFieldMaterials.size()); i < heightField.materialCount; i++)
+                m_HeightFieldMaterials.push_back(new JPH::PhysicsMaterialSimple(std::format("HeightFieldMaterial{}", i), JPH::Color::sGrey));
+
+            materials.assign(m_HeightFieldMaterials.begin(), m_HeightFieldMaterials.begin() + heightField.materialCount);
+        }
+
+        JPH::HeightFieldShapeSettings heightFieldSettings(
+            heightField.samples,
+            JPH::Vec3(-halfExtent * scaling.x, 0.f, -halfExtent * scaling.z),
+            JPH::Vec3(heightField.sampleSpacing * scaling.x, heightField.heightScale * scaling.y, heightField.sampleSpacing * scaling.z),
+            heightField.sampleCount,
+            heightField.materialIndices,
+            materials
+        );
+        heightFieldSettings.mBlockSize = heightField.blockSize;
+        heightFieldSettings.mBitsPerSample = heightField.bitsPerSample;
+
+        const JPH::ShapeSettings::ShapeResult result = heightFieldSettings.Create();
+        if (!result.IsValid())
+        {
+            Logger::LogError("[Physics] - Couldn't create the height field shape : {}", result.GetError().c_str());
+            return JPH::BodyID::cInvalidBodyID;
+        }
+
+        shape = result.Get();
+
+        if (!cacheKey.empty())
+            m_ShapeCache.emplace(cacheKey, shape);
+    }
+
+    // Height fields can't be dynamic
+    JPH::BodyCreationSettings settings(shape, ToJph(info.position), ToJph(info.rotation), JPH::EMotionType::Static, Layers::NON_MOVING);
+
+    return CreateBody(info, settings);
+}
+
+void PhysicsWorld::ClearShapeCache()
+{
+    m_ShapeCache.clear();
+}
+
 void PhysicsWorld::DestroyBody(const uint32_t bodyId)
 {
-    m_BodyInterface->RemoveBody(JPH::BodyID(bodyId));
+    const decltype(m_PendingBodies)::const_iterator pending = std::ranges::find(m_PendingBodies, JPH::BodyID(bodyId));
+
+    // A body that is still pending was never added to the world
+    if (pending != m_PendingBodies.cend())
+        m_PendingBodies.erase(pending);
+    else
+        m_BodyInterface->RemoveBody(JPH::BodyID(bodyId));
+
     m_BodyInterface->DestroyBody(JPH::BodyID(bodyId));
     m_BodyMap.erase(m_BodyMap.find(bodyId));
 }
@@ -353,6 +626,10 @@ bool_t PhysicsWorld::Raycast(const Vector3& position, const Vector3& direction,
     result->point = FromJph(ray.GetPointOnRay(jphResult.mFraction));
     result->normal = FromJph(body.GetWorldSpaceSurfaceNormal(jphResult.mSubShapeID2, ray.GetPointOnRay(jphResult.mFraction)));
     result->distance = length * jphResult.mFraction;
+
+    const JPH::PhysicsMaterial* const material = body.GetShape()->GetMaterial(jphResult.mSubShapeID2);
+    const JPH::PhysicsMaterialList::const_iterator materialIt = std::find(m_HeightFieldMaterials.cbegin(), m_HeightFieldMaterials.cend(), material);
+    result->materialIndex = materialIt == m_HeightFieldMaterials.cend() ? 0 : static_cast<uint32_t>(materialIt - m_HeightFieldMaterials.cbegin());
     
     return hit;
 }
@@ -444,7 +721,25 @@ uint32_t PhysicsWorld::CreateBody(const BodyCreationInfo& info, JPH::BodyCreatio
 
     settings.mAllowSleeping = false;
 
-    const uint32_t bodyId = m_BodyInterface->CreateAndAddBody(settings, JPH::EActivation::Activate).GetIndexAndSequenceNumber();
+    uint32_t bodyId;
+
+    if (m_IsBatching)
+    {
+        const JPH::Body* const body = m_BodyInterface->CreateBody(settings);
+
+        if (body == nullptr)
+        {
+            Logger::LogError("[Physics] - Couldn't create body, the maximum number of bodies has been reached");
+            return JPH::BodyID::cInvalidBodyID;
+        }
+
+        m_PendingBodies.push_back(body->GetID());
+        bodyId = body->GetID().GetIndexAndSequenceNumber();
+    }
+    else
+    {
+        bodyId = m_BodyInterface->CreateAndAddBody(settings, JPH::EActivation::Activate).GetIndexAndSequenceNumber();
+    }
 
     m_BodyMap.emplace(bodyId, info.collider);
     
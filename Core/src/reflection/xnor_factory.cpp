@@ -4,7 +4,9 @@
 #include "audio/component/audio_source.hpp"
 #include "physics/component/box_collider.hpp"
 #include "physics/component/capsule_collider.hpp"
+#include "physics/component/character_controller.hpp"
 #include "physics/component/collider.hpp"
+#include "physics/component/height_field_collider.hpp"
 #include "physics/component/sphere_collider.hpp"
 #include "rendering/light/directional_light.hpp"
 #include "rendering/light/point_light.hpp"
@@ -119,6 +121,8 @@ void XnorFactory::RegisterAllTypes()
     RegisterType<BoxCollider>();
     RegisterType<SphereCollider>();
     RegisterType<CapsuleCollider>();
+    RegisterType<HeightFieldCollider>();
+    RegisterType<CharacterController>();
     RegisterType<CameraComponent>();
 
     RegisterType<AudioListener>();
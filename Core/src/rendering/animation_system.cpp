@@ -0,0 +1,89 @@
+#include "rendering/animation_system.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+
+#include "rendering/frustum.hpp"
+#include "rendering/renderer.hpp"
+#include "scene/entity.hpp"
+#include "scene/scene.hpp"
+#include "scene/component/skinned_mesh_renderer.hpp"
+#include "utils/job_system.hpp"
+
+using namespace XnorCore;
+
+void AnimationSystem::Update(Scene& scene, const std::vector<RenderedView>& views, const float_t deltaTime)
+{
+    auto&& start = std::chrono::system_clock::now();
+
+    scene.GetAllComponentsOfType<SkinnedMeshRenderer>(&m_Renderers);
+    m_DueRenderers.clear();
+
+    m_Frusta.resize(views.size());
+    for (size_t i = 0; i < views.size(); i++)
+        m_Frusta[i].UpdateFromCamera(views[i].camera, views[i].aspect);
+
+    // Deciding which animations are due is cheap and touches the scene, so it is done before dispatching the jobs
+    for (SkinnedMeshRenderer* const renderer : m_Renderers)
+    {
+        uint32_t updateInterval = 1;
+
+        if (enableLod && !views.empty() && renderer->animationLod && renderer->mesh)
+        {
+            // The bound of the last evaluated pose, so a character whose animation moves it into the view is still caught
+            Bound bound;
+            renderer->GetAabb(&bound);
+
+            // The closest view the mesh is in decides, or the closest view at all when it is in none of them
+            updateInterval = std::numeric_limits<uint32_t>::max();
+            for (size_t i = 0; i < views.size(); i++)
+            {
+                const float_t distance = (bound.center - views[i].camera.position).Length();
+                updateInterval = std::min(updateInterval, ComputeUpdateInterval(distance, m_Frusta[i].IsOnFrustum(bound), lodSettings));
+            }
+        }
+
+        if (renderer->ScheduleAnimation(deltaTime, updateInterval))
+            m_DueRenderers.push_back(renderer);
+    }
+
+    JobSystem::ParallelFor(m_DueRenderers.size(), MinAnimationsPerJob, [](const size_t first, const size_t last)
+    {
+        for (size_t i = first; i < last; i++)
+            m_DueRenderers[i]->Animate();
+    });
+
+    m_UpdateTime = std::chrono::duration<float_t, std::milli>(std::chrono::system_clock::now() - start).count();
+}
+
+uint32_t AnimationSystem::ComputeUpdateInterval(const float_t distance, const bool_t isVisible, const AnimationLodSettings& settings)
+{
+    if (!isVisible)
+        return std::max(settings.offscreenUpdateInterval, 1u);
+
+    if (distance <= settings.fullRateDistance || settings.maxUpdateInterval <= 1)
+        return 1;
+
+    if (distance >= settings.minRateDistance)
+        return settings.maxUpdateInterval;
+
+    // The interval grows linearly between the two distances
+    const float_t t = (distance - settings.fullRateDistance) / (settings.minRateDistance - settings.fullRateDistance);
+    return 1 + static_cast<uint32_t>(t * static_cast<float_t>(settings.maxUpdateInterval - 1));
+}
+
+size_t AnimationSystem::GetAnimatedCount()
+{
+    return m_Renderers.size();
+}
+
+size_t AnimationSystem::GetEvaluatedCount()
+{
+    return m_DueRenderers.size();
+}
+
+float_t AnimationSystem::GetUpdateTime()
+{
+    return m_UpdateTime;
+}
@@ -1,6 +1,7 @@
 ﻿#include "rendering/animator.hpp"
 
 #include "input/time.hpp"
+#include "rendering/pose_blending.hpp"
 #include "utils/utils.hpp"
 #include "resource/animation.hpp"
 #include "utils/logger.hpp"
@@ -16,6 +17,8 @@ void Animator::Start(const Pointer<Animation>& animation)
 {
     m_Animation = animation;
     m_FrameCount = animation->GetFrameCount();
+    m_ChannelBindings = nullptr;
+    m_BoneParents.Clear();
 }
 
 void Animator::StartBlending(Animator* const target)
@@ -24,6 +27,11 @@ void Animator::StartBlending(Animator* const target)
 }
 
 void Animator::Animate()
+{
+    Animate(Time::GetDeltaTime());
+}
+
+void Animator::Animate(const float_t deltaTime)
 {
     if (!m_Animation)
         return;
@@ -33,79 +41,85 @@ void Animator::Animate()
     
     m_FrameCount = m_Animation->GetFrameCount();
 
-    UpdateTime();
+    UpdateTime(deltaTime);
 
-    size_t nextFrame = m_CurrentFrame;
-    if (m_PlaySpeed < 0)
-    {
-        if (m_CurrentFrame == 0)
-            nextFrame = m_FrameCount - 1;
-        else
-            nextFrame = (m_CurrentFrame - 1) % m_FrameCount;
-    }
-    else
+    const List<Bone>& bones = m_Animation->skeleton->GetBones();
+
+    // The buffers only grow when the skeleton changes, so animating doesn't allocate once the first frame is done
+    m_LocalPose.Resize(bones.GetSize());
+    m_ChannelCursors.Resize(bones.GetSize());
+    if (m_FinalMatrices.GetSize() < bones.GetSize())
+        m_FinalMatrices.Resize(bones.GetSize());
+
+    if (m_BoneParents.GetSize() != bones.GetSize())
     {
-        nextFrame = (m_CurrentFrame + 1) % m_FrameCount;
+        m_BoneParents.Resize(bones.GetSize());
+        for (size_t i = 0; i < bones.GetSize(); i++)
+            m_BoneParents[i] = bones[i].parentId;
     }
-    float_t t = std::fmodf(m_Time, m_Animation->GetFrameDuration()) / m_Animation->GetFrameDuration();
-    if (m_PlaySpeed < 0)
-        t = 1 - t;
 
-    const List<Bone>& bones = m_Animation->skeleton->GetBones();
-    List<Matrix> currentMatrices(bones.GetSize());
+    // Bones are matched with the animation channels by name only once, sampling then indexes the channels directly
+    if (m_ChannelBindings == nullptr || m_ChannelBindings->GetSize() != bones.GetSize())
+        m_ChannelBindings = &m_Animation->GetChannelBindings(*m_Animation->skeleton);
+    const List<int32_t>& channelBindings = *m_ChannelBindings;
 
     if (m_BlendTarget)
     {
         m_BlendTarget->m_PlaySpeed = m_BlendTarget->m_Animation->GetDuration() / m_Animation->GetDuration() * m_PlaySpeed;
-        m_BlendTarget->Animate();
+        m_BlendTarget->Animate(deltaTime);
     }
 
-    for (size_t i = 0; i < bones.GetSize(); i++)
-    {
-        const Bone& bone = bones[i];
+    for (const AnimationLayer& layer : m_Layers)
+        layer.source->Animate(deltaTime);
 
-        if (static_cast<size_t>(bone.id) >= currentMatrices.GetSize())
-            continue;
-
-        const List<Animation::KeyFrame>* keyFramesPtr = nullptr;
-        m_Animation->GetBoneKeyFrame(bone, &keyFramesPtr);
-        if (keyFramesPtr == nullptr)
+    size_t sampledCount = 0;
+    for (; sampledCount < bones.GetSize(); sampledCount++)
+    {
+        const int32_t channel = channelBindings[sampledCount];
+        if (channel == -1)
         {
             // Reset animation
             m_Time = 0.f;
             break;
         }
-        const List<Animation::KeyFrame>& keyFrames = *keyFramesPtr;
 
-        const size_t frame = Utils::RemapValue(m_CurrentFrame, Vector2i(0, static_cast<int32_t>(m_FrameCount)), Vector2i(0, static_cast<int32_t>(keyFrames.GetSize())));
-        nextFrame = (frame + 1) % keyFrames.GetSize();
+        // Channels have their own key times, so they are sampled by time. The cursor keeps the keys of the previous frame so they don't have to be searched
+        Vector3 position;
+        Quaternion rotation;
+        m_Animation->SampleChannel(channel, m_Time, &m_ChannelCursors[sampledCount], &position, &rotation, nullptr);
 
-        //Logger::LogInfo("Current frame = {} ; Next frame = {}", frame, nextFrame);
-        
-        m_Positions[i] = Vector3::Lerp(keyFrames[frame].translation, keyFrames[nextFrame].translation, t);
-        m_Rotations[i] = Quaternion::Slerp(keyFrames[frame].rotation, keyFrames[nextFrame].rotation, t);
+        m_LocalPose.SetTranslation(sampledCount, position);
+        m_LocalPose.SetRotation(sampledCount, rotation);
+    }
 
-        if (m_BlendTarget)
-        {
-            m_Positions[i] = Vector3::Lerp(m_Positions[i], m_BlendTarget->m_Positions[i], m_CrossFadeT);
-            m_Rotations[i] = Quaternion::Slerp(m_Rotations[i], m_BlendTarget->m_Rotations[i], m_CrossFadeT);
-        }
+    // The blends work on whole poses at once, so the poses must come from the same skeleton
+    if (m_BlendTarget && m_BlendTarget->m_LocalPose.GetBoneCount() == m_LocalPose.GetBoneCount())
+        PoseBlending::Blend(m_LocalPose, m_BlendTarget->m_LocalPose, m_CrossFadeT, nullptr, &m_LocalPose);
 
-        const Matrix localAnim = Matrix::Trs(m_Positions[i], m_Rotations[i], Vector3(1.f));
+    for (const AnimationLayer& layer : m_Layers)
+    {
+        const Pose& layerPose = layer.source->m_LocalPose;
+        if (layerPose.GetBoneCount() != m_LocalPose.GetBoneCount())
+            continue;
 
-        if (bone.parentId != -1)
-        {
-            // The bone has a parent, so apply the parent global transform to it
-            currentMatrices[bone.id] = currentMatrices[bones[bone.parentId].id] * localAnim;
-        }
+        if (layer.mode == AnimationLayerMode::Additive)
+            PoseBlending::BlendAdditive(m_LocalPose, layerPose, layer.weight, layer.mask, &m_LocalPose);
         else
-        {
-            // The bone has no parent, so its global transform is the same as its local
-            currentMatrices[bone.id] = localAnim;
-        }
-	    
+            PoseBlending::Blend(m_LocalPose, layerPose, layer.weight, layer.mask, &m_LocalPose);
+    }
+
+    // The hierarchy is applied on the whole pose, the transforms only become matrices for the palette
+    PoseBlending::ComputeModelPose(m_LocalPose, m_BoneParents.GetData(), &m_ModelPose);
+
+    for (size_t i = 0; i < sampledCount; i++)
+    {
+        const Bone& bone = bones[i];
+
+        if (static_cast<size_t>(bone.id) >= m_FinalMatrices.GetSize())
+            continue;
+
         // Apply the inverse to the global transform to remove the bind pose transform
-        m_FinalMatrices[bone.id] = currentMatrices[bone.id] * bone.global;
+        m_FinalMatrices[bone.id] = Matrix::Trs(m_ModelPose.GetTranslation(i), m_ModelPose.GetRotation(i), Vector3(1.f)) * bone.global;
     }
 }
 
@@ -114,6 +128,33 @@ void Animator::SetCrossFadeDelta(const float_t delta)
     m_CrossFadeT = delta;
 }
 
+size_t Animator::AddLayer(Animator* const source, const AnimationLayerMode mode, const float_t weight, const BoneMask* const mask)
+{
+    m_Layers.Add({ .source = source, .mode = mode, .weight = weight, .mask = mask });
+
+    return m_Layers.GetSize() - 1;
+}
+
+void Animator::SetLayerWeight(const size_t layer, const float_t weight)
+{
+    m_Layers[layer].weight = weight;
+}
+
+void Animator::ClearLayers()
+{
+    m_Layers.Clear();
+}
+
+const Pose& Animator::GetLocalPose() const
+{
+    return m_LocalPose;
+}
+
+const Pose& Animator::GetModelPose() const
+{
+    return m_ModelPose;
+}
+
 const List<Matrix>& Animator::GetMatrices() const
 {
     if (!m_Animation || !m_Animation->skeleton)
@@ -127,9 +168,9 @@ const List<Matrix>& Animator::GetMatrices() const
     return m_FinalMatrices;
 }
 
-void Animator::UpdateTime()
+void Animator::UpdateTime(const float_t deltaTime)
 {
-    m_Time += Time::GetDeltaTime() * m_PlaySpeed;
+    m_Time += deltaTime * m_PlaySpeed;
     
     if (m_Time >= m_Animation->GetDuration())
     {
@@ -0,0 +1,56 @@
+#include "rendering/bone_mask.hpp"
+
+#include "rendering/pose.hpp"
+#include "resource/skeleton.hpp"
+
+using namespace XnorCore;
+
+BoneMask::BoneMask(const size_t boneCount, const float_t weight)
+{
+    Reset(boneCount, weight);
+}
+
+void BoneMask::Reset(const size_t boneCount, const float_t weight)
+{
+    m_BoneCount = boneCount;
+    m_Weights.Resize(Pose::GetPaddedCount(boneCount));
+
+    for (size_t i = 0; i < m_Weights.GetSize(); i++)
+        m_Weights[i] = i < boneCount ? weight : 0.f;
+}
+
+size_t BoneMask::GetBoneCount() const
+{
+    return m_BoneCount;
+}
+
+void BoneMask::SetWeight(const size_t bone, const float_t weight)
+{
+    m_Weights[bone] = weight;
+}
+
+void BoneMask::SetBranchWeight(const Skeleton& skeleton, const size_t bone, const float_t weight)
+{
+    const List<Bone>& bones = skeleton.GetBones();
+
+    for (size_t i = 0; i < bones.GetSize() && i < m_BoneCount; i++)
+    {
+        // Walk up the hierarchy to find whether the branch root is an ancestor of this bone
+        int32_t current = static_cast<int32_t>(i);
+        while (current != -1 && static_cast<size_t>(current) != bone)
+            current = bones[current].parentId;
+
+        if (current != -1)
+            m_Weights[i] = weight;
+    }
+}
+
+float_t BoneMask::GetWeight(const size_t bone) const
+{
+    return m_Weights[bone];
+}
+
+const float_t* BoneMask::GetWeights() const
+{
+    return m_Weights.GetData();
+}
@@ -0,0 +1,54 @@
+﻿#include "rendering/buffer/shader_storage_buffer.hpp"
+
+#include <glad/glad.h>
+
+#include "rendering/render_stats.hpp"
+
+using namespace XnorCore;
+
+ShaderStorageBuffer::ShaderStorageBuffer()
+{
+    glCreateBuffers(1, &m_Id);
+}
+
+ShaderStorageBuffer::~ShaderStorageBuffer()
+{
+    glDeleteBuffers(1, &m_Id);
+}
+
+void ShaderStorageBuffer::Allocate(const size_t size, const void* const data)
+{
+    // The storage is immutable, so growing the buffer means creating a new one
+    if (m_Size != 0)
+    {
+        glDeleteBuffers(1, &m_Id);
+        glCreateBuffers(1, &m_Id);
+    }
+
+    glNamedBufferStorage(m_Id, static_cast<GLsizeiptr>(size), data, GL_DYNAMIC_STORAGE_BIT);
+    m_Size = size;
+
+    if (data)
+        RenderStats::AddBufferUpload(size);
+}
+
+void ShaderStorageBuffer::Update(const size_t size, const size_t offset, const void* const data) const
+{
+    glNamedBufferSubData(m_Id, static_cast<GLsizeiptr>(offset), static_cast<GLsizeiptr>(size), data);
+    RenderStats::AddBufferUpload(size);
+}
+
+void ShaderStorageBuffer::Bind(const uint32_t index) const
+{
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, index, m_Id);
+}
+
+size_t ShaderStorageBuffer::GetSize() const
+{
+    return m_Size;
+}
+
+uint32_t ShaderStorageBuffer::GetId() const
+{
+    return m_Id;
+}
\ No newline at end of file
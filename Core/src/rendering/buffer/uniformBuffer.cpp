@@ -2,6 +2,8 @@
 
 #include <glad/glad.h>
 
+#include "rendering/render_stats.hpp"
+
 using namespace XnorCore;
 
 UniformBuffer::UniformBuffer()
@@ -17,11 +19,15 @@ UniformBuffer::~UniformBuffer()
 void UniformBuffer::Allocate(const size_t size, const void* const data) const
 {
     glNamedBufferStorage(m_Id, static_cast<GLsizeiptr>(size), data, GL_DYNAMIC_STORAGE_BIT);
+
+    if (data)
+        RenderStats::AddBufferUpload(size);
 }
 
 void UniformBuffer::Update(const size_t size, const size_t offset, const void* const data) const
 {
-    glNamedBufferSubData(m_Id, static_cast<GLsizeiptr>(offset), static_cast<GLsizeiptr>(size), data);   
+    glNamedBufferSubData(m_Id, static_cast<GLsizeiptr>(offset), static_cast<GLsizeiptr>(size), data);
+    RenderStats::AddBufferUpload(size);
 }
 
 void UniformBuffer::Bind(const uint32_t index) const
@@ -2,6 +2,7 @@
 
 #include <glad/glad.h>
 
+#include "rendering/render_stats.hpp"
 #include "rendering/rhi.hpp"
 #include "rendering/buffer/vao.hpp"
 
@@ -16,12 +17,15 @@ Vbo::~Vbo()
 void Vbo::  Allocate(const size_t size, const void* const data , const BufferUsage bufferUsage)
 {
     glNamedBufferData(m_Id, static_cast<uint32_t>(size), data, Rhi::BufferUsageToOpenglUsage(bufferUsage));
-    
+
+    if (data)
+        RenderStats::AddBufferUpload(size);
 }
 
 void Vbo::UpdateData(const size_t offset, const size_t size, const void* const data)
 {
     glNamedBufferSubData(m_Id, offset, size, data);
+    RenderStats::AddBufferUpload(size);
 }
 
 
@@ -49,22 +49,36 @@ void Frustum::UpdateCameraPerspective(const Camera& camera, float_t aspect)
 
 }   
 
-void Frustum::UpdateCameraOrthoGraphic(const Camera& camera, float_t aspect)
+void Frustum::UpdateCameraOrthoGraphic(const Camera& camera, float_t)
 {
-    const float_t halfVSide = camera.far * 0.5f;
-    const float_t halfHSide = halfVSide * aspect;
+    // The orthographic projection doesn't depend on the screen size, so its planes are taken from the exact matrix used for rendering
+    Matrix viewProjection;
+    camera.GetVp({ 1, 1 }, &viewProjection);
 
-    const Vector3 frontMultFar = camera.far * camera.front;
-    
-    plane[Near] = Plane(camera.position + camera.near * camera.front, camera.front);
-    
-    plane[Far] = Plane(camera.position + frontMultFar, -camera.front);
-    
-    plane[Right] = Plane(camera.position,Vector3::Cross(frontMultFar - camera.right * halfHSide, camera.up));
-    
-    plane[Left] = Plane(camera.position,Vector3::Cross(camera.up,frontMultFar + (camera.right * halfHSide)));
-    
-    plane[Top] = Plane(camera.position, Vector3::Cross(camera.right, frontMultFar - (camera.up * halfVSide)));
-    
-    plane[Bottom] = Plane(camera.position, Vector3::Cross(frontMultFar + (camera.up * halfVSide), camera.right));
+    UpdateFromMatrix(viewProjection);
+}
+
+void Frustum::UpdateFromMatrix(const Matrix& viewProjection)
+{
+    const Vector4 row0 = Vector4(viewProjection.m00, viewProjection.m01, viewProjection.m02, viewProjection.m03);
+    const Vector4 row1 = Vector4(viewProjection.m10, viewProjection.m11, viewProjection.m12, viewProjection.m13);
+    const Vector4 row2 = Vector4(viewProjection.m20, viewProjection.m21, viewProjection.m22, viewProjection.m23);
+    const Vector4 row3 = Vector4(viewProjection.m30, viewProjection.m31, viewProjection.m32, viewProjection.m33);
+
+    // Gribb-Hartmann extraction, a point is inside when -w <= x, y, z <= w in clip space
+    SetPlane(Left, row3 + row0);
+    SetPlane(Right, row3 - row0);
+    SetPlane(Bottom, row3 + row1);
+    SetPlane(Top, row3 - row1);
+    SetPlane(Near, row3 + row2);
+    SetPlane(Far, row3 - row2);
+}
+
+void Frustum::SetPlane(const Face face, const Vector4& coefficients)
+{
+    const Vector3 normal = Vector3(coefficients.x, coefficients.y, coefficients.z);
+    const float_t length = normal.Length();
+
+    plane[face].normal = normal / length;
+    plane[face].distance = -coefficients.w / length;
 }
@@ -13,23 +13,18 @@ void CascadeShadowMap::GetCascadeCameras(std::vector<Camera>* cameras, const Cam
     for (size_t i = 0; i < DirectionalCascadeLevel + 1; ++i)
     {
         cameras->at(i) = viewPortCamera;
-        
-        if (i == 0)
-        {
-            GetCamera(&cameras->at(i), viewPortCamera.near, m_CascadeLevel[i],viewPortCamera,lightDir,screenSize);
-        }
-        else if (i < m_CascadeLevel.size())
-        {
-            GetCamera(&cameras->at(i), m_CascadeLevel[i - 1], m_CascadeLevel[i], viewPortCamera,lightDir,screenSize);
-        }
-        else
-        {
-            GetCamera(&cameras->at(i), m_CascadeLevel[i - 1], viewPortCamera.far, viewPortCamera,lightDir,screenSize);
 
-        }
+        float_t cascadeNear = 0.f;
+        float_t cascadeFar = 0.f;
+        GetCascadeRange(i, viewPortCamera, &cascadeNear, &cascadeFar);
+        GetCamera(&cameras->at(i), cascadeNear, cascadeFar, viewPortCamera, lightDir, screenSize);
     }
+}
 
-    
+void CascadeShadowMap::GetCascadeRange(const size_t index, const Camera& viewPortCamera, float_t* const cascadeNear, float_t* const cascadeFar) const
+{
+    *cascadeNear = index == 0 ? viewPortCamera.near : m_CascadeLevel[index - 1];
+    *cascadeFar = index < m_CascadeLevel.size() ? m_CascadeLevel[index] : viewPortCamera.far;
 }
 
 void CascadeShadowMap::SetCascadeLevel(const std::array<float_t,DirectionalCascadeLevel>& cascadeLevel)
@@ -1 +1,27 @@
 ﻿#include "rendering/light/light.hpp"
+
+#include "rendering/render_systems/light_manager.hpp"
+
+using namespace XnorCore;
+
+Light::Light()
+{
+    LightManager::RegisterLight(this);
+}
+
+Light::~Light()
+{
+    LightManager::UnregisterLight(this);
+}
+
+Light::Light(const Light& other)
+    : Component(other), color(other.color), intensity(other.intensity), castShadow(other.castShadow), near(other.near), far(other.far)
+{
+    LightManager::RegisterLight(this);
+}
+
+Light::Light(Light&& other) noexcept
+    : Component(std::move(other)), color(other.color), intensity(other.intensity), castShadow(other.castShadow), near(other.near), far(other.far)
+{
+    LightManager::RegisterLight(this);
+}
@@ -0,0 +1,215 @@
+﻿#include "rendering/light/light_cluster_grid.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include <Maths/calc.hpp>
+
+#include "utils/job_system.hpp"
+
+using namespace XnorCore;
+
+void LightClusterGrid::Build(const Camera& camera, const float_t aspect, const std::vector<ClusteredLight>& lights)
+{
+    const Vector3 front = camera.front.Normalized();
+    const Vector3 right = Vector3::Cross(front, camera.up).Normalized();
+    const Vector3 up = Vector3::Cross(right, front);
+
+    m_GpuData.cameraPosition = Vector4(camera.position.x, camera.position.y, camera.position.z, 1.f);
+    m_GpuData.cameraRight = Vector4(right.x, right.y, right.z, 0.f);
+    m_GpuData.cameraUp = Vector4(up.x, up.y, up.z, 0.f);
+    m_GpuData.cameraFront = Vector4(front.x, front.y, front.z, 0.f);
+
+    if (camera.isOrthographic)
+    {
+        m_GpuData.tanHalfFovX = 1.f;
+        m_GpuData.tanHalfFovY = 1.f;
+        m_GpuData.near = camera.near;
+        m_GpuData.sliceScale = 0.f;
+        m_GpuData.tileCountX = 1;
+        m_GpuData.tileCountY = 1;
+        m_GpuData.sliceCount = 1;
+
+        m_Clusters.assign(1, { 0, static_cast<uint32_t>(lights.size()) });
+        m_LightIndices.resize(lights.size());
+        for (size_t i = 0; i < lights.size(); i++)
+            m_LightIndices[i] = static_cast<uint32_t>(i);
+
+        return;
+    }
+
+    const float_t near = std::max(camera.near, 1e-3f);
+    const float_t far = std::max(camera.far, near * 2.f);
+
+    m_GpuData.tanHalfFovY = std::tan(camera.fov * Calc::Deg2Rad * 0.5f);
+    m_GpuData.tanHalfFovX = m_GpuData.tanHalfFovY * aspect;
+    m_GpuData.near = near;
+    m_GpuData.sliceScale = static_cast<float_t>(SliceCount) / std::log(far / near);
+    m_GpuData.tileCountX = TileCountX;
+    m_GpuData.tileCountY = TileCountY;
+    m_GpuData.sliceCount = SliceCount;
+
+    for (uint32_t i = 0; i <= SliceCount; i++)
+        m_SliceDepths[i] = near * std::pow(far / near, static_cast<float_t>(i) / static_cast<float_t>(SliceCount));
+
+    m_ViewLights.resize(lights.size());
+    for (size_t i = 0; i < lights.size(); i++)
+    {
+        const Vector3 toLight = lights[i].position - camera.position;
+        m_ViewLights[i] = Vector4(Vector3::Dot(toLight, right), Vector3::Dot(toLight, up), Vector3::Dot(toLight, front), lights[i].radius);
+    }
+
+    m_Clusters.resize(ClusterCount);
+
+    JobSystem::ParallelFor(SliceCount, 1, [this](const size_t first, const size_t last)
+    {
+        for (size_t slice = first; slice < last; slice++)
+            BinSlice(static_cast<uint32_t>(slice));
+    });
+
+    // The slices were binned with local offsets, they are laid out one after the other in the final array
+    size_t indexCount = 0;
+    for (const std::vector<uint32_t>& indices : m_SliceIndices)
+        indexCount += indices.size();
+
+    m_LightIndices.resize(indexCount);
+
+    uint32_t sliceOffset = 0;
+    for (uint32_t slice = 0; slice < SliceCount; slice++)
+    {
+        const std::vector<uint32_t>& indices = m_SliceIndices[slice];
+        std::ranges::copy(indices, m_LightIndices.begin() + sliceOffset);
+
+        for (uint32_t i = 0; i < TileCountX * TileCountY; i++)
+            m_Clusters[slice * TileCountX * TileCountY + i].offset += sliceOffset;
+
+        sliceOffset += static_cast<uint32_t>(indices.size());
+    }
+}
+
+const GpuLightClusterData& LightClusterGrid::GetGpuData() const
+{
+    return m_GpuData;
+}
+
+const std::vector<LightClusterRange>& LightClusterGrid::GetClusters() const
+{
+    return m_Clusters;
+}
+
+const std::vector<uint32_t>& LightClusterGrid::GetLightIndices() const
+{
+    return m_LightIndices;
+}
+
+uint32_t LightClusterGrid::GetClusterIndex(const Vector3 position) const
+{
+    const Vector3 toPosition = position - Vector3(m_GpuData.cameraPosition.x, m_GpuData.cameraPosition.y, m_GpuData.cameraPosition.z);
+    const float_t x = Vector3::Dot(toPosition, static_cast<Vector3>(m_GpuData.cameraRight));
+    const float_t y = Vector3::Dot(toPosition, static_cast<Vector3>(m_GpuData.cameraUp));
+    const float_t depth = std::max(Vector3::Dot(toPosition, static_cast<Vector3>(m_GpuData.cameraFront)), m_GpuData.near);
+
+    const auto getCell = [](const float_t coordinate, const uint32_t count) -> uint32_t
+    {
+        const float_t cell = std::floor(coordinate * static_cast<float_t>(count));
+        return static_cast<uint32_t>(std::clamp(cell, 0.f, static_cast<float_t>(count - 1)));
+    };
+
+    const uint32_t tileX = getCell((x / (depth * m_GpuData.tanHalfFovX) + 1.f) * 0.5f, m_GpuData.tileCountX);
+    const uint32_t tileY = getCell((y / (depth * m_GpuData.tanHalfFovY) + 1.f) * 0.5f, m_GpuData.tileCountY);
+    const uint32_t slice = getCell(std::log(depth / m_GpuData.near) * m_GpuData.sliceScale / static_cast<float_t>(m_GpuData.sliceCount), m_GpuData.sliceCount);
+
+    return (slice * m_GpuData.tileCountY + tileY) * m_GpuData.tileCountX + tileX;
+}
+
+ClusteredLight LightClusterGrid::GetSpotLightBounds(const Vector3 position, const Vector3 direction, const float_t angle, const float_t range)
+{
+    // Wide cones are bounded by the circle at their end, narrow ones by a sphere going through the apex
+    if (angle > Calc::PiOver4)
+        return { position + direction * (std::cos(angle) * range), std::sin(angle) * range };
+
+    const float_t radius = range / (2.f * std::cos(angle));
+    return { position + direction * radius, radius };
+}
+
+void LightClusterGrid::BinSlice(const uint32_t slice)
+{
+    const float_t sliceNear = m_SliceDepths[slice];
+    const float_t sliceFar = m_SliceDepths[slice + 1];
+
+    std::vector<ClusterEntry>& entries = m_SliceEntries[slice];
+    entries.clear();
+
+    for (uint32_t i = 0; i < m_ViewLights.size(); i++)
+    {
+        const Vector4& light = m_ViewLights[i];
+
+        const float_t minDepth = std::max(light.z - light.w, sliceNear);
+        const float_t maxDepth = std::min(light.z + light.w, sliceFar);
+        if (minDepth > maxDepth)
+            continue;
+
+        uint32_t firstX, lastX, firstY, lastY;
+        GetTileRange(light.x, light.w, minDepth, maxDepth, m_GpuData.tanHalfFovX, TileCountX, &firstX, &lastX);
+        GetTileRange(light.y, light.w, minDepth, maxDepth, m_GpuData.tanHalfFovY, TileCountY, &firstY, &lastY);
+        if (firstX > lastX || firstY > lastY)
+            continue;
+
+        for (uint32_t y = firstY; y <= lastY; y++)
+        {
+            for (uint32_t x = firstX; x <= lastX; x++)
+                entries.push_back({ y * TileCountX + x, i });
+        }
+    }
+
+    // Counting sort of the entries by cluster, which keeps the lights of a cluster in ascending order
+    LightClusterRange* const clusters = &m_Clusters[static_cast<size_t>(slice) * TileCountX * TileCountY];
+    std::fill_n(clusters, TileCountX * TileCountY, LightClusterRange{});
+
+    for (const ClusterEntry& entry : entries)
+        clusters[entry.cluster].count++;
+
+    uint32_t offset = 0;
+    for (uint32_t i = 0; i < TileCountX * TileCountY; i++)
+    {
+        clusters[i].offset = offset;
+        offset += clusters[i].count;
+        clusters[i].count = 0;
+    }
+
+    std::vector<uint32_t>& indices = m_SliceIndices[slice];
+    indices.resize(entries.size());
+
+    for (const ClusterEntry& entry : entries)
+    {
+        LightClusterRange& cluster = clusters[entry.cluster];
+        indices[cluster.offset + cluster.count++] = entry.light;
+    }
+}
+
+void LightClusterGrid::GetTileRange(
+    const float_t center,
+    const float_t radius,
+    const float_t minDepth,
+    const float_t maxDepth,
+    const float_t tanHalfFov,
+    const uint32_t tileCount,
+    uint32_t* const first,
+    uint32_t* const last
+) const
+{
+    // Projected extent of the sphere bounding box over the depth range, which is conservative since the depth is positive
+    const float_t min = std::min((center - radius) / minDepth, (center - radius) / maxDepth) / tanHalfFov;
+    const float_t max = std::max((center + radius) / minDepth, (center + radius) / maxDepth) / tanHalfFov;
+
+    if (max < -1.f || min > 1.f)
+    {
+        *first = 1;
+        *last = 0;
+        return;
+    }
+
+    const float_t scale = static_cast<float_t>(tileCount) * 0.5f;
+    *first = static_cast<uint32_t>(std::clamp(std::floor((min + 1.f) * scale), 0.f, static_cast<float_t>(tileCount - 1)));
+    *last = static_cast<uint32_t>(std::clamp(std::floor((max + 1.f) * scale), 0.f, static_cast<float_t>(tileCount - 1)));
+}
@@ -0,0 +1,88 @@
+﻿#include "rendering/light/shadow_cache.hpp"
+
+using namespace XnorCore;
+
+void ShadowCache::BeginFrame()
+{
+    m_Stats = {};
+    m_Frame++;
+
+    // The views of removed lights are never asked for again, their state would otherwise stay forever
+    std::erase_if(m_Views, [this](const decltype(m_Views)::value_type& entry) { return m_Frame - entry.second.lastUsedFrame > MaxUnusedFrames; });
+}
+
+ShadowCache::Update ShadowCache::GetUpdate(const uint32_t viewId, const uint64_t staticSignature, const bool_t hasDynamicCasters)
+{
+    const decltype(m_Views)::iterator it = m_Views.find(viewId);
+
+    if (it == m_Views.end() || it->second.staticSignature != staticSignature)
+    {
+        m_Views[viewId] = { staticSignature, hasDynamicCasters, m_Frame };
+        m_Stats.fullUpdates++;
+        return Update::Full;
+    }
+
+    it->second.lastUsedFrame = m_Frame;
+
+    // A dynamic caster that left the view must still be erased from the shadow map once
+    if (hasDynamicCasters || it->second.hadDynamicCasters)
+    {
+        it->second.hadDynamicCasters = hasDynamicCasters;
+        m_Stats.dynamicUpdates++;
+        return Update::Dynamic;
+    }
+
+    m_Stats.skippedUpdates++;
+    return Update::None;
+}
+
+ShadowCache::Update ShadowCache::PeekUpdate(const uint32_t viewId, const uint64_t staticSignature, const bool_t hasDynamicCasters) const
+{
+    const decltype(m_Views)::const_iterator it = m_Views.find(viewId);
+
+    if (it == m_Views.end() || it->second.staticSignature != staticSignature)
+        return Update::Full;
+
+    if (hasDynamicCasters || it->second.hadDynamicCasters)
+        return Update::Dynamic;
+
+    return Update::None;
+}
+
+void ShadowCache::Touch(const uint32_t viewId)
+{
+    const decltype(m_Views)::iterator it = m_Views.find(viewId);
+
+    if (it != m_Views.end())
+        it->second.lastUsedFrame = m_Frame;
+}
+
+void ShadowCache::Invalidate()
+{
+    m_Views.clear();
+}
+
+const ShadowCacheStats& ShadowCache::GetStats() const
+{
+    return m_Stats;
+}
+
+size_t ShadowCache::GetViewCount() const
+{
+    return m_Views.size();
+}
+
+uint64_t ShadowCache::Hash(uint64_t signature, const void* const data, const size_t size)
+{
+    // FNV-1a, the signatures are only compared to themselves from one frame to the next
+    constexpr uint64_t Prime = 1099511628211ull;
+
+    const uint8_t* const bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; i++)
+    {
+        signature ^= bytes[i];
+        signature *= Prime;
+    }
+
+    return signature;
+}
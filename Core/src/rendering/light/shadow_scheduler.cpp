@@ -0,0 +1,115 @@
+﻿#include "rendering/light/shadow_scheduler.hpp"
+
+#include <algorithm>
+
+using namespace XnorCore;
+
+void ShadowScheduler::BeginFrame()
+{
+    m_Frame++;
+    ClearRequests();
+    m_Stats = {};
+}
+
+void ShadowScheduler::ClearRequests()
+{
+    m_Requests.clear();
+    m_Scheduled.clear();
+}
+
+size_t ShadowScheduler::Submit(const ShadowViewRequest& request)
+{
+    m_Requests.push_back(request);
+    m_Scheduled.push_back(false);
+
+    return m_Requests.size() - 1;
+}
+
+void ShadowScheduler::Schedule(const ShadowBudget& budget)
+{
+    m_Candidates.clear();
+
+    for (size_t i = 0; i < m_Requests.size(); i++)
+    {
+        const ShadowViewRequest& request = m_Requests[i];
+        const decltype(m_LastUpdates)::const_iterator it = m_LastUpdates.find(request.viewId);
+
+        if (it == m_LastUpdates.end())
+        {
+            m_Candidates.push_back({ i, 0.f, true });
+            continue;
+        }
+
+        // Already rendered for another viewport during this frame, the shadow map is up to date
+        const uint32_t staleness = static_cast<uint32_t>(m_Frame - it->second);
+        if (staleness == 0)
+            continue;
+
+        if (staleness < request.updateInterval)
+        {
+            m_Stats.deferredViews++;
+            continue;
+        }
+
+        m_Candidates.push_back({ i, GetPriority(request, staleness), false });
+    }
+
+    // New views first, then by priority, the view id breaks the ties so that the order never depends on the submission order
+    std::ranges::sort(m_Candidates, [this](const Candidate& lhs, const Candidate& rhs) -> bool_t
+    {
+        if (lhs.isNew != rhs.isNew)
+            return lhs.isNew;
+
+        if (lhs.priority != rhs.priority)
+            return lhs.priority > rhs.priority;
+
+        return m_Requests[lhs.requestIndex].viewId < m_Requests[rhs.requestIndex].viewId;
+    });
+
+    for (const Candidate& candidate : m_Candidates)
+    {
+        const ShadowViewRequest& request = m_Requests[candidate.requestIndex];
+
+        // At least one view is rendered each frame, even if it alone goes over the budget
+        const bool_t hasViewsLeft = budget.maxViews == 0 || m_Stats.scheduledViews < budget.maxViews;
+        const bool_t hasCostLeft = budget.maxCost <= 0.f || m_Stats.scheduledCost + request.cost <= budget.maxCost || m_Stats.scheduledViews == 0;
+
+        if (!candidate.isNew && !(hasViewsLeft && hasCostLeft))
+        {
+            m_Stats.deferredViews++;
+            continue;
+        }
+
+        m_Scheduled[candidate.requestIndex] = true;
+        m_LastUpdates[request.viewId] = m_Frame;
+        m_Stats.scheduledViews++;
+        m_Stats.scheduledCost += request.cost;
+    }
+}
+
+bool_t ShadowScheduler::IsScheduled(const size_t requestIndex) const
+{
+    return m_Scheduled[requestIndex];
+}
+
+void ShadowScheduler::Reset()
+{
+    m_LastUpdates.clear();
+}
+
+void ShadowScheduler::Forget(const uint32_t viewId)
+{
+    m_LastUpdates.erase(viewId);
+}
+
+const ShadowSchedulerStats& ShadowScheduler::GetStats() const
+{
+    return m_Stats;
+}
+
+float_t ShadowScheduler::GetPriority(const ShadowViewRequest& request, const uint32_t staleness)
+{
+    const float_t coverage = std::clamp(request.screenCoverage, 0.f, 1.f);
+
+    return (1.f + CoverageWeight * coverage) * static_cast<float_t>(staleness) / (1.f + DistanceFalloff * std::max(request.distance, 0.f));
+}
@@ -0,0 +1,115 @@
+﻿#include "rendering/lod_selector.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <Maths/calc.hpp>
+
+#include "scene/component/static_mesh_renderer.hpp"
+
+using namespace XnorCore;
+
+void LodSelector::BeginFrame()
+{
+    // The meshes that left the view start again from their screen size when they come back
+    std::erase_if(m_Selections, [this](const auto& selection) { return selection.second.frame != m_Frame; });
+    m_Frame++;
+}
+
+uint32_t LodSelector::Select(const StaticMeshRenderer& meshRenderer, const Camera& camera, const MeshLodSettings& settings)
+{
+    Bound bound;
+    meshRenderer.GetAabb(&bound);
+
+    return SelectFromScreenSize(meshRenderer, ComputeScreenSize(camera, bound), settings);
+}
+
+uint32_t LodSelector::Select(const StaticMeshRenderer& meshRenderer, const std::vector<Camera>& cameras, const MeshLodSettings& settings)
+{
+    Bound bound;
+    meshRenderer.GetAabb(&bound);
+
+    return SelectFromScreenSize(meshRenderer, ComputeScreenSize(cameras, bound), settings);
+}
+
+float_t LodSelector::ComputeScreenSize(const Camera& camera, const Bound& bound)
+{
+    const float_t radius = bound.extents.Length();
+
+    if (camera.isOrthographic)
+        return 2.f * radius / std::abs(camera.bottomtop.y - camera.bottomtop.x);
+
+    const float_t distance = (bound.center - camera.position).Length();
+    if (distance <= radius)
+        return std::numeric_limits<float_t>::max();
+
+    return radius / (distance * std::tan(camera.fov * Calc::Deg2Rad * 0.5f));
+}
+
+float_t LodSelector::ComputeScreenSize(const std::vector<Camera>& cameras, const Bound& bound)
+{
+    float_t screenSize = 0.f;
+    for (const Camera& camera : cameras)
+        screenSize = std::max(screenSize, ComputeScreenSize(camera, bound));
+
+    return screenSize;
+}
+
+uint32_t LodSelector::ComputeLod(const float_t screenSize, uint32_t currentLod, const uint32_t lodCount, const MeshLodSettings& settings)
+{
+    const uint32_t lastLod = std::min(lodCount, static_cast<uint32_t>(Model::MaxLodCount)) - 1;
+    currentLod = std::min(currentLod, lastLod);
+
+    // The level of a mesh only changes once its screen size went past the threshold by the hysteresis margin
+    while (currentLod < lastLod && screenSize < settings.screenSizes[currentLod] * (1.f - settings.hysteresis))
+        currentLod++;
+
+    while (currentLod > 0 && screenSize > settings.screenSizes[currentLod - 1] * (1.f + settings.hysteresis))
+        currentLod--;
+
+    return currentLod;
+}
+
+size_t LodSelector::GetTriangleCount(const StaticMeshRenderer& meshRenderer, const uint32_t lod)
+{
+    size_t triangleCount = 0;
+    for (size_t i = 0; i < meshRenderer.mesh->models.GetSize(); i++)
+    {
+        const Pointer<Model>& model = meshRenderer.mesh->models[i];
+        if (model.IsValid())
+            triangleCount += model->GetTriangleCount(lod);
+    }
+
+    return triangleCount;
+}
+
+uint32_t LodSelector::SelectFromScreenSize(const StaticMeshRenderer& meshRenderer, const float_t screenSize, const MeshLodSettings& settings)
+{
+    uint32_t lodCount = 1;
+    for (size_t i = 0; i < meshRenderer.mesh->models.GetSize(); i++)
+    {
+        const Pointer<Model>& model = meshRenderer.mesh->models[i];
+        if (model.IsValid())
+            lodCount = std::max(lodCount, static_cast<uint32_t>(model->GetLodCount()));
+    }
+
+    const auto&& [it, inserted] = m_Selections.try_emplace(&meshRenderer);
+    Selection& selection = it->second;
+
+    if (inserted)
+    {
+        // A mesh seen for the first time has no level to stick to
+        MeshLodSettings firstSettings = settings;
+        firstSettings.hysteresis = 0.f;
+        selection.lod = ComputeLod(screenSize, 0, lodCount, firstSettings);
+    }
+    else
+    {
+        selection.lod = ComputeLod(screenSize, selection.lod, lodCount, settings);
+    }
+
+    selection.frame = m_Frame;
+
+    return selection.lod;
+}
@@ -0,0 +1,438 @@
+﻿#include "rendering/mesh_simplifier.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <unordered_map>
+
+using namespace XnorCore;
+
+namespace
+{
+    constexpr uint32_t NoVertex = std::numeric_limits<uint32_t>::max();
+
+    // Cosine of the largest rotation a collapse may apply to a triangle, slivers flip with barely any rotation otherwise
+    constexpr float_t MinNormalCosine = 0.25f;
+
+    /// @brief Sum of squared distances to a set of planes, as a symmetric 4x4 matrix
+    struct Quadric
+    {
+        double xx = 0.0, xy = 0.0, xz = 0.0, xw = 0.0;
+        double yy = 0.0, yz = 0.0, yw = 0.0;
+        double zz = 0.0, zw = 0.0;
+        double ww = 0.0;
+
+        void AddPlane(const double a, const double b, const double c, const double d, const double weight)
+        {
+            xx += a * a * weight; xy += a * b * weight; xz += a * c * weight; xw += a * d * weight;
+            yy += b * b * weight; yz += b * c * weight; yw += b * d * weight;
+            zz += c * c * weight; zw += c * d * weight;
+            ww += d * d * weight;
+        }
+
+        void Add(const Quadric& other)
+        {
+            xx += other.xx; xy += other.xy; xz += other.xz; xw += other.xw;
+            yy += other.yy; yz += other.yz; yw += other.yw;
+            zz += other.zz; zw += other.zw;
+            ww += other.ww;
+        }
+
+        [[nodiscard]]
+        double Evaluate(const Vector3& p) const
+        {
+            const double x = p.x;
+            const double y = p.y;
+            const double z = p.z;
+
+            return x * x * xx + 2.0 * x * y * xy + 2.0 * x * z * xz + 2.0 * x * xw
+                + y * y * yy + 2.0 * y * z * yz + 2.0 * y * yw
+                + z * z * zz + 2.0 * z * zw
+                + ww;
+        }
+    };
+
+    struct Collapse
+    {
+        double cost;
+        uint32_t from;
+        uint32_t to;
+        uint32_t fromVersion;
+        uint32_t toVersion;
+
+        bool_t operator>(const Collapse& other) const
+        {
+            return cost > other.cost;
+        }
+    };
+
+    // Attributes two vertices must share to be merged, the tangent space is derived from them
+    struct VertexKey
+    {
+        std::array<float_t, 8> values;
+
+        bool_t operator==(const VertexKey& other) const
+        {
+            return values == other.values;
+        }
+    };
+
+    struct VertexKeyHash
+    {
+        size_t operator()(const VertexKey& key) const
+        {
+            uint64_t hash = 14695981039346656037ull;
+            for (const float_t value : key.values)
+            {
+                uint32_t bits;
+                std::memcpy(&bits, &value, sizeof(bits));
+                hash = (hash ^ bits) * 1099511628211ull;
+            }
+
+            return static_cast<size_t>(hash);
+        }
+    };
+
+    uint64_t GetEdgeKey(const uint32_t a, const uint32_t b)
+    {
+        return static_cast<uint64_t>(std::min(a, b)) << 32 | std::max(a, b);
+    }
+
+    Vector3 GetNormal(const Vector3& a, const Vector3& b, const Vector3& c)
+    {
+        return Vector3::Cross(b - a, c - a);
+    }
+
+    /// @brief State of a simplification, the triangles reference the merged vertices
+    class Simplification
+    {
+    public:
+        Simplification(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices)
+            : m_Vertices(vertices)
+        {
+            MergeVertices(indices);
+            LockVertices();
+            ComputeQuadrics();
+        }
+
+        void Run(const size_t targetTriangleCount)
+        {
+            for (uint32_t t = 0; t < m_Triangles.size(); t++)
+            {
+                for (uint32_t k = 0; k < 3; k++)
+                {
+                    PushCollapse(m_Triangles[t][k], m_Triangles[t][(k + 1) % 3]);
+                    PushCollapse(m_Triangles[t][(k + 1) % 3], m_Triangles[t][k]);
+                }
+            }
+
+            while (m_LiveTriangleCount > targetTriangleCount && !m_Collapses.empty())
+            {
+                const Collapse collapse = m_Collapses.top();
+                m_Collapses.pop();
+
+                // The costs of the collapses around a vertex change each time it is modified
+                if (collapse.fromVersion != m_Versions[collapse.from] || collapse.toVersion != m_Versions[collapse.to])
+                    continue;
+
+                if (!CanCollapse(collapse.from, collapse.to))
+                    continue;
+
+                ApplyCollapse(collapse.from, collapse.to);
+            }
+        }
+
+        void GetIndices(std::vector<uint32_t>* const result) const
+        {
+            result->clear();
+            result->reserve(m_LiveTriangleCount * 3);
+
+            for (uint32_t t = 0; t < m_Triangles.size(); t++)
+            {
+                if (m_DeadTriangles[t])
+                    continue;
+
+                result->insert(result->end(), m_Triangles[t].begin(), m_Triangles[t].end());
+            }
+        }
+
+    private:
+        const std::vector<Vertex>& m_Vertices;
+
+        std::vector<std::array<uint32_t, 3>> m_Triangles;
+        std::vector<bool_t> m_DeadTriangles;
+        size_t m_LiveTriangleCount = 0;
+
+        std::vector<std::vector<uint32_t>> m_VertexTriangles;
+        std::vector<Quadric> m_Quadrics;
+        std::vector<bool_t> m_Locked;
+        std::vector<uint32_t> m_Versions;
+
+        std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>> m_Collapses;
+
+        // Identical vertices are merged, the importer may have split every triangle corner
+        void MergeVertices(const std::vector<uint32_t>& indices)
+        {
+            std::unordered_map<VertexKey, uint32_t, VertexKeyHash> firstVertices;
+            std::vector<uint32_t> remap(m_Vertices.size());
+
+            for (uint32_t i = 0; i < m_Vertices.size(); i++)
+            {
+                const Vertex& vertex = m_Vertices[i];
+                const VertexKey key = { {
+                    vertex.position.x, vertex.position.y, vertex.position.z,
+                    vertex.normal.x, vertex.normal.y, vertex.normal.z,
+                    vertex.textureCoord.x, vertex.textureCoord.y
+                } };
+
+                remap[i] = firstVertices.emplace(key, i).first->second;
+            }
+
+            m_VertexTriangles.resize(m_Vertices.size());
+            m_Triangles.reserve(indices.size() / 3);
+
+            for (size_t i = 0; i + 2 < indices.size(); i += 3)
+            {
+                const std::array<uint32_t, 3> triangle = { remap[indices[i]], remap[indices[i + 1]], remap[indices[i + 2]] };
+                if (triangle[0] == triangle[1] || triangle[1] == triangle[2] || triangle[2] == triangle[0])
+                    continue;
+
+                for (const uint32_t vertex : triangle)
+                    m_VertexTriangles[vertex].push_back(static_cast<uint32_t>(m_Triangles.size()));
+                m_Triangles.push_back(triangle);
+            }
+
+            m_DeadTriangles.assign(m_Triangles.size(), false);
+            m_LiveTriangleCount = m_Triangles.size();
+            m_Versions.assign(m_Vertices.size(), 0);
+        }
+
+        // The vertices on a seam or a border would tear the mesh or shrink its silhouette if they moved
+        void LockVertices()
+        {
+            m_Locked.assign(m_Vertices.size(), false);
+
+            std::unordered_map<VertexKey, uint32_t, VertexKeyHash> positions;
+            std::vector<uint32_t> positionIds(m_Vertices.size(), NoVertex);
+            std::vector<uint32_t> positionVertices;
+
+            for (uint32_t i = 0; i < m_Vertices.size(); i++)
+            {
+                if (m_VertexTriangles[i].empty())
+                    continue;
+
+                const Vector3& position = m_Vertices[i].position;
+                const VertexKey key = { { position.x, position.y, position.z, 0.f, 0.f, 0.f, 0.f, 0.f } };
+                const auto&& [it, inserted] = positions.emplace(key, static_cast<uint32_t>(positionVertices.size()));
+
+                if (inserted)
+                {
+                    positionVertices.push_back(i);
+                }
+                else
+                {
+                    m_Locked[i] = true;
+                    m_Locked[positionVertices[it->second]] = true;
+                }
+
+                positionIds[i] = it->second;
+            }
+
+            // Edges are counted by position so that a seam isn't taken for a border
+            std::unordered_map<uint64_t, uint32_t> edgeTriangleCounts;
+            for (const std::array<uint32_t, 3>& triangle : m_Triangles)
+            {
+                for (uint32_t k = 0; k < 3; k++)
+                    edgeTriangleCounts[GetEdgeKey(positionIds[triangle[k]], positionIds[triangle[(k + 1) % 3]])]++;
+            }
+
+            for (const std::array<uint32_t, 3>& triangle : m_Triangles)
+            {
+                for (uint32_t k = 0; k < 3; k++)
+                {
+                    const uint32_t a = triangle[k];
+                    const uint32_t b = triangle[(k + 1) % 3];
+
+                    if (edgeTriangleCounts[GetEdgeKey(positionIds[a], positionIds[b])] != 2)
+                    {
+                        m_Locked[a] = true;
+                        m_Locked[b] = true;
+                    }
+                }
+            }
+        }
+
+        void ComputeQuadrics()
+        {
+            m_Quadrics.assign(m_Vertices.size(), Quadric());
+
+            for (const std::array<uint32_t, 3>& triangle : m_Triangles)
+            {
+                const Vector3& a = m_Vertices[triangle[0]].position;
+                const Vector3 normal = GetNormal(a, m_Vertices[triangle[1]].position, m_Vertices[triangle[2]].position);
+                const double length = normal.Length();
+                if (length <= 0.0)
+                    continue;
+
+                // Weighted by the area so that small triangles don't hold large ones in place
+                const double nx = normal.x / length;
+                const double ny = normal.y / length;
+                const double nz = normal.z / length;
+                const double d = -(nx * a.x + ny * a.y + nz * a.z);
+
+                for (const uint32_t vertex : triangle)
+                    m_Quadrics[vertex].AddPlane(nx, ny, nz, d, length * 0.5);
+            }
+        }
+
+        void PushCollapse(const uint32_t from, const uint32_t to)
+        {
+            if (m_Locked[from])
+                return;
+
+            Quadric quadric = m_Quadrics[from];
+            quadric.Add(m_Quadrics[to]);
+
+            m_Collapses.push({ quadric.Evaluate(m_Vertices[to].position), from, to, m_Versions[from], m_Versions[to] });
+        }
+
+        [[nodiscard]]
+        bool_t CanCollapse(const uint32_t from, const uint32_t to) const
+        {
+            std::vector<uint32_t> fromNeighbors;
+            size_t sharedTriangleCount = 0;
+
+            for (const uint32_t t : m_VertexTriangles[from])
+            {
+                if (m_DeadTriangles[t])
+                    continue;
+
+                const std::array<uint32_t, 3>& triangle = m_Triangles[t];
+                for (const uint32_t vertex : triangle)
+                {
+                    if (vertex != from && vertex != to)
+                        fromNeighbors.push_back(vertex);
+                }
+
+                if (std::ranges::find(triangle, to) != triangle.end())
+                {
+                    sharedTriangleCount++;
+                    continue;
+                }
+
+                // The triangles moving with the vertex must not flip, turn too far or become degenerate
+                const Vector3 before = GetNormal(m_Vertices[triangle[0]].position, m_Vertices[triangle[1]].position, m_Vertices[triangle[2]].position);
+                const Vector3 after = GetNormal(
+                    m_Vertices[triangle[0] == from ? to : triangle[0]].position,
+                    m_Vertices[triangle[1] == from ? to : triangle[1]].position,
+                    m_Vertices[triangle[2] == from ? to : triangle[2]].position
+                );
+
+                const float_t dot = Vector3::Dot(before, after);
+                if (dot <= 0.f || dot * dot < MinNormalCosine * MinNormalCosine * before.SquaredLength() * after.SquaredLength())
+                    return false;
+            }
+
+            if (sharedTriangleCount == 0)
+                return false;
+
+            std::ranges::sort(fromNeighbors);
+            const auto&& [first, last] = std::ranges::unique(fromNeighbors);
+            fromNeighbors.erase(first, last);
+
+            std::vector<uint32_t> commonNeighbors;
+            for (const uint32_t t : m_VertexTriangles[to])
+            {
+                if (m_DeadTriangles[t])
+                    continue;
+
+                for (const uint32_t vertex : m_Triangles[t])
+                {
+                    if (vertex != to && std::ranges::binary_search(fromNeighbors, vertex))
+                        commonNeighbors.push_back(vertex);
+                }
+            }
+
+            std::ranges::sort(commonNeighbors);
+            const auto&& [commonFirst, commonLast] = std::ranges::unique(commonNeighbors);
+            commonNeighbors.erase(commonFirst, commonLast);
+
+            // Link condition, the vertices only share the neighbors facing the edge, otherwise the collapse pinches the mesh
+            return commonNeighbors.size() == sharedTriangleCount;
+        }
+
+        void ApplyCollapse(const uint32_t from, const uint32_t to)
+        {
+            for (const uint32_t t : m_VertexTriangles[from])
+            {
+                if (m_DeadTriangles[t])
+                    continue;
+
+                std::array<uint32_t, 3>& triangle = m_Triangles[t];
+                if (std::ranges::find(triangle, to) != triangle.end())
+                {
+                    m_DeadTriangles[t] = true;
+                    m_LiveTriangleCount--;
+                    continue;
+                }
+
+                *std::ranges::find(triangle, from) = to;
+                m_VertexTriangles[to].push_back(t);
+            }
+
+            m_VertexTriangles[from].clear();
+            std::erase_if(m_VertexTriangles[to], [this](const uint32_t t) { return m_DeadTriangles[t]; });
+
+            m_Quadrics[to].Add(m_Quadrics[from]);
+            m_Versions[from]++;
+            m_Versions[to]++;
+
+            // The quadric of the target changed, so did the cost of every collapse around it
+            for (const uint32_t t : m_VertexTriangles[to])
+            {
+                for (const uint32_t vertex : m_Triangles[t])
+                {
+                    if (vertex == to)
+                        continue;
+
+                    PushCollapse(vertex, to);
+                    PushCollapse(to, vertex);
+                }
+            }
+        }
+    };
+}
+
+void MeshSimplifier::Simplify(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, const size_t targetIndexCount, std::vector<uint32_t>* const result)
+{
+    Simplification simplification(vertices, indices);
+    simplification.Run(targetIndexCount / 3);
+    simplification.GetIndices(result);
+}
+
+void MeshSimplifier::CompactVertices(
+    const std::vector<Vertex>& vertices,
+    const std::vector<uint32_t>& indices,
+    std::vector<Vertex>* const usedVertices,
+    std::vector<uint32_t>* const remappedIndices
+)
+{
+    std::vector<uint32_t> remap(vertices.size(), NoVertex);
+    usedVertices->clear();
+    remappedIndices->resize(indices.size());
+
+    for (size_t i = 0; i < indices.size(); i++)
+    {
+        uint32_t& newIndex = remap[indices[i]];
+        if (newIndex == NoVertex)
+        {
+            newIndex = static_cast<uint32_t>(usedVertices->size());
+            usedVertices->push_back(vertices[indices[i]]);
+        }
+
+        (*remappedIndices)[i] = newIndex;
+    }
+}
@@ -0,0 +1,163 @@
+﻿#include "rendering/multi_view_culler.hpp"
+
+#include <algorithm>
+#include <bit>
+
+#include "utils/job_system.hpp"
+
+using namespace XnorCore;
+
+namespace
+{
+    constexpr size_t MaskWordBits = 64;
+    constexpr float_t MortonCellCount = 1023.f;
+
+    // Spreads the 10 low bits so that they can be interleaved with two other axes
+    uint32_t SpreadMortonBits(uint32_t value)
+    {
+        value &= 0x3ff;
+        value = (value | value << 16) & 0x030000ff;
+        value = (value | value << 8) & 0x0300f00f;
+        value = (value | value << 4) & 0x030c30c3;
+        value = (value | value << 2) & 0x09249249;
+        return value;
+    }
+
+    uint32_t GetMortonCell(const float_t coordinate, const float_t min, const float_t scale)
+    {
+        return static_cast<uint32_t>(std::clamp((coordinate - min) * scale, 0.f, MortonCellCount));
+    }
+}
+
+void MultiViewCuller::Cull(const std::vector<Frustum>& frusta, const std::vector<Bound>& bounds, const std::vector<uint32_t>& candidates)
+{
+    const size_t viewCount = frusta.size();
+    const size_t chunkCount = (candidates.size() + ChunkSize - 1) / ChunkSize;
+    m_MaskWordCount = (viewCount + MaskWordBits - 1) / MaskWordBits;
+
+    SortCandidates(bounds, candidates);
+
+    m_ChunkMasks.assign(chunkCount * m_MaskWordCount, 0);
+    m_ChunkBoundTests.assign(chunkCount, 0);
+    m_Masks.assign(candidates.size() * m_MaskWordCount, 0);
+
+    // Each chunk writes its own masks, so they can be culled in any order
+    JobSystem::ParallelFor(chunkCount, 1, [&](const size_t first, const size_t last)
+    {
+        for (size_t chunk = first; chunk < last; chunk++)
+            CullChunk(frusta, bounds, candidates, chunk);
+    });
+
+    m_Stats = { .views = viewCount, .candidates = candidates.size(), .chunkTests = chunkCount * viewCount, .boundTests = 0 };
+    for (const size_t boundTests : m_ChunkBoundTests)
+        m_Stats.boundTests += boundTests;
+
+    // The masks are expanded in the order of the candidates, so each list matches what culling the view on its own gives
+    m_Visible.resize(std::max(m_Visible.size(), viewCount));
+    for (std::vector<uint32_t>& visible : m_Visible)
+        visible.clear();
+
+    for (size_t i = 0; i < candidates.size(); i++)
+    {
+        const uint64_t* const mask = &m_Masks[i * m_MaskWordCount];
+
+        for (size_t word = 0; word < m_MaskWordCount; word++)
+        {
+            for (uint64_t bits = mask[word]; bits != 0; bits &= bits - 1)
+                m_Visible[word * MaskWordBits + static_cast<size_t>(std::countr_zero(bits))].push_back(candidates[i]);
+        }
+    }
+}
+
+const std::vector<uint32_t>& MultiViewCuller::GetVisible(const size_t view) const
+{
+    return m_Visible[view];
+}
+
+bool_t MultiViewCuller::IsVisible(const size_t candidate, const size_t view) const
+{
+    return (m_Masks[candidate * m_MaskWordCount + view / MaskWordBits] >> (view % MaskWordBits) & 1) != 0;
+}
+
+const MultiViewCullerStats& MultiViewCuller::GetStats() const
+{
+    return m_Stats;
+}
+
+void MultiViewCuller::SortCandidates(const std::vector<Bound>& bounds, const std::vector<uint32_t>& candidates)
+{
+    m_SortedCandidates.resize(candidates.size());
+    if (candidates.empty())
+        return;
+
+    Vector3 min = bounds[candidates[0]].center;
+    Vector3 max = min;
+    for (const uint32_t index : candidates)
+    {
+        const Vector3& center = bounds[index].center;
+        min = Vector3(std::min(min.x, center.x), std::min(min.y, center.y), std::min(min.z, center.z));
+        max = Vector3(std::max(max.x, center.x), std::max(max.y, center.y), std::max(max.z, center.z));
+    }
+
+    const float_t scaleX = MortonCellCount / std::max(max.x - min.x, 1e-4f);
+    const float_t scaleY = MortonCellCount / std::max(max.y - min.y, 1e-4f);
+    const float_t scaleZ = MortonCellCount / std::max(max.z - min.z, 1e-4f);
+
+    for (size_t i = 0; i < candidates.size(); i++)
+    {
+        const Vector3& center = bounds[candidates[i]].center;
+        const uint32_t code = SpreadMortonBits(GetMortonCell(center.x, min.x, scaleX))
+            | SpreadMortonBits(GetMortonCell(center.y, min.y, scaleY)) << 1
+            | SpreadMortonBits(GetMortonCell(center.z, min.z, scaleZ)) << 2;
+
+        m_SortedCandidates[i] = { code, static_cast<uint32_t>(i) };
+    }
+
+    std::ranges::sort(m_SortedCandidates, [](const SortedCandidate& lhs, const SortedCandidate& rhs)
+    {
+        if (lhs.mortonCode != rhs.mortonCode)
+            return lhs.mortonCode < rhs.mortonCode;
+
+        return lhs.candidate < rhs.candidate;
+    });
+}
+
+void MultiViewCuller::CullChunk(const std::vector<Frustum>& frusta, const std::vector<Bound>& bounds, const std::vector<uint32_t>& candidates, const size_t chunk)
+{
+    const size_t first = chunk * ChunkSize;
+    const size_t last = std::min(first + ChunkSize, m_SortedCandidates.size());
+
+    Bound chunkBound = bounds[candidates[m_SortedCandidates[first].candidate]];
+    for (size_t i = first + 1; i < last; i++)
+        chunkBound.Encapsulate(bounds[candidates[m_SortedCandidates[i].candidate]]);
+
+    uint64_t* const chunkMask = &m_ChunkMasks[chunk * m_MaskWordCount];
+    for (size_t view = 0; view < frusta.size(); view++)
+    {
+        if (frusta[view].IsOnFrustum(chunkBound))
+            chunkMask[view / MaskWordBits] |= 1ull << (view % MaskWordBits);
+    }
+
+    // A bound is only tested against the views its chunk may be seen from
+    size_t boundTests = 0;
+    for (size_t i = first; i < last; i++)
+    {
+        const uint32_t position = m_SortedCandidates[i].candidate;
+        const Bound& bound = bounds[candidates[position]];
+        uint64_t* const mask = &m_Masks[position * m_MaskWordCount];
+
+        for (size_t word = 0; word < m_MaskWordCount; word++)
+        {
+            for (uint64_t bits = chunkMask[word]; bits != 0; bits &= bits - 1)
+            {
+                const size_t bit = static_cast<size_t>(std::countr_zero(bits));
+                boundTests++;
+
+                if (frusta[word * MaskWordBits + bit].IsOnFrustum(bound))
+                    mask[word] |= 1ull << bit;
+            }
+        }
+    }
+
+    m_ChunkBoundTests[chunk] = boundTests;
+}
@@ -0,0 +1,462 @@
+﻿#include "rendering/occlusion_culler.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <xmmintrin.h>
+
+using namespace XnorCore;
+
+namespace
+{
+    constexpr int32_t SimdWidth = 4;
+    // Smallest clip w of a vertex in front of the camera, the triangles and bounds crossing the camera plane can't be projected
+    constexpr float_t MinClipW = 1e-5f;
+    // Keeps an occluder from hiding its own bound because of rounding errors
+    constexpr float_t DepthBias = 1e-5f;
+    // Smallest doubled screen area of a rasterized triangle
+    constexpr float_t MinArea = 1e-6f;
+
+    Vector4 ToScreen(const Vector4& clip)
+    {
+        const float_t inverseW = 1.f / clip.w;
+
+        return Vector4(
+            (clip.x * inverseW * 0.5f + 0.5f) * static_cast<float_t>(OcclusionCuller::Width),
+            (clip.y * inverseW * 0.5f + 0.5f) * static_cast<float_t>(OcclusionCuller::Height),
+            clip.z * inverseW,
+            clip.w
+        );
+    }
+
+    // Plane of a value interpolated over a triangle in screen space, value = x * dx + y * dy + offset
+    struct ScreenPlane
+    {
+        float_t dx;
+        float_t dy;
+        float_t offset;
+    };
+
+    // Twice the signed area, the triangles are rasterized whatever their winding
+    float_t GetDoubleArea(const Vector4& a, const Vector4& b, const Vector4& c)
+    {
+        return (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+    }
+
+    // Weight of the vertex opposite to the edge from a to b, 1 on that vertex and 0 on the edge
+    ScreenPlane GetBarycentricPlane(const Vector4& a, const Vector4& b, const float_t inverseArea)
+    {
+        const float_t dx = (a.y - b.y) * inverseArea;
+        const float_t dy = (b.x - a.x) * inverseArea;
+
+        return { dx, dy, -(dx * a.x + dy * a.y) };
+    }
+
+    // Largest variation of a plane from the center of a pixel to its corners
+    float_t GetHalfPixelVariation(const ScreenPlane& plane)
+    {
+        return 0.5f * (std::abs(plane.dx) + std::abs(plane.dy));
+    }
+}
+
+void OcclusionCuller::Begin(const Matrix& viewProjection)
+{
+    m_ViewProjection = viewProjection;
+    m_Stats = {};
+
+    if (m_Levels.empty())
+    {
+        int32_t width = Width;
+        int32_t height = Height;
+
+        while (true)
+        {
+            DepthLevel& level = m_Levels.emplace_back();
+            level.width = width;
+            level.height = height;
+            level.maxDepth.resize(static_cast<size_t>(width) * static_cast<size_t>(height));
+            level.minDepth.resize(level.maxDepth.size());
+
+            if (width == 1 && height == 1)
+                break;
+
+            width = std::max((width + 1) / 2, 1);
+            height = std::max((height + 1) / 2, 1);
+        }
+    }
+
+    std::ranges::fill(m_Levels[0].maxDepth, FarDepth);
+}
+
+void OcclusionCuller::RasterizeOccluder(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, const Matrix& modelMatrix)
+{
+    const Matrix mvp = m_ViewProjection * modelMatrix;
+
+    m_ScreenVertices.resize(vertices.size());
+    for (size_t i = 0; i < vertices.size(); i++)
+    {
+        const Vector3& position = vertices[i].position;
+        const Vector4 clip = mvp * Vector4(position.x, position.y, position.z, 1.f);
+
+        m_ScreenVertices[i] = clip.w > MinClipW ? ToScreen(clip) : clip;
+    }
+
+    m_Stats.occluders++;
+
+    // Skipping an occluder triangle only hides less, but then it doesn't cover the pixels along the edges it shares
+    const auto isProjected = [&](const size_t i) -> bool_t
+    {
+        const Vector4& a = m_ScreenVertices[indices[i]];
+        const Vector4& b = m_ScreenVertices[indices[i + 1]];
+        const Vector4& c = m_ScreenVertices[indices[i + 2]];
+
+        return a.w > MinClipW && b.w > MinClipW && c.w > MinClipW && std::abs(GetDoubleArea(a, b, c)) >= MinArea;
+    };
+
+    WeldVertices(vertices);
+
+    m_Edges.clear();
+    for (size_t i = 0; i + 2 < indices.size(); i += 3)
+    {
+        if (!isProjected(i))
+            continue;
+
+        for (uint32_t e = 0; e < 3; e++)
+            m_Edges.push_back(GetEdge(indices, i, e));
+    }
+
+    std::ranges::sort(m_Edges, {}, &OccluderEdge::key);
+
+    m_SilhouetteEdges.clear();
+    for (const OccluderEdge& edge : m_Edges)
+    {
+        if (IsInteriorEdge(edge))
+            continue;
+
+        const Vector4& from = m_ScreenVertices[indices[edge.triangle + edge.edge]];
+        const Vector4& to = m_ScreenVertices[indices[edge.triangle + (edge.edge + 1) % 3]];
+        const Vector4& opposite = m_ScreenVertices[indices[edge.triangle + (edge.edge + 2) % 3]];
+        const ScreenPlane plane = GetBarycentricPlane(from, to, 1.f / GetDoubleArea(opposite, from, to));
+
+        m_SilhouetteEdges.push_back(
+            {
+                Vector2(std::min(from.x, to.x), std::min(from.y, to.y)),
+                Vector2(std::max(from.x, to.x), std::max(from.y, to.y)),
+                Vector4(plane.dx, plane.dy, plane.offset, GetHalfPixelVariation(plane))
+            }
+        );
+    }
+
+    for (size_t i = 0; i + 2 < indices.size(); i += 3)
+    {
+        if (!isProjected(i))
+            continue;
+
+        uint32_t interiorEdges = 0;
+        for (uint32_t e = 0; e < 3; e++)
+        {
+            if (IsInteriorEdge(GetEdge(indices, i, e)))
+                interiorEdges |= 1u << e;
+        }
+
+        const Vector4& a = m_ScreenVertices[indices[i]];
+        const Vector4& b = m_ScreenVertices[indices[i + 1]];
+        const Vector4& c = m_ScreenVertices[indices[i + 2]];
+
+        // A pixel crossing an interior edge is covered by the triangles around, unless the silhouette goes through it.
+        // The silhouette edges are tested as whole lines, which only drops more pixels around the concave parts of the silhouette
+        m_SilhouettePlanes.clear();
+        if (interiorEdges != 0)
+        {
+            const Vector2 min(std::min({ a.x, b.x, c.x }) - 1.f, std::min({ a.y, b.y, c.y }) - 1.f);
+            const Vector2 max(std::max({ a.x, b.x, c.x }) + 1.f, std::max({ a.y, b.y, c.y }) + 1.f);
+
+            for (const SilhouetteEdge& edge : m_SilhouetteEdges)
+            {
+                if (edge.max.x >= min.x && edge.min.x <= max.x && edge.max.y >= min.y && edge.min.y <= max.y)
+                    m_SilhouettePlanes.push_back(edge.plane);
+            }
+        }
+
+        RasterizeTriangle(a, b, c, interiorEdges, m_SilhouettePlanes);
+    }
+}
+
+void OcclusionCuller::End()
+{
+    DepthLevel& fullResolution = m_Levels[0];
+    fullResolution.minDepth = fullResolution.maxDepth;
+
+    for (size_t l = 1; l < m_Levels.size(); l++)
+    {
+        const DepthLevel& source = m_Levels[l - 1];
+        DepthLevel& level = m_Levels[l];
+
+        for (int32_t y = 0; y < level.height; y++)
+        {
+            const int32_t y0 = y * 2;
+            const int32_t y1 = std::min(y0 + 1, source.height - 1);
+
+            for (int32_t x = 0; x < level.width; x++)
+            {
+                const int32_t x0 = x * 2;
+                const int32_t x1 = std::min(x0 + 1, source.width - 1);
+
+                const size_t i00 = static_cast<size_t>(y0 * source.width + x0);
+                const size_t i01 = static_cast<size_t>(y0 * source.width + x1);
+                const size_t i10 = static_cast<size_t>(y1 * source.width + x0);
+                const size_t i11 = static_cast<size_t>(y1 * source.width + x1);
+                const size_t i = static_cast<size_t>(y * level.width + x);
+
+                level.minDepth[i] = std::min({ source.minDepth[i00], source.minDepth[i01], source.minDepth[i10], source.minDepth[i11] });
+                level.maxDepth[i] = std::max({ source.maxDepth[i00], source.maxDepth[i01], source.maxDepth[i10], source.maxDepth[i11] });
+            }
+        }
+    }
+}
+
+bool_t OcclusionCuller::IsOccluded(const Bound& bound) const
+{
+    const Vector3 min = bound.GetMin();
+    const Vector3 max = bound.GetMax();
+
+    Vector3 screenMin = Vector3(std::numeric_limits<float_t>::max());
+    Vector3 screenMax = Vector3(std::numeric_limits<float_t>::lowest());
+
+    for (uint32_t i = 0; i < 8; i++)
+    {
+        const Vector4 corner = Vector4(i & 1 ? max.x : min.x, i & 2 ? max.y : min.y, i & 4 ? max.z : min.z, 1.f);
+        const Vector4 clip = m_ViewProjection * corner;
+
+        if (clip.w <= MinClipW)
+            return false;
+
+        const Vector4 screen = ToScreen(clip);
+        screenMin = Vector3(std::min(screenMin.x, screen.x), std::min(screenMin.y, screen.y), std::min(screenMin.z, screen.z));
+        screenMax = Vector3(std::max(screenMax.x, screen.x), std::max(screenMax.y, screen.y), std::max(screenMax.z, screen.z));
+    }
+
+    // Out of the view, the frustum culling handles it
+    if (screenMax.x < 0.f || screenMax.y < 0.f || screenMin.x >= static_cast<float_t>(Width) || screenMin.y >= static_cast<float_t>(Height))
+        return false;
+
+    const Vector2i pixelMin = Vector2i(
+        static_cast<int32_t>(std::clamp(std::floor(screenMin.x), 0.f, static_cast<float_t>(Width - 1))),
+        static_cast<int32_t>(std::clamp(std::floor(screenMin.y), 0.f, static_cast<float_t>(Height - 1)))
+    );
+    const Vector2i pixelMax = Vector2i(
+        static_cast<int32_t>(std::clamp(std::floor(screenMax.x), 0.f, static_cast<float_t>(Width - 1))),
+        static_cast<int32_t>(std::clamp(std::floor(screenMax.y), 0.f, static_cast<float_t>(Height - 1)))
+    );
+
+    // Coarsest level where the rectangle spans at most 2 by 2 texels
+    size_t level = 0;
+    while (level + 1 < m_Levels.size() && ((pixelMax.x >> level) - (pixelMin.x >> level) > 1 || (pixelMax.y >> level) - (pixelMin.y >> level) > 1))
+        level++;
+
+    for (int32_t y = pixelMin.y >> level; y <= pixelMax.y >> level; y++)
+    {
+        for (int32_t x = pixelMin.x >> level; x <= pixelMax.x >> level; x++)
+        {
+            if (!IsTexelOccluded(level, x, y, pixelMin, pixelMax, screenMin.z, screenMax.z))
+                return false;
+        }
+    }
+
+    return true;
+}
+
+float_t OcclusionCuller::GetDepth(const int32_t x, const int32_t y) const
+{
+    return m_Levels[0].maxDepth[static_cast<size_t>(y * Width + x)];
+}
+
+size_t OcclusionCuller::GetLevelCount() const
+{
+    return m_Levels.size();
+}
+
+const OcclusionCullerStats& OcclusionCuller::GetStats() const
+{
+    return m_Stats;
+}
+
+void OcclusionCuller::WeldVertices(const std::vector<Vertex>& vertices)
+{
+    // The vertices are split for their normals or uvs, the edges are matched on the positions
+    m_SortedVertices.resize(vertices.size());
+    for (size_t i = 0; i < vertices.size(); i++)
+        m_SortedVertices[i] = static_cast<uint32_t>(i);
+
+    std::ranges::sort(m_SortedVertices, [&](const uint32_t lhs, const uint32_t rhs)
+    {
+        const Vector3& a = vertices[lhs].position;
+        const Vector3& b = vertices[rhs].position;
+
+        if (a.x != b.x)
+            return a.x < b.x;
+        if (a.y != b.y)
+            return a.y < b.y;
+
+        return a.z < b.z;
+    });
+
+    m_PositionIds.resize(vertices.size());
+    for (size_t i = 0; i < m_SortedVertices.size(); i++)
+    {
+        const uint32_t vertex = m_SortedVertices[i];
+        const bool_t isNewPosition = i == 0 || vertices[m_SortedVertices[i - 1]].position != vertices[vertex].position;
+
+        m_PositionIds[vertex] = isNewPosition ? vertex : m_PositionIds[m_SortedVertices[i - 1]];
+    }
+}
+
+OcclusionCuller::OccluderEdge OcclusionCuller::GetEdge(const std::vector<uint32_t>& indices, const size_t triangle, const uint32_t edge) const
+{
+    const uint32_t fromId = m_PositionIds[indices[triangle + edge]];
+    const uint32_t toId = m_PositionIds[indices[triangle + (edge + 1) % 3]];
+    const uint32_t minId = std::min(fromId, toId);
+    const uint32_t maxId = std::max(fromId, toId);
+
+    const Vector4& start = m_ScreenVertices[minId];
+    const Vector4& end = m_ScreenVertices[maxId];
+    const Vector4& opposite = m_ScreenVertices[indices[triangle + (edge + 2) % 3]];
+
+    return { static_cast<uint64_t>(minId) << 32 | maxId, triangle, edge, GetDoubleArea(start, end, opposite) > 0.f };
+}
+
+bool_t OcclusionCuller::IsInteriorEdge(const OccluderEdge& edge) const
+{
+    // On a silhouette, both triangles are on the same side of the edge
+    const auto range = std::ranges::equal_range(m_Edges, edge.key, {}, &OccluderEdge::key);
+
+    return std::ranges::any_of(range, [&](const OccluderEdge& other) { return other.isLeft != edge.isLeft; });
+}
+
+void OcclusionCuller::RasterizeTriangle(
+    const Vector4& a,
+    const Vector4& b,
+    const Vector4& c,
+    const uint32_t interiorEdges,
+    const std::vector<Vector4>& silhouettePlanes
+)
+{
+    const float_t area = GetDoubleArea(a, b, c);
+    if (std::abs(area) < MinArea)
+        return;
+
+    const float_t minX = std::min({ a.x, b.x, c.x });
+    const float_t maxX = std::max({ a.x, b.x, c.x });
+    const float_t minY = std::min({ a.y, b.y, c.y });
+    const float_t maxY = std::max({ a.y, b.y, c.y });
+
+    if (maxX < 0.f || maxY < 0.f || minX >= static_cast<float_t>(Width) || minY >= static_cast<float_t>(Height))
+        return;
+
+    m_Stats.rasterizedTriangles++;
+
+    // The rows start on a SIMD boundary, the width is a multiple of the SIMD width so the last group never overflows
+    const int32_t pixelMinX = static_cast<int32_t>(std::clamp(std::floor(minX), 0.f, static_cast<float_t>(Width - 1))) & ~(SimdWidth - 1);
+    const int32_t pixelMaxX = static_cast<int32_t>(std::clamp(std::floor(maxX), 0.f, static_cast<float_t>(Width - 1)));
+    const int32_t pixelMinY = static_cast<int32_t>(std::clamp(std::floor(minY), 0.f, static_cast<float_t>(Height - 1)));
+    const int32_t pixelMaxY = static_cast<int32_t>(std::clamp(std::floor(maxY), 0.f, static_cast<float_t>(Height - 1)));
+
+    const float_t inverseArea = 1.f / area;
+    const ScreenPlane weightA = GetBarycentricPlane(b, c, inverseArea);
+    const ScreenPlane weightB = GetBarycentricPlane(c, a, inverseArea);
+    const ScreenPlane weightC = GetBarycentricPlane(a, b, inverseArea);
+
+    // The normalized device z is linear in screen space
+    const ScreenPlane depth =
+    {
+        weightA.dx * a.z + weightB.dx * b.z + weightC.dx * c.z,
+        weightA.dy * a.z + weightB.dy * b.z + weightC.dy * c.z,
+        weightA.offset * a.z + weightB.offset * b.z + weightC.offset * c.z
+    };
+
+    // A pixel is entirely on the inner side of an edge if the weight is at least its variation from the center to a corner.
+    // The weights of a, b and c vanish on the edges b -> c, c -> a and a -> b
+    const float_t minWeightA = interiorEdges & 2 ? 0.f : GetHalfPixelVariation(weightA);
+    const float_t minWeightB = interiorEdges & 4 ? 0.f : GetHalfPixelVariation(weightB);
+    const float_t minWeightC = interiorEdges & 1 ? 0.f : GetHalfPixelVariation(weightC);
+
+    // The farthest depth of the triangle over the pixel, so that it doesn't hide what is visible in a part of the pixel
+    const float_t depthOffset = depth.offset + GetHalfPixelVariation(depth);
+
+    // Pixel centers of a group, relative to its first pixel
+    const __m128 laneOffsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+
+    for (int32_t y = pixelMinY; y <= pixelMaxY; y++)
+    {
+        const float_t centerY = static_cast<float_t>(y) + 0.5f;
+        float_t* const row = &m_Levels[0].maxDepth[static_cast<size_t>(y * Width)];
+
+        for (int32_t x = pixelMinX; x <= pixelMaxX; x += SimdWidth)
+        {
+            const __m128 centerX = _mm_add_ps(_mm_set1_ps(static_cast<float_t>(x)), laneOffsets);
+
+            const __m128 a0 = _mm_add_ps(_mm_mul_ps(centerX, _mm_set1_ps(weightA.dx)), _mm_set1_ps(weightA.dy * centerY + weightA.offset));
+            const __m128 b0 = _mm_add_ps(_mm_mul_ps(centerX, _mm_set1_ps(weightB.dx)), _mm_set1_ps(weightB.dy * centerY + weightB.offset));
+            const __m128 c0 = _mm_add_ps(_mm_mul_ps(centerX, _mm_set1_ps(weightC.dx)), _mm_set1_ps(weightC.dy * centerY + weightC.offset));
+
+            __m128 inside = _mm_and_ps(
+                _mm_and_ps(_mm_cmpge_ps(a0, _mm_set1_ps(minWeightA)), _mm_cmpge_ps(b0, _mm_set1_ps(minWeightB))),
+                _mm_cmpge_ps(c0, _mm_set1_ps(minWeightC))
+            );
+
+            for (const Vector4& plane : silhouettePlanes)
+            {
+                const __m128 weight = _mm_add_ps(_mm_mul_ps(centerX, _mm_set1_ps(plane.x)), _mm_set1_ps(plane.y * centerY + plane.z));
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(weight, _mm_set1_ps(plane.w)));
+            }
+
+            if (_mm_movemask_ps(inside) == 0)
+                continue;
+
+            const __m128 pixelDepth = _mm_add_ps(_mm_mul_ps(centerX, _mm_set1_ps(depth.dx)), _mm_set1_ps(depth.dy * centerY + depthOffset));
+            const __m128 stored = _mm_loadu_ps(row + x);
+            const __m128 closest = _mm_min_ps(stored, pixelDepth);
+
+            _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, closest), _mm_andnot_ps(inside, stored)));
+        }
+    }
+}
+
+bool_t OcclusionCuller::IsTexelOccluded(
+    const size_t level,
+    const int32_t x,
+    const int32_t y,
+    const Vector2i pixelMin,
+    const Vector2i pixelMax,
+    const float_t minZ,
+    const float_t maxZ
+) const
+{
+    const DepthLevel& depthLevel = m_Levels[level];
+    const size_t i = static_cast<size_t>(y * depthLevel.width + x);
+
+    // Behind every occluder of the texel
+    if (minZ > depthLevel.maxDepth[i] + DepthBias)
+        return true;
+
+    // In front of every occluder of the texel, or at full resolution where both depths are the same
+    if (level == 0 || maxZ < depthLevel.minDepth[i])
+        return false;
+
+    const size_t childLevel = level - 1;
+    const DepthLevel& children = m_Levels[childLevel];
+    const int32_t childMinX = std::max(x * 2, pixelMin.x >> childLevel);
+    const int32_t childMaxX = std::min({ x * 2 + 1, pixelMax.x >> childLevel, children.width - 1 });
+    const int32_t childMinY = std::max(y * 2, pixelMin.y >> childLevel);
+    const int32_t childMaxY = std::min({ y * 2 + 1, pixelMax.y >> childLevel, children.height - 1 });
+
+    for (int32_t childY = childMinY; childY <= childMaxY; childY++)
+    {
+        for (int32_t childX = childMinX; childX <= childMaxX; childX++)
+        {
+            if (!IsTexelOccluded(childLevel, childX, childY, pixelMin, pixelMax, minZ, maxZ))
+                return false;
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,106 @@
+#include "rendering/pose.hpp"
+
+#include <algorithm>
+
+using namespace XnorCore;
+
+Pose::Pose(const size_t boneCount)
+{
+    Resize(boneCount);
+}
+
+size_t Pose::GetPaddedCount(const size_t boneCount)
+{
+    return (boneCount + SimdWidth - 1) / SimdWidth * SimdWidth;
+}
+
+void Pose::Resize(const size_t boneCount)
+{
+    const size_t paddedCount = GetPaddedCount(boneCount);
+
+    if (paddedCount > m_Translations[0].GetSize())
+    {
+        for (List<float_t>& translation : m_Translations)
+            translation.Resize(paddedCount);
+
+        for (List<float_t>& rotation : m_Rotations)
+            rotation.Resize(paddedCount);
+    }
+
+    // The storage is kept when the pose shrinks, so the lanes past the bones may hold the transforms of a previous bigger pose.
+    // They are reset so the padding is identity and so bones added later don't start from stale transforms
+    const size_t firstReset = std::min(m_BoneCount, boneCount);
+
+    for (List<float_t>& translation : m_Translations)
+    {
+        for (size_t i = firstReset; i < paddedCount; i++)
+            translation[i] = 0.f;
+    }
+
+    // Only w is 1 for an identity rotation
+    for (size_t i = 0; i < RotationComponents; i++)
+    {
+        const float_t identity = i == 3 ? 1.f : 0.f;
+        List<float_t>& rotation = m_Rotations[i];
+
+        for (size_t j = firstReset; j < paddedCount; j++)
+            rotation[j] = identity;
+    }
+
+    m_BoneCount = boneCount;
+}
+
+size_t Pose::GetBoneCount() const
+{
+    return m_BoneCount;
+}
+
+size_t Pose::GetPaddedBoneCount() const
+{
+    return GetPaddedCount(m_BoneCount);
+}
+
+void Pose::SetTranslation(const size_t bone, const Vector3& translation)
+{
+    m_Translations[0][bone] = translation.x;
+    m_Translations[1][bone] = translation.y;
+    m_Translations[2][bone] = translation.z;
+}
+
+Vector3 Pose::GetTranslation(const size_t bone) const
+{
+    return Vector3(m_Translations[0][bone], m_Translations[1][bone], m_Translations[2][bone]);
+}
+
+void Pose::SetRotation(const size_t bone, const Quaternion& rotation)
+{
+    m_Rotations[0][bone] = rotation.X();
+    m_Rotations[1][bone] = rotation.Y();
+    m_Rotations[2][bone] = rotation.Z();
+    m_Rotations[3][bone] = rotation.W();
+}
+
+Quaternion Pose::GetRotation(const size_t bone) const
+{
+    return Quaternion(m_Rotations[0][bone], m_Rotations[1][bone], m_Rotations[2][bone], m_Rotations[3][bone]);
+}
+
+float_t* Pose::GetTranslations(const size_t component)
+{
+    return m_Translations[component].GetData();
+}
+
+const float_t* Pose::GetTranslations(const size_t component) const
+{
+    return m_Translations[component].GetData();
+}
+
+float_t* Pose::GetRotations(const size_t component)
+{
+    return m_Rotations[component].GetData();
+}
+
+const float_t* Pose::GetRotations(const size_t component) const
+{
+    return m_Rotations[component].GetData();
+}
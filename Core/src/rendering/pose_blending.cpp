@@ -0,0 +1,329 @@
+#include "rendering/pose_blending.hpp"
+
+#include <algorithm>
+#include <xmmintrin.h>
+
+#include "rendering/bone_mask.hpp"
+#include "rendering/pose.hpp"
+
+using namespace XnorCore;
+
+namespace
+{
+    /// @brief Rotations of Pose::SimdWidth bones, one register per component
+    struct RotationLanes
+    {
+        __m128 x;
+        __m128 y;
+        __m128 z;
+        __m128 w;
+    };
+
+    __m128 Lerp(const __m128 a, const __m128 b, const __m128 t)
+    {
+        return _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), t));
+    }
+
+    __m128 Dot(const RotationLanes& a, const RotationLanes& b)
+    {
+        const __m128 xy = _mm_add_ps(_mm_mul_ps(a.x, b.x), _mm_mul_ps(a.y, b.y));
+        const __m128 zw = _mm_add_ps(_mm_mul_ps(a.z, b.z), _mm_mul_ps(a.w, b.w));
+
+        return _mm_add_ps(xy, zw);
+    }
+
+    /// @brief Negates the lanes whose mask is set
+    RotationLanes Negate(const RotationLanes& q, const __m128 mask)
+    {
+        const __m128 sign = _mm_and_ps(mask, _mm_set1_ps(-0.f));
+
+        return { _mm_xor_ps(q.x, sign), _mm_xor_ps(q.y, sign), _mm_xor_ps(q.z, sign), _mm_xor_ps(q.w, sign) };
+    }
+
+    RotationLanes Normalize(const RotationLanes& q)
+    {
+        // A full precision square root is used because the approximate reciprocal one drifts after a few blends
+        const __m128 inverseLength = _mm_div_ps(_mm_set1_ps(1.f), _mm_sqrt_ps(_mm_max_ps(Dot(q, q), _mm_set1_ps(1e-12f))));
+
+        return { _mm_mul_ps(q.x, inverseLength), _mm_mul_ps(q.y, inverseLength), _mm_mul_ps(q.z, inverseLength), _mm_mul_ps(q.w, inverseLength) };
+    }
+
+    RotationLanes Nlerp(const RotationLanes& a, const RotationLanes& b, const __m128 t)
+    {
+        // q and -q are the same rotation, interpolating towards the one closest to a takes the shortest path
+        const RotationLanes closest = Negate(b, _mm_cmplt_ps(Dot(a, b), _mm_setzero_ps()));
+
+        return Normalize({ Lerp(a.x, closest.x, t), Lerp(a.y, closest.y, t), Lerp(a.z, closest.z, t), Lerp(a.w, closest.w, t) });
+    }
+
+    /// @brief Hamilton product, same convention as the Quaternion multiplication
+    RotationLanes Multiply(const RotationLanes& a, const RotationLanes& b)
+    {
+        return
+        {
+            _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(a.w, b.x), _mm_mul_ps(a.x, b.w)), _mm_mul_ps(a.y, b.z)), _mm_mul_ps(a.z, b.y)),
+            _mm_add_ps(_mm_sub_ps(_mm_mul_ps(a.w, b.y), _mm_mul_ps(a.x, b.z)), _mm_add_ps(_mm_mul_ps(a.y, b.w), _mm_mul_ps(a.z, b.x))),
+            _mm_add_ps(_mm_sub_ps(_mm_add_ps(_mm_mul_ps(a.w, b.z), _mm_mul_ps(a.x, b.y)), _mm_mul_ps(a.y, b.x)), _mm_mul_ps(a.z, b.w)),
+            _mm_sub_ps(_mm_sub_ps(_mm_sub_ps(_mm_mul_ps(a.w, b.w), _mm_mul_ps(a.x, b.x)), _mm_mul_ps(a.y, b.y)), _mm_mul_ps(a.z, b.z))
+        };
+    }
+
+    /// @brief Rotates vectors by rotations, v + w * t + q x t with t = 2 * q x v
+    void Rotate(const RotationLanes& q, const __m128 (&v)[Pose::TranslationComponents], __m128 (&result)[Pose::TranslationComponents])
+    {
+        const __m128 two = _mm_set1_ps(2.f);
+        const __m128 tx = _mm_mul_ps(two, _mm_sub_ps(_mm_mul_ps(q.y, v[2]), _mm_mul_ps(q.z, v[1])));
+        const __m128 ty = _mm_mul_ps(two, _mm_sub_ps(_mm_mul_ps(q.z, v[0]), _mm_mul_ps(q.x, v[2])));
+        const __m128 tz = _mm_mul_ps(two, _mm_sub_ps(_mm_mul_ps(q.x, v[1]), _mm_mul_ps(q.y, v[0])));
+
+        result[0] = _mm_add_ps(_mm_add_ps(v[0], _mm_mul_ps(q.w, tx)), _mm_sub_ps(_mm_mul_ps(q.y, tz), _mm_mul_ps(q.z, ty)));
+        result[1] = _mm_add_ps(_mm_add_ps(v[1], _mm_mul_ps(q.w, ty)), _mm_sub_ps(_mm_mul_ps(q.z, tx), _mm_mul_ps(q.x, tz)));
+        result[2] = _mm_add_ps(_mm_add_ps(v[2], _mm_mul_ps(q.w, tz)), _mm_sub_ps(_mm_mul_ps(q.x, ty), _mm_mul_ps(q.y, tx)));
+    }
+
+    /// @brief Scalar version of the model-space transform of a single bone
+    void ComputeModelBone(const Pose& local, const int32_t parent, const size_t bone, Pose* const model)
+    {
+        if (parent == -1)
+        {
+            model->SetTranslation(bone, local.GetTranslation(bone));
+            model->SetRotation(bone, local.GetRotation(bone));
+            return;
+        }
+
+        const Quaternion parentRotation = model->GetRotation(static_cast<size_t>(parent));
+
+        model->SetTranslation(bone, model->GetTranslation(static_cast<size_t>(parent)) + Quaternion::Rotate(local.GetTranslation(bone), parentRotation));
+        model->SetRotation(bone, (parentRotation * local.GetRotation(bone)).Normalized());
+    }
+
+    RotationLanes LoadRotations(const Pose& pose, const size_t bone)
+    {
+        return
+        {
+            _mm_loadu_ps(pose.GetRotations(0) + bone),
+            _mm_loadu_ps(pose.GetRotations(1) + bone),
+            _mm_loadu_ps(pose.GetRotations(2) + bone),
+            _mm_loadu_ps(pose.GetRotations(3) + bone)
+        };
+    }
+
+    void StoreRotations(Pose* const pose, const size_t bone, const RotationLanes& rotations)
+    {
+        _mm_storeu_ps(pose->GetRotations(0) + bone, rotations.x);
+        _mm_storeu_ps(pose->GetRotations(1) + bone, rotations.y);
+        _mm_storeu_ps(pose->GetRotations(2) + bone, rotations.z);
+        _mm_storeu_ps(pose->GetRotations(3) + bone, rotations.w);
+    }
+
+    const float_t* GetMaskWeights(const BoneMask* const mask, const size_t boneCount)
+    {
+        if (mask == nullptr || mask->GetBoneCount() < boneCount)
+            return nullptr;
+
+        return mask->GetWeights();
+    }
+
+    __m128 LoadWeights(const __m128 weight, const float_t* const maskWeights, const size_t bone)
+    {
+        if (maskWeights == nullptr)
+            return weight;
+
+        return _mm_mul_ps(weight, _mm_loadu_ps(maskWeights + bone));
+    }
+}
+
+void PoseBlending::Blend(const Pose& a, const Pose& b, const float_t weight, const BoneMask* const mask, Pose* const result)
+{
+    const size_t boneCount = a.GetBoneCount();
+    result->Resize(boneCount);
+
+    const size_t paddedCount = a.GetPaddedBoneCount();
+    const float_t* const maskWeights = GetMaskWeights(mask, boneCount);
+    const __m128 globalWeight = _mm_set1_ps(weight);
+
+    for (size_t i = 0; i < paddedCount; i += Pose::SimdWidth)
+    {
+        const __m128 t = LoadWeights(globalWeight, maskWeights, i);
+
+        for (size_t j = 0; j < Pose::TranslationComponents; j++)
+        {
+            const __m128 blended = Lerp(_mm_loadu_ps(a.GetTranslations(j) + i), _mm_loadu_ps(b.GetTranslations(j) + i), t);
+            _mm_storeu_ps(result->GetTranslations(j) + i, blended);
+        }
+
+        StoreRotations(result, i, Nlerp(LoadRotations(a, i), LoadRotations(b, i), t));
+    }
+}
+
+void PoseBlending::BlendAdditive(const Pose& base, const Pose& additive, const float_t weight, const BoneMask* const mask, Pose* const result)
+{
+    const size_t boneCount = base.GetBoneCount();
+    result->Resize(boneCount);
+
+    const size_t paddedCount = base.GetPaddedBoneCount();
+    const float_t* const maskWeights = GetMaskWeights(mask, boneCount);
+    const __m128 globalWeight = _mm_set1_ps(weight);
+
+    const RotationLanes identity = { _mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps(), _mm_set1_ps(1.f) };
+
+    for (size_t i = 0; i < paddedCount; i += Pose::SimdWidth)
+    {
+        const __m128 t = LoadWeights(globalWeight, maskWeights, i);
+
+        for (size_t j = 0; j < Pose::TranslationComponents; j++)
+        {
+            const __m128 offset = _mm_mul_ps(_mm_loadu_ps(additive.GetTranslations(j) + i), t);
+            _mm_storeu_ps(result->GetTranslations(j) + i, _mm_add_ps(_mm_loadu_ps(base.GetTranslations(j) + i), offset));
+        }
+
+        // Scale the additive rotation by interpolating it from the identity
+        const RotationLanes delta = Nlerp(identity, LoadRotations(additive, i), t);
+        StoreRotations(result, i, Normalize(Multiply(LoadRotations(base, i), delta)));
+    }
+}
+
+void PoseBlending::BlendWeighted(const Pose* const* const poses, const float_t* const weights, const size_t poseCount, Pose* const result)
+{
+    if (poseCount == 0)
+        return;
+
+    float_t totalWeight = 0.f;
+    for (size_t i = 0; i < poseCount; i++)
+        totalWeight += weights[i];
+
+    const Pose& first = *poses[0];
+    const size_t boneCount = first.GetBoneCount();
+
+    // Without any weight there is nothing to blend, the first pose is used as is
+    if (totalWeight <= 0.f)
+    {
+        Blend(first, first, 0.f, nullptr, result);
+        return;
+    }
+
+    result->Resize(boneCount);
+
+    const size_t paddedCount = first.GetPaddedBoneCount();
+    const float_t inverseTotalWeight = 1.f / totalWeight;
+
+    for (size_t i = 0; i < paddedCount; i += Pose::SimdWidth)
+    {
+        __m128 translations[Pose::TranslationComponents] = { _mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps() };
+        RotationLanes rotation = { _mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps() };
+
+        const RotationLanes reference = LoadRotations(first, i);
+
+        for (size_t j = 0; j < poseCount; j++)
+        {
+            const __m128 weight = _mm_set1_ps(weights[j] * inverseTotalWeight);
+
+            for (size_t k = 0; k < Pose::TranslationComponents; k++)
+                translations[k] = _mm_add_ps(translations[k], _mm_mul_ps(_mm_loadu_ps(poses[j]->GetTranslations(k) + i), weight));
+
+            // Every rotation is brought in the hemisphere of the first one before being accumulated
+            RotationLanes current = LoadRotations(*poses[j], i);
+            current = Negate(current, _mm_cmplt_ps(Dot(reference, current), _mm_setzero_ps()));
+
+            rotation.x = _mm_add_ps(rotation.x, _mm_mul_ps(current.x, weight));
+            rotation.y = _mm_add_ps(rotation.y, _mm_mul_ps(current.y, weight));
+            rotation.z = _mm_add_ps(rotation.z, _mm_mul_ps(current.z, weight));
+            rotation.w = _mm_add_ps(rotation.w, _mm_mul_ps(current.w, weight));
+        }
+
+        for (size_t k = 0; k < Pose::TranslationComponents; k++)
+            _mm_storeu_ps(result->GetTranslations(k) + i, translations[k]);
+
+        StoreRotations(result, i, Normalize(rotation));
+    }
+}
+
+void PoseBlending::ComputeAdditive(const Pose& pose, const Pose& reference, Pose* const result)
+{
+    const size_t boneCount = pose.GetBoneCount();
+    result->Resize(boneCount);
+
+    const size_t paddedCount = pose.GetPaddedBoneCount();
+
+    for (size_t i = 0; i < paddedCount; i += Pose::SimdWidth)
+    {
+        for (size_t j = 0; j < Pose::TranslationComponents; j++)
+        {
+            const __m128 difference = _mm_sub_ps(_mm_loadu_ps(pose.GetTranslations(j) + i), _mm_loadu_ps(reference.GetTranslations(j) + i));
+            _mm_storeu_ps(result->GetTranslations(j) + i, difference);
+        }
+
+        // The inverse of a normalized rotation is its conjugate
+        RotationLanes inverseReference = LoadRotations(reference, i);
+        const __m128 sign = _mm_set1_ps(-0.f);
+        inverseReference.x = _mm_xor_ps(inverseReference.x, sign);
+        inverseReference.y = _mm_xor_ps(inverseReference.y, sign);
+        inverseReference.z = _mm_xor_ps(inverseReference.z, sign);
+
+        StoreRotations(result, i, Normalize(Multiply(inverseReference, LoadRotations(pose, i))));
+    }
+}
+
+void PoseBlending::ComputeModelPose(const Pose& local, const int32_t* const parents, Pose* const model)
+{
+    const size_t boneCount = local.GetBoneCount();
+    model->Resize(boneCount);
+
+    const size_t paddedCount = local.GetPaddedBoneCount();
+
+    for (size_t i = 0; i < paddedCount; i += Pose::SimdWidth)
+    {
+        const size_t laneCount = std::min(Pose::SimdWidth, boneCount - i);
+
+        // A bone whose parent is in the same group needs the parent result first, so the group is done bone by bone
+        bool_t independent = true;
+        for (size_t j = 0; j < laneCount; j++)
+            independent &= parents[i + j] < static_cast<int32_t>(i);
+
+        if (!independent)
+        {
+            for (size_t j = 0; j < laneCount; j++)
+                ComputeModelBone(local, parents[i + j], i + j, model);
+            continue;
+        }
+
+        // Roots and padding lanes get an identity parent
+        alignas(16) float_t parentTranslations[Pose::TranslationComponents][Pose::SimdWidth] = {};
+        alignas(16) float_t parentRotations[Pose::RotationComponents][Pose::SimdWidth] = {};
+
+        for (size_t j = 0; j < Pose::SimdWidth; j++)
+        {
+            const int32_t parent = j < laneCount ? parents[i + j] : -1;
+            if (parent == -1)
+            {
+                parentRotations[3][j] = 1.f;
+                continue;
+            }
+
+            for (size_t k = 0; k < Pose::TranslationComponents; k++)
+                parentTranslations[k][j] = model->GetTranslations(k)[parent];
+            for (size_t k = 0; k < Pose::RotationComponents; k++)
+                parentRotations[k][j] = model->GetRotations(k)[parent];
+        }
+
+        const RotationLanes parentRotation =
+        {
+            _mm_load_ps(parentRotations[0]),
+            _mm_load_ps(parentRotations[1]),
+            _mm_load_ps(parentRotations[2]),
+            _mm_load_ps(parentRotations[3])
+        };
+
+        __m128 translation[Pose::TranslationComponents];
+        for (size_t k = 0; k < Pose::TranslationComponents; k++)
+            translation[k] = _mm_loadu_ps(local.GetTranslations(k) + i);
+
+        __m128 rotated[Pose::TranslationComponents];
+        Rotate(parentRotation, translation, rotated);
+
+        for (size_t k = 0; k < Pose::TranslationComponents; k++)
+            _mm_storeu_ps(model->GetTranslations(k) + i, _mm_add_ps(_mm_load_ps(parentTranslations[k]), rotated[k]));
+
+        StoreRotations(model, i, Normalize(Multiply(parentRotation, LoadRotations(local, i))));
+    }
+}
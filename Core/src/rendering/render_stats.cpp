@@ -0,0 +1,170 @@
+﻿#include "rendering/render_stats.hpp"
+
+#include <algorithm>
+#include <format>
+#include <fstream>
+
+#include "utils/logger.hpp"
+
+using namespace XnorCore;
+
+namespace
+{
+    void AppendCounters(std::string* const json, const RenderCounters& counters)
+    {
+        *json += std::format(
+            "\"drawCalls\": {}, \"triangles\": {}, \"stateChanges\": {}, \"shaderBinds\": {}, \"textureBinds\": {}, \"bufferUploads\": {}, \"uploadedBytes\": {}",
+            counters.drawCalls,
+            counters.triangles,
+            counters.stateChanges,
+            counters.shaderBinds,
+            counters.textureBinds,
+            counters.bufferUploads,
+            counters.uploadedBytes
+        );
+    }
+}
+
+void RenderStats::AddDrawCall(const uint64_t triangleCount)
+{
+    m_Counters.drawCalls.fetch_add(1, std::memory_order_relaxed);
+    m_Counters.triangles.fetch_add(triangleCount, std::memory_order_relaxed);
+}
+
+void RenderStats::AddStateChange()
+{
+    m_Counters.stateChanges.fetch_add(1, std::memory_order_relaxed);
+}
+
+void RenderStats::AddShaderBind()
+{
+    m_Counters.shaderBinds.fetch_add(1, std::memory_order_relaxed);
+}
+
+void RenderStats::AddTextureBind()
+{
+    m_Counters.textureBinds.fetch_add(1, std::memory_order_relaxed);
+}
+
+void RenderStats::AddBufferUpload(const size_t size)
+{
+    m_Counters.bufferUploads.fetch_add(1, std::memory_order_relaxed);
+    m_Counters.uploadedBytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+void RenderStats::BeginPass(const char_t* const name)
+{
+    Flush();
+
+    std::vector<PassRenderStats>& passes = m_CurrentFrame.passes;
+    const auto&& it = std::ranges::find(passes, std::string_view(name), &PassRenderStats::name);
+
+    if (it == passes.end())
+    {
+        m_PassStack.push_back(passes.size());
+        passes.emplace_back().name = name;
+    }
+    else
+    {
+        m_PassStack.push_back(static_cast<size_t>(it - passes.begin()));
+    }
+}
+
+void RenderStats::EndPass()
+{
+    Flush();
+
+    if (!m_PassStack.empty())
+        m_PassStack.pop_back();
+}
+
+void RenderStats::EndFrame()
+{
+    Flush();
+
+    if (!m_PassStack.empty())
+    {
+        Logger::LogWarning("Render pass {} didn't end before the end of the frame", m_CurrentFrame.passes[m_PassStack.back()].name);
+        m_PassStack.clear();
+    }
+
+    m_CurrentFrame.total = {};
+    for (const PassRenderStats& pass : m_CurrentFrame.passes)
+        Accumulate(&m_CurrentFrame.total, pass.counters);
+
+    const uint64_t frame = m_CurrentFrame.frame;
+    std::swap(m_LastFrame, m_CurrentFrame);
+
+    // The pass vector of the older frame is reused and keeps its capacity
+    m_CurrentFrame.frame = frame + 1;
+    m_CurrentFrame.total = {};
+    m_CurrentFrame.passes.clear();
+}
+
+const FrameRenderStats& RenderStats::GetLastFrame()
+{
+    return m_LastFrame;
+}
+
+void RenderStats::Accumulate(RenderCounters* const counters, const RenderCounters& other)
+{
+    counters->drawCalls += other.drawCalls;
+    counters->triangles += other.triangles;
+    counters->stateChanges += other.stateChanges;
+    counters->shaderBinds += other.shaderBinds;
+    counters->textureBinds += other.textureBinds;
+    counters->bufferUploads += other.bufferUploads;
+    counters->uploadedBytes += other.uploadedBytes;
+}
+
+std::string RenderStats::ToJson(const FrameRenderStats& frameStats)
+{
+    std::string json = std::format("{{\n    \"frame\": {},\n    \"total\": {{ ", frameStats.frame);
+    AppendCounters(&json, frameStats.total);
+    json += " },\n    \"passes\": [";
+
+    for (size_t i = 0; i < frameStats.passes.size(); i++)
+    {
+        const PassRenderStats& pass = frameStats.passes[i];
+
+        // The pass names are identifiers chosen in the code, they don't need escaping
+        json += std::format("{}\n        {{ \"name\": \"{}\", ", i == 0 ? "" : ",", pass.name);
+        AppendCounters(&json, pass.counters);
+        json += " }";
+    }
+
+    json += "\n    ]\n}\n";
+
+    return json;
+}
+
+bool_t RenderStats::SaveJson(const std::filesystem::path& filepath)
+{
+    std::ofstream file(filepath);
+    if (!file.is_open())
+    {
+        Logger::LogError("Couldn't open render stats file {}", filepath);
+        return false;
+    }
+
+    file << ToJson(m_LastFrame);
+
+    return file.good();
+}
+
+void RenderStats::Flush()
+{
+    // The work done outside of any pass has its own entry, always first
+    if (m_CurrentFrame.passes.empty())
+        m_CurrentFrame.passes.emplace_back().name = OtherPassName;
+
+    RenderCounters& counters = m_CurrentFrame.passes[m_PassStack.empty() ? 0 : m_PassStack.back()].counters;
+
+    counters.drawCalls += m_Counters.drawCalls.exchange(0, std::memory_order_relaxed);
+    counters.triangles += m_Counters.triangles.exchange(0, std::memory_order_relaxed);
+    counters.stateChanges += m_Counters.stateChanges.exchange(0, std::memory_order_relaxed);
+    counters.shaderBinds += m_Counters.shaderBinds.exchange(0, std::memory_order_relaxed);
+    counters.textureBinds += m_Counters.textureBinds.exchange(0, std::memory_order_relaxed);
+    counters.bufferUploads += m_Counters.bufferUploads.exchange(0, std::memory_order_relaxed);
+    counters.uploadedBytes += m_Counters.uploadedBytes.exchange(0, std::memory_order_relaxed);
+}
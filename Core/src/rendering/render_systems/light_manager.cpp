@@ -1,7 +1,11 @@
 ﻿#include "rendering/render_systems/light_manager.hpp"
 
+#include <algorithm>
 #include <iostream>
+#include <unordered_set>
 
+#include "input/time.hpp"
+#include "rendering/frustum.hpp"
 #include "rendering/rhi.hpp"
 #include "rendering/rhi_typedef.hpp"
 #include "resource/resource_manager.hpp"
@@ -11,15 +15,193 @@
 
 using namespace XnorCore;
 
+namespace
+{
+	template <typename PredicateT>
+	void CullCasters(const std::vector<uint32_t>& candidates, const std::vector<Bound>& bounds, const PredicateT& predicate, std::vector<uint32_t>* const casters)
+	{
+		casters->clear();
+
+		for (const uint32_t index : candidates)
+		{
+			if (predicate(bounds[index]))
+				casters->push_back(index);
+		}
+	}
+
+	void GetLightScreenCoverage(const Camera& viewer, const Vector3 lightPosition, const float_t range, float_t* const coverage, float_t* const distance)
+	{
+		*distance = (lightPosition - viewer.position).Length();
+
+		if (*distance <= range)
+		{
+			*coverage = 1.f;
+			return;
+		}
+
+		// Ratio between the angular size of the light range and the field of view, squared for an area
+		const float_t angularRadius = std::asin(range / *distance);
+		const float_t ratio = angularRadius / (viewer.fov * Calc::Deg2Rad * 0.5f);
+		*coverage = std::min(ratio * ratio, 1.f);
+	}
+
+	Bound GetSphereBound(const ClusteredLight& sphere)
+	{
+		return Bound(sphere.position, Vector3(sphere.radius * 2.f));
+	}
+
+	bool_t IsLightActive(const Light& light)
+	{
+		return light.enabled && light.GetEntity() != nullptr;
+	}
+
+	template <typename LightT, typename SphereFunctionT>
+	void UpdateLightOctree(
+		const std::vector<const LightT*>& lights,
+		const SphereFunctionT& getSphere,
+		std::vector<ObjectBounding<const LightT>>* const newBounds,
+		std::vector<ObjectBounding<const LightT>>* const bounds,
+		Octree<const LightT>* const octree
+	)
+	{
+		newBounds->clear();
+
+		for (const LightT* const light : lights)
+		{
+			if (!IsLightActive(*light))
+				continue;
+
+			// A light that reaches nothing is never visible, and an empty bound would keep dividing the octree
+			const ClusteredLight sphere = getSphere(*light);
+			if (sphere.radius <= 0.f)
+				continue;
+
+			ObjectBounding<const LightT> data;
+			data.handle = light;
+			data.bound = GetSphereBound(sphere);
+			newBounds->push_back(data);
+		}
+
+		// Most frames move no light, so the octree is only rebuilt when one moved, changed or appeared
+		const auto isSame = [](const ObjectBounding<const LightT>& lhs, const ObjectBounding<const LightT>& rhs) -> bool_t
+		{
+			return lhs.handle == rhs.handle && lhs.bound == rhs.bound;
+		};
+		if (std::ranges::equal(*newBounds, *bounds, isSame))
+			return;
+
+		std::swap(*newBounds, *bounds);
+		octree->Update(*bounds);
+	}
+
+	template <typename LightT, typename SphereFunctionT>
+	void CullLightOctree(Octree<const LightT>* const octree, const Frustum& frustum, const SphereFunctionT& getSphere, std::vector<const LightT*>* const visibleLights)
+	{
+		visibleLights->clear();
+
+		const OctreeIterator<OctreeNode<const LightT>> it = octree->GetIterator();
+		while (true)
+		{
+			if (frustum.IsOnFrustum(it.GetBound()))
+			{
+				std::vector<const LightT*>* handles = nullptr;
+				it.GetHandles(&handles);
+
+				for (const LightT* const light : *handles)
+				{
+					if (frustum.IsOnFrustum(GetSphereBound(getSphere(*light))))
+						visibleLights->push_back(light);
+				}
+			}
+
+			if (!it.Iterate())
+				break;
+		}
+	}
+
+	template <typename LightT, typename DataT, size_t SlotCount>
+	bool_t AssignShadowSlots(
+		const std::vector<const LightT*>& lights,
+		std::vector<DataT>* const data,
+		std::array<const LightT*, SlotCount>* const owners,
+		std::vector<uint32_t>* const reassignedSlots
+	)
+	{
+		std::array<bool_t, SlotCount> isKept = {};
+
+		// The lights still visible keep their slot
+		for (size_t i = 0; i < lights.size(); i++)
+		{
+			if (!lights[i]->castShadow)
+				continue;
+
+			const auto slot = std::ranges::find(*owners, lights[i]);
+			if (slot == owners->end())
+				continue;
+
+			const size_t slotIndex = static_cast<size_t>(slot - owners->begin());
+			isKept[slotIndex] = true;
+			(*data)[i].shadowIndex = static_cast<int32_t>(slotIndex);
+		}
+
+		for (size_t i = 0; i < SlotCount; i++)
+		{
+			if (!isKept[i])
+				(*owners)[i] = nullptr;
+		}
+
+		// The others take the free slots, the lights past the last slot are still lit without shadows
+		bool_t droppedShadows = false;
+		for (size_t i = 0; i < lights.size(); i++)
+		{
+			if (!lights[i]->castShadow || (*data)[i].shadowIndex >= 0)
+				continue;
+
+			const auto slot = std::ranges::find(*owners, static_cast<const LightT*>(nullptr));
+			if (slot == owners->end())
+			{
+				droppedShadows = true;
+				continue;
+			}
+
+			const size_t slotIndex = static_cast<size_t>(slot - owners->begin());
+			*slot = lights[i];
+			(*data)[i].shadowIndex = static_cast<int32_t>(slotIndex);
+			reassignedSlots->push_back(static_cast<uint32_t>(slotIndex));
+		}
+
+		for (DataT& lightData : *data)
+			lightData.isCastingShadow = lightData.shadowIndex >= 0;
+
+		return droppedShadows;
+	}
+
+	template <typename LightT, size_t SlotCount>
+	void ReleaseShadowSlots(const std::vector<const LightT*>& registeredLights, std::array<const LightT*, SlotCount>* const owners)
+	{
+		for (const LightT*& owner : *owners)
+		{
+			if (owner != nullptr && std::ranges::find(registeredLights, owner) == registeredLights.end())
+				owner = nullptr;
+		}
+	}
+}
+
 LightManager::~LightManager()
 {
 	delete m_DirectionalShadowMaps;
 	m_DirectionalShadowMaps = nullptr;
+	delete m_DirectionalStaticShadowMaps;
+	m_DirectionalStaticShadowMaps = nullptr;
 
 	delete m_SpotLightShadowMapTextureArray;
 	m_SpotLightShadowMapTextureArray = nullptr;
+	delete m_SpotLightStaticShadowMapTextureArray;
+	m_SpotLightStaticShadowMapTextureArray = nullptr;
 	delete m_PointLightShadowMapCubemapArrayPixelDistance;
 	m_PointLightShadowMapCubemapArrayPixelDistance = nullptr;
+	delete m_PointLightStaticShadowMapCubemapArray;
+	m_PointLightStaticShadowMapCubemapArray = nullptr;
 	delete m_DepthBufferForPointLightPass;
 	m_DepthBufferForPointLightPass = nullptr;
 	delete m_ShadowFrameBufferPointLight;
@@ -47,15 +229,62 @@ void LightManager::InitResources()
 	m_ShadowFrameBufferPointLight->AttachTexture(*m_DepthBufferForPointLightPass, Attachment::Depth, 0);
 }
 
-void LightManager::BeginFrame(const Scene& scene,const Viewport& viewport, Renderer& renderer)
+void LightManager::RegisterLight(const Light* const light)
+{
+	std::scoped_lock lock(m_RegistryMutex);
+
+	m_RegisteredLights.push_back(light);
+	m_RegistryVersion++;
+}
+
+void LightManager::UnregisterLight(const Light* const light)
+{
+	std::scoped_lock lock(m_RegistryMutex);
+
+	const decltype(m_RegisteredLights)::iterator it = std::ranges::find(m_RegisteredLights, light);
+	if (it == m_RegisteredLights.end())
+		return;
+
+	// The order does not matter, the typed lists are rebuilt from scratch
+	*it = m_RegisteredLights.back();
+	m_RegisteredLights.pop_back();
+	m_RegistryVersion++;
+}
+
+std::vector<const Light*> LightManager::GetRegisteredLights()
+{
+	std::scoped_lock lock(m_RegistryMutex);
+
+	return m_RegisteredLights;
+}
+
+void LightManager::BeginFrame(const Scene& scene, const Viewport& viewport, Renderer& renderer)
 {
-	scene.GetAllComponentsOfType<PointLight>(&m_PointLights);
-	scene.GetAllComponentsOfType<SpotLight>(&m_SpotLights);
-	scene.GetAllComponentsOfType<DirectionalLight>(&m_DirectionalLights);
+	UpdateRegisteredLights(scene);
+	UpdateLightOctrees();
+	CullLights(viewport);
 
 	FecthLightInfo();
-	ComputeShadow(scene, viewport, renderer);
+	PrepareShadowCasters(renderer);
+	ComputeShadow(viewport, renderer);
+	BuildLightClusters(viewport);
+
 	Rhi::UpdateLight(*m_GpuLightData);
+	Rhi::UpdateLightArrays(
+		m_PointLightData.data(),
+		m_PointLightData.size(),
+		m_SpotLightData.data(),
+		m_SpotLightData.size(),
+		m_DirectionalLightData.data(),
+		m_DirectionalLightData.size()
+	);
+	Rhi::UpdateLightClusters(
+		m_LightClusterGrid.GetGpuData(),
+		m_LightClusterGrid.GetClusters().data(),
+		m_LightClusterGrid.GetClusters().size(),
+		m_LightClusterGrid.GetLightIndices().data(),
+		m_LightClusterGrid.GetLightIndices().size()
+	);
 }
 
 void LightManager::EndFrame(const Scene&)
@@ -65,9 +294,6 @@ void LightManager::EndFrame(const Scene&)
 
 void LightManager::DrawLightGizmo(const Camera& camera, const Scene& scene) const
 {
-	scene.GetAllComponentsOfType<PointLight>(&m_PointLights);
-	scene.GetAllComponentsOfType<SpotLight>(&m_SpotLights);
-	scene.GetAllComponentsOfType<DirectionalLight>(&m_DirectionalLights);
 	DrawLightGizmoWithShader(camera, scene, m_RenderingLightStruct.editorUi);
 }
 
@@ -133,38 +359,132 @@ void LightManager::UnBindShadowMap() const
 	m_PointLightShadowMapCubemapArrayPixelDistance->BindTexture(ShadowTextureBinding::PointLightCubemapArrayPixelDistance);
 }
 
-void LightManager::FecthLightInfo() const
+const ShadowCacheStats& LightManager::GetShadowCacheStats() const
 {
-	 if (m_DirectionalLights.size() > MaxDirectionalLights)
-		Logger::LogWarning("You cannot have more than 1 directional light in the scene");
-	
-	const size_t nbrOfpointLight = std::clamp<size_t>(m_PointLights.size(), 0, MaxPointLights);
-	const size_t nbrOfSpotLight = std::clamp<size_t>(m_SpotLights.size(), 0, MaxSpotLights);
-	const size_t nbrOfDirectionalLight = std::clamp<size_t>(m_DirectionalLights.size(), 0, MaxDirectionalLights);
+	return m_ShadowCache.GetStats();
+}
+
+const ShadowSchedulerStats& LightManager::GetShadowSchedulerStats() const
+{
+	return m_ShadowScheduler.GetStats();
+}
+
+void LightManager::UpdateRegisteredLights(const Scene& scene)
+{
+	{
+		std::scoped_lock lock(m_RegistryMutex);
+
+		if (m_RegisteredLightsVersion == m_RegistryVersion && m_RegisteredLightsScene == &scene)
+			return;
+
+		m_RegisteredLightsVersion = m_RegistryVersion;
+		m_RegisteredLightsScene = &scene;
+		m_SceneLights = m_RegisteredLights;
+	}
+
+	// The registry holds the lights of every scene, only the ones of the rendered scene are kept
+	const List<Entity*>& entities = scene.GetEntities();
+	std::unordered_set<const Entity*> sceneEntities;
+	for (size_t i = 0; i < entities.GetSize(); i++)
+		sceneEntities.insert(entities[i]);
+
+	bool_t hasDetachedLights = false;
+	std::erase_if(m_SceneLights, [&](const Light* const light)
+	{
+		// A light is registered when it is created, before it is added to an entity
+		hasDetachedLights |= light->GetEntity() == nullptr;
+		return !sceneEntities.contains(light->GetEntity());
+	});
+
+	// Check again next frame, the detached lights may be added to this scene meanwhile
+	if (hasDetachedLights)
+		m_RegisteredLightsVersion = std::numeric_limits<uint64_t>::max();
+
+	m_RegisteredPointLights.clear();
+	m_RegisteredSpotLights.clear();
+	m_RegisteredDirectionalLights.clear();
 
-	m_GpuLightData->nbrOfDirLight = static_cast<uint32_t>(nbrOfDirectionalLight);
-	m_GpuLightData->nbrOfPointLight = static_cast<uint32_t>(nbrOfpointLight);
-	m_GpuLightData->nbrOfSpotLight = static_cast<uint32_t>(nbrOfSpotLight);
+	for (const Light* const light : m_SceneLights)
+	{
+		if (const PointLight* const pointLight = dynamic_cast<const PointLight*>(light))
+			m_RegisteredPointLights.push_back(pointLight);
+		else if (const SpotLight* const spotLight = dynamic_cast<const SpotLight*>(light))
+			m_RegisteredSpotLights.push_back(spotLight);
+		else if (const DirectionalLight* const directionalLight = dynamic_cast<const DirectionalLight*>(light))
+			m_RegisteredDirectionalLights.push_back(directionalLight);
+	}
+
+	// A new light could be allocated at the address of a destroyed one, it must not inherit its shadow maps
+	ReleaseShadowSlots(m_RegisteredPointLights, &m_PointLightShadowOwners);
+	ReleaseShadowSlots(m_RegisteredSpotLights, &m_SpotLightShadowOwners);
+}
+
+void LightManager::UpdateLightOctrees()
+{
+	UpdateLightOctree(
+		m_RegisteredPointLights,
+		[](const PointLight& light) -> ClusteredLight { return GetLightSphere(light); },
+		&m_NewPointLightBounds,
+		&m_PointLightBounds,
+		&m_PointLightOctree
+	);
+	UpdateLightOctree(
+		m_RegisteredSpotLights,
+		[](const SpotLight& light) -> ClusteredLight { return GetLightSphere(light); },
+		&m_NewSpotLightBounds,
+		&m_SpotLightBounds,
+		&m_SpotLightOctree
+	);
+}
+
+void LightManager::CullLights(const Viewport& viewport)
+{
+	const float_t aspect = static_cast<float_t>(viewport.viewPortSize.x) / static_cast<float_t>(viewport.viewPortSize.y);
+	Frustum frustum;
+	frustum.UpdateFromCamera(*viewport.camera, aspect);
+
+	CullLightOctree(&m_PointLightOctree, frustum, [](const PointLight& light) -> ClusteredLight { return GetLightSphere(light); }, &m_PointLights);
+	CullLightOctree(&m_SpotLightOctree, frustum, [](const SpotLight& light) -> ClusteredLight { return GetLightSphere(light); }, &m_SpotLights);
 
-	for (size_t i = 0; i < nbrOfpointLight; i++)
+	// Directional lights reach the whole scene
+	m_DirectionalLights.clear();
+	for (const DirectionalLight* const directionalLight : m_RegisteredDirectionalLights)
+	{
+		if (IsLightActive(*directionalLight))
+			m_DirectionalLights.push_back(directionalLight);
+	}
+}
+
+void LightManager::FecthLightInfo()
+{
+	m_PointLightData.resize(m_PointLights.size());
+	m_SpotLightData.resize(m_SpotLights.size());
+	m_DirectionalLightData.resize(m_DirectionalLights.size());
+
+	m_GpuLightData->nbrOfPointLight = static_cast<uint32_t>(m_PointLightData.size());
+	m_GpuLightData->nbrOfSpotLight = static_cast<uint32_t>(m_SpotLightData.size());
+	m_GpuLightData->nbrOfDirLight = static_cast<uint32_t>(m_DirectionalLightData.size());
+
+	for (size_t i = 0; i < m_PointLights.size(); i++)
 	{
 		const PointLight* pointLight = m_PointLights[i];
 		
-		m_GpuLightData->pointLightData[i] =
+		m_PointLightData[i] =
 		{
 			.color = static_cast<Vector3>(pointLight->color),
 			.intensity = pointLight->intensity,
 			.position = static_cast<Vector3>(pointLight->GetEntity()->transform.worldMatrix[3]),
 			.radius = LightThreshold * sqrt(pointLight->intensity),
-			.isCastingShadow = pointLight[i].castShadow
+			.isCastingShadow = false,
+			.shadowIndex = -1
 		};
 	}
 
-	for (size_t i = 0 ; i < nbrOfSpotLight ; i++)
+	for (size_t i = 0 ; i < m_SpotLights.size() ; i++)
 	{
 		const SpotLight* spotLight = m_SpotLights[i];
 		
-		m_GpuLightData->spotLightData[i] =
+		m_SpotLightData[i] =
 		{
 			.color = static_cast<Vector3>(spotLight->color),
 			.intensity = spotLight->intensity,
@@ -172,206 +492,565 @@ void LightManager::FecthLightInfo() const
 			.cutOff = std::cos(spotLight->cutOff * Calc::Deg2Rad),
 			.direction = spotLight->GetLightDirection(),
 			.outerCutOff = std::cos(spotLight->outerCutOff * Calc::Deg2Rad),
-			.isCastingShadow = spotLight->castShadow,
+			.isCastingShadow = false,
+			.shadowIndex = -1,
+			.radius = LightThreshold * sqrt(spotLight->intensity)
 		};
 	}
-	
 
-	if (nbrOfDirectionalLight != 0)
+	// A slot given to another light holds the map of the previous one, so the scheduler must render it right away
+	m_ReassignedShadowSlots.clear();
+	bool_t droppedShadows = AssignShadowSlots(m_PointLights, &m_PointLightData, &m_PointLightShadowOwners, &m_ReassignedShadowSlots);
+	for (const uint32_t slot : m_ReassignedShadowSlots)
+	{
+		for (uint32_t k = 0; k < 6; k++)
+			m_ShadowScheduler.Forget(PointLightViewOffset + slot * 6 + k);
+	}
+
+	m_ReassignedShadowSlots.clear();
+	droppedShadows |= AssignShadowSlots(m_SpotLights, &m_SpotLightData, &m_SpotLightShadowOwners, &m_ReassignedShadowSlots);
+	for (const uint32_t slot : m_ReassignedShadowSlots)
+		m_ShadowScheduler.Forget(SpotLightViewOffset + slot);
+
+	if (droppedShadows)
+		Logger::LogWarning("Too many visible lights casting shadows, only {} point lights and {} spot lights have shadows", MaxPointLightShadows, MaxSpotLightShadows);
+
+	// The shadows of the first directional light casting them are sampled, it is moved first
+	for (size_t i = 1; i < m_DirectionalLights.size(); i++)
 	{
-		for (size_t i = 0 ; i < MaxDirectionalLights ; i++)
+		if (m_DirectionalLights[i]->castShadow && !m_DirectionalLights[0]->castShadow)
 		{
-			const Vector3 direction = m_DirectionalLights[i]->GetLightDirection(); 
-			m_GpuLightData->directionalData[i] =
-			{
-				.color = static_cast<Vector3>(m_DirectionalLights[i]->color),
-				.intensity = m_DirectionalLights[i]->intensity,	
-				.direction = { direction.x, direction.y, direction.z },
-			};
+			std::swap(m_DirectionalLights[0], m_DirectionalLights[i]);
+			break;
 		}
 	}
+
+	for (size_t i = 0 ; i < m_DirectionalLights.size() ; i++)
+	{
+		const Vector3 direction = m_DirectionalLights[i]->GetLightDirection(); 
+		m_DirectionalLightData[i] =
+		{
+			.color = static_cast<Vector3>(m_DirectionalLights[i]->color),
+			.intensity = m_DirectionalLights[i]->intensity,	
+			.direction = { direction.x, direction.y, direction.z },
+		};
+	}
 }
 
-void LightManager::ComputeShadow(const Scene& scene, const Viewport& viewport, Renderer& renderer)
+void LightManager::BuildLightClusters(const Viewport& viewport)
 {
-	ComputeShadowDirLight(scene, *viewport.camera,viewport.viewPortSize, renderer);
-	ComputeShadowSpotLight(scene, renderer);
-	ComputeShadowPointLight(scene, renderer);
+	m_ClusteredLights.resize(m_PointLightData.size() + m_SpotLightData.size());
+
+	for (size_t i = 0; i < m_PointLights.size(); i++)
+		m_ClusteredLights[i] = GetLightSphere(*m_PointLights[i]);
+
+	for (size_t i = 0; i < m_SpotLights.size(); i++)
+		m_ClusteredLights[m_PointLights.size() + i] = GetLightSphere(*m_SpotLights[i]);
+
+	const float_t aspect = static_cast<float_t>(viewport.viewPortSize.x) / static_cast<float_t>(viewport.viewPortSize.y);
+	m_LightClusterGrid.Build(*viewport.camera, aspect, m_ClusteredLights);
 }
 
-void LightManager::ComputeShadowDirLight(const Scene& scene,const Camera& viewPortCamera, const Vector2i viewportSize, Renderer& renderer)
+void LightManager::ComputeShadow(const Viewport& viewport, const Renderer& renderer)
 {
-	for (const DirectionalLight* const directionalLight : m_DirectionalLights)
+	// The editor renders several viewports per frame, the shadow views only age once per frame
+	const uint64_t frame = Time::GetTotalFrameCount<uint64_t>();
+	if (frame != m_ShadowFrame)
 	{
-		m_GpuLightData->directionalData->isDirlightCastingShadow = directionalLight->castShadow;
-		
-		if (!directionalLight->castShadow)
+		m_ShadowCache.BeginFrame();
+		m_ShadowScheduler.BeginFrame();
+		m_ShadowFrame = frame;
+		m_CachedCascadeViewport = &viewport;
+	}
+	else
+	{
+		m_ShadowScheduler.ClearRequests();
+	}
+
+	// The cascades follow the camera, one last rendered for another viewport can't be deferred since the shadow map doesn't match this view
+	for (size_t i = 0; i < m_CascadeViewports.size(); i++)
+	{
+		if (m_CascadeViewports[i] != &viewport)
+			m_ShadowScheduler.Forget(static_cast<uint32_t>(i));
+	}
+
+	m_ShadowViewCount = 0;
+	m_PendingViewCount = 0;
+
+	// The maps are rendered from scratch while the cache is disabled, so the cached states must not be trusted afterward
+	if (!enableShadowCache)
+		m_ShadowCache.Invalidate();
+
+	ComputeShadowDirLight(viewport);
+	ComputeShadowSpotLight(*viewport.camera);
+	ComputeShadowPointLight(*viewport.camera);
+
+	CullShadowViews(renderer);
+
+	m_ShadowScheduler.Schedule(shadowBudget);
+
+	m_ShadowSkinnedCasters.clear();
+	for (size_t i = 0; i < m_PendingViewCount; i++)
+	{
+		const PendingShadowView& pendingView = m_PendingViews[i];
+		if (!m_ShadowScheduler.IsScheduled(pendingView.requestIndex))
 			continue;
 
-		const Texture& shadowMap = *m_DirectionalShadowMaps;
-		const Vector2i shadowMapSize = shadowMap.GetSize(); 
-		
-		const Vector3 lightDir = directionalLight->GetLightDirection();
-		
-		// HardCoded Shadow Cascade distance by level
-		std::array<float_t, DirectionalCascadeLevel> shadowCascadeLevels =
-		{
-		    viewPortCamera.far / 100.f,
-			viewPortCamera.far / 50.f,
-			viewPortCamera.far / 20.f,
-			viewPortCamera.far / 4.f,
-		
-		};
+		// A deferred view keeps sampling its previous map, so the matrix only changes along with it, before the lights are uploaded
+		if (pendingView.gpuLightSpaceMatrix)
+			*pendingView.gpuLightSpaceMatrix = pendingView.lightSpaceMatrix;
 
-		m_CascadeShadowMap.SetCascadeLevel(shadowCascadeLevels);
-		m_CascadeShadowMap.SetZMultiplicator(directionalLight->zCascadeShadowMapZMultiplactor);
+		if (pendingView.viewId < SpotLightViewOffset)
+			m_CascadeViewports[pendingView.viewId] = &viewport;
 
-		for (size_t k = 0; k < shadowCascadeLevels.size(); k++)
-		{
-			m_GpuLightData->directionalData->cascadePlaneDistance[k] = shadowCascadeLevels[k];
-		}
-		
-		std::vector<Camera> cascadedCameras;
-		m_CascadeShadowMap.GetCascadeCameras(&cascadedCameras, viewPortCamera ,lightDir, viewportSize);
+		m_ShadowSkinnedCasters.insert(m_ShadowSkinnedCasters.end(), pendingView.casters.skinnedCasters.begin(), pendingView.casters.skinnedCasters.end());
+	}
+
+	std::ranges::sort(m_ShadowSkinnedCasters);
+	const auto&& duplicates = std::ranges::unique(m_ShadowSkinnedCasters);
+	m_ShadowSkinnedCasters.erase(duplicates.begin(), duplicates.end());
+}
+
+void LightManager::RenderShadows(Renderer& renderer)
+{
+	for (size_t i = 0; i < m_PendingViewCount; i++)
+	{
+		if (m_ShadowScheduler.IsScheduled(m_PendingViews[i].requestIndex))
+			RenderShadowView(renderer, m_PendingViews[i]);
+	}
+}
+
+const std::vector<uint32_t>& LightManager::GetShadowSkinnedCasters() const
+{
+	return m_ShadowSkinnedCasters;
+}
+
+void LightManager::ComputeShadowDirLight(const Viewport& viewport)
+{
+	const Camera& viewPortCamera = *viewport.camera;
+	const Vector2i viewportSize = viewport.viewPortSize;
+
+	// Only the first directional light can cast shadows, see FecthLightInfo
+	if (m_DirectionalLights.empty())
+		return;
+
+	const DirectionalLight* const directionalLight = m_DirectionalLights[0];
+	DirectionalLightData& directionalData = m_DirectionalLightData[0];
+	directionalData.isDirlightCastingShadow = directionalLight->castShadow;
+
+	if (!directionalLight->castShadow)
+		return;
+
+	const Texture& shadowMap = *m_DirectionalShadowMaps;
+	const Vector2i shadowMapSize = shadowMap.GetSize(); 
+	
+	const Vector3 lightDir = directionalLight->GetLightDirection();
+	
+	// HardCoded Shadow Cascade distance by level
+	std::array<float_t, DirectionalCascadeLevel> shadowCascadeLevels =
+	{
+	    viewPortCamera.far / 100.f,
+		viewPortCamera.far / 50.f,
+		viewPortCamera.far / 20.f,
+		viewPortCamera.far / 4.f,
+	
+	};
+
+	m_CascadeShadowMap.SetCascadeLevel(shadowCascadeLevels);
+	m_CascadeShadowMap.SetZMultiplicator(directionalLight->zCascadeShadowMapZMultiplactor);
+
+	for (size_t k = 0; k < shadowCascadeLevels.size(); k++)
+	{
+		directionalData.cascadePlaneDistance[k] = shadowCascadeLevels[k];
+	}
+	
+	std::vector<Camera> cascadedCameras;
+	m_CascadeShadowMap.GetCascadeCameras(&cascadedCameras, viewPortCamera ,lightDir, viewportSize);
+
+	const float_t viewportAspect = static_cast<float_t>(viewportSize.x) / static_cast<float_t>(viewportSize.y);
+	
+	for (size_t i = 0; i < cascadedCameras.size(); i++)
+	{
+		ShadowViewSetup& setup = AddShadowView();
+		setup.camera = cascadedCameras[i];
+		setup.camera.isOrthographic = true;
+		setup.camera.GetVp(viewportSize, &setup.lightSpaceMatrix);
+		setup.hasLightSpaceMatrix = true;
+		setup.gpuLightSpaceMatrix = &m_GpuLightData->dirLightSpaceMatrix[i];
+		setup.frustum.UpdateFromCamera(setup.camera, viewportAspect);
+
+		// Slice of the view the cascade is sampled in, a caster is only kept if its shadow can reach it
+		Camera receiverCamera = viewPortCamera;
+		m_CascadeShadowMap.GetCascadeRange(i, viewPortCamera, &receiverCamera.near, &receiverCamera.far);
+		setup.receiverFrustum.UpdateFromCamera(receiverCamera, viewportAspect);
+
+		// The shadow of a caster is cast away from the cascade camera, up to the end of its depth range
+		setup.shadowOffset = setup.camera.front * std::abs(setup.camera.far - setup.camera.near);
+		setup.volume = ShadowVolume::CascadeReceiver;
 		
-		for (size_t i = 0; i < cascadedCameras.size(); i++)
+		setup.view =
 		{
-			cascadedCameras[i].isOrthographic = true;
-			cascadedCameras[i].GetVp(viewportSize, &m_GpuLightData->dirLightSpaceMatrix[i]);
+			.camera = nullptr,
+			.size = shadowMapSize,
+			.shadowMap = m_DirectionalShadowMaps,
+			.staticShadowMap = m_DirectionalStaticShadowMaps,
+			.layer = static_cast<uint32_t>(i),
+			.isPointLightFace = false,
+			.isCached = &viewport == m_CachedCascadeViewport,
+			.isOverwritten = m_CascadeViewports[i] != &viewport
+		};
 
-			
-			m_ShadowFrameBuffer->AttachTextureLayer(*m_DirectionalShadowMaps, Attachment::Depth, 0, static_cast<uint32_t>(i));
-			RenderPassBeginInfo renderPassBeginInfo =
-			{
-				.frameBuffer = m_ShadowFrameBuffer,
-				.renderAreaOffset = { 0, 0 },
-				.renderAreaExtent = shadowMapSize,
-				.clearBufferFlags = BufferFlag::DepthBit,
-				.clearColor = Vector4::Zero()
-			};
-			renderer.RenderNonShadedPass(scene,cascadedCameras.at(i) , renderPassBeginInfo, m_ShadowRenderPass,m_ShadowMapShader, m_ShadowMapShaderSkinned, false);
-		}
+		// The cascades always cover the view
+		setup.request =
+		{
+			.viewId = static_cast<uint32_t>(i),
+			.screenCoverage = 1.f,
+			.distance = 0.f,
+			.updateInterval = CascadeUpdateIntervals[i]
+		};
 	}
 }
 
-void LightManager::ComputeShadowSpotLight(const Scene& scene, Renderer& renderer)
+void LightManager::ComputeShadowSpotLight(const Camera& viewPortCamera)
 {
 	for (size_t i = 0; i < m_SpotLights.size(); i++)
 	{
-		if (!m_SpotLights[i]->castShadow)
-			return;
+		const int32_t shadowIndex = m_SpotLightData[i].shadowIndex;
+		if (shadowIndex < 0)
+			continue;
 		
-		Camera cam;
+		ShadowViewSetup& setup = AddShadowView();
+		Camera& cam = setup.camera;
 		cam.position = m_SpotLights[i]->entity->transform.GetPosition();
 		cam.front = m_SpotLights[i]->GetLightDirection();
 		cam.up = Vector3::UnitY();
 		cam.right = Vector3::Cross(cam.front, cam.up).Normalized();
 		cam.near = m_SpotLights[i]->near;
 		cam.far = m_SpotLights[i]->far;
-		cam.GetVp(SpotLightShadowMapSize, &m_GpuLightData->spotLightSpaceMatrix[i]);
-		
-		m_ShadowFrameBuffer->AttachTextureLayer(*m_SpotLightShadowMapTextureArray, Attachment::Depth, 0, static_cast<uint32_t>(i));
+		cam.GetVp(SpotLightShadowMapSize, &setup.lightSpaceMatrix);
+		setup.hasLightSpaceMatrix = true;
+		setup.gpuLightSpaceMatrix = &m_GpuLightData->spotLightSpaceMatrix[shadowIndex];
+		setup.frustum.UpdateFromCamera(cam, static_cast<float_t>(SpotLightShadowMapSize.x) / static_cast<float_t>(SpotLightShadowMapSize.y));
 
-		RenderPassBeginInfo renderPassBeginInfo =
+		setup.volume = ShadowVolume::Cone;
+		setup.coneAngle = m_SpotLights[i]->outerCutOff * Calc::Deg2Rad;
+		
+		setup.view =
 		{
-			.frameBuffer = m_ShadowFrameBuffer,
-			.renderAreaOffset = { 0, 0 },
-			.renderAreaExtent = SpotLightShadowMapSize,
-			.clearBufferFlags = BufferFlag::DepthBit,
-			.clearColor = Vector4(0.f)
+			.camera = nullptr,
+			.size = SpotLightShadowMapSize,
+			.shadowMap = m_SpotLightShadowMapTextureArray,
+			.staticShadowMap = m_SpotLightStaticShadowMapTextureArray,
+			.layer = static_cast<uint32_t>(shadowIndex),
+			.isPointLightFace = false
 		};
-		
-		renderer.RenderNonShadedPass(scene, cam, renderPassBeginInfo, m_ShadowRenderPass,m_ShadowMapShader, m_ShadowMapShaderSkinned, false);
+
+		setup.request = { .viewId = SpotLightViewOffset + static_cast<uint32_t>(shadowIndex) };
+		GetLightScreenCoverage(viewPortCamera, cam.position, cam.far, &setup.request.screenCoverage, &setup.request.distance);
 	}
 }
 
-void LightManager::ComputeShadowPointLight(const Scene& scene, Renderer& renderer)
+void LightManager::ComputeShadowPointLight(const Camera& viewPortCamera)
 {
-	Camera cam;
 	for (size_t i = 0; i < m_PointLights.size(); i++)
 	{
-		if (!m_PointLights[i]->castShadow)	
+		const int32_t shadowIndex = m_PointLightData[i].shadowIndex;
+		if (shadowIndex < 0)
 			continue;
 		
 		const Vector3&& pos = static_cast<Vector3>(m_PointLights[i]->entity->transform.worldMatrix[3]);
+		const float_t range = m_PointLights[i]->far;
+
+		ShadowViewRequest request;
+		GetLightScreenCoverage(viewPortCamera, pos, range, &request.screenCoverage, &request.distance);
 		
 		// Render fo each face of a the CubeMap
 		for (size_t k = 0; k < 6; k++)
 		{
+			ShadowViewSetup& setup = AddShadowView();
+			Camera& cam = setup.camera;
 			GetPointLightDirection(k, &cam.front, &cam.up);
 			cam.position = pos;
 			cam.near = m_PointLights[i]->near;
-			cam.far = m_PointLights[i]->far;
+			cam.far = range;
 			cam.right = Vector3::Cross(cam.front, cam.up).Normalized();
+			setup.frustum.UpdateFromCamera(cam, static_cast<float_t>(PointLightLightShadowMapSize.x) / static_cast<float_t>(PointLightLightShadowMapSize.y));
+
+			// The faces reach past the light range in their corners
+			setup.volume = ShadowVolume::Sphere;
 			
 			// Get Current CubeMap faces In Cubemap Array
-			const uint32_t currentFace = static_cast<uint32_t>(k + i * 6);
-			m_ShadowFrameBufferPointLight->AttachTextureLayer(*m_PointLightShadowMapCubemapArrayPixelDistance, Attachment::Color00, 0, currentFace);
-			
-			RenderPassBeginInfo renderPassBeginInfo =
+			const uint32_t currentFace = static_cast<uint32_t>(k + static_cast<size_t>(shadowIndex) * 6);
+
+			setup.view =
 			{
-				.frameBuffer = m_ShadowFrameBufferPointLight,
-				.renderAreaOffset = { 0, 0 },
-				.renderAreaExtent = SpotLightShadowMapSize ,
-				.clearBufferFlags = static_cast<BufferFlag::BufferFlag>(BufferFlag::DepthBit | BufferFlag::ColorBit),
-				.clearColor = Vector4(std::numeric_limits<float_t>::max())
+				.camera = nullptr,
+				.size = PointLightLightShadowMapSize,
+				.shadowMap = m_PointLightShadowMapCubemapArrayPixelDistance,
+				.staticShadowMap = m_PointLightStaticShadowMapCubemapArray,
+				.layer = currentFace,
+				.isPointLightFace = true
 			};
-			
-		
-			renderer.RenderNonShadedPass(scene, cam, renderPassBeginInfo, m_ShadowRenderPass, m_ShadowMapShaderPointLight, m_ShadowMapShaderPointLightSkinned, false);
+			setup.request = request;
+			setup.request.viewId = PointLightViewOffset + currentFace;
 		}
 	}
 }
 
-
-void LightManager::GetDistanceFromCamera(std::map<float_t, GizmoLight>* sortedLight, const Camera& camera) const
+void LightManager::PrepareShadowCasters(const Renderer& renderer)
 {
-	
-	for (const PointLight* const pointLight : m_PointLights)
+	const std::vector<const StaticMeshRenderer*>& staticMeshes = renderer.meshesDrawer.GetStaticMeshes();
+	const std::vector<const SkinnedMeshRenderer*>& skinnedMeshes = renderer.meshesDrawer.GetSkinnedMeshes();
+
+	// The bounds are computed once here, every shadow view of the frame then only tests them
+	m_StaticCasterBounds.resize(staticMeshes.size());
+	m_SceneCasters.staticCasters.clear();
+	for (size_t i = 0; i < staticMeshes.size(); i++)
 	{
-		if (pointLight == nullptr)
+		if (!staticMeshes[i]->mesh.IsValid())
 			continue;
 
-		const Vector3 entityPosition = static_cast<Vector3>(pointLight->GetEntity()->transform.worldMatrix[3]);
-		
-		GizmoLight gizmoLight = {
-			.pos = entityPosition,
-			.light = pointLight,
-			.type = RenderingLight::PointLight,
-		};
-		
-		const float_t distance = (camera.position - entityPosition).SquaredLength();
-		sortedLight->emplace(distance, gizmoLight);
+		staticMeshes[i]->GetAabb(&m_StaticCasterBounds[i]);
+		m_SceneCasters.staticCasters.push_back(static_cast<uint32_t>(i));
 	}
-	
-	for (const SpotLight* const spotLight : m_SpotLights)
+
+	m_SkinnedCasterBounds.resize(skinnedMeshes.size());
+	m_SceneCasters.skinnedCasters.clear();
+	for (size_t i = 0; i < skinnedMeshes.size(); i++)
 	{
-		if (spotLight == nullptr)
+		if (!skinnedMeshes[i]->mesh)
 			continue;
 
-		const Vector3 entityPosition = static_cast<Vector3>(spotLight->GetEntity()->transform.worldMatrix[3]);
-		
-		GizmoLight gizmoLight = {
-			.pos = entityPosition,
-			.light = spotLight,
-			.type = RenderingLight::SpothLight
-		};
-		
-		const float_t distance = (camera.position - entityPosition).SquaredLength();
-		sortedLight->emplace(distance, gizmoLight);
+		skinnedMeshes[i]->GetAabb(&m_SkinnedCasterBounds[i]);
+		m_SceneCasters.skinnedCasters.push_back(static_cast<uint32_t>(i));
 	}
-	
-	for (const DirectionalLight* const dirLight : m_DirectionalLights)
+}
+
+LightManager::ShadowViewSetup& LightManager::AddShadowView()
+{
+	if (m_ShadowViewCount == m_ShadowViewSetups.size())
+		m_ShadowViewSetups.emplace_back();
+
+	ShadowViewSetup& setup = m_ShadowViewSetups[m_ShadowViewCount++];
+	setup = ShadowViewSetup();
+	return setup;
+}
+
+void LightManager::CullShadowViews(const Renderer& renderer)
+{
+	m_ShadowFrusta.resize(m_ShadowViewCount);
+	for (size_t i = 0; i < m_ShadowViewCount; i++)
+		m_ShadowFrusta[i] = m_ShadowViewSetups[i].frustum;
+
+	// Each caster is tested once against the frusta of all the views, instead of once per view
+	if (enableMultiViewCulling)
 	{
-		if (dirLight == nullptr)
-			continue;
+		m_StaticCasterCuller.Cull(m_ShadowFrusta, m_StaticCasterBounds, m_SceneCasters.staticCasters);
+		m_SkinnedCasterCuller.Cull(m_ShadowFrusta, m_SkinnedCasterBounds, m_SceneCasters.skinnedCasters);
+	}
 
-		const Vector3 entityPosition = static_cast<Vector3>(dirLight->GetEntity()->transform.worldMatrix[3]);
+	for (size_t i = 0; i < m_ShadowViewCount; i++)
+	{
+		ShadowViewSetup& setup = m_ShadowViewSetups[i];
+
+		if (enableMultiViewCulling)
+		{
+			// The frustum was already tested, only the light volume is left
+			const auto isCaster = [&](const Bound& bound) -> bool_t
+			{
+				return IsInShadowVolume(setup, bound);
+			};
+			CullCasters(m_StaticCasterCuller.GetVisible(i), m_StaticCasterBounds, isCaster, &m_ViewCasters.staticCasters);
+			CullCasters(m_SkinnedCasterCuller.GetVisible(i), m_SkinnedCasterBounds, isCaster, &m_ViewCasters.skinnedCasters);
+		}
+		else
+		{
+			const auto isCaster = [&](const Bound& bound) -> bool_t
+			{
+				return m_ShadowFrusta[i].IsOnFrustum(bound) && IsInShadowVolume(setup, bound);
+			};
+			CullCasters(m_SceneCasters.staticCasters, m_StaticCasterBounds, isCaster, &m_ViewCasters.staticCasters);
+			CullCasters(m_SceneCasters.skinnedCasters, m_SkinnedCasterBounds, isCaster, &m_ViewCasters.skinnedCasters);
+		}
+
+		// The setups can't be moved anymore, so the view can point to their camera
+		setup.view.camera = &setup.camera;
+		SubmitShadowView(renderer, setup.view, setup.request, setup.hasLightSpaceMatrix ? &setup.lightSpaceMatrix : nullptr, setup.gpuLightSpaceMatrix);
+	}
+}
+
+bool_t LightManager::IsInShadowVolume(const ShadowViewSetup& setup, const Bound& bound)
+{
+	switch (setup.volume)
+	{
+		case ShadowVolume::CascadeReceiver:
+		{
+			Bound shadowVolume = bound;
+			shadowVolume.Encapsulate(Bound(bound.center + setup.shadowOffset, bound.extents * 2.f));
+			return setup.receiverFrustum.IsOnFrustum(shadowVolume);
+		}
+
+		case ShadowVolume::Cone:
+			// The cone is tighter than the frustum around the light, the frustum also clips the near plane
+			return bound.IntersectCone(setup.camera.position, setup.camera.front, setup.coneAngle, setup.camera.far);
+
+		case ShadowVolume::Sphere:
+			return bound.IntersectSphere(setup.camera.position, setup.camera.far);
+	}
+
+	return true;
+}
+
+void LightManager::SubmitShadowView(
+	const Renderer& renderer,
+	const ShadowView& view,
+	ShadowViewRequest request,
+	const Matrix* const lightSpaceMatrix,
+	Matrix* const gpuLightSpaceMatrix
+)
+{
+	uint64_t staticSignature = 0;
+	ShadowCache::Update update = ShadowCache::Update::Full;
+
+	if (enableShadowCache && view.isCached)
+	{
+		GetCasterSignature(view, renderer, &staticSignature);
+		update = m_ShadowCache.PeekUpdate(request.viewId, staticSignature, !m_ViewCasters.skinnedCasters.empty());
+
+		// The base map is still valid, but another viewport rendered its cascade over the shadow map
+		if (update == ShadowCache::Update::None && view.isOverwritten)
+			update = ShadowCache::Update::Dynamic;
+
+		// The light view is part of the signature, so the matrix already matches the shadow map
+		if (update == ShadowCache::Update::None)
+		{
+			(void)m_ShadowCache.GetUpdate(request.viewId, staticSignature, false);
+			return;
+		}
+
+		// The view may be deferred by the scheduler, its state must be kept meanwhile
+		m_ShadowCache.Touch(request.viewId);
+	}
+
+	// Estimated in draw calls, a dynamic update also copies the base map
+	const size_t skinnedCount = m_ViewCasters.skinnedCasters.size();
+	const size_t staticCount = update == ShadowCache::Update::Full ? m_ViewCasters.staticCasters.size() : 0;
+	request.cost = static_cast<float_t>(staticCount + skinnedCount + 1);
+
+	if (m_PendingViewCount == m_PendingViews.size())
+		m_PendingViews.emplace_back();
+
+	PendingShadowView& pendingView = m_PendingViews[m_PendingViewCount++];
+	pendingView.camera = *view.camera;
+	pendingView.view = view;
+	pendingView.view.camera = nullptr;
+	pendingView.casters.staticCasters = m_ViewCasters.staticCasters;
+	pendingView.casters.skinnedCasters = m_ViewCasters.skinnedCasters;
+	pendingView.viewId = request.viewId;
+	pendingView.staticSignature = staticSignature;
+	pendingView.requestIndex = m_ShadowScheduler.Submit(request);
+	pendingView.gpuLightSpaceMatrix = gpuLightSpaceMatrix;
+	if (lightSpaceMatrix)
+		pendingView.lightSpaceMatrix = *lightSpaceMatrix;
+}
+
+void LightManager::RenderShadowView(Renderer& renderer, const PendingShadowView& pendingView)
+{
+	const ShadowView& view = pendingView.view;
+	const ShadowCasters& casters = pendingView.casters;
+	const Camera& camera = pendingView.camera;
+
+	Framebuffer* const framebuffer = view.isPointLightFace ? m_ShadowFrameBufferPointLight : m_ShadowFrameBuffer;
+	const Attachment::Attachment attachment = view.isPointLightFace ? Attachment::Color00 : Attachment::Depth;
+	const Pointer<Shader>& staticShader = view.isPointLightFace ? m_ShadowMapShaderPointLight : m_ShadowMapShader;
+	const Pointer<Shader>& skinnedShader = view.isPointLightFace ? m_ShadowMapShaderPointLightSkinned : m_ShadowMapShaderSkinned;
+	static const std::vector<uint32_t> NoCasters;
+
+	// Point lights write the distance to the light in a color attachment, next to a depth buffer shared by all the faces
+	RenderPassBeginInfo renderPassBeginInfo =
+	{
+		.frameBuffer = framebuffer,
+		.renderAreaOffset = { 0, 0 },
+		.renderAreaExtent = view.size,
+		.clearBufferFlags = view.isPointLightFace ? static_cast<BufferFlag::BufferFlag>(BufferFlag::DepthBit | BufferFlag::ColorBit) : BufferFlag::DepthBit,
+		.clearColor = view.isPointLightFace ? Vector4(std::numeric_limits<float_t>::max()) : Vector4::Zero()
+	};
+
+	if (!enableShadowCache || !view.isCached)
+	{
+		framebuffer->AttachTextureLayer(*view.shadowMap, attachment, 0, view.layer);
+		renderer.RenderShadowCasters(camera, renderPassBeginInfo, m_ShadowRenderPass, staticShader, skinnedShader,
+			casters.staticCasters, casters.skinnedCasters);
+		return;
+	}
+
+	const bool_t hasDynamicCasters = !casters.skinnedCasters.empty();
+	const ShadowCache::Update update = m_ShadowCache.GetUpdate(pendingView.viewId, pendingView.staticSignature, hasDynamicCasters);
+
+	if (update == ShadowCache::Update::Full)
+	{
+		framebuffer->AttachTextureLayer(*view.staticShadowMap, attachment, 0, view.layer);
+		renderer.RenderShadowCasters(camera, renderPassBeginInfo, m_ShadowRenderPass, staticShader, skinnedShader,
+			casters.staticCasters, NoCasters);
+	}
+
+	const TextureType::TextureType textureType = view.isPointLightFace ? TextureType::TextureCubeMapArray : TextureType::Texture2DArray;
+	Rhi::CopyTextureLayer(view.staticShadowMap->GetId(), view.shadowMap->GetId(), textureType, view.size, view.layer);
+
+	if (!hasDynamicCasters)
+		return;
+
+	// The depth of the dynamic casters is tested against the copied base map,
+	// point lights have no depth to test against so their shaders keep the closest distance with a min blending
+	renderPassBeginInfo.clearBufferFlags = view.isPointLightFace ? BufferFlag::DepthBit : BufferFlag::None;
+	framebuffer->AttachTextureLayer(*view.shadowMap, attachment, 0, view.layer);
+	renderer.RenderShadowCasters(camera, renderPassBeginInfo, m_ShadowRenderPass, staticShader, skinnedShader,
+		NoCasters, casters.skinnedCasters);
+}
+
+void LightManager::GetCasterSignature(const ShadowView& view, const Renderer& renderer, uint64_t* const staticSignature) const
+{
+	const std::vector<const StaticMeshRenderer*>& staticMeshes = renderer.meshesDrawer.GetStaticMeshes();
+
+	// The light view covers the light position, direction and range
+	Matrix viewProjection;
+	view.camera->GetVp(view.size, &viewProjection);
+	uint64_t signature = ShadowCache::Hash(ShadowCache::SignatureSeed, viewProjection.Raw(), sizeof(Matrix));
+
+	for (const uint32_t index : m_ViewCasters.staticCasters)
+	{
+		const StaticMeshRenderer* const caster = staticMeshes[index];
+		const Mesh* const mesh = caster->mesh.Get();
+		signature = ShadowCache::Hash(signature, &caster, sizeof(caster));
+		signature = ShadowCache::Hash(signature, &mesh, sizeof(mesh));
+		signature = ShadowCache::Hash(signature, caster->GetEntity()->transform.worldMatrix.Raw(), sizeof(Matrix));
+
+		// A caster switching detail level changes the shadow map
+		const uint32_t lod = renderer.meshesDrawer.GetShadowLod(index);
+		signature = ShadowCache::Hash(signature, &lod, sizeof(lod));
+	}
+
+	*staticSignature = signature;
+}
+
+
+void LightManager::GetDistanceFromCamera(std::map<float_t, GizmoLight>* sortedLight, const Camera& camera) const
+{
+	// The gizmos are drawn for every light of the scene, even the disabled ones or the ones out of the view
+	for (const Light* const light : m_SceneLights)
+	{
+		RenderingLight type = RenderingLight::DirLight;
+		if (dynamic_cast<const PointLight*>(light))
+			type = RenderingLight::PointLight;
+		else if (dynamic_cast<const SpotLight*>(light))
+			type = RenderingLight::SpothLight;
+
+		const Vector3 entityPosition = static_cast<Vector3>(light->GetEntity()->transform.worldMatrix[3]);
 		
 		GizmoLight gizmoLight = {
 			.pos = entityPosition,
-			.light = dirLight,
-			.type = RenderingLight::DirLight
+			.light = light,
+			.type = type
 		};
 		
 		const float_t distance = (camera.position - entityPosition).SquaredLength();
@@ -419,6 +1098,21 @@ void LightManager::GetPointLightDirection(const size_t index, Vector3* front, Ve
 	}
 }
 
+ClusteredLight LightManager::GetLightSphere(const PointLight& light)
+{
+	return { static_cast<Vector3>(light.GetEntity()->transform.worldMatrix[3]), LightThreshold * std::sqrt(light.intensity) };
+}
+
+ClusteredLight LightManager::GetLightSphere(const SpotLight& light)
+{
+	return LightClusterGrid::GetSpotLightBounds(
+		static_cast<Vector3>(light.GetEntity()->transform.worldMatrix[3]),
+		light.GetLightDirection(),
+		light.outerCutOff * Calc::Deg2Rad,
+		LightThreshold * std::sqrt(light.intensity)
+	);
+}
+
 void LightManager::InitShadowMap()
 {
 	const TextureCreateInfo dirLightShadowMap =
@@ -436,12 +1130,13 @@ void LightManager::InitShadowMap()
 	};
 	
 	m_DirectionalShadowMaps = new Texture(dirLightShadowMap);
+	m_DirectionalStaticShadowMaps = new Texture(dirLightShadowMap);
 	
 	const TextureCreateInfo spothLightShadowArray =
 	{
 		.textureType = TextureType::Texture2DArray,
 		.mipMaplevel = 1,
-		.depth = MaxSpotLights,
+		.depth = MaxSpotLightShadows,
 		.size = SpotLightShadowMapSize,
 		.filtering = TextureFiltering::Nearest,
 		.wrapping = TextureWrapping::ClampToBorder,
@@ -451,12 +1146,13 @@ void LightManager::InitShadowMap()
 	};
 
 	m_SpotLightShadowMapTextureArray = new Texture(spothLightShadowArray);
+	m_SpotLightStaticShadowMapTextureArray = new Texture(spothLightShadowArray);
 
 	const TextureCreateInfo pointLightDepthBufferCreateInfo =
 	{
 		.textureType = TextureType::Texture2D,
 		.mipMaplevel = 1,
-		.depth = MaxPointLights,
+		.depth = MaxPointLightShadows,
 		.size = PointLightLightShadowMapSize,
 		.filtering = TextureFiltering::Linear,
 		.wrapping = TextureWrapping::ClampToEdge,
@@ -471,7 +1167,7 @@ void LightManager::InitShadowMap()
 	{
 		.textureType = TextureType::TextureCubeMapArray,
 		.mipMaplevel = 1,
-		.depth = MaxPointLights,
+		.depth = MaxPointLightShadows,
 		.size = PointLightLightShadowMapSize,
 		.filtering = TextureFiltering::Linear,
 		.wrapping = TextureWrapping::ClampToEdge,
@@ -481,6 +1177,7 @@ void LightManager::InitShadowMap()
 	};
 
 	m_PointLightShadowMapCubemapArrayPixelDistance = new Texture(pointLightCubeMapArrayWorldSpaceInfo);
+	m_PointLightStaticShadowMapCubemapArray = new Texture(pointLightCubeMapArrayWorldSpaceInfo);
 }
 
 void LightManager::InitShader()
@@ -510,8 +1207,19 @@ void LightManager::InitShader()
 	m_ShadowMapShader->SetFaceCullingInfo(cullInfo);
 	m_ShadowMapShader->CreateInInterface();
 
+	// The point light faces keep the closest distance, which is what the depth test already does on a cleared face,
+	// but also lets the dynamic casters be composited on top of a cached face that has no depth
+	constexpr BlendFunction closestDistance =
+	{
+		.isBlending = true,
+		.sValue = BlendValue::One,
+		.dValue = BlendValue::One,
+		.blendEquation = BlendEquation::Min
+	};
+
 	m_ShadowMapShaderPointLight = ResourceManager::Get<Shader>("depth_shader_point_light");
 	m_ShadowMapShaderPointLight->SetFaceCullingInfo(cullInfo);
+	m_ShadowMapShaderPointLight->SetBlendFunction(closestDistance);
 	m_ShadowMapShaderPointLight->CreateInInterface();
 	
 	// Skinned
@@ -521,5 +1229,6 @@ void LightManager::InitShader()
 
 	m_ShadowMapShaderPointLightSkinned = ResourceManager::Get<Shader>("depth_shader_point_light_skinned");
 	m_ShadowMapShaderPointLightSkinned->SetFaceCullingInfo(cullInfo);
+	m_ShadowMapShaderPointLightSkinned->SetBlendFunction(closestDistance);
 	m_ShadowMapShaderPointLightSkinned->CreateInInterface();
 }
@@ -8,17 +8,9 @@
 
 using namespace XnorCore;
 
-MeshesDrawer::MeshesDrawer()
-    : m_SkinnedMeshGpuData(new SkinnedMeshGpuData())
-{
-}
-
+MeshesDrawer::MeshesDrawer() = default;
 
-
-MeshesDrawer::~MeshesDrawer()
-{
-    delete m_SkinnedMeshGpuData;
-}
+MeshesDrawer::~MeshesDrawer() = default;
 
 void MeshesDrawer::InitResources()
 {
@@ -34,6 +26,7 @@ void MeshesDrawer::InitResources()
     m_SkinnedShader->CreateInInterface();
     m_GizmoShader = ResourceManager::Get<Shader>("gizmo_shader");
     m_GizmoShader->CreateInInterface();
+    m_SkinningPass.Init();
 }
 
 
@@ -89,8 +82,8 @@ void MeshesDrawer::DrawAabb(const Pointer<Mesh> cube) const
         if (skinnedMeshRender->mesh)
         {
 
-            const Transform& transform = skinnedMeshRender->GetEntity()->transform;
-            const Bound& modelAabb = Bound::GetAabbFromTransform(skinnedMeshRender->mesh->aabb, transform);
+            Bound modelAabb;
+            skinnedMeshRender->GetAabb(&modelAabb);
             const Matrix&& trsAabb = Matrix::Trs(modelAabb.center, Quaternion::Identity(), modelAabb.extents);
             modelData.model = trsAabb;
             Rhi::UpdateModelUniform(modelData);
@@ -108,16 +101,48 @@ void MeshesDrawer::BeginFrame(const Scene& scene, const Renderer&)
     scene.GetAllComponentsOfType<SkinnedMeshRenderer>(&m_SkinnedRender);
     scene.GetAllComponentsOfType<StaticMeshRenderer>(&m_StaticMeshs);
     PrepareOctree(scene);
+
+    // Full detail until SelectShadowLods runs
+    m_ShadowLods.assign(m_StaticMeshs.size(), 0);
+    m_ShadowCasterStats = {};
+}
+
+void MeshesDrawer::PrepareSkinnedMeshes(const ViewVisibility& visibility, const std::vector<uint32_t>& shadowCasters)
+{
+    m_IsSkinnedMeshDrawn.assign(m_SkinnedRender.size(), false);
+
+    for (const uint32_t index : visibility.GetSkinnedMeshes())
+        m_IsSkinnedMeshDrawn[index] = true;
+
+    for (const uint32_t index : shadowCasters)
+        m_IsSkinnedMeshDrawn[index] = true;
+
+    m_DrawnSkinnedMeshes.clear();
+    for (size_t i = 0; i < m_SkinnedRender.size(); i++)
+    {
+        if (m_IsSkinnedMeshDrawn[i])
+            m_DrawnSkinnedMeshes.push_back(static_cast<uint32_t>(i));
+    }
+
+    PrepareBonePalettes();
+
+    m_UsesSkinningPass = enableSkinningPass && !m_DrawnSkinnedMeshes.empty();
+    if (m_UsesSkinningPass)
+        m_SkinningPass.Compute(m_SkinnedRender, m_DrawnSkinnedMeshes, m_BoneOffsets);
 }
 
-void MeshesDrawer::RenderAnimation() const
+void MeshesDrawer::RenderAnimation(const ViewVisibility& visibility) const
 {
     m_SkinnedShader->Use();
 
-    for (const SkinnedMeshRenderer* skinnedMeshRender : m_SkinnedRender)
+    for (const uint32_t j : visibility.GetSkinnedMeshes())
     {
+        const SkinnedMeshRenderer* const skinnedMeshRender = m_SkinnedRender[j];
+
         ModelUniformData modelData;
         modelData.model = skinnedMeshRender->GetTransform().worldMatrix;
+        modelData.boneOffset = m_BoneOffsets[j];
+        modelData.boneCount = static_cast<uint32_t>(skinnedMeshRender->GetMatrices().GetSize());
 
         try
         {
@@ -130,263 +155,182 @@ void MeshesDrawer::RenderAnimation() const
 		
         Rhi::UpdateModelUniform(modelData);
 
-        if (skinnedMeshRender->mesh)
+        for (uint32_t i = 0; i < skinnedMeshRender->mesh->models.GetSize(); i++)
         {
-
-            for (uint32_t i = 0; i < skinnedMeshRender->mesh->models.GetSize(); i++)
-            {
-                const List<Matrix>& matrices = skinnedMeshRender->GetMatrices();
-                for (size_t j = 0; j < matrices.GetSize(); j++)
-                    m_SkinnedMeshGpuData->boneMatrices[j] = matrices[j];
-
-                skinnedMeshRender->material.BindMaterial();
-                Rhi::UpdateAnimationUniform(*m_SkinnedMeshGpuData);
-                Rhi::DrawModel(DrawMode::Triangles, skinnedMeshRender->mesh->models[i]->GetId());
-            }
+            skinnedMeshRender->material.BindMaterial();
+            Rhi::DrawModel(DrawMode::Triangles, skinnedMeshRender->mesh->models[i]->GetId());
         }
     }
     m_SkinnedShader->Unuse();
 }
 
-void MeshesDrawer::RenderAnimationNonShaded(const Scene& scene) const
+void MeshesDrawer::RenderAnimationNonShaded(const ViewVisibility& visibility, const Scene& scene) const
 {
+    for (const uint32_t j : visibility.GetSkinnedMeshes())
+    {
+        // +1 to avoid the black color of the attachment be a valid index
+        DrawSkinnedMeshNonShaded(j, scene.GetEntityIndex(m_SkinnedRender[j]->GetEntity()) + 1);
+    }
+}
 
-    for (const SkinnedMeshRenderer* skinnedMeshRender : m_SkinnedRender)
+void MeshesDrawer::RenderStaticCasters(const std::vector<uint32_t>& casters) const
+{
+    for (const uint32_t index : casters)
     {
-        ModelUniformData modelData;
-        modelData.model = skinnedMeshRender->GetTransform().worldMatrix;
-        modelData.meshRenderIndex = scene.GetEntityIndex(skinnedMeshRender->GetEntity()) + 1;
+        const StaticMeshRenderer* const meshRenderer = m_StaticMeshs[index];
+        const uint32_t lod = m_ShadowLods[index];
 
-        try
-        {
-            modelData.normalInvertMatrix = skinnedMeshRender->GetTransform().worldMatrix.Inverted().Transposed();
-        }
-        catch (const std::invalid_argument&)
-        {
-            modelData.normalInvertMatrix = Matrix::Identity();
-        }
-		
+        // The depth only shaders don't read the normal matrix
+        ModelUniformData modelData;
+        modelData.model = meshRenderer->GetEntity()->transform.worldMatrix;
         Rhi::UpdateModelUniform(modelData);
 
-        if (skinnedMeshRender->mesh)
+        for (size_t i = 0; i < meshRenderer->mesh->models.GetSize(); i++)
         {
-            for (uint32_t i = 0; i < skinnedMeshRender->mesh->models.GetSize(); i++)
-            {
-                const List<Matrix>& matrices = skinnedMeshRender->GetMatrices();
-                for (size_t j = 0; j < matrices.GetSize(); j++)
-                    m_SkinnedMeshGpuData->boneMatrices[j] = matrices[j];
+            const Pointer<Model>& model = meshRenderer->mesh->models[i];
 
-                Rhi::UpdateAnimationUniform(*m_SkinnedMeshGpuData);
-                Rhi::DrawModel(DrawMode::Triangles, skinnedMeshRender->mesh->models[i]->GetId());
-            }
+            if (model.IsValid())
+                Rhi::DrawModel(DrawMode::Triangles, model->GetLodId(lod));
         }
+
+        m_ShadowCasterStats.casters++;
+        m_ShadowCasterStats.fullDetailTriangles += LodSelector::GetTriangleCount(*meshRenderer, 0);
+        m_ShadowCasterStats.triangles += LodSelector::GetTriangleCount(*meshRenderer, lod);
     }
 }
 
+void MeshesDrawer::RenderSkinnedCasters(const std::vector<uint32_t>& casters) const
+{
+    for (const uint32_t index : casters)
+        DrawSkinnedMeshNonShaded(index, 0);
+}
+
+const std::vector<const StaticMeshRenderer*>& MeshesDrawer::GetStaticMeshes() const
+{
+    return m_StaticMeshs;
+}
+
+const std::vector<const SkinnedMeshRenderer*>& MeshesDrawer::GetSkinnedMeshes() const
+{
+    return m_SkinnedRender;
+}
+
+uint32_t MeshesDrawer::GetShadowLod(const uint32_t index) const
+{
+    return m_ShadowLods[index];
+}
+
+const ShadowCasterStats& MeshesDrawer::GetShadowCasterStats() const
+{
+    return m_ShadowCasterStats;
+}
+
+bool_t MeshesDrawer::UsesSkinningPass() const
+{
+    return m_UsesSkinningPass;
+}
+
 
-void MeshesDrawer::RenderStaticMesh(const MaterialType materialtype, const Camera& camera, const Frustum& frustum, const Scene& scene) const
+void MeshesDrawer::SelectLods(const Camera& camera, LodSelector* const lodSelector, ViewVisibility* const visibility)
+{
+    if (enableLod)
+        visibility->SelectLods(camera, lodSelector, lodSettings);
+}
+
+void MeshesDrawer::SelectShadowLods(const std::vector<Camera>& cameras)
+{
+    if (!enableLod)
+        return;
+
+    // The shadow views are rendered before the visibility of the viewport is known, so every mesh gets a level
+    m_ShadowLodSelector.BeginFrame();
+
+    for (size_t i = 0; i < m_StaticMeshs.size(); i++)
+    {
+        if (!m_StaticMeshs[i]->mesh.IsValid())
+            continue;
+
+        m_ShadowLods[i] = m_ShadowLodSelector.Select(*m_StaticMeshs[i], cameras, lodSettings) + lodSettings.shadowLodBias;
+    }
+}
+
+void MeshesDrawer::RenderStaticMesh(const ViewVisibility& visibility, const MaterialType materialType, const Scene& scene) const
 {
     Rhi::SetPolygonMode(PolygonFace::FrontAndBack, PolygonMode::Fill);
-    const OctreeIterator<OctreeNode<const StaticMeshRenderer>> it = scene.renderOctree.GetIterator();
-    if (!camera.isOrthographic)
+
+    const std::vector<const StaticMeshRenderer*>& meshes = visibility.GetStaticMeshes(materialType);
+    const std::vector<uint32_t>& lods = visibility.GetStaticMeshLods(materialType);
+
+    for (size_t j = 0; j < meshes.size(); j++)
     {
-#pragma region Draw OctreeFrustum
+        const StaticMeshRenderer* const staticMeshRenderer = meshes[j];
+        const Transform& transform = staticMeshRenderer->GetEntity()->transform;
+        ModelUniformData modelData;
+        modelData.model = transform.worldMatrix;
+        // +1 to avoid the black color of the attachment be a valid index  
+        modelData.meshRenderIndex = scene.GetEntityIndex(staticMeshRenderer->GetEntity()) + 1;
 
-        while (true)
+        try
         {
-            Bound bound = it.GetBound();
-            // if we not see it 
-            if (frustum.IsOnFrustum(bound))
-            {
-                std::vector<const StaticMeshRenderer*>* handle = nullptr;
-                it.GetHandles(&handle);
-
-                // draw
-                for (const StaticMeshRenderer* const staticMeshRenderer : *handle)
-                {
-                    for (size_t i = 0; i < staticMeshRenderer->mesh->models.GetSize(); i++)
-                    {
-                        if (staticMeshRenderer->material.materialType != materialtype )
-                            continue;
-                        
-                        Pointer<Model> model = staticMeshRenderer->mesh->models[i];
-                        Bound aabb;
-                        staticMeshRenderer->GetAabb(&aabb);
-
-                        if (!frustum.IsOnFrustum(aabb))
-                        {
-                            continue;
-                        }
-
-                        const Transform& transform = staticMeshRenderer->GetEntity()->transform;
-                        ModelUniformData modelData;
-                        modelData.model = transform.worldMatrix;
-                        // +1 to avoid the black color of the attachment be a valid index  
-                            modelData.meshRenderIndex = scene.GetEntityIndex(staticMeshRenderer->GetEntity()) + 1;
-
-                        try
-                        {
-                            modelData.normalInvertMatrix = transform.worldMatrix.Inverted().Transposed();
-                        }
-                        catch (const std::invalid_argument&)
-                        {
-                            modelData.normalInvertMatrix = Matrix::Identity();
-                        }
-                        
-                        if (model.IsValid())
-                        {
-                            staticMeshRenderer->material.BindMaterial();
-                            Rhi::UpdateModelUniform(modelData);
-                            Rhi::DrawModel(DrawMode::Triangles, model->GetId());
-                        }
-                    }
-                  
-                }
-            }
-            if (!it.Iterate())
-                break;
+            modelData.normalInvertMatrix = transform.worldMatrix.Inverted().Transposed();
+        }
+        catch (const std::invalid_argument&)
+        {
+            modelData.normalInvertMatrix = Matrix::Identity();
         }
-#pragma endregion Draw OctreeFrustum
-    }
-    else
-    {
-#pragma region Draw iteration
 
-        for (const StaticMeshRenderer* staticMeshRenderer : m_StaticMeshs)
+        for (size_t i = 0; i < staticMeshRenderer->mesh->models.GetSize(); i++)
         {
-            if (!staticMeshRenderer->mesh)
-                continue;
+            const Pointer<Model>& model = staticMeshRenderer->mesh->models[i];
 
-            for (size_t i = 0; i < staticMeshRenderer->mesh->models.GetSize(); i++)
+            if (model.IsValid())
             {
-                Pointer<Model> model = staticMeshRenderer->mesh->models[i];
-                const Transform& transform = staticMeshRenderer->GetEntity()->transform;
-                ModelUniformData modelData;
-                modelData.model = transform.worldMatrix;
-                // +1 to avoid the black color of the attachment be a valid index  
-                modelData.meshRenderIndex = scene.GetEntityIndex(staticMeshRenderer->GetEntity()) + 1;
-
-                try
-                {
-                    modelData.normalInvertMatrix = transform.worldMatrix.Inverted().Transposed();
-                }
-                catch (const std::invalid_argument&)
-                {
-                    modelData.normalInvertMatrix = Matrix::Identity();
-                }
-
-
-                if (model.IsValid())
-                {
-                    staticMeshRenderer->material.BindMaterial();
-                    Rhi::UpdateModelUniform(modelData);
-                    Rhi::DrawModel(DrawMode::Triangles, model->GetId());
-                }
+                staticMeshRenderer->material.BindMaterial();
+                Rhi::UpdateModelUniform(modelData);
+                Rhi::DrawModel(DrawMode::Triangles, model->GetLodId(lods[j]));
             }
-           
         }
-#pragma endregion Draw iteration
     }
 }
 
-void MeshesDrawer::RenderStaticMeshNonShaded(const Camera& camera, const Frustum& frustum, const Scene& scene) const
+void MeshesDrawer::RenderStaticMeshNonShaded(const ViewVisibility& visibility, const Scene& scene) const
 {
     Rhi::SetPolygonMode(PolygonFace::FrontAndBack, PolygonMode::Fill);
-    const OctreeIterator<OctreeNode<const StaticMeshRenderer>> it = scene.renderOctree.GetIterator();
-    if (!camera.isOrthographic)
+
+    // Without shading the material type doesn't matter, every bin is drawn
+    for (size_t bin = 0; bin < ViewVisibility::BinCount; bin++)
     {
-#pragma region Draw OctreeFrustum
+        const std::vector<const StaticMeshRenderer*>& meshes = visibility.GetStaticMeshes(static_cast<MaterialType>(bin));
+        const std::vector<uint32_t>& lods = visibility.GetStaticMeshLods(static_cast<MaterialType>(bin));
 
-        while (true)
+        for (size_t j = 0; j < meshes.size(); j++)
         {
-            Bound bound = it.GetBound();
-            // if we not see it 
-            if (frustum.IsOnFrustum(bound))
+            const StaticMeshRenderer* const meshRenderer = meshes[j];
+            const Transform& transform = meshRenderer->GetEntity()->transform;
+            ModelUniformData modelData;
+            modelData.model = transform.worldMatrix;
+            // +1 to avoid the black color of the attachment be a valid index  
+            modelData.meshRenderIndex = scene.GetEntityIndex(meshRenderer->GetEntity()) + 1;
+
+            try
             {
-                std::vector<const StaticMeshRenderer*>* handle = nullptr;
-                it.GetHandles(&handle);
-
-                // draw
-                for (const StaticMeshRenderer* const meshRenderer : *handle)
-                {
-                    if (!meshRenderer->mesh.IsValid())
-                        continue;
-                    
-                    for (size_t i = 0; i < meshRenderer->mesh->models.GetSize(); i++)
-                    {
-                        Pointer<Model> model = meshRenderer->mesh->models[i];
-                        Bound aabb;
-                        meshRenderer->GetAabb(&aabb);
-
-                        if (!frustum.IsOnFrustum(aabb))
-                        {
-                            continue;
-                        }
-
-                        const Transform& transform = meshRenderer->GetEntity()->transform;
-                        ModelUniformData modelData;
-                        modelData.model = transform.worldMatrix;
-                        // +1 to avoid the black color of the attachment be a valid index  
-                            modelData.meshRenderIndex = scene.GetEntityIndex(meshRenderer->GetEntity()) + 1;
-
-                        try
-                        {
-                            modelData.normalInvertMatrix = transform.worldMatrix.Inverted().Transposed();
-                        }
-                        catch (const std::invalid_argument&)
-                        {
-                            modelData.normalInvertMatrix = Matrix::Identity();
-                        }
-                        
-                        if (model.IsValid())
-                        {
-                            Rhi::UpdateModelUniform(modelData);
-                            Rhi::DrawModel(DrawMode::Triangles, model->GetId());
-                        }
-                    }
-                  
-                }
+                modelData.normalInvertMatrix = transform.worldMatrix.Inverted().Transposed();
             }
-            if (!it.Iterate())
-                break;
-        }
-#pragma endregion Draw OctreeFrustum
-    }
-    else
-    {
-#pragma region Draw iteration
-        for (const StaticMeshRenderer* mesh : m_StaticMeshs)
-        {
-            if (!mesh->mesh)
-                continue;
+            catch (const std::invalid_argument&)
+            {
+                modelData.normalInvertMatrix = Matrix::Identity();
+            }
+
+            Rhi::UpdateModelUniform(modelData);
 
-            for (size_t i = 0; i < mesh->mesh->models.GetSize(); i++)
+            for (size_t i = 0; i < meshRenderer->mesh->models.GetSize(); i++)
             {
-                Pointer<Model> model = mesh->mesh->models[i];
-                const Transform& transform = mesh->GetEntity()->transform;
-                ModelUniformData modelData;
-                modelData.model = transform.worldMatrix;
-                // +1 to avoid the black color of the attachment be a valid index  
-                modelData.meshRenderIndex = scene.GetEntityIndex(mesh->GetEntity()) + 1;
-
-                // Use a try-catch block in case the matrix is not invertible
-                try
-                {
-                    modelData.normalInvertMatrix = transform.worldMatrix.Inverted().Transposed();
-                }
-                catch (const std::invalid_argument&)
-                {
-                    modelData.normalInvertMatrix = Matrix::Identity();
-                }
+                const Pointer<Model>& model = meshRenderer->mesh->models[i];
 
                 if (model.IsValid())
-                {
-                    Rhi::UpdateModelUniform(modelData);
-                    Rhi::DrawModel(DrawMode::Triangles, model->GetId());
-                }
+                    Rhi::DrawModel(DrawMode::Triangles, model->GetLodId(lods[j]));
             }
         }
-#pragma endregion Draw iteration
     }
 }
 
@@ -416,6 +360,62 @@ void MeshesDrawer::PrepareOctree(const Scene& scene)
     scene.renderOctree.Update(meshrenderWithAabb);
 }
 
+void MeshesDrawer::PrepareBonePalettes()
+{
+    m_BonePalettes.Clear();
+    m_BoneOffsets.assign(m_SkinnedRender.size(), 0);
+
+    // The palettes are uploaded once here, the passes of the viewport then only select theirs with an offset
+    for (const uint32_t i : m_DrawnSkinnedMeshes)
+    {
+        const List<Matrix>& matrices = m_SkinnedRender[i]->GetMatrices();
+
+        m_BoneOffsets[i] = static_cast<uint32_t>(m_BonePalettes.GetSize());
+        m_BonePalettes.AddRange(matrices.GetData(), matrices.GetSize());
+    }
+
+    Rhi::UpdateBonePalettes(m_BonePalettes.GetData(), m_BonePalettes.GetSize());
+}
+
+void MeshesDrawer::DrawSkinnedMeshNonShaded(const size_t index, const uint64_t meshRenderIndex) const
+{
+    const SkinnedMeshRenderer* const skinnedMeshRender = m_SkinnedRender[index];
+
+    ModelUniformData modelData;
+    modelData.model = skinnedMeshRender->GetTransform().worldMatrix;
+    modelData.boneOffset = m_BoneOffsets[index];
+    modelData.boneCount = static_cast<uint32_t>(skinnedMeshRender->GetMatrices().GetSize());
+    modelData.meshRenderIndex = meshRenderIndex;
+
+    try
+    {
+        modelData.normalInvertMatrix = skinnedMeshRender->GetTransform().worldMatrix.Inverted().Transposed();
+    }
+    catch (const std::invalid_argument&)
+    {
+        modelData.normalInvertMatrix = Matrix::Identity();
+    }
+
+    Rhi::UpdateModelUniform(modelData);
+
+    if (m_UsesSkinningPass)
+    {
+        uint32_t baseVertex = m_SkinningPass.GetBaseVertex(index);
+        for (uint32_t i = 0; i < skinnedMeshRender->mesh->models.GetSize(); i++)
+        {
+            const Pointer<Model>& model = skinnedMeshRender->mesh->models[i];
+            Rhi::DrawSkinnedModel(DrawMode::Triangles, model->GetId(), baseVertex);
+            baseVertex += static_cast<uint32_t>(model->GetVertices().size());
+        }
+        return;
+    }
+
+    for (uint32_t i = 0; i < skinnedMeshRender->mesh->models.GetSize(); i++)
+    {
+        Rhi::DrawModel(DrawMode::Triangles, skinnedMeshRender->mesh->models[i]->GetId());
+    }
+}
+
 void MeshesDrawer::EndFrame()
 {
     // TO DO
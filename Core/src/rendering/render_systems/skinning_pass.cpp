@@ -0,0 +1,135 @@
+﻿#include "rendering/render_systems/skinning_pass.hpp"
+
+#include "rendering/rhi.hpp"
+#include "resource/resource_manager.hpp"
+
+using namespace XnorCore;
+
+// The compute shader reads the vertices as an array of floats
+static_assert(sizeof(Vertex) == 22 * sizeof(float_t), "The layout of Vertex must match the skinning compute shader");
+static_assert(offsetof(Vertex, boneIndices) == 14 * sizeof(float_t), "The layout of Vertex must match the skinning compute shader");
+static_assert(offsetof(Vertex, boneWeight) == 18 * sizeof(float_t), "The layout of Vertex must match the skinning compute shader");
+
+void SkinningPass::Init()
+{
+    m_SkinningShader = ResourceManager::Get<ComputeShader>("skinning");
+    m_SkinningShader->CreateInInterface();
+}
+
+void SkinningPass::Compute(const std::vector<const SkinnedMeshRenderer*>& renderers, const std::vector<uint32_t>& drawnRenderers, const std::vector<uint32_t>& boneOffsets)
+{
+    m_BaseVertices.assign(renderers.size(), 0);
+
+    uint32_t vertexCount = 0;
+    for (const uint32_t i : drawnRenderers)
+    {
+        m_BaseVertices[i] = vertexCount;
+
+        if (!renderers[i]->mesh)
+            continue;
+
+        for (size_t j = 0; j < renderers[i]->mesh->models.GetSize(); j++)
+            vertexCount += static_cast<uint32_t>(renderers[i]->mesh->models[j]->GetVertices().size());
+    }
+
+    if (vertexCount == 0)
+        return;
+
+    Rhi::ReserveSkinnedVertices(vertexCount);
+
+    m_SkinningShader->Use();
+
+    for (const uint32_t i : drawnRenderers)
+    {
+        const SkinnedMeshRenderer* const renderer = renderers[i];
+
+        if (!renderer->mesh)
+            continue;
+
+        m_SkinningShader->SetInt("boneOffset", static_cast<int32_t>(boneOffsets[i]));
+        m_SkinningShader->SetInt("boneCount", static_cast<int32_t>(renderer->GetMatrices().GetSize()));
+
+        uint32_t baseVertex = m_BaseVertices[i];
+        for (size_t j = 0; j < renderer->mesh->models.GetSize(); j++)
+        {
+            const Pointer<Model>& model = renderer->mesh->models[j];
+            const uint32_t modelVertexCount = static_cast<uint32_t>(model->GetVertices().size());
+
+            Rhi::BindModelVertices(model->GetId(), SourceVertexBinding);
+            m_SkinningShader->SetInt("vertexCount", static_cast<int32_t>(modelVertexCount));
+            m_SkinningShader->SetInt("baseVertex", static_cast<int32_t>(baseVertex));
+            m_SkinningShader->DispatchCompute((modelVertexCount + WorkGroupSize - 1) / WorkGroupSize, 1, 1);
+
+            baseVertex += modelVertexCount;
+        }
+    }
+
+    // The cache is then read as vertex attributes by the draws of the depth passes
+    m_SkinningShader->SetMemoryBarrier(GpuMemoryBarrier::VertexAttribArrayBarrierBit);
+    m_SkinningShader->Unuse();
+}
+
+uint32_t SkinningPass::GetBaseVertex(const size_t rendererIndex) const
+{
+    return m_BaseVertices[rendererIndex];
+}
+
+void SkinningPass::SkinVertices(
+    const Vertex* const vertices,
+    const size_t vertexCount,
+    const Matrix* const boneMatrices,
+    const size_t boneCount,
+    SkinnedVertex* const output
+)
+{
+    for (size_t i = 0; i < vertexCount; i++)
+    {
+        const Vertex& vertex = vertices[i];
+
+        Vector3 position = vertex.position;
+        Vector3 normal = vertex.normal;
+
+        Vector3 skinnedPosition;
+        Vector3 skinnedNormal;
+        float_t totalWeight = 0.f;
+        bool_t inPalette = true;
+
+        for (size_t j = 0; j < Vertex::MaxBoneWeight; j++)
+        {
+            const float_t index = vertex.boneIndices[j];
+            const float_t weight = vertex.boneWeight[j];
+
+            if (index < 0.f || weight <= 0.f)
+                continue;
+
+            const size_t bone = static_cast<size_t>(index);
+
+            if (bone >= boneCount)
+            {
+                inPalette = false;
+                break;
+            }
+
+            const Matrix& m = boneMatrices[bone];
+            skinnedPosition += m * position * weight;
+            skinnedNormal += Vector3(
+                m.m00 * normal.x + m.m01 * normal.y + m.m02 * normal.z,
+                m.m10 * normal.x + m.m11 * normal.y + m.m12 * normal.z,
+                m.m20 * normal.x + m.m21 * normal.y + m.m22 * normal.z
+            ) * weight;
+            totalWeight += weight;
+        }
+
+        // Same fallback as the skinned vertex shaders, a vertex outside of its palette stays in bind pose
+        if (inPalette && totalWeight > 0.f)
+        {
+            position = skinnedPosition;
+
+            if (skinnedNormal.SquaredLength() > 0.f)
+                normal = skinnedNormal.Normalized();
+        }
+
+        output[i].position = Vector4(position.x, position.y, position.z, 1.f);
+        output[i].normal = Vector4(normal.x, normal.y, normal.z, 0.f);
+    }
+}
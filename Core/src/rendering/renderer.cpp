@@ -1,5 +1,7 @@
 #include "rendering/renderer.hpp"
 
+#include "input/time.hpp"
+#include "rendering/render_stats.hpp"
 #include "rendering/rhi.hpp"
 #include "resource/resource_manager.hpp"
 #include "scene/component/static_mesh_renderer.hpp"
@@ -24,8 +26,69 @@ void Renderer::Initialize()
 void Renderer::BeginFrame(const Scene& scene, const Viewport& viewport)
 {
     Rhi::ClearBuffer(BufferFlag::ColorBit);
-    meshesDrawer.BeginFrame(scene, *this);  
+
+    const uint64_t frame = Time::GetTotalFrameCount<uint64_t>();
+    if (frame != m_Frame)
+        BeginApplicationFrame(scene, viewport, frame);
+
+    ViewportState& state = m_ViewportStates[&viewport];
+    state.view = { *viewport.camera, viewport.GetAspect() };
+    state.frame = frame;
+
+    state.visibility.ResetStats();
+    m_NonShadedVisibility.ResetStats();
+
+    m_Frustum.UpdateFromCamera(*viewport.camera, viewport.GetAspect());
+
+    const OcclusionCuller* occlusionCuller = nullptr;
+    if (enableOcclusionCulling)
+    {
+        RasterizeOccluders(*viewport.camera, viewport.viewPortSize);
+        occlusionCuller = &m_OcclusionCuller;
+    }
+
+    // Every pass of the view draws from the same visibility
+    state.visibility.Compute(m_Frustum, &scene.renderOctree, meshesDrawer.GetSkinnedMeshes(), occlusionCuller);
+    meshesDrawer.SelectLods(*viewport.camera, &state.lodSelector, &state.visibility);
+
+    RenderStats::BeginPass("Lights");
     lightManager.BeginFrame(scene, viewport, *this);
+    RenderStats::EndPass();
+
+    // The visible skinned meshes and the casters of the shadow views are known, only their palettes are uploaded
+    RenderStats::BeginPass("Meshes");
+    meshesDrawer.PrepareSkinnedMeshes(state.visibility, lightManager.GetShadowSkinnedCasters());
+    RenderStats::EndPass();
+
+    RenderStats::BeginPass("Lights");
+    lightManager.RenderShadows(*this);
+    RenderStats::EndPass();
+}
+
+void Renderer::BeginApplicationFrame(const Scene& scene, const Viewport& viewport, const uint64_t frame)
+{
+    // The viewports that weren't rendered during the last frame are closed or hidden
+    std::erase_if(m_ViewportStates, [this](const decltype(m_ViewportStates)::value_type& entry) { return entry.second.frame != m_Frame; });
+
+    m_RenderedViews.clear();
+    for (const decltype(m_ViewportStates)::value_type& entry : m_ViewportStates)
+        m_RenderedViews.push_back(entry.second.view);
+
+    m_ActiveCameras.clear();
+    for (const RenderedView& view : m_RenderedViews)
+        m_ActiveCameras.push_back(view.camera);
+
+    if (m_ActiveCameras.empty())
+        m_ActiveCameras.push_back(*viewport.camera);
+
+    m_Frame = frame;
+
+    RenderStats::BeginPass("Meshes");
+    meshesDrawer.BeginFrame(scene, *this);
+    RenderStats::EndPass();
+
+    // The viewports share the shadow maps, so the casters get the same level in all of them
+    meshesDrawer.SelectShadowLods(m_ActiveCameras);
 }
 
 void Renderer::EndFrame(const Scene& scene)
@@ -39,23 +102,55 @@ void Renderer::RenderViewport(const Viewport& viewport, const Scene& scene)
     BeginFrame(scene,viewport);
     
 	BindCamera(*viewport.camera,viewport.viewPortSize);
-	m_Frustum.UpdateFromCamera(*viewport.camera,viewport.GetAspect());
+
+	const ViewportState& state = m_ViewportStates[&viewport];
 	const ViewportData& viewportData = viewport.viewportData;
-	DeferredRendering(*viewport.camera, scene, viewportData, viewport.viewPortSize);
-	ForwardPass(scene, viewport, viewport.viewPortSize, viewport.isEditor);
+	DeferredRendering(*viewport.camera, scene, state.visibility, viewportData, viewport.viewPortSize);
+	ForwardPass(scene, state.visibility, viewport, viewport.viewPortSize, viewport.isEditor);
 	
 	if (viewportData.usePostProcess)
+	{
+		RenderStats::BeginPass("PostProcess");
 		postProcessPass.Compute(*viewport.viewportData.colorAttachment , *viewport.image, viewportData.postprocessRendertarget);
+		RenderStats::EndPass();
+	}
 
     EndFrame(scene);
 }
 
-void Renderer::ZPass(const Scene& scene, const Camera& camera,
+void Renderer::RasterizeOccluders(const Camera& camera, const Vector2i viewportSize)
+{
+    Matrix viewProjection;
+    camera.GetVp(viewportSize, &viewProjection);
+    m_OcclusionCuller.Begin(viewProjection);
+
+    for (const StaticMeshRenderer* const meshRenderer : meshesDrawer.GetStaticMeshes())
+    {
+        if (!meshRenderer->isOccluder || !meshRenderer->mesh.IsValid())
+            continue;
+
+        Bound aabb;
+        meshRenderer->GetAabb(&aabb);
+        if (!m_Frustum.IsOnFrustum(aabb))
+            continue;
+
+        const Matrix& modelMatrix = meshRenderer->GetEntity()->transform.worldMatrix;
+        for (size_t i = 0; i < meshRenderer->mesh->models.GetSize(); i++)
+        {
+            const Model& model = *meshRenderer->mesh->models[i];
+            m_OcclusionCuller.RasterizeOccluder(model.GetVertices(), model.GetIndices(), modelMatrix);
+        }
+    }
+
+    m_OcclusionCuller.End();
+}
+
+void Renderer::ZPass(const Scene& scene, const Viewport& viewport,
                      const RenderPassBeginInfo& renderPassBeginInfo, const RenderPass& renderPass,
                      const Pointer<Shader>& shaderToUseStatic,const Pointer<Shader> shaderToUseSkinned,
                      bool_t drawEditorUi)
 {
-    RenderNonShadedPass(scene, camera, renderPassBeginInfo, renderPass, shaderToUseStatic, shaderToUseSkinned, drawEditorUi);
+    RenderNonShadedPass(scene, viewport, renderPassBeginInfo, renderPass, shaderToUseStatic, shaderToUseSkinned, drawEditorUi);
 }
 
 void Renderer::SwapBuffers() const
@@ -63,7 +158,12 @@ void Renderer::SwapBuffers() const
     Rhi::SwapBuffers();
 }
 
-void Renderer::DeferredRendering(const Camera& camera, const Scene& scene, const ViewportData& viewportData, const Vector2i viewportSize) const 
+const std::vector<RenderedView>& Renderer::GetRenderedViews() const
+{
+    return m_RenderedViews;
+}
+
+void Renderer::DeferredRendering(const Camera&, const Scene& scene, const ViewVisibility& visibility, const ViewportData& viewportData, const Vector2i viewportSize) const 
 {
     const RenderPassBeginInfo renderPassBeginInfo =
     {
@@ -74,17 +174,19 @@ void Renderer::DeferredRendering(const Camera& camera, const Scene& scene, const
         .clearColor = clearColor
     };
 
+    RenderStats::BeginPass("GBuffer");
     viewportData.gBufferPass.BeginRenderPass(renderPassBeginInfo);
 
     // Draw Simple Mesh
     m_GBufferShader->Use();
-    meshesDrawer.RenderStaticMesh(MaterialType::Opaque, camera, m_Frustum,scene);
+    meshesDrawer.RenderStaticMesh(visibility, MaterialType::Opaque, scene);
     m_GBufferShader->Unuse();
     
     // DrawSkinnedMesh
-    meshesDrawer.RenderAnimation();
+    meshesDrawer.RenderAnimation(visibility);
 
     viewportData.gBufferPass.EndRenderPass();
+    RenderStats::EndPass();
 
     const RenderPassBeginInfo renderPassBeginInfoLit =
     {
@@ -95,6 +197,7 @@ void Renderer::DeferredRendering(const Camera& camera, const Scene& scene, const
         .clearColor = clearColor
     };
 
+    RenderStats::BeginPass("Lighting");
     viewportData.colorPass.BeginRenderPass(renderPassBeginInfoLit);
     m_GBufferShaderLit->Use();
 
@@ -110,9 +213,10 @@ void Renderer::DeferredRendering(const Camera& camera, const Scene& scene, const
     viewportData.colorPass.EndRenderPass();
 
     m_GBufferShaderLit->Unuse();
+    RenderStats::EndPass();
 }
 
-void Renderer::ForwardPass(const Scene& scene,
+void Renderer::ForwardPass(const Scene& scene, const ViewVisibility& visibility,
                            const Viewport& viewport, const Vector2i viewportSize, const bool_t isEditor) const
 {
     const ViewportData& viewportData = viewport.viewportData;
@@ -126,10 +230,11 @@ void Renderer::ForwardPass(const Scene& scene,
         .clearColor = clearColor
     };
 
+    RenderStats::BeginPass("Forward");
     viewportData.colorPass.BeginRenderPass(renderPassBeginInfoLit);
 
     m_Forward->Use();
-    meshesDrawer.RenderStaticMesh(MaterialType::Lit,*viewport.camera,m_Frustum,scene);
+    meshesDrawer.RenderStaticMesh(visibility, MaterialType::Lit, scene);
     m_Forward->Unuse();
     meshesDrawer.DrawAabb(m_Cube);
     skyboxRenderer.DrawSkymap(m_Cube, scene.skybox);
@@ -144,95 +249,47 @@ void Renderer::ForwardPass(const Scene& scene,
     }
 
     viewportData.colorPass.EndRenderPass();
+    RenderStats::EndPass();
 }
 
 
-void Renderer::DrawMeshRendersByType(const MaterialType materialType, const Scene& scene) const
-{
-    Rhi::SetPolygonMode(PolygonFace::FrontAndBack, PolygonMode::Fill);
-
-
-    const OctreeIterator<OctreeNode<const StaticMeshRenderer>> it = scene.renderOctree.GetIterator();
-
-    while (true)
-    {
-        Bound bound = it.GetBound();
-        // if we not see it 
-        if (m_Frustum.IsOnFrustum(bound))
-        {
-            std::vector<const StaticMeshRenderer*>* handle = nullptr;
-            it.GetHandles(&handle);
-
-#pragma region Draw
-            // draw
-            for (const StaticMeshRenderer* const meshRenderer : *handle)
-            {
-                if (!meshRenderer->mesh)
-                    continue;
-                
-                if (meshRenderer->material.materialType != materialType)
-                    continue;
-                
-                for (size_t i = 0; i < meshRenderer->mesh->models.GetSize(); i++)
-                {
-                    Pointer<Model> model = meshRenderer->mesh->models[i];
-                    
-                    Bound aabb;
-                    meshRenderer->GetAabb(&aabb);
-
-                    if (!m_Frustum.IsOnFrustum(aabb))
-                    {
-                        continue;
-                    }
-
-                    const Transform& transform = meshRenderer->GetEntity()->transform;
-                    ModelUniformData modelData;
-                    modelData.model = transform.worldMatrix;
-
-                    try
-                    {
-                        modelData.normalInvertMatrix = transform.worldMatrix.Inverted().Transposed();
-                    }
-                    catch (const std::invalid_argument&)
-                    {
-                        modelData.normalInvertMatrix = Matrix::Identity();
-                    }
-
-
-                    if (model)
-                    {
-                        Rhi::UpdateModelUniform(modelData);
-                        meshRenderer->material.BindMaterial();
-                        Rhi::DrawModel(DrawMode::Triangles, model->GetId());
-                    }
-                }
-
-#pragma endregion Draw
-            }
-        }
-        if (!it.Iterate())
-            break;
-    }
-}
-
-
-void Renderer::RenderNonShadedPass(const Scene& scene, const Camera& camera,
+void Renderer::RenderNonShadedPass(const Scene& scene, const Viewport& viewport,
                                    const RenderPassBeginInfo& renderPassBeginInfo,
                                    const RenderPass& renderPass, const Pointer<Shader>& shaderToUseStatic,const Pointer<Shader>& shaderToUseSkinned,
                                    bool_t drawEditorUi)
 {
+    RenderStats::BeginPass("NonShaded");
     shaderToUseStatic->Use();
+    const Camera& camera = *viewport.camera;
     const Vector2i viewportSize = renderPassBeginInfo.renderAreaOffset + renderPassBeginInfo.renderAreaExtent;
-    const float_t aspect =  static_cast<float_t>(viewportSize.x) / static_cast<float_t>(viewportSize.y);
     BindCamera(camera, viewportSize);
-    m_Frustum.UpdateFromCamera(camera, aspect);
+
+    // The viewport was already culled if it was rendered during this frame
+    const ViewVisibility* visibility = &m_NonShadedVisibility;
+    const decltype(m_ViewportStates)::const_iterator state = m_ViewportStates.find(&viewport);
+    if (state != m_ViewportStates.end() && state->second.frame == Time::GetTotalFrameCount<uint64_t>())
+    {
+        visibility = &state->second.visibility;
+    }
+    else
+    {
+        const float_t aspect =  static_cast<float_t>(viewportSize.x) / static_cast<float_t>(viewportSize.y);
+        m_Frustum.UpdateFromCamera(camera, aspect);
+        m_NonShadedVisibility.Compute(m_Frustum, &scene.renderOctree, meshesDrawer.GetSkinnedMeshes());
+
+        static const std::vector<uint32_t> NoShadowCasters;
+        meshesDrawer.PrepareSkinnedMeshes(m_NonShadedVisibility, NoShadowCasters);
+    }
+
     renderPass.BeginRenderPass(renderPassBeginInfo);
-    meshesDrawer.RenderStaticMeshNonShaded(camera, m_Frustum, scene);
+    meshesDrawer.RenderStaticMeshNonShaded(*visibility, scene);
     shaderToUseStatic->Unuse();
 
-    shaderToUseSkinned->Use();
-    meshesDrawer.RenderAnimationNonShaded(scene);
-    shaderToUseSkinned->Unuse();
+    // Pre-skinned meshes are plain geometry for this pass
+    const Pointer<Shader>& skinnedShader = meshesDrawer.UsesSkinningPass() ? shaderToUseStatic : shaderToUseSkinned;
+    skinnedShader->Use();
+    meshesDrawer.RenderAnimationNonShaded(*visibility, scene);
+    skinnedShader->Unuse();
 
     shaderToUseStatic->Use();
     if (drawEditorUi)
@@ -243,10 +300,35 @@ void Renderer::RenderNonShadedPass(const Scene& scene, const Camera& camera,
     shaderToUseStatic->Unuse();
     
     renderPass.EndRenderPass();
+    RenderStats::EndPass();
 }
 
 
 
+void Renderer::RenderShadowCasters(const Camera& camera, const RenderPassBeginInfo& renderPassBeginInfo, const RenderPass& renderPass,
+                                   const Pointer<Shader>& shaderToUseStatic, const Pointer<Shader>& shaderToUseSkinned,
+                                   const std::vector<uint32_t>& staticCasters, const std::vector<uint32_t>& skinnedCasters)
+{
+    RenderStats::BeginPass("Shadows");
+    shaderToUseStatic->Use();
+    BindCamera(camera, renderPassBeginInfo.renderAreaOffset + renderPassBeginInfo.renderAreaExtent);
+    renderPass.BeginRenderPass(renderPassBeginInfo);
+    meshesDrawer.RenderStaticCasters(staticCasters);
+    shaderToUseStatic->Unuse();
+
+    if (!skinnedCasters.empty())
+    {
+        // Pre-skinned meshes are plain geometry for this pass
+        const Pointer<Shader>& skinnedShader = meshesDrawer.UsesSkinningPass() ? shaderToUseStatic : shaderToUseSkinned;
+        skinnedShader->Use();
+        meshesDrawer.RenderSkinnedCasters(skinnedCasters);
+        skinnedShader->Unuse();
+    }
+
+    renderPass.EndRenderPass();
+    RenderStats::EndPass();
+}
+
 void Renderer::BindCamera(const Camera& camera, const Vector2i screenSize) const
 {
     CameraUniformData cam;
@@ -1,5 +1,6 @@
 #include "rendering/rhi.hpp"
 
+#include <algorithm>
 #include <ranges>
 
 #include <glad/glad.h>
@@ -10,20 +11,44 @@
 #include "rendering/camera.hpp"
 #include "rendering/frame_buffer.hpp"
 #include "rendering/render_pass.hpp"
+#include "rendering/render_stats.hpp"
 #include "resource/resource_manager.hpp"
 #include "resource/shader.hpp"
 #include "utils/logger.hpp"
 
 using namespace XnorCore;
 
+namespace
+{
+	uint64_t GetTriangleCount(const DrawMode::DrawMode drawMode, const uint32_t vertexCount)
+	{
+		switch (drawMode)
+		{
+			case DrawMode::Triangles:
+			case DrawMode::TrianglesAdjency:
+				return vertexCount / 3;
+
+			case DrawMode::TrianglesStrip:
+			case DrawMode::TrianglesFan:
+			case DrawMode::TrianglesStripAdjency:
+				return vertexCount > 2 ? vertexCount - 2 : 0;
+
+			default:
+				return 0;
+		}
+	}
+}
+
 void Rhi::SetPolygonMode(const PolygonFace::PolygonFace face, const PolygonMode::PolygonMode mode)
 {
 	glPolygonMode(static_cast<GLenum>(face), GL_POINT + static_cast<GLenum>(mode));
+	RenderStats::AddStateChange();
 }
 
 void Rhi::SetViewport(const Vector2i screenOffset, const Vector2i screenSize)
 {
 	glViewport(screenOffset.x, screenOffset.y, screenSize.x, screenSize.y);
+	RenderStats::AddStateChange();
 }
 
 
@@ -56,8 +81,10 @@ uint32_t Rhi::CreateModel(const std::vector<Vertex>& vertices, const std::vector
 
 	GLintptr size = static_cast<GLintptr>(vertices.size() * sizeof(Vertex));
 	glNamedBufferData(modelInternal.vbo, size, vertices.data(), GL_STATIC_DRAW);
+	RenderStats::AddBufferUpload(static_cast<size_t>(size));
 	size = static_cast<GLintptr>(indices.size() * sizeof(uint32_t));
 	glNamedBufferData(modelInternal.ebo, size, indices.data(), GL_STATIC_DRAW);
+	RenderStats::AddBufferUpload(static_cast<size_t>(size));
 
 	// Position
 	glEnableVertexArrayAttrib(modelInternal.vao, 0);
@@ -129,11 +156,30 @@ void Rhi::DrawModel(const ENUM_VALUE(DrawMode) drawMode,const uint32_t modelId)
 	
 	
 	glDrawElements(DrawModeToOpengl(drawMode), static_cast<GLsizei>(model.nbrOfIndicies), GL_UNSIGNED_INT, nullptr);
+	RenderStats::AddDrawCall(GetTriangleCount(drawMode, model.nbrOfIndicies));
+}
+
+void Rhi::DrawSkinnedModel(const ENUM_VALUE(DrawMode) drawMode, const uint32_t modelId, const uint32_t baseVertex)
+{
+	const ModelInternal model = m_ModelMap.at(modelId);
+
+	// The cache only replaces the vertices, the indices of the model are reused as is
+	glVertexArrayElementBuffer(m_SkinnedVertexArray, model.ebo);
+	glBindVertexArray(m_SkinnedVertexArray);
+
+	glDrawElementsBaseVertex(DrawModeToOpengl(drawMode), static_cast<GLsizei>(model.nbrOfIndicies), GL_UNSIGNED_INT, nullptr, static_cast<GLint>(baseVertex));
+	RenderStats::AddDrawCall(GetTriangleCount(drawMode, model.nbrOfIndicies));
+}
+
+void Rhi::BindModelVertices(const uint32_t modelId, const uint32_t index)
+{
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, index, m_ModelMap.at(modelId).vbo);
 }
 
 void Rhi::DrawArray(DrawMode::DrawMode drawMode,uint32_t first, uint32_t count)
 {
 	glDrawArrays(DrawModeToOpengl(drawMode), static_cast<GLint>(first),  static_cast<GLint>(count));
+	RenderStats::AddDrawCall(GetTriangleCount(drawMode, count));
 }
 
 void Rhi::DestroyProgram(const uint32_t shaderId)
@@ -252,6 +298,7 @@ void Rhi::UseShader(const uint32_t shaderId)
 		glBlendFunc(srcValue, destValue);
 		glBlendEquation(blendEquation);
 		m_Blending = true;
+		RenderStats::AddStateChange();
 	}
 	
 	if (shaderInternal.cullInfo.enableCullFace)
@@ -260,9 +307,11 @@ void Rhi::UseShader(const uint32_t shaderId)
 		glCullFace(CullFaceToOpenglCullFace(shaderInternal.cullInfo.cullFace));
 		glFrontFace(FrontFaceToOpenglFrontFace(shaderInternal.cullInfo.frontFace));
 		m_Cullface = true;
+		RenderStats::AddStateChange();
 	}
 	
 	glUseProgram(shaderId);
+	RenderStats::AddShaderBind();
 }
 
 void Rhi::UnuseShader()
@@ -271,12 +320,14 @@ void Rhi::UnuseShader()
 	{
 		glDisable(GL_BLEND);
 		m_Blending = false;
+		RenderStats::AddStateChange();
 	}
 
 	if (m_Cullface)
 	{
 		glDisable(GL_CULL_FACE);
 		m_Cullface = false;
+		RenderStats::AddStateChange();
 	}
 	
 	glUseProgram(0);
@@ -663,6 +714,7 @@ void Rhi::ComputeDepthFunction(DepthFunction::DepthFunction depthFunction)
 	{
 		DepthTest(true);
 		glDepthFunc(GetOpengDepthEnum(depthFunction));
+		RenderStats::AddStateChange();
 	}	
 	else
 	{
@@ -978,6 +1030,7 @@ void Rhi::DestroyTexture(const uint32_t textureId)
 void Rhi::BindTexture(const uint32_t unit, const uint32_t textureId)
 {
 	glBindTextureUnit(unit, textureId);
+	RenderStats::AddTextureBind();
 }
 
 uint32_t Rhi::CreateFrameBuffer()
@@ -1056,15 +1109,30 @@ void Rhi::BlitFrameBuffer(const uint32_t readBuffer, const uint32_t targetBuffer
 	);
 }
 
+void Rhi::CopyTextureLayer(const uint32_t sourceId, const uint32_t targetId, const TextureType::TextureType textureType, const Vector2i size, const uint32_t layer)
+{
+	const GLenum target = GetOpenglTextureType(textureType);
+
+	glCopyImageSubData(
+		sourceId, target, 0, 0, 0, static_cast<GLint>(layer),
+		targetId, target, 0, 0, 0, static_cast<GLint>(layer),
+		size.x, size.y, 1
+	);
+}
+
 void Rhi::BindFrameBuffer(const uint32_t frameBufferId)
 {
 	if (glIsFramebuffer(frameBufferId))
+	{
 		glBindFramebuffer(GL_FRAMEBUFFER, frameBufferId);
+		RenderStats::AddStateChange();
+	}
 }
 
 void Rhi::UnbindFrameBuffer()
 {
 	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	RenderStats::AddStateChange();
 }
 
 void Rhi::AttachTextureToFrameBufferLayer(const uint32_t bufferId, const Attachment::Attachment attachment, const uint32_t textureId, const uint32_t level, const uint32_t layer)
@@ -1114,6 +1182,9 @@ void Rhi::GetPixelFromAttachement(const uint32_t attachmentIndex, const Vector2i
 void Rhi::SwapBuffers()
 {
 	glfwSwapBuffers(glfwGetCurrentContext());
+
+	// The frame ends once all its viewports are presented
+	RenderStats::EndFrame();
 }
 
 uint32_t Rhi::GetOpenglShaderType(const ShaderType::ShaderType shaderType)
@@ -1605,7 +1676,16 @@ void Rhi::Shutdown()
 	delete m_ModelUniform;
 	delete m_LightUniform;
 	delete m_MaterialUniform;
-	delete m_AnimationBuffer;
+	delete m_BonePaletteBuffer;
+	delete m_SkinnedVertexBuffer;
+	delete m_PointLightBuffer;
+	delete m_SpotLightBuffer;
+	delete m_DirectionalLightBuffer;
+	delete m_LightClusterBuffer;
+	delete m_LightIndexBuffer;
+
+	if (glIsVertexArray(m_SkinnedVertexArray))
+		glDeleteVertexArrays(1, &m_SkinnedVertexArray);
 }
 
 void Rhi::PrepareRendering()
@@ -1626,9 +1706,48 @@ void Rhi::PrepareRendering()
 	m_MaterialUniform->Allocate(sizeof(MaterialData),nullptr);
 	m_MaterialUniform->Bind(4);
 
-	m_AnimationBuffer = new UniformBuffer();
-	m_AnimationBuffer->Allocate(sizeof(SkinnedMeshGpuData),nullptr);
-	m_AnimationBuffer->Bind(5);
+	m_BonePaletteBuffer = new ShaderStorageBuffer();
+	m_BonePaletteBuffer->Allocate(InitialBonePaletteSize * sizeof(Matrix), nullptr);
+	m_BonePaletteBuffer->Bind(BonePaletteBinding);
+
+	m_SkinnedVertexBuffer = new ShaderStorageBuffer();
+	m_SkinnedVertexBuffer->Allocate(InitialSkinnedVertexCount * sizeof(SkinnedVertex), nullptr);
+	m_SkinnedVertexBuffer->Bind(SkinnedVertexBinding);
+
+	// The depth passes only read the position and the normal, so the cache is drawn with a reduced layout
+	glCreateVertexArrays(1, &m_SkinnedVertexArray);
+
+	// Position
+	glEnableVertexArrayAttrib(m_SkinnedVertexArray, 0);
+	glVertexArrayAttribBinding(m_SkinnedVertexArray, 0, 0);
+	glVertexArrayAttribFormat(m_SkinnedVertexArray, 0, 3, GL_FLOAT, GL_FALSE, offsetof(SkinnedVertex, position));
+
+	// Normal
+	glEnableVertexArrayAttrib(m_SkinnedVertexArray, 1);
+	glVertexArrayAttribBinding(m_SkinnedVertexArray, 1, 0);
+	glVertexArrayAttribFormat(m_SkinnedVertexArray, 1, 3, GL_FLOAT, GL_FALSE, offsetof(SkinnedVertex, normal));
+
+	glVertexArrayVertexBuffer(m_SkinnedVertexArray, 0, m_SkinnedVertexBuffer->GetId(), 0, sizeof(SkinnedVertex));
+
+	m_PointLightBuffer = new ShaderStorageBuffer();
+	m_PointLightBuffer->Allocate(InitialLightBufferSize, nullptr);
+	m_PointLightBuffer->Bind(PointLightBinding);
+
+	m_SpotLightBuffer = new ShaderStorageBuffer();
+	m_SpotLightBuffer->Allocate(InitialLightBufferSize, nullptr);
+	m_SpotLightBuffer->Bind(SpotLightBinding);
+
+	m_DirectionalLightBuffer = new ShaderStorageBuffer();
+	m_DirectionalLightBuffer->Allocate(InitialLightBufferSize, nullptr);
+	m_DirectionalLightBuffer->Bind(DirectionalLightBinding);
+
+	m_LightClusterBuffer = new ShaderStorageBuffer();
+	m_LightClusterBuffer->Allocate(InitialLightBufferSize, nullptr);
+	m_LightClusterBuffer->Bind(LightClusterBinding);
+
+	m_LightIndexBuffer = new ShaderStorageBuffer();
+	m_LightIndexBuffer->Allocate(InitialLightBufferSize, nullptr);
+	m_LightIndexBuffer->Bind(LightIndexBinding);
 
 	skyBoxParser.Init();
 }
@@ -1653,9 +1772,33 @@ void Rhi::UpdateCameraUniform(const CameraUniformData& cameraUniformData)
 	m_CameraUniform->Update(sizeof(CameraUniformData), 0, cameraUniformData.view.Raw());
 }
 
-void Rhi::UpdateAnimationUniform(const SkinnedMeshGpuData& skinnedMeshGpuData)
+void Rhi::UpdateBonePalettes(const Matrix* const boneMatrices, const size_t boneCount)
 {
-	m_AnimationBuffer->Update(sizeof(SkinnedMeshGpuData), 0, skinnedMeshGpuData.boneMatrices->Raw());
+	if (boneCount == 0)
+		return;
+
+	const size_t size = boneCount * sizeof(Matrix);
+
+	if (size > m_BonePaletteBuffer->GetSize())
+	{
+		// Doubling keeps the reallocations rare when characters are added over time
+		m_BonePaletteBuffer->Allocate(std::max(size, m_BonePaletteBuffer->GetSize() * 2), nullptr);
+		m_BonePaletteBuffer->Bind(BonePaletteBinding);
+	}
+
+	m_BonePaletteBuffer->Update(size, 0, boneMatrices->Raw());
+}
+
+void Rhi::ReserveSkinnedVertices(const size_t vertexCount)
+{
+	const size_t size = vertexCount * sizeof(SkinnedVertex);
+
+	if (size <= m_SkinnedVertexBuffer->GetSize())
+		return;
+
+	m_SkinnedVertexBuffer->Allocate(std::max(size, m_SkinnedVertexBuffer->GetSize() * 2), nullptr);
+	m_SkinnedVertexBuffer->Bind(SkinnedVertexBinding);
+	glVertexArrayVertexBuffer(m_SkinnedVertexArray, 0, m_SkinnedVertexBuffer->GetId(), 0, sizeof(SkinnedVertex));
 }
 
 void Rhi::UpdateLight(const GpuLightData& lightData)
@@ -1663,6 +1806,58 @@ void Rhi::UpdateLight(const GpuLightData& lightData)
 	m_LightUniform->Update(sizeof(GpuLightData), 0, &lightData.nbrOfPointLight);
 }
 
+void Rhi::UpdateLightArrays(
+	const PointLightData* const pointLights,
+	const size_t pointLightCount,
+	const SpotLightData* const spotLights,
+	const size_t spotLightCount,
+	const DirectionalLightData* const directionalLights,
+	const size_t directionalLightCount
+)
+{
+	UpdateStorageBuffer(m_PointLightBuffer, PointLightBinding, pointLightCount * sizeof(PointLightData), pointLights);
+	UpdateStorageBuffer(m_SpotLightBuffer, SpotLightBinding, spotLightCount * sizeof(SpotLightData), spotLights);
+	UpdateStorageBuffer(m_DirectionalLightBuffer, DirectionalLightBinding, directionalLightCount * sizeof(DirectionalLightData), directionalLights);
+}
+
+void Rhi::UpdateLightClusters(
+	const GpuLightClusterData& clusterData,
+	const LightClusterRange* const clusters,
+	const size_t clusterCount,
+	const uint32_t* const lightIndices,
+	const size_t lightIndexCount
+)
+{
+	const size_t rangesSize = clusterCount * sizeof(LightClusterRange);
+
+	// The header and the ranges share the buffer, so it is grown by hand before the two updates
+	if (sizeof(GpuLightClusterData) + rangesSize > m_LightClusterBuffer->GetSize())
+	{
+		m_LightClusterBuffer->Allocate(std::max(sizeof(GpuLightClusterData) + rangesSize, m_LightClusterBuffer->GetSize() * 2), nullptr);
+		m_LightClusterBuffer->Bind(LightClusterBinding);
+	}
+
+	m_LightClusterBuffer->Update(sizeof(GpuLightClusterData), 0, &clusterData);
+	if (rangesSize != 0)
+		m_LightClusterBuffer->Update(rangesSize, sizeof(GpuLightClusterData), clusters);
+
+	UpdateStorageBuffer(m_LightIndexBuffer, LightIndexBinding, lightIndexCount * sizeof(uint32_t), lightIndices);
+}
+
+void Rhi::UpdateStorageBuffer(ShaderStorageBuffer* const buffer, const uint32_t binding, const size_t size, const void* const data)
+{
+	if (size == 0)
+		return;
+
+	if (size > buffer->GetSize())
+	{
+		buffer->Allocate(std::max(size, buffer->GetSize() * 2), nullptr);
+		buffer->Bind(binding);
+	}
+
+	buffer->Update(size, 0, data);
+}
+
 void Rhi::BindMaterial(const Material& material)
 {
 	MaterialData materialData;
@@ -1709,6 +1904,7 @@ void Rhi::DepthTest(const bool_t value)
 {
 	value ? glEnable(GL_DEPTH_TEST) : glDisable(GL_DEPTH_TEST);
 	m_Depth = value;
+	RenderStats::AddStateChange();
 }
 
 
@@ -1741,6 +1937,7 @@ void Rhi::BindImageTexture(const uint32_t unit, const uint32_t texture,	const ui
 	const GLenum textureFormatInternal = GetOpenglInternalFormat(textureInternalFormat);
 
 	glBindImageTexture(unit, texture, static_cast<GLint>(level), static_cast<GLboolean>(layered), static_cast<GLint>(layer), access, textureFormatInternal);
+	RenderStats::AddTextureBind();
 }
 
 uint32_t Rhi::CreateTexture(const TextureCreateInfo& textureCreateInfo)
@@ -0,0 +1,132 @@
+﻿#include "rendering/view_visibility.hpp"
+
+#include "scene/component/skinned_mesh_renderer.hpp"
+#include "scene/component/static_mesh_renderer.hpp"
+
+using namespace XnorCore;
+
+void ViewVisibility::Compute(
+    const Frustum& frustum,
+    Octree<const StaticMeshRenderer>* const octree,
+    const std::vector<const SkinnedMeshRenderer*>& skinnedMeshes,
+    const OcclusionCuller* const occlusionCuller
+)
+{
+    for (std::vector<const StaticMeshRenderer*>& bin : m_StaticMeshes)
+        bin.clear();
+    for (std::vector<uint32_t>& bin : m_StaticMeshLods)
+        bin.clear();
+    m_SkinnedMeshes.clear();
+
+    m_Stats.traversals++;
+
+    const OctreeIterator<OctreeNode<const StaticMeshRenderer>> it = octree->GetIterator();
+    while (true)
+    {
+        m_Stats.testedNodes++;
+
+        if (frustum.IsOnFrustum(it.GetBound()))
+        {
+            std::vector<const StaticMeshRenderer*>* handles = nullptr;
+            it.GetHandles(&handles);
+
+            for (const StaticMeshRenderer* const meshRenderer : *handles)
+            {
+                if (!meshRenderer->mesh.IsValid())
+                    continue;
+
+                Bound aabb;
+                meshRenderer->GetAabb(&aabb);
+                m_Stats.testedMeshes++;
+
+                if (!frustum.IsOnFrustum(aabb))
+                    continue;
+
+                if (occlusionCuller && occlusionCuller->IsOccluded(aabb))
+                {
+                    m_Stats.occludedMeshes++;
+                    continue;
+                }
+
+                const size_t bin = static_cast<size_t>(meshRenderer->material.materialType);
+                m_StaticMeshes[bin].push_back(meshRenderer);
+                m_StaticMeshLods[bin].push_back(0);
+                m_Stats.visibleMeshes++;
+
+                const size_t triangleCount = LodSelector::GetTriangleCount(*meshRenderer, 0);
+                m_Stats.fullDetailTriangles += triangleCount;
+                m_Stats.triangles += triangleCount;
+            }
+        }
+
+        if (!it.Iterate())
+            break;
+    }
+
+    // The skinned meshes move every frame, so they aren't in the octree
+    for (size_t i = 0; i < skinnedMeshes.size(); i++)
+    {
+        if (!skinnedMeshes[i]->mesh)
+            continue;
+
+        Bound aabb;
+        skinnedMeshes[i]->GetAabb(&aabb);
+        m_Stats.testedMeshes++;
+
+        if (!frustum.IsOnFrustum(aabb))
+            continue;
+
+        if (occlusionCuller && occlusionCuller->IsOccluded(aabb))
+        {
+            m_Stats.occludedMeshes++;
+            continue;
+        }
+
+        m_SkinnedMeshes.push_back(static_cast<uint32_t>(i));
+        m_Stats.visibleMeshes++;
+    }
+}
+
+void ViewVisibility::SelectLods(const Camera& camera, LodSelector* const lodSelector, const MeshLodSettings& settings)
+{
+    lodSelector->BeginFrame();
+
+    for (size_t bin = 0; bin < BinCount; bin++)
+    {
+        for (size_t i = 0; i < m_StaticMeshes[bin].size(); i++)
+        {
+            const StaticMeshRenderer& meshRenderer = *m_StaticMeshes[bin][i];
+            uint32_t& lod = m_StaticMeshLods[bin][i];
+
+            // The triangles were counted at the level selected by Compute
+            m_Stats.triangles -= LodSelector::GetTriangleCount(meshRenderer, lod);
+            lod = lodSelector->Select(meshRenderer, camera, settings);
+            m_Stats.triangles += LodSelector::GetTriangleCount(meshRenderer, lod);
+        }
+    }
+}
+
+const std::vector<const StaticMeshRenderer*>& ViewVisibility::GetStaticMeshes(const MaterialType materialType) const
+{
+    return m_StaticMeshes[static_cast<size_t>(materialType)];
+}
+
+const std::vector<uint32_t>& ViewVisibility::GetStaticMeshLods(const MaterialType materialType) const
+{
+    return m_StaticMeshLods[static_cast<size_t>(materialType)];
+}
+
+const std::vector<uint32_t>& ViewVisibility::GetSkinnedMeshes() const
+{
+    return m_SkinnedMeshes;
+}
+
+const ViewVisibilityStats& ViewVisibility::GetStats() const
+{
+    return m_Stats;
+}
+
+void ViewVisibility::ResetStats()
+{
+    m_Stats = {};
+}
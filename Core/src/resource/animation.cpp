@@ -1,5 +1,9 @@
 #include "resource/animation.hpp"
 
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+
 #include "input/time.hpp"
 #include "rendering/animator.hpp"
 #include "rendering/rhi_typedef.hpp"
@@ -7,6 +11,191 @@
 
 using namespace XnorCore;
 
+namespace
+{
+    /// @brief Maximum error of a key time quantized to 16 bits, in ticks
+    constexpr float_t MaxKeyTimeError = 1.f;
+    /// @brief Maximum error of a key time quantized to 16 bits, relative to the smallest time between two keys of its track
+    constexpr float_t MaxKeyTimeGapError = 0.01f;
+
+    // Animators sharing an animation can be evaluated on different threads and resolve their bindings lazily.
+    // This is shared by all the animations so they stay copyable, it is only locked the first time an animator uses a skeleton
+    std::mutex channelBindingsMutex;
+
+    /// @brief Greedily removes the keys that can be interpolated from the kept ones
+    /// @param keyCount Number of keys
+    /// @param isSegmentValid Function returning whether the keys between two keys can be interpolated from them within the error bounds
+    /// @returns Indices of the kept keys
+    template <typename IsSegmentValidT>
+    std::vector<uint32_t> ReduceKeys(const uint32_t keyCount, IsSegmentValidT&& isSegmentValid)
+    {
+        std::vector<uint32_t> keptKeys = { 0 };
+        uint32_t start = 0;
+
+        for (uint32_t end = 2; end < keyCount; end++)
+        {
+            if (isSegmentValid(start, end))
+                continue;
+
+            // The segment can't be extended to this key, so the previous one is kept and starts a new segment
+            start = end - 1;
+            keptKeys.push_back(start);
+        }
+
+        if (keyCount > 1)
+            keptKeys.push_back(keyCount - 1);
+
+        return keptKeys;
+    }
+
+    /// @brief Number of keys a cursor can move forward before the search falls back to a binary search
+    constexpr uint32_t MaxCursorSteps = 4;
+
+    /// @brief Finds the last key at or before a time, starting from the key found by the previous search
+    /// @param keyCount Number of keys, must not be 0
+    /// @param time Time
+    /// @param cursor Key found by the previous search, updated with the found key
+    /// @param getTime Function returning the time of a key
+    /// @returns Key index, 0 if the time is before the first key
+    template <typename GetTimeT>
+    uint32_t FindKey(const uint32_t keyCount, const float_t time, uint32_t* const cursor, GetTimeT&& getTime)
+    {
+        uint32_t key = std::min(*cursor, keyCount - 1);
+
+        if (getTime(key) <= time)
+        {
+            // When playing forward the key is the same as last time or one of the next few ones
+            for (uint32_t i = 0; i <= MaxCursorSteps; i++)
+            {
+                if (key + 1 >= keyCount || getTime(key + 1) > time)
+                {
+                    *cursor = key;
+                    return key;
+                }
+
+                key++;
+            }
+        }
+        else if (key > 0 && getTime(key - 1) <= time)
+        {
+            // Playing backward
+            *cursor = key - 1;
+            return key - 1;
+        }
+
+        // Seek, or the animation looped: find the first key after the time
+        uint32_t first = 0;
+        uint32_t last = keyCount;
+
+        while (first < last)
+        {
+            const uint32_t middle = (first + last) / 2;
+
+            if (getTime(middle) <= time)
+                first = middle + 1;
+            else
+                last = middle;
+        }
+
+        key = first == 0 ? 0 : first - 1;
+        *cursor = key;
+
+        return key;
+    }
+
+    float_t KeyFactor(const float_t keyTime, const float_t nextKeyTime, const float_t time)
+    {
+        const float_t duration = nextKeyTime - keyTime;
+        if (duration <= 0.f)
+            return 0.f;
+
+        return std::clamp((time - keyTime) / duration, 0.f, 1.f);
+    }
+
+    /// @brief Samples an imported vector track, which can have its own key times
+    Vector3 SampleImportedKeys(const aiVectorKey* const keys, const uint32_t keyCount, const double_t time, const Vector3& defaultValue)
+    {
+        if (keyCount == 0)
+            return defaultValue;
+
+        uint32_t cursor = 0;
+        const uint32_t key = FindKey(keyCount, static_cast<float_t>(time), &cursor, [keys](const uint32_t i) { return static_cast<float_t>(keys[i].mTime); });
+        const uint32_t nextKey = std::min(key + 1, keyCount - 1);
+
+        const float_t t = KeyFactor(static_cast<float_t>(keys[key].mTime), static_cast<float_t>(keys[nextKey].mTime), static_cast<float_t>(time));
+
+        return Vector3::Lerp(Vector3(&keys[key].mValue.x), Vector3(&keys[nextKey].mValue.x), t);
+    }
+
+    /// @brief Samples an imported rotation track, which can have its own key times
+    Quaternion SampleImportedKeys(const aiQuatKey* const keys, const uint32_t keyCount, const double_t time)
+    {
+        if (keyCount == 0)
+            return Quaternion::Identity();
+
+        uint32_t cursor = 0;
+        const uint32_t key = FindKey(keyCount, static_cast<float_t>(time), &cursor, [keys](const uint32_t i) { return static_cast<float_t>(keys[i].mTime); });
+        const uint32_t nextKey = std::min(key + 1, keyCount - 1);
+
+        const float_t t = KeyFactor(static_cast<float_t>(keys[key].mTime), static_cast<float_t>(keys[nextKey].mTime), static_cast<float_t>(time));
+
+        const Quaternion rotation = Quaternion(Vector3(&keys[key].mValue.x), keys[key].mValue.w);
+        const Quaternion nextRotation = Quaternion(Vector3(&keys[nextKey].mValue.x), keys[nextKey].mValue.w);
+
+        return AnimationCompression::Nlerp(rotation, nextRotation, t);
+    }
+
+    /// @brief Packs the keys of a vector track and returns whether all of them are within the error bound once unpacked
+    bool_t PackVectors(
+        const List<Animation::KeyFrame>& keyFrames,
+        Vector3 Animation::KeyFrame::* const property,
+        const Vector3& min,
+        const Vector3& extent,
+        const float_t maxError,
+        const bool_t wide,
+        std::vector<uint16_t>* const packedValues,
+        std::vector<Vector3>* const decodedValues
+    )
+    {
+        const size_t keyCount = keyFrames.GetSize();
+        const size_t packedSize = wide ? AnimationCompression::WidePackedSize : AnimationCompression::PackedSize;
+
+        packedValues->resize(keyCount * packedSize);
+        decodedValues->resize(keyCount);
+
+        bool_t isValid = true;
+        for (size_t i = 0; i < keyCount; i++)
+        {
+            uint16_t* const packed = &(*packedValues)[i * packedSize];
+            const Vector3& value = keyFrames[i].*property;
+
+            if (wide)
+            {
+                AnimationCompression::PackVectorWide(value, min, extent, packed);
+                (*decodedValues)[i] = AnimationCompression::UnpackVectorWide(packed, min, extent);
+            }
+            else
+            {
+                AnimationCompression::PackVector(value, min, extent, packed);
+                (*decodedValues)[i] = AnimationCompression::UnpackVector(packed, min, extent);
+            }
+
+            isValid &= ((*decodedValues)[i] - value).Length() <= maxError;
+        }
+
+        return isValid;
+    }
+
+    float_t SegmentFactor(const List<Animation::KeyFrame>& keyFrames, const uint32_t start, const uint32_t end, const uint32_t key)
+    {
+        const float_t duration = keyFrames[end].time - keyFrames[start].time;
+        if (duration <= 0.f)
+            return 0.f;
+
+        return (keyFrames[key].time - keyFrames[start].time) / duration;
+    }
+}
+
 void Animation::BindSkeleton(Pointer<Skeleton> bindedSkeleton)
 {
     skeleton = std::move(bindedSkeleton);
@@ -24,28 +213,54 @@ bool_t Animation::Load(const aiAnimation& loadedData)
     m_FrameDuration = 1.f / m_Framerate;
     m_Duration = static_cast<float_t>(loadedData.mDuration / loadedData.mTicksPerSecond);
 
+    m_Channels.Clear();
+    m_ChannelIndices.clear();
+
+    m_IsCompressed = false;
+    m_CompressedChannels.Clear();
+    m_KeyTimes.Clear();
+    m_KeyValues.Clear();
+
+    // Animators keep pointers to the bindings, so they are emptied to be resolved again instead of being erased
+    for (auto&& bindings : m_ChannelBindings)
+        bindings.second.Clear();
+
     for (uint32_t i = 0; i < loadedData.mNumChannels; i++)
     {
         const aiNodeAnim* const channel = loadedData.mChannels[i];
         std::string name = channel->mNodeName.C_Str();
 
-        auto&& it = m_KeyFrames.emplace(name, channel->mNumPositionKeys);
+        if (!m_ChannelIndices.emplace(std::move(name), static_cast<int32_t>(m_Channels.GetSize())).second)
+            continue;
+
+        // Each property can have its own keys, so the channel gets a key at every time one of its properties has one
+        std::vector<double_t> times;
+        times.reserve(static_cast<size_t>(channel->mNumPositionKeys) + channel->mNumRotationKeys + channel->mNumScalingKeys);
 
         for (uint32_t j = 0; j < channel->mNumPositionKeys; j++)
-        {
-            const Vector3 translation = Vector3(&channel->mPositionKeys[j].mValue.x);
-            const Quaternion rotation = Quaternion(Vector3(&channel->mRotationKeys[j].mValue.x), channel->mRotationKeys[j].mValue.w);
-            const Vector3 scaling = Vector3(&channel->mScalingKeys[j].mValue.x);
+            times.push_back(channel->mPositionKeys[j].mTime);
+        for (uint32_t j = 0; j < channel->mNumRotationKeys; j++)
+            times.push_back(channel->mRotationKeys[j].mTime);
+        for (uint32_t j = 0; j < channel->mNumScalingKeys; j++)
+            times.push_back(channel->mScalingKeys[j].mTime);
+
+        std::ranges::sort(times);
+        times.erase(std::ranges::unique(times).begin(), times.end());
 
+        m_Channels.Add(List<KeyFrame>(times.size()));
+        List<KeyFrame>& keyFrames = m_Channels.Back();
+
+        for (size_t j = 0; j < times.size(); j++)
+        {
             const KeyFrame keyFrame =
             {
-                .translation = translation,
-                .rotation = rotation,
-                .scaling = scaling,
-                .time = static_cast<float_t>(channel->mPositionKeys[j].mTime)
+                .translation = SampleImportedKeys(channel->mPositionKeys, channel->mNumPositionKeys, times[j], Vector3::Zero()),
+                .rotation = SampleImportedKeys(channel->mRotationKeys, channel->mNumRotationKeys, times[j]),
+                .scaling = SampleImportedKeys(channel->mScalingKeys, channel->mNumScalingKeys, times[j], Vector3(1.f)),
+                .time = static_cast<float_t>(times[j])
             };
 
-            it.first->second[j] = keyFrame;
+            keyFrames[j] = keyFrame;
         }
     }
 
@@ -75,12 +290,395 @@ float_t Animation::GetFrameDuration() const
 
 void Animation::GetBoneKeyFrame(const Bone& bone, const List<Animation::KeyFrame>** keyFrames) const
 {
-    auto&& it = m_KeyFrames.find(bone.name);
-    if (it == m_KeyFrames.end())
+    auto&& it = m_ChannelIndices.find(bone.name);
+    if (it == m_ChannelIndices.end() || m_IsCompressed)
     {
         *keyFrames = nullptr;
         return;
     }
 
-    *keyFrames = &it->second;
+    *keyFrames = &m_Channels[it->second];
+}
+
+const List<int32_t>& Animation::GetChannelBindings(const Skeleton& boneSkeleton) const
+{
+    const List<Bone>& bones = boneSkeleton.GetBones();
+
+    std::scoped_lock lock(channelBindingsMutex);
+
+    auto&& it = m_ChannelBindings.find(boneSkeleton.GetGuid());
+
+    // The skeleton might have been reloaded with different bones since the bindings were resolved
+    if (it != m_ChannelBindings.end() && it->second.GetSize() == bones.GetSize())
+        return it->second;
+
+    List<int32_t>& bindings = m_ChannelBindings[boneSkeleton.GetGuid()];
+    bindings.Resize(bones.GetSize());
+
+    for (size_t i = 0; i < bones.GetSize(); i++)
+    {
+        auto&& channel = m_ChannelIndices.find(bones[i].name);
+        bindings[i] = channel == m_ChannelIndices.end() ? -1 : channel->second;
+    }
+
+    return bindings;
+}
+
+const List<Animation::KeyFrame>& Animation::GetChannel(const size_t channel) const
+{
+    if (m_IsCompressed)
+    {
+        static const List<KeyFrame> Empty;
+
+        Logger::LogError("Trying to get the key frames of channel {} of a compressed animation, use SampleChannel instead", channel);
+        return Empty;
+    }
+
+    return m_Channels[channel];
+}
+
+size_t Animation::GetChannelCount() const
+{
+    return m_IsCompressed ? m_CompressedChannels.GetSize() : m_Channels.GetSize();
+}
+
+void Animation::Compress(const AnimationCompressionSettings& settings)
+{
+    if (m_IsCompressed)
+        return;
+
+    m_CompressedChannels.Resize(m_Channels.GetSize());
+    m_KeyTimes.Clear();
+    m_KeyValues.Clear();
+
+    for (size_t i = 0; i < m_Channels.GetSize(); i++)
+    {
+        const List<KeyFrame>& keyFrames = m_Channels[i];
+        CompressedChannel& channel = m_CompressedChannels[i];
+
+        CompressVectorTrack(keyFrames, &KeyFrame::translation, settings.maxTranslationError, &channel.translation);
+        CompressRotationTrack(keyFrames, settings.maxRotationError, &channel.rotation, &channel.constantRotation);
+        CompressVectorTrack(keyFrames, &KeyFrame::scaling, settings.maxScalingError, &channel.scaling);
+    }
+
+    m_Channels = List<List<KeyFrame>>();
+    m_IsCompressed = true;
+}
+
+bool_t Animation::IsCompressed() const
+{
+    return m_IsCompressed;
+}
+
+void Animation::SampleChannel(const size_t channel, const float_t time, Vector3* const translation, Quaternion* const rotation, Vector3* const scaling) const
+{
+    ChannelCursor cursor;
+    SampleChannel(channel, time, &cursor, translation, rotation, scaling);
+}
+
+void Animation::SampleChannel(
+    const size_t channel,
+    const float_t time,
+    ChannelCursor* const cursor,
+    Vector3* const translation,
+    Quaternion* const rotation,
+    Vector3* const scaling
+) const
+{
+    if (m_IsCompressed)
+    {
+        const CompressedChannel& compressedChannel = m_CompressedChannels[channel];
+        // Key times are in ticks
+        const float_t keyTime = std::clamp(time * m_Framerate, 0.f, m_Duration * m_Framerate);
+
+        if (translation)
+            *translation = SampleVectorTrack(compressedChannel.translation, keyTime, &cursor->translationKey);
+        if (rotation)
+            *rotation = SampleRotationTrack(compressedChannel.rotation, compressedChannel.constantRotation, keyTime, &cursor->rotationKey);
+        if (scaling)
+            *scaling = SampleVectorTrack(compressedChannel.scaling, keyTime, &cursor->scalingKey);
+
+        return;
+    }
+
+    const List<KeyFrame>& keyFrames = m_Channels[channel];
+    if (keyFrames.GetSize() == 0)
+        return;
+
+    // Raw key frames have all their properties at the same times, so only one key needs to be found
+    const float_t tick = time * m_Framerate;
+    const uint32_t keyCount = static_cast<uint32_t>(keyFrames.GetSize());
+    const uint32_t key = FindKey(keyCount, tick, &cursor->translationKey, [&keyFrames](const uint32_t i) { return keyFrames[i].time; });
+    const uint32_t nextKey = std::min(key + 1, keyCount - 1);
+
+    const float_t t = KeyFactor(keyFrames[key].time, keyFrames[nextKey].time, tick);
+
+    if (translation)
+        *translation = Vector3::Lerp(keyFrames[key].translation, keyFrames[nextKey].translation, t);
+    if (rotation)
+        *rotation = AnimationCompression::Nlerp(keyFrames[key].rotation, keyFrames[nextKey].rotation, t);
+    if (scaling)
+        *scaling = Vector3::Lerp(keyFrames[key].scaling, keyFrames[nextKey].scaling, t);
+}
+
+size_t Animation::GetKeyFrameMemorySize() const
+{
+    if (m_IsCompressed)
+        return m_CompressedChannels.GetSize() * sizeof(CompressedChannel) + (m_KeyTimes.GetSize() + m_KeyValues.GetSize()) * sizeof(uint16_t);
+
+    size_t size = 0;
+    for (size_t i = 0; i < m_Channels.GetSize(); i++)
+        size += m_Channels[i].GetSize() * sizeof(KeyFrame);
+
+    return size;
+}
+
+void Animation::CompressVectorTrack(const List<KeyFrame>& keyFrames, Vector3 KeyFrame::* const property, const float_t maxError, CompressedTrack* const track)
+{
+    const uint32_t keyCount = static_cast<uint32_t>(keyFrames.GetSize());
+    if (keyCount == 0)
+    {
+        *track = CompressedTrack();
+        return;
+    }
+
+    const Vector3& first = keyFrames[0].*property;
+
+    Vector3 min = first;
+    Vector3 max = first;
+    bool_t isConstant = true;
+
+    for (uint32_t i = 0; i < keyCount; i++)
+    {
+        const Vector3& value = keyFrames[i].*property;
+
+        min = Vector3(std::min(min.x, value.x), std::min(min.y, value.y), std::min(min.z, value.z));
+        max = Vector3(std::max(max.x, value.x), std::max(max.y, value.y), std::max(max.z, value.z));
+
+        if ((value - first).Length() > maxError)
+            isConstant = false;
+    }
+
+    track->firstKey = static_cast<uint32_t>(m_KeyTimes.GetSize());
+    track->keyCount = 0;
+    track->isWide = false;
+    track->min = first;
+    track->extent = Vector3::Zero();
+
+    if (isConstant)
+        return;
+
+    track->min = min;
+    track->extent = max - min;
+
+    // The reduction is checked against the quantized values so the error bound accounts for the quantization.
+    // Any key can be kept, so all of them must be within the bound once quantized, which 16 bits can't do over a large range
+    std::vector<uint16_t> packedValues;
+    std::vector<Vector3> decodedValues;
+
+    if (!PackVectors(keyFrames, property, track->min, track->extent, maxError, false, &packedValues, &decodedValues))
+    {
+        track->isWide = true;
+        PackVectors(keyFrames, property, track->min, track->extent, maxError, true, &packedValues, &decodedValues);
+    }
+
+    const std::vector<uint32_t> keptKeys = ReduceKeys(
+        keyCount,
+        [&](const uint32_t start, const uint32_t end) -> bool_t
+        {
+            for (uint32_t i = start + 1; i < end; i++)
+            {
+                const Vector3 interpolated = Vector3::Lerp(decodedValues[start], decodedValues[end], SegmentFactor(keyFrames, start, end, i));
+
+                if ((interpolated - keyFrames[i].*property).Length() > maxError)
+                    return false;
+            }
+
+            return true;
+        }
+    );
+
+    AddKeys(keyFrames, keptKeys, packedValues, track);
+}
+
+void Animation::CompressRotationTrack(const List<KeyFrame>& keyFrames, const float_t maxError, CompressedTrack* const track, Quaternion* const constant)
+{
+    const uint32_t keyCount = static_cast<uint32_t>(keyFrames.GetSize());
+
+    *track = CompressedTrack();
+    track->firstKey = static_cast<uint32_t>(m_KeyTimes.GetSize());
+    *constant = Quaternion::Identity();
+
+    if (keyCount == 0)
+        return;
+
+    const Quaternion first = keyFrames[0].rotation.Normalized();
+
+    bool_t isConstant = true;
+    for (uint32_t i = 1; i < keyCount; i++)
+    {
+        if (AnimationCompression::AngleBetween(first, keyFrames[i].rotation.Normalized()) > maxError)
+        {
+            isConstant = false;
+            break;
+        }
+    }
+
+    if (isConstant)
+    {
+        *constant = first;
+        return;
+    }
+
+    // The smallest three error is around 1e-4 radians at most, well below any useful bound, so the rotations always fit in 16 bits
+    std::vector<uint16_t> packedValues(static_cast<size_t>(keyCount) * AnimationCompression::PackedSize);
+    std::vector<Quaternion> decodedValues(keyCount);
+
+    for (uint32_t i = 0; i < keyCount; i++)
+    {
+        uint16_t* const packed = &packedValues[static_cast<size_t>(i) * AnimationCompression::PackedSize];
+
+        AnimationCompression::PackRotation(keyFrames[i].rotation.Normalized(), packed);
+        decodedValues[i] = AnimationCompression::UnpackRotation(packed);
+    }
+
+    const std::vector<uint32_t> keptKeys = ReduceKeys(
+        keyCount,
+        [&](const uint32_t start, const uint32_t end) -> bool_t
+        {
+            for (uint32_t i = start + 1; i < end; i++)
+            {
+                const Quaternion interpolated = AnimationCompression::Nlerp(decodedValues[start], decodedValues[end], SegmentFactor(keyFrames, start, end, i));
+
+                if (AnimationCompression::AngleBetween(interpolated, keyFrames[i].rotation.Normalized()) > maxError)
+                    return false;
+            }
+
+            return true;
+        }
+    );
+
+    AddKeys(keyFrames, keptKeys, packedValues, track);
+}
+
+void Animation::AddKeys(
+    const List<KeyFrame>& keyFrames,
+    const std::vector<uint32_t>& keptKeys,
+    const std::vector<uint16_t>& packedValues,
+    CompressedTrack* const track
+)
+{
+    track->firstKey = static_cast<uint32_t>(m_KeyTimes.GetSize());
+    track->keyCount = static_cast<uint32_t>(keptKeys.size());
+    track->firstValue = static_cast<uint32_t>(m_KeyValues.GetSize());
+
+    // The times are quantized over the range of the track rather than the whole animation, so a short track keeps precise times in a long animation
+    track->startTime = keyFrames[keptKeys.front()].time;
+    track->timeExtent = keyFrames[keptKeys.back()].time - track->startTime;
+
+    // A long track can't place its keys within a tick with 16 bits, in which case its times are stored on 32 bits instead
+    float_t maxTimeError = MaxKeyTimeError;
+    for (size_t i = 1; i < keptKeys.size(); i++)
+        maxTimeError = std::min(maxTimeError, (keyFrames[keptKeys[i]].time - keyFrames[keptKeys[i - 1]].time) * MaxKeyTimeGapError);
+
+    track->isTimeWide = false;
+    for (const uint32_t key : keptKeys)
+    {
+        const float_t time = keyFrames[key].time;
+        const float_t quantizedTime = AnimationCompression::Dequantize(AnimationCompression::Quantize(time, track->startTime, track->timeExtent), track->startTime, track->timeExtent);
+
+        if (std::abs(quantizedTime - time) > maxTimeError)
+        {
+            track->isTimeWide = true;
+            break;
+        }
+    }
+
+    const size_t packedSize = track->isWide ? AnimationCompression::WidePackedSize : AnimationCompression::PackedSize;
+
+    for (const uint32_t key : keptKeys)
+    {
+        const float_t time = keyFrames[key].time;
+
+        if (track->isTimeWide)
+        {
+            uint16_t packedTime[AnimationCompression::WideSize];
+            AnimationCompression::QuantizeWide(time, track->startTime, track->timeExtent, packedTime);
+
+            for (size_t i = 0; i < AnimationCompression::WideSize; i++)
+                m_KeyTimes.Add(packedTime[i]);
+        }
+        else
+        {
+            m_KeyTimes.Add(AnimationCompression::Quantize(time, track->startTime, track->timeExtent));
+        }
+
+        for (size_t i = 0; i < packedSize; i++)
+            m_KeyValues.Add(packedValues[static_cast<size_t>(key) * packedSize + i]);
+    }
+}
+
+float_t Animation::GetCompressedKeyTime(const CompressedTrack& track, const uint32_t key) const
+{
+    if (track.isTimeWide)
+        return AnimationCompression::DequantizeWide(&m_KeyTimes[track.firstKey + static_cast<size_t>(key) * AnimationCompression::WideSize], track.startTime, track.timeExtent);
+
+    return AnimationCompression::Dequantize(m_KeyTimes[track.firstKey + key], track.startTime, track.timeExtent);
+}
+
+uint32_t Animation::FindCompressedKey(const CompressedTrack& track, const float_t keyTime, uint32_t* const cursor, float_t* const t) const
+{
+    const uint32_t key = FindKey(track.keyCount, keyTime, cursor, [this, &track](const uint32_t i) { return GetCompressedKeyTime(track, i); });
+
+    *t = 0.f;
+    if (key + 1 < track.keyCount)
+        *t = KeyFactor(GetCompressedKeyTime(track, key), GetCompressedKeyTime(track, key + 1), keyTime);
+
+    return key;
+}
+
+Vector3 Animation::SampleVectorTrack(const CompressedTrack& track, const float_t keyTime, uint32_t* const cursor) const
+{
+    if (track.keyCount == 0)
+        return track.min;
+
+    float_t t;
+    const uint32_t key = FindCompressedKey(track, keyTime, cursor, &t);
+
+    if (track.isWide)
+    {
+        const uint16_t* const packed = &m_KeyValues[track.firstValue + static_cast<size_t>(key) * AnimationCompression::WidePackedSize];
+
+        const Vector3 value = AnimationCompression::UnpackVectorWide(packed, track.min, track.extent);
+        if (t <= 0.f)
+            return value;
+
+        return Vector3::Lerp(value, AnimationCompression::UnpackVectorWide(packed + AnimationCompression::WidePackedSize, track.min, track.extent), t);
+    }
+
+    const uint16_t* const packed = &m_KeyValues[track.firstValue + static_cast<size_t>(key) * AnimationCompression::PackedSize];
+
+    const Vector3 value = AnimationCompression::UnpackVector(packed, track.min, track.extent);
+    if (t <= 0.f)
+        return value;
+
+    const Vector3 nextValue = AnimationCompression::UnpackVector(packed + AnimationCompression::PackedSize, track.min, track.extent);
+    return Vector3::Lerp(value, nextValue, t);
+}
+
+Quaternion Animation::SampleRotationTrack(const CompressedTrack& track, const Quaternion& constant, const float_t keyTime, uint32_t* const cursor) const
+{
+    if (track.keyCount == 0)
+        return constant;
+
+    float_t t;
+    const uint32_t key = FindCompressedKey(track, keyTime, cursor, &t);
+    const uint16_t* const packed = &m_KeyValues[track.firstValue + static_cast<size_t>(key) * AnimationCompression::PackedSize];
+
+    const Quaternion value = AnimationCompression::UnpackRotation(packed);
+    if (t <= 0.f)
+        return value;
+
+    const Quaternion nextValue = AnimationCompression::UnpackRotation(packed + AnimationCompression::PackedSize);
+    return AnimationCompression::Nlerp(value, nextValue, t);
 }
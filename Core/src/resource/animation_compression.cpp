@@ -0,0 +1,143 @@
+#include "resource/animation_compression.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace XnorCore;
+
+namespace
+{
+    constexpr float_t MaxQuantized = static_cast<float_t>(std::numeric_limits<uint16_t>::max());
+    constexpr double_t MaxWideQuantized = static_cast<double_t>(std::numeric_limits<uint32_t>::max());
+
+    // The three smallest components of a normalized quaternion are in [-1/sqrt(2), 1/sqrt(2)]
+    constexpr float_t SmallestThreeRange = 0.70710678f;
+    constexpr uint16_t SmallestThreeMask = 0x7FFF;
+    constexpr float_t MaxSmallestThree = static_cast<float_t>(SmallestThreeMask);
+}
+
+uint16_t AnimationCompression::Quantize(const float_t value, const float_t min, const float_t extent)
+{
+    if (extent <= 0.f)
+        return 0;
+
+    const float_t normalized = std::clamp((value - min) / extent, 0.f, 1.f);
+    return static_cast<uint16_t>(std::lround(normalized * MaxQuantized));
+}
+
+float_t AnimationCompression::Dequantize(const uint16_t value, const float_t min, const float_t extent)
+{
+    return min + static_cast<float_t>(value) / MaxQuantized * extent;
+}
+
+void AnimationCompression::QuantizeWide(const float_t value, const float_t min, const float_t extent, uint16_t* const packed)
+{
+    uint32_t quantized = 0;
+    if (extent > 0.f)
+    {
+        const double_t normalized = std::clamp((static_cast<double_t>(value) - min) / extent, 0.0, 1.0);
+        quantized = static_cast<uint32_t>(std::llround(normalized * MaxWideQuantized));
+    }
+
+    packed[0] = static_cast<uint16_t>(quantized >> 16);
+    packed[1] = static_cast<uint16_t>(quantized & 0xFFFF);
+}
+
+float_t AnimationCompression::DequantizeWide(const uint16_t* const packed, const float_t min, const float_t extent)
+{
+    const uint32_t quantized = (static_cast<uint32_t>(packed[0]) << 16) | packed[1];
+
+    return static_cast<float_t>(min + static_cast<double_t>(quantized) / MaxWideQuantized * extent);
+}
+
+void AnimationCompression::PackVector(const Vector3& vector, const Vector3& min, const Vector3& extent, uint16_t* const packed)
+{
+    packed[0] = Quantize(vector.x, min.x, extent.x);
+    packed[1] = Quantize(vector.y, min.y, extent.y);
+    packed[2] = Quantize(vector.z, min.z, extent.z);
+}
+
+Vector3 AnimationCompression::UnpackVector(const uint16_t* const packed, const Vector3& min, const Vector3& extent)
+{
+    return Vector3(Dequantize(packed[0], min.x, extent.x), Dequantize(packed[1], min.y, extent.y), Dequantize(packed[2], min.z, extent.z));
+}
+
+void AnimationCompression::PackVectorWide(const Vector3& vector, const Vector3& min, const Vector3& extent, uint16_t* const packed)
+{
+    QuantizeWide(vector.x, min.x, extent.x, packed);
+    QuantizeWide(vector.y, min.y, extent.y, packed + 2);
+    QuantizeWide(vector.z, min.z, extent.z, packed + 4);
+}
+
+Vector3 AnimationCompression::UnpackVectorWide(const uint16_t* const packed, const Vector3& min, const Vector3& extent)
+{
+    return Vector3(DequantizeWide(packed, min.x, extent.x), DequantizeWide(packed + 2, min.y, extent.y), DequantizeWide(packed + 4, min.z, extent.z));
+}
+
+void AnimationCompression::PackRotation(const Quaternion& rotation, uint16_t* const packed)
+{
+    size_t largest = 0;
+    for (size_t i = 1; i < 4; i++)
+    {
+        if (std::abs(rotation[i]) > std::abs(rotation[largest]))
+            largest = i;
+    }
+
+    // q and -q are the same rotation, so the dropped component can always be made positive
+    const float_t sign = rotation[largest] < 0.f ? -1.f : 1.f;
+
+    size_t component = 0;
+    for (size_t i = 0; i < 4; i++)
+    {
+        if (i == largest)
+            continue;
+
+        const float_t normalized = std::clamp((rotation[i] * sign / SmallestThreeRange + 1.f) * 0.5f, 0.f, 1.f);
+        packed[component] = static_cast<uint16_t>(std::lround(normalized * MaxSmallestThree));
+        component++;
+    }
+
+    // The index of the dropped component is stored in the high bits of the first two values
+    packed[0] |= static_cast<uint16_t>((largest >> 1) << 15);
+    packed[1] |= static_cast<uint16_t>((largest & 1) << 15);
+}
+
+Quaternion AnimationCompression::UnpackRotation(const uint16_t* const packed)
+{
+    const size_t largest = (static_cast<size_t>(packed[0] >> 15) << 1) | static_cast<size_t>(packed[1] >> 15);
+
+    Quaternion rotation;
+    float_t squaredSum = 0.f;
+    size_t component = 0;
+
+    for (size_t i = 0; i < 4; i++)
+    {
+        if (i == largest)
+            continue;
+
+        const float_t normalized = static_cast<float_t>(packed[component] & SmallestThreeMask) / MaxSmallestThree;
+        rotation[i] = (normalized * 2.f - 1.f) * SmallestThreeRange;
+        squaredSum += rotation[i] * rotation[i];
+        component++;
+    }
+
+    rotation[largest] = std::sqrt(std::max(0.f, 1.f - squaredSum));
+
+    return rotation;
+}
+
+Quaternion AnimationCompression::Nlerp(const Quaternion& a, const Quaternion& b, const float_t t)
+{
+    // Interpolating towards -b when the rotations are more than 180 degrees apart takes the shortest path
+    const float_t sign = Quaternion::Dot(a, b) < 0.f ? -1.f : 1.f;
+
+    return (a * (1.f - t) + b * (t * sign)).Normalized();
+}
+
+float_t AnimationCompression::AngleBetween(const Quaternion& a, const Quaternion& b)
+{
+    const float_t dot = std::min(std::abs(Quaternion::Dot(a, b)), 1.f);
+
+    return 2.f * std::acos(dot);
+}
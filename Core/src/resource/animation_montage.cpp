@@ -82,13 +82,13 @@ void AnimationMontage::AddAnimationBlending(const float_t when, const size_t sou
 
     m_AnimationTimeline.SetEventDuration(when, duration);
 
-    m_AnimationTimeline.AddBeginEvent(when, [&](SkinnedMeshRenderer* const renderer) -> void
+    m_AnimationTimeline.AddBeginEvent(when, [sourceAnim, targetAnim](SkinnedMeshRenderer* const renderer) -> void
     {
         renderer->StartAnimation(sourceAnim);
         renderer->StartBlending(targetAnim);
     });
 
-    m_AnimationTimeline.AddUpdateEvent(when, [&](const float_t deltaTime, SkinnedMeshRenderer* const renderer) -> void
+    m_AnimationTimeline.AddUpdateEvent(when, [](const float_t deltaTime, SkinnedMeshRenderer* const renderer) -> void
     {
         renderer->SetCrossFadeDelta(deltaTime);
     });
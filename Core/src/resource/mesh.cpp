@@ -32,6 +32,8 @@ bool_t Mesh::Load(const uint8_t* buffer, const int64_t length)
             Pointer<Animation> animation = ResourceManager::Add<Animation>(folderPath + std::string(scene->mAnimations[i]->mName.C_Str()) + ".anim");
         
             animation->Load(*scene->mAnimations[i]);
+            // There is no cooking step, so the key frames are compressed as soon as they are imported
+            animation->Compress(AnimationCompressionSettings());
             animation->BindSkeleton(m_Skeletons[0]);
             m_Animations.Add(animation);
         }
@@ -78,6 +80,7 @@ bool_t Mesh::Load(const uint8_t* buffer, const int64_t length)
         material.albedoTexture = Pointer<Texture>::New(*textures[0]);
     }*/
     ComputeAabb();
+    ComputeBoneAabbs();
     
     return true;
 }
@@ -98,6 +101,11 @@ Pointer<Animation> Mesh::GetAnimation(const size_t id)
     return m_Animations[id];
 }
 
+const List<BoneAabb>& Mesh::GetBoneAabbs() const
+{
+    return m_BoneAabbs;
+}
+
 std::string Mesh::GetTextureFileName(const std::string& textureName, const std::string& textureFormat)
 {
     std::string returnName;
@@ -257,3 +265,24 @@ void Mesh::ComputeAabb()
     aabb.SetMinMax(aabbMin, aabbMax);
 }
 
+void Mesh::ComputeBoneAabbs()
+{
+    m_BoneAabbs.Clear();
+
+    // The models of a mesh share the same bone palette, so the boxes of a bone are merged across the models
+    for (size_t i = 0; i < models.GetSize(); i++)
+    {
+        if (!models[i].IsValid())
+            continue;
+
+        for (const BoneAabb& boneAabb : models[i]->GetBoneAabbs())
+        {
+            BoneAabb* const existing = m_BoneAabbs.Find([&](const BoneAabb* b) -> bool_t { return b->boneId == boneAabb.boneId; });
+
+            if (existing)
+                existing->aabb.Encapsulate(boneAabb.aabb);
+            else
+                m_BoneAabbs.Add(boneAabb);
+        }
+    }
+}
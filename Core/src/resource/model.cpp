@@ -1,20 +1,38 @@
 #include "resource/model.hpp"
 
+#include <algorithm>
+
 #include <assimp/Importer.hpp>
 #include <assimp/postprocess.h>
 #include <assimp/scene.h>
 
 #include "assimp/Exporter.hpp"
 #include "assimp/Logger.hpp"
+#include "rendering/mesh_simplifier.hpp"
 #include "rendering/rhi.hpp"
 #include "utils/list.hpp"
 #include "utils/logger.hpp"
 
 using namespace XnorCore;
 
+namespace
+{
+    // Fraction of the triangles kept by each detail level
+    constexpr float_t LodReduction = 0.5f;
+
+    // A detail level that doesn't remove at least this fraction of the triangles of the previous one isn't worth a draw
+    constexpr float_t MinLodGain = 0.1f;
+
+    // Below this count the models are already cheap enough
+    constexpr size_t MinLodTriangleCount = 64;
+}
+
 Model::~Model()
 {
     Rhi::DestroyModel(m_ModelId);
+
+    for (const Lod& lod : m_Lods)
+        Rhi::DestroyModel(lod.modelId);
 }
 
 
@@ -62,6 +80,8 @@ bool_t Model::Load(const aiMesh& loadedData)
             if (!Calc::Equals(totalWeight, 1.f))
                 Logger::LogError("Invalid bone weight : {} ; {}", i, totalWeight);
         }
+
+        ComputeBoneAabbs(loadedData.mNumBones);
     }
 
     m_Indices.resize(static_cast<size_t>(loadedData.mNumFaces) * 3);
@@ -85,6 +105,10 @@ bool_t Model::Load(const aiMesh& loadedData)
 
     ComputeAabb(loadedData.mAABB);
 
+    // The simplifier merges vertices regardless of their bone weights
+    if (loadedData.mNumBones == 0)
+        GenerateLods();
+
     return true;
 }
 
@@ -92,6 +116,9 @@ void Model::CreateInInterface()
 {
     m_ModelId = Rhi::CreateModel(m_Vertices, m_Indices);
 
+    for (Lod& lod : m_Lods)
+        lod.modelId = Rhi::CreateModel(lod.vertices, lod.indices);
+
     m_LoadedInInterface = true;
 }
 
@@ -99,6 +126,9 @@ void Model::DestroyInInterface()
 {
     Rhi::DestroyModel(m_ModelId);
 
+    for (const Lod& lod : m_Lods)
+        Rhi::DestroyModel(lod.modelId);
+
     m_LoadedInInterface = false;
 }
 
@@ -109,6 +139,8 @@ void Model::Unload()
     
     m_Vertices.clear();
     m_Indices.clear();
+    m_BoneAabbs.clear();
+    m_Lods.clear();
 
     m_Loaded = false;
 }
@@ -185,11 +217,42 @@ uint32_t Model::GetId() const
     return m_ModelId;
 }
 
+size_t Model::GetLodCount() const
+{
+    return m_Lods.size() + 1;
+}
+
+uint32_t Model::GetLodId(const size_t lod) const
+{
+    if (lod == 0 || m_Lods.empty())
+        return m_ModelId;
+
+    return m_Lods[std::min(lod, m_Lods.size()) - 1].modelId;
+}
+
+size_t Model::GetTriangleCount(const size_t lod) const
+{
+    if (lod == 0 || m_Lods.empty())
+        return m_Indices.size() / 3;
+
+    return m_Lods[std::min(lod, m_Lods.size()) - 1].indices.size() / 3;
+}
+
 const std::vector<Vertex>& Model::GetVertices() const
 {
     return m_Vertices;
 }
 
+const std::vector<uint32_t>& Model::GetIndices() const
+{
+    return m_Indices;
+}
+
+const std::vector<BoneAabb>& Model::GetBoneAabbs() const
+{
+    return m_BoneAabbs;
+}
+
 void Model::ComputeAabb(const aiAABB& assimpAabb)
 {
     Vector3 min;
@@ -223,3 +286,74 @@ void Model::ComputeAabb(const aiAABB& assimpAabb)
 
     aabb.SetMinMax(min, max);
 }
+
+void Model::ComputeBoneAabbs(const uint32_t boneCount)
+{
+    std::vector<Vector3> mins(boneCount, Vector3(std::numeric_limits<float_t>::max()));
+    std::vector<Vector3> maxs(boneCount, Vector3(std::numeric_limits<float_t>::lowest()));
+    std::vector<bool_t> influenced(boneCount, false);
+
+    for (const Vertex& vertex : m_Vertices)
+    {
+        for (size_t k = 0; k < Vertex::MaxBoneWeight; k++)
+        {
+            if (vertex.boneIndices[k] < 0.f || vertex.boneWeight[k] <= 0.f)
+                continue;
+
+            const size_t bone = static_cast<size_t>(vertex.boneIndices[k]);
+
+            Vector3& min = mins[bone];
+            Vector3& max = maxs[bone];
+
+            min.x = std::min(min.x, vertex.position.x);
+            min.y = std::min(min.y, vertex.position.y);
+            min.z = std::min(min.z, vertex.position.z);
+
+            max.x = std::max(max.x, vertex.position.x);
+            max.y = std::max(max.y, vertex.position.y);
+            max.z = std::max(max.z, vertex.position.z);
+
+            influenced[bone] = true;
+        }
+    }
+
+    m_BoneAabbs.clear();
+
+    for (uint32_t i = 0; i < boneCount; i++)
+    {
+        if (!influenced[i])
+            continue;
+
+        BoneAabb& boneAabb = m_BoneAabbs.emplace_back();
+        boneAabb.boneId = i;
+        boneAabb.aabb.SetMinMax(mins[i], maxs[i]);
+    }
+}
+
+void Model::GenerateLods()
+{
+    m_Lods.clear();
+
+    // Each level is simplified from the previous one, its indices still refer to the full detail vertices
+    std::vector<uint32_t> sourceIndices = m_Indices;
+    std::vector<uint32_t> indices;
+
+    while (m_Lods.size() + 1 < MaxLodCount)
+    {
+        const size_t sourceTriangleCount = sourceIndices.size() / 3;
+        if (sourceTriangleCount < MinLodTriangleCount)
+            break;
+
+        const size_t targetIndexCount = static_cast<size_t>(static_cast<float_t>(sourceTriangleCount) * LodReduction) * 3;
+        MeshSimplifier::Simplify(m_Vertices, sourceIndices, targetIndexCount, &indices);
+
+        const size_t triangleCount = indices.size() / 3;
+        if (triangleCount == 0 || static_cast<float_t>(triangleCount) > static_cast<float_t>(sourceTriangleCount) * (1.f - MinLodGain))
+            break;
+
+        Lod& lod = m_Lods.emplace_back();
+        MeshSimplifier::CompactVertices(m_Vertices, indices, &lod.vertices, &lod.indices);
+
+        sourceIndices.swap(indices);
+    }
+}
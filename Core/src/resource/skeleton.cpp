@@ -52,7 +52,15 @@ bool_t Skeleton::Load(const aiSkeleton& loadedData)
         const Matrix* const globalInv = reinterpret_cast<const Matrix*>(&bone->mOffsetMatrix);
 
         m_Bones[i].Create(*local, *globalInv);
+        m_Bones[i].id = static_cast<int32_t>(i);
         m_Bones[i].parentId = bone->mParent;
+
+        // The name is what animation channels are bound with
+        if (bone->mNode != nullptr)
+            m_Bones[i].name = bone->mNode->mName.C_Str();
+
+        if (bone->mParent != -1)
+            m_Bones[bone->mParent].children.Add(static_cast<int32_t>(i));
     }
 
     return true;
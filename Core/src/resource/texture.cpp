@@ -56,10 +56,12 @@ bool_t Texture::Load(const uint8_t* const buffer, const int64_t length)
     if (std::filesystem::path(m_Name).extension() == ".hdr")
     {
         m_Data = reinterpret_cast<decltype(m_Data)>(stbi_loadf_from_memory(buffer, static_cast<int32_t>(length), &m_Size.x, &m_Size.y, &m_DataChannels, loadData.desiredChannels));
+        m_DataType = DataType::Float;
     }
     else
     {
         m_Data = stbi_load_from_memory(buffer, static_cast<int32_t>(length), &m_Size.x, &m_Size.y, &m_DataChannels, loadData.desiredChannels);
+        m_DataType = DataType::UnsignedByte;
     }
     
     m_TextureFormat = Rhi::GetTextureFormatFromChannels(m_DataChannels);
@@ -81,7 +83,7 @@ void Texture::CreateInInterface()
     };
     createInfo.datas.push_back(m_Data);
 
-    if (std::filesystem::path(m_Name).extension() == ".hdr")
+    if (m_DataType == DataType::Float)
     {
         createInfo.filtering = TextureFiltering::Linear;
         createInfo.wrapping = TextureWrapping::ClampToEdge;
@@ -133,6 +135,11 @@ int32_t Texture::GetChannels() const
     return loadData.desiredChannels != 0 ? loadData.desiredChannels : m_DataChannels;
 }
 
+DataType::DataType Texture::GetDataType() const
+{
+    return m_DataType;
+}
+
 void Texture::BindTexture(const uint32_t index) const
 {
     Rhi::BindTexture(index, m_Id);
@@ -27,7 +27,7 @@ void EnemyCpp::OnDetectionExit(Collider* const, const Collider* const other)
     m_SkinnedMeshRenderer->StartAnimation(m_Idle);
     player = other->entity;
     m_IsInDetectionRange = false;
-    capsule->SetLinearVelocity(Vector3::Zero());
+    SetVelocity(Vector3::Zero());
 }
 
 void EnemyCpp::OnTriggerStay(Collider* const, const Collider* const other, const CollisionData&)
@@ -39,7 +39,7 @@ void EnemyCpp::OnTriggerStay(Collider* const, const Collider* const other, const
 
     if (m_IsAttacking)
     {
-        capsule->SetLinearVelocity(Vector3::Zero());
+        SetVelocity(Vector3::Zero());
         return;
     }
     
@@ -59,13 +59,30 @@ void EnemyCpp::Move() const
         return;
     
     // Update velocity
-    const Vector3 currentVelocity = capsule->GetLinearVelocity();
+    const Vector3 currentVelocity = GetVelocity();
     Vector3 desiredVelocity = m_FwdVector * m_MoveSpeed;
     desiredVelocity.y = currentVelocity.y;
     const Vector3 newVelocity = 0.75f * currentVelocity + 0.25f * desiredVelocity;
     
     // Update position
-    capsule->SetLinearVelocity(newVelocity);
+    SetVelocity(newVelocity);
+}
+
+Vector3 EnemyCpp::GetVelocity() const
+{
+    if (m_Controller != nullptr)
+        return m_Controller->GetVelocity();
+
+    return capsule->GetLinearVelocity();
+}
+
+void EnemyCpp::SetVelocity(const Vector3& velocity) const
+{
+    // Enemies with a character controller don't need a dynamic body to move
+    if (m_Controller != nullptr)
+        m_Controller->SetVelocity(velocity);
+    else
+        capsule->SetLinearVelocity(velocity);
 }
 
 void EnemyCpp::LookAtPlayer()
@@ -119,6 +136,7 @@ void EnemyCpp::Awake()
     Component::Awake();
     SphereCollider* const s = entity->GetComponent<SphereCollider>();
     capsule = entity->GetComponent<CapsuleCollider>();
+    m_Controller = entity->GetComponent<CharacterController>();
     
     s->onTriggerEnter += [this](Collider* const self, const Collider* const other, const CollisionData& data) { OnDetectionEnter(self, other, data); };
     s->onTriggerExit += [this](Collider* const self, const Collider* const other) { OnDetectionExit(self, other); };
@@ -1,5 +1,8 @@
 #include "scene/component/script_component.hpp"
 
+#include <array>
+#include <string_view>
+
 #include "Coral/GC.hpp"
 #include "csharp/dotnet_assembly.hpp"
 #include "csharp/dotnet_constants.hpp"
@@ -8,6 +11,20 @@
 
 using namespace XnorCore;
 
+namespace
+{
+    /// @brief Names of the managed methods of the collision events, in the order of ScriptComponent::CollisionEvent
+    constexpr std::array<std::string_view, 6> CollisionEventMethods =
+    {
+        "OnTriggerEnter",
+        "OnTriggerStay",
+        "OnTriggerExit",
+        "OnCollisionEnter",
+        "OnCollisionStay",
+        "OnCollisionExit"
+    };
+}
+
 ScriptComponent* ScriptComponent::New(const std::string& managedTypeName, const DotnetAssembly* assembly)
 {
     Logger::LogDebug("Creating ScriptComponent instance with managed type {} from assembly {}", managedTypeName, assembly->GetName());
@@ -25,6 +42,72 @@ ScriptComponent* ScriptComponent::New(const std::string& managedTypeName, const
     return script;
 }
 
+void ScriptComponent::ReleaseColliderWrapper(const Collider* const collider)
+{
+    const decltype(m_ColliderWrappers)::iterator it = m_ColliderWrappers.find(collider);
+
+    if (it == m_ColliderWrappers.end())
+        return;
+
+    it->second.Destroy();
+    m_ColliderWrappers.erase(it);
+}
+
+void ScriptComponent::ReleaseManagedCache()
+{
+    for (auto&& wrapper : m_ColliderWrappers)
+        wrapper.second.Destroy();
+    m_ColliderWrappers.clear();
+
+    if (m_HasCollisionDataWrapper)
+    {
+        m_CollisionDataWrapper.Destroy();
+        m_HasCollisionDataWrapper = false;
+    }
+
+    m_ColliderType = nullptr;
+    m_CollisionDataType = nullptr;
+}
+
+void ScriptComponent::CacheManagedTypes()
+{
+    if (m_ColliderType != nullptr)
+        return;
+
+    const Coral::ManagedAssembly* assembly = DotnetAssembly::xnorCoreAssembly->GetCoralAssembly();
+
+    m_ColliderType = &assembly->GetType(Dotnet::XnorCoreNamespace + ".Collider");
+    m_CollisionDataType = &assembly->GetType(Dotnet::XnorCoreNamespace + ".CollisionData");
+}
+
+Coral::ManagedObject& ScriptComponent::GetColliderWrapper(Collider* collider)
+{
+    const decltype(m_ColliderWrappers)::iterator it = m_ColliderWrappers.find(collider);
+
+    if (it != m_ColliderWrappers.end())
+        return it->second;
+
+    CacheManagedTypes();
+
+    return m_ColliderWrappers.emplace(collider, m_ColliderType->CreateInstance(FORWARD(collider), false)).first->second;
+}
+
+Coral::ManagedObject& ScriptComponent::GetCollisionDataWrapper(const CollisionData& data)
+{
+    // The managed scripts are invoked one after the other on the main thread, so a single native storage is enough
+    m_CollisionDataStorage = data;
+
+    if (!m_HasCollisionDataWrapper)
+    {
+        CacheManagedTypes();
+
+        m_CollisionDataWrapper = m_CollisionDataType->CreateInstance(&m_CollisionDataStorage, false);
+        m_HasCollisionDataWrapper = true;
+    }
+
+    return m_CollisionDataWrapper;
+}
+
 void ScriptComponent::Destroy()
 {
     Logger::LogDebug("Destroying ScriptComponent instance with managed type {}", static_cast<std::string>(m_ManagedObject.GetType().GetFullName()));
@@ -67,68 +150,40 @@ const Coral::ManagedObject& ScriptComponent::GetManagedObject() const
 
 void ScriptComponent::OnTriggerEnter(Collider* self, Collider* other, const CollisionData& data)
 {
-    InvokeCollisionEvent("OnTriggerEnter", FORWARD(self), FORWARD(other), FORWARD(data));
+    InvokeCollisionEvent(CollisionEvent::TriggerEnter, FORWARD(self), FORWARD(other), FORWARD(data));
 }
 
 void ScriptComponent::OnTriggerStay(Collider* self, Collider* other, const CollisionData& data)
 {
-    InvokeCollisionEvent("OnTriggerStay", FORWARD(self), FORWARD(other), FORWARD(data));
+    InvokeCollisionEvent(CollisionEvent::TriggerStay, FORWARD(self), FORWARD(other), FORWARD(data));
 }
 
 void ScriptComponent::OnTriggerExit(Collider* self, Collider* other)
 {
-    InvokeCollisionExitEvent("OnTriggerExit", FORWARD(self), FORWARD(other));
+    InvokeCollisionExitEvent(CollisionEvent::TriggerExit, FORWARD(self), FORWARD(other));
 }
 
 void ScriptComponent::OnCollisionEnter(Collider* self, Collider* other, const CollisionData& data)
 {
-    InvokeCollisionEvent("OnCollisionEnter", FORWARD(self), FORWARD(other), FORWARD(data));
+    InvokeCollisionEvent(CollisionEvent::CollisionEnter, FORWARD(self), FORWARD(other), FORWARD(data));
 }
 
 void ScriptComponent::OnCollisionStay(Collider* self, Collider* other, const CollisionData& data)
 {
-    InvokeCollisionEvent("OnCollisionStay", FORWARD(self), FORWARD(other), FORWARD(data));
+    InvokeCollisionEvent(CollisionEvent::CollisionStay, FORWARD(self), FORWARD(other), FORWARD(data));
 }
 
 void ScriptComponent::OnCollisionExit(Collider* self, Collider* other)
 {
-    InvokeCollisionExitEvent("OnCollisionExit", FORWARD(self), FORWARD(other));
+    InvokeCollisionExitEvent(CollisionEvent::CollisionExit, FORWARD(self), FORWARD(other));
 }
 
-void ScriptComponent::InvokeCollisionEvent(const std::string& functionName, Collider* self, Collider* other, const CollisionData& data)
+void ScriptComponent::InvokeCollisionEvent(const CollisionEvent event, Collider* self, Collider* other, const CollisionData& data)
 {
-    const Coral::ManagedAssembly* assembly = DotnetAssembly::xnorCoreAssembly->GetCoralAssembly();
-    
-    Coral::Type& colliderType = assembly->GetType(Dotnet::XnorCoreNamespace + ".Collider");
-    Coral::Type& collisionDataType = assembly->GetType(Dotnet::XnorCoreNamespace + ".CollisionData");
-
-    std::array managedObjects
-    {
-        colliderType.CreateInstance(FORWARD(self), false),
-        colliderType.CreateInstance(FORWARD(other), false),
-        collisionDataType.CreateInstance(&data, false)
-    };
-    
-    m_ManagedObject.InvokeMethod(functionName, managedObjects[0], managedObjects[1], managedObjects[2]);
-
-    for (auto&& object : managedObjects)
-        object.Destroy();
+    m_ManagedObject.InvokeMethod(CollisionEventMethods[static_cast<size_t>(event)], GetColliderWrapper(self), GetColliderWrapper(other), GetCollisionDataWrapper(data));
 }
 
-void ScriptComponent::InvokeCollisionExitEvent(const std::string& functionName, Collider* self, Collider* other)
+void ScriptComponent::InvokeCollisionExitEvent(const CollisionEvent event, Collider* self, Collider* other)
 {
-    const Coral::ManagedAssembly* assembly = DotnetAssembly::xnorCoreAssembly->GetCoralAssembly();
-    
-    Coral::Type& colliderType = assembly->GetType(Dotnet::XnorCoreNamespace + ".Collider");
-
-    std::array managedObjects
-    {
-        colliderType.CreateInstance(FORWARD(self), false),
-        colliderType.CreateInstance(FORWARD(other), false),
-    };
-    
-    m_ManagedObject.InvokeMethod(functionName, managedObjects[0], managedObjects[1]);
-
-    for (auto&& object : managedObjects)
-        object.Destroy();
+    m_ManagedObject.InvokeMethod(CollisionEventMethods[static_cast<size_t>(event)], GetColliderWrapper(self), GetColliderWrapper(other));
 }
@@ -1,5 +1,7 @@
 ﻿#include "scene/component/skinned_mesh_renderer.hpp"
 
+#include <algorithm>
+
 #include "rendering/animator.hpp"
 
 using namespace XnorCore;
@@ -10,12 +12,11 @@ void SkinnedMeshRenderer::Begin()
 
 void SkinnedMeshRenderer::OnRendering()
 {
+    // Montages can start other animations, so they are updated here on the main thread, the poses are then evaluated in parallel by the AnimationSystem
     if (m_CurrentMontage)
     {
         m_CurrentMontage->Update(this);
     }
-
-    m_Animator.Animate();
 }
 
 void SkinnedMeshRenderer::StartAnimation(const Pointer<Animation>& animation)
@@ -44,3 +45,64 @@ const List<Matrix>& SkinnedMeshRenderer::GetMatrices() const
 {
     return m_Animator.GetMatrices();
 }
+
+bool_t SkinnedMeshRenderer::ScheduleAnimation(const float_t deltaTime, const uint32_t updateInterval)
+{
+    m_PendingDeltaTime += deltaTime;
+    m_FramesSinceAnimation++;
+
+    return !m_HasAnimated || m_FramesSinceAnimation >= updateInterval;
+}
+
+void SkinnedMeshRenderer::Animate()
+{
+    m_Animator.Animate(m_PendingDeltaTime);
+    ComputePoseAabb();
+
+    m_PendingDeltaTime = 0.f;
+    m_FramesSinceAnimation = 0;
+    m_HasAnimated = true;
+}
+
+void SkinnedMeshRenderer::GetAabb(Bound* const bound) const
+{
+    if (mesh.IsValid())
+        *bound = Bound::GetAabbFromTransform(m_HasAnimated ? m_PoseAabb : mesh->aabb, GetTransform());
+}
+
+void SkinnedMeshRenderer::ComputePoseAabb()
+{
+    if (!mesh.IsValid())
+        return;
+
+    const List<BoneAabb>& boneAabbs = mesh->GetBoneAabbs();
+    const List<Matrix>& matrices = m_Animator.GetMatrices();
+
+    if (boneAabbs.Empty() || matrices.Empty())
+    {
+        m_PoseAabb = mesh->aabb;
+        return;
+    }
+
+    // A skinned vertex is a weighted average of the vertex transformed by each of its bones, so it lies in the union of
+    // the bind pose box of each bone transformed by the bone matrix
+    Vector3 min = Vector3(std::numeric_limits<float_t>::max());
+    Vector3 max = Vector3(std::numeric_limits<float_t>::lowest());
+
+    for (const BoneAabb& boneAabb : boneAabbs)
+    {
+        const Bound bound = boneAabb.boneId < matrices.GetSize() ? Bound::GetAabbFromMatrix(boneAabb.aabb, matrices[boneAabb.boneId]) : boneAabb.aabb;
+        const Vector3 boundMin = bound.GetMin();
+        const Vector3 boundMax = bound.GetMax();
+
+        min.x = std::min(min.x, boundMin.x);
+        min.y = std::min(min.y, boundMin.y);
+        min.z = std::min(min.z, boundMin.z);
+
+        max.x = std::max(max.x, boundMax.x);
+        max.y = std::max(max.y, boundMax.y);
+        max.z = std::max(max.z, boundMax.z);
+    }
+
+    m_PoseAabb.SetMinMax(min, max);
+}
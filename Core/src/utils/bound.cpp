@@ -1,5 +1,8 @@
 ﻿#include "utils/bound.hpp"
 
+#include <algorithm>
+#include <cmath>
+
 using namespace XnorCore;
 
 Bound:: Bound(const Vector3 newCenter, const Vector3 newSize) : extents(newSize * 0.5f),
@@ -35,9 +38,14 @@ void Bound::SetMinMax(const Vector3 newmin, const Vector3 newMax)
 
 Bound Bound::GetAabbFromTransform(const Bound& bound, const Transform& transform)
 {
-    const Vector3 globalPos = static_cast<Vector3>(transform.worldMatrix * Vector4(bound.center.x, bound.center.y, bound.center.z, 1.f));
+    return GetAabbFromMatrix(bound, transform.worldMatrix);
+}
+
+Bound Bound::GetAabbFromMatrix(const Bound& bound, const Matrix& matrix)
+{
+    const Vector3 globalPos = static_cast<Vector3>(matrix * Vector4(bound.center.x, bound.center.y, bound.center.z, 1.f));
     // Let the constructor
-    return ReturnAabbFromMatrix(bound, transform.worldMatrix, globalPos);
+    return ReturnAabbFromMatrix(bound, matrix, globalPos);
 }
 
 bool_t Bound::Intersect(const Bound& otherBound) const
@@ -71,6 +79,35 @@ bool_t Bound::Countain(const Bound& otherBound) const
 
 }
 
+bool_t Bound::IntersectSphere(const Vector3 sphereCenter, const float_t radius) const
+{
+    const Vector3 min = GetMin();
+    const Vector3 max = GetMax();
+
+    const Vector3 closestPoint = Vector3(
+        std::clamp(sphereCenter.x, min.x, max.x),
+        std::clamp(sphereCenter.y, min.y, max.y),
+        std::clamp(sphereCenter.z, min.z, max.z)
+    );
+
+    return (closestPoint - sphereCenter).SquaredLength() <= radius * radius;
+}
+
+bool_t Bound::IntersectCone(const Vector3 apex, const Vector3 direction, const float_t angle, const float_t range) const
+{
+    if (!IntersectSphere(apex, range))
+        return false;
+
+    // Tests the bounding sphere of the box against the cone surface,
+    // the signed distance is exact in front of the apex and underestimated behind it
+    const Vector3 toCenter = center - apex;
+    const float_t distanceAlongAxis = Vector3::Dot(toCenter, direction);
+    const float_t distanceToAxis = std::sqrt(std::max(toCenter.SquaredLength() - distanceAlongAxis * distanceAlongAxis, 0.f));
+    const float_t distanceToCone = std::cos(angle) * distanceToAxis - std::sin(angle) * distanceAlongAxis;
+
+    return distanceToCone <= extents.Length();
+}
+
 bool_t Bound::IsOnPlane(const Plane& plane) const
 {
     const float_t r = extents.x * std::abs(plane.normal.x) +
@@ -0,0 +1,113 @@
+#include "utils/job_system.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <thread>
+
+#include <Jolt/Jolt.h>
+#include <Jolt/Core/JobSystemThreadPool.h>
+#include <Jolt/Core/Memory.h>
+#include <Jolt/Physics/PhysicsSettings.h>
+
+using namespace XnorCore;
+
+namespace
+{
+    // Leaves room for a physics step on top of the engine jobs
+    constexpr uint32_t MaxJobs = JPH::cMaxPhysicsJobs + 1024;
+    constexpr uint32_t MaxBarriers = JPH::cMaxPhysicsBarriers + 16;
+
+    struct ThreadIndex
+    {
+        uint32_t generation = std::numeric_limits<uint32_t>::max();
+        size_t index = 0;
+    };
+
+    thread_local ThreadIndex threadIndex;
+}
+
+void JobSystem::Initialize()
+{
+    if (m_ThreadPool)
+        return;
+
+    // The pool allocates its jobs through the Jolt allocation hooks
+    JPH::RegisterDefaultAllocator();
+
+    // The calling thread also executes jobs while it waits for them
+    const int32_t workerCount = std::max(static_cast<int32_t>(std::thread::hardware_concurrency()) - 1, 1);
+    m_ThreadIndexGeneration++;
+    m_NextThreadIndex = 0;
+    m_ThreadPool = new JPH::JobSystemThreadPool(MaxJobs, MaxBarriers, workerCount);
+}
+
+void JobSystem::Destroy()
+{
+    delete m_ThreadPool;
+    m_ThreadPool = nullptr;
+}
+
+bool_t JobSystem::IsInitialized()
+{
+    return m_ThreadPool != nullptr;
+}
+
+size_t JobSystem::GetMaxConcurrency()
+{
+    return m_ThreadPool ? static_cast<size_t>(m_ThreadPool->GetMaxConcurrency()) : 1;
+}
+
+size_t JobSystem::GetThreadIndex()
+{
+    const uint32_t generation = m_ThreadIndexGeneration;
+
+    if (threadIndex.generation != generation)
+    {
+        threadIndex.generation = generation;
+        threadIndex.index = m_NextThreadIndex++;
+    }
+
+    return threadIndex.index;
+}
+
+JPH::JobSystemThreadPool* JobSystem::GetThreadPool()
+{
+    return m_ThreadPool;
+}
+
+void JobSystem::ParallelFor(const size_t count, const size_t minBatchSize, const BatchFunction& function)
+{
+    if (count == 0)
+        return;
+
+    const size_t batchCount = std::clamp<size_t>(count / std::max<size_t>(minBatchSize, 1), 1, GetMaxConcurrency());
+
+    if (batchCount == 1)
+    {
+        function(0, count);
+        return;
+    }
+
+    const size_t batchSize = (count + batchCount - 1) / batchCount;
+
+    JPH::JobSystem::Barrier* const barrier = m_ThreadPool->CreateBarrier();
+
+    for (size_t i = 0; i < batchCount; i++)
+    {
+        const size_t first = i * batchSize;
+        const size_t last = std::min(first + batchSize, count);
+
+        if (first >= last)
+            break;
+
+        const JPH::JobHandle job = m_ThreadPool->CreateJob("ParallelFor", JPH::Color::sGreen, [&function, first, last]
+        {
+            function(first, last);
+        });
+
+        barrier->AddJob(job);
+    }
+
+    m_ThreadPool->WaitForJobs(barrier);
+    m_ThreadPool->DestroyBarrier(barrier);
+}
@@ -1,7 +1,12 @@
 ﻿#include "world/world.hpp"
 
+#include <chrono>
+
+#include "application.hpp"
 #include "input/time.hpp"
 #include "physics/physics_world.hpp"
+#include "rendering/animation_system.hpp"
+#include "utils/logger.hpp"
 #include "world/scene_graph.hpp"
 
 using namespace XnorCore;
@@ -10,7 +15,15 @@ void World::Update()
 {
     if (!hasStarted && isPlaying)
     {
+        auto&& start = std::chrono::system_clock::now();
+
+        // Colliders create their bodies in Awake, so we add all of them to the physics world at once
+        PhysicsWorld::BeginBodyBatch();
         scene->Awake();
+        PhysicsWorld::EndBodyBatch();
+
+        Logger::LogDebug("Scene awake successful. Took {}", std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now() - start));
+
         scene->Begin();
         hasStarted = true;
     }
@@ -26,5 +39,9 @@ void World::Update()
     SceneGraph::Update(scene->GetEntities());
 
     scene->OnRendering();
-}
 
+    // The animations are updated before the frame is rendered, so the views of the last frame decide their update rates
+    static const std::vector<RenderedView> NoViews;
+    const std::vector<RenderedView>& views = Application::applicationInstance ? Application::applicationInstance->renderer.GetRenderedViews() : NoViews;
+    AnimationSystem::Update(*scene, views, Time::GetDeltaTime());
+}
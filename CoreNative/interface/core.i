@@ -137,6 +137,8 @@ struct Data64
 #include "physics/component/collider.hpp"
 #include "physics/component/box_collider.hpp"
 #include "physics/component/capsule_collider.hpp"
+#include "physics/component/character_controller.hpp"
+#include "physics/component/height_field_collider.hpp"
 #include "physics/component/mesh_collider.hpp"
 #include "physics/component/sphere_collider.hpp"
 
@@ -262,6 +264,8 @@ struct Data64
 %include "physics/component/collider.i"
 %include "physics/component/box_collider.i"
 %include "physics/component/capsule_collider.i"
+%include "physics/component/character_controller.i"
+%include "physics/component/height_field_collider.i"
 %include "physics/component/mesh_collider.i"
 %include "physics/component/sphere_collider.i"
 
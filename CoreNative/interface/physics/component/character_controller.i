@@ -0,0 +1,3 @@
+%module CoreNative
+
+%include "physics/component/character_controller.hpp"
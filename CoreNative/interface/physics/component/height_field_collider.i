@@ -0,0 +1,3 @@
+%module CoreNative
+
+%include "physics/component/height_field_collider.hpp"
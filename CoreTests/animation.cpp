@@ -0,0 +1,865 @@
+#include "pch.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <format>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#ifdef _DEBUG
+#include <crtdbg.h>
+#endif
+
+#include <assimp/anim.h>
+#include <assimp/mesh.h>
+#include <assimp/scene.h>
+
+#include "rendering/animation_system.hpp"
+#include "rendering/animator.hpp"
+#include "rendering/bone_mask.hpp"
+#include "rendering/pose.hpp"
+#include "rendering/pose_blending.hpp"
+#include "rendering/render_systems/skinning_pass.hpp"
+#include "resource/animation.hpp"
+#include "resource/skeleton.hpp"
+#include "utils/job_system.hpp"
+#include "utils/logger.hpp"
+
+namespace
+{
+    constexpr uint32_t BoneCount = 100;
+    constexpr uint32_t KeyCount = 60;
+    constexpr uint32_t SampleCount = 1000;
+    constexpr uint32_t CharacterCount = 256;
+    constexpr float_t FrameDuration = 1.f / 60.f;
+    constexpr uint32_t BlendBoneCount = 1021;
+    constexpr float_t BlendTolerance = 1e-5f;
+
+    std::string BoneName(const uint32_t index)
+    {
+        return std::format("mixamorig:Bone_{}", index);
+    }
+
+    /// @brief Creates a chain of bones, each one being the child of the previous one
+    Pointer<Skeleton> CreateSkeleton()
+    {
+        std::vector<std::unique_ptr<aiNode>> nodes;
+        std::vector<aiSkeletonBone> bones(BoneCount);
+
+        aiSkeleton skeletonData;
+        skeletonData.mNumBones = BoneCount;
+        skeletonData.mBones = new aiSkeletonBone*[BoneCount];
+
+        for (uint32_t i = 0; i < BoneCount; i++)
+        {
+            nodes.push_back(std::make_unique<aiNode>(BoneName(i)));
+
+            bones[i].mNode = nodes.back().get();
+            bones[i].mParent = static_cast<int32_t>(i) - 1;
+            skeletonData.mBones[i] = &bones[i];
+        }
+
+        Pointer<Skeleton> skeleton = Pointer<Skeleton>::New("skeleton");
+        skeleton->Load(skeletonData);
+
+        return skeleton;
+    }
+
+    /// @brief Creates an animation animating all the bones, with the channels in the reverse order of the bones
+    Pointer<Animation> CreateAnimation(const Pointer<Skeleton>& skeleton)
+    {
+        aiAnimation animationData;
+        animationData.mDuration = KeyCount;
+        animationData.mTicksPerSecond = 30.0;
+        animationData.mNumChannels = BoneCount;
+        animationData.mChannels = new aiNodeAnim*[BoneCount];
+
+        for (uint32_t i = 0; i < BoneCount; i++)
+        {
+            aiNodeAnim* const channel = new aiNodeAnim;
+            channel->mNodeName = BoneName(BoneCount - 1 - i);
+
+            channel->mNumPositionKeys = KeyCount;
+            channel->mNumRotationKeys = KeyCount;
+            channel->mNumScalingKeys = KeyCount;
+            channel->mPositionKeys = new aiVectorKey[KeyCount];
+            channel->mRotationKeys = new aiQuatKey[KeyCount];
+            channel->mScalingKeys = new aiVectorKey[KeyCount];
+
+            for (uint32_t j = 0; j < KeyCount; j++)
+            {
+                const double_t time = static_cast<double_t>(j);
+                const float_t angle = static_cast<float_t>(j) * 0.05f;
+
+                channel->mPositionKeys[j] = aiVectorKey(time, aiVector3D(0.f, 1.f, static_cast<float_t>(j) * 0.01f));
+                channel->mRotationKeys[j] = aiQuatKey(time, aiQuaternion(aiVector3D(0.f, 1.f, 0.f), angle));
+                channel->mScalingKeys[j] = aiVectorKey(time, aiVector3D(1.f));
+            }
+
+            animationData.mChannels[i] = channel;
+        }
+
+        Pointer<Animation> animation = Pointer<Animation>::New("animation");
+        animation->Load(animationData);
+        animation->BindSkeleton(skeleton);
+
+        return animation;
+    }
+
+    /// @brief Creates a pose with varied but deterministic transforms
+    Pose CreatePose(const size_t boneCount, const float_t seed)
+    {
+        Pose pose(boneCount);
+
+        for (size_t i = 0; i < boneCount; i++)
+        {
+            const float_t value = static_cast<float_t>(i) * 0.37f + seed;
+
+            pose.SetTranslation(i, Vector3(std::sin(value), std::cos(value * 1.3f), value * 0.01f));
+            pose.SetRotation(i, Quaternion(Vector3(std::sin(value), std::cos(value * 0.7f), std::sin(value * 2.1f)), std::cos(value * 0.3f)).Normalized());
+        }
+
+        return pose;
+    }
+
+#ifdef _DEBUG
+    std::thread::id countedThread;
+    size_t allocationCount = 0;
+
+    /// @brief Debug CRT hook counting the allocations made on the tested thread, which includes the ones made in Core
+    int32_t CountAllocations(const int32_t allocationType, void*, size_t, int32_t, long, const unsigned char*, int32_t)
+    {
+        if ((allocationType == _HOOK_ALLOC || allocationType == _HOOK_REALLOC) && std::this_thread::get_id() == countedThread)
+            allocationCount++;
+
+        return 1;
+    }
+#endif
+}
+
+TEST(Animation, ChannelBindings)
+{
+    const Pointer<Skeleton> skeleton = CreateSkeleton();
+    const Pointer<Animation> animation = CreateAnimation(skeleton);
+
+    const List<int32_t>& bindings = animation->GetChannelBindings(*skeleton);
+
+    ASSERT_EQ(bindings.GetSize(), BoneCount);
+    EXPECT_EQ(animation->GetChannelCount(), BoneCount);
+
+    for (uint32_t i = 0; i < BoneCount; i++)
+        EXPECT_EQ(bindings[i], static_cast<int32_t>(BoneCount - 1 - i));
+
+    // The bindings must be resolved only once per skeleton
+    EXPECT_EQ(&animation->GetChannelBindings(*skeleton), &bindings);
+}
+
+TEST(Animation, ChannelBindingSamplingBenchmark)
+{
+    const Pointer<Skeleton> skeleton = CreateSkeleton();
+    const Pointer<Animation> animation = CreateAnimation(skeleton);
+    const List<Bone>& bones = skeleton->GetBones();
+
+    size_t nameKeyCount = 0;
+    auto&& start = std::chrono::system_clock::now();
+
+    for (uint32_t i = 0; i < SampleCount; i++)
+    {
+        for (size_t j = 0; j < bones.GetSize(); j++)
+        {
+            const List<Animation::KeyFrame>* keyFrames = nullptr;
+            animation->GetBoneKeyFrame(bones[j], &keyFrames);
+            nameKeyCount += keyFrames->GetSize();
+        }
+    }
+
+    const std::chrono::microseconds nameTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now() - start);
+
+    size_t bindingKeyCount = 0;
+    start = std::chrono::system_clock::now();
+
+    for (uint32_t i = 0; i < SampleCount; i++)
+    {
+        const List<int32_t>& bindings = animation->GetChannelBindings(*skeleton);
+
+        for (size_t j = 0; j < bones.GetSize(); j++)
+            bindingKeyCount += animation->GetChannel(bindings[j]).GetSize();
+    }
+
+    const std::chrono::microseconds bindingTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now() - start);
+
+    Animator animator(animation);
+    start = std::chrono::system_clock::now();
+
+    // A frame per sample, so the evaluation crosses keys and wraps around the clip like in a game
+    for (uint32_t i = 0; i < SampleCount; i++)
+        animator.Animate(FrameDuration);
+
+    const std::chrono::microseconds animateTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now() - start);
+
+    Logger::LogInfo(
+        "Channel lookup for {} bones over {} samples: by name {}, by binding {}, full Animator::Animate {}",
+        BoneCount,
+        SampleCount,
+        nameTime,
+        bindingTime,
+        animateTime
+    );
+
+    EXPECT_EQ(nameKeyCount, bindingKeyCount);
+    EXPECT_EQ(bindingKeyCount, static_cast<size_t>(BoneCount) * KeyCount * SampleCount);
+}
+
+TEST(Animation, AllocationFreeEvaluation)
+{
+#ifndef _DEBUG
+    GTEST_SKIP() << "Allocations can only be counted with the debug CRT";
+#else
+    const Pointer<Skeleton> skeleton = CreateSkeleton();
+    const Pointer<Animation> animation = CreateAnimation(skeleton);
+    const Pointer<Animation> targetAnimation = CreateAnimation(skeleton);
+
+    Animator target(targetAnimation);
+    Animator animator(animation);
+    animator.StartBlending(&target);
+    animator.SetCrossFadeDelta(0.5f);
+
+    // The first frame sizes the pose buffers and resolves the channel bindings
+    animator.Animate(FrameDuration);
+
+    countedThread = std::this_thread::get_id();
+    allocationCount = 0;
+
+    const _CRT_ALLOC_HOOK previousHook = _CrtSetAllocHook(CountAllocations);
+
+    size_t paletteSize = 0;
+    for (uint32_t i = 0; i < SampleCount; i++)
+    {
+        animator.Animate(FrameDuration);
+        paletteSize = animator.GetMatrices().GetSize();
+    }
+
+    _CrtSetAllocHook(previousHook);
+
+    EXPECT_EQ(allocationCount, 0u);
+    EXPECT_GE(paletteSize, static_cast<size_t>(BoneCount));
+#endif
+}
+
+TEST(Animation, CompressionRatio)
+{
+    const Pointer<Skeleton> skeleton = CreateSkeleton();
+    const Pointer<Animation> animation = CreateAnimation(skeleton);
+
+    const size_t rawSize = animation->GetKeyFrameMemorySize();
+    animation->Compress(AnimationCompressionSettings());
+    const size_t compressedSize = animation->GetKeyFrameMemorySize();
+
+    Logger::LogInfo(
+        "Animation compression for {} bones and {} keys: {} bytes raw, {} bytes compressed, ratio {:.1f}",
+        BoneCount,
+        KeyCount,
+        rawSize,
+        compressedSize,
+        static_cast<float_t>(rawSize) / static_cast<float_t>(compressedSize)
+    );
+
+    EXPECT_TRUE(animation->IsCompressed());
+    EXPECT_EQ(animation->GetChannelCount(), BoneCount);
+    EXPECT_GE(rawSize, compressedSize * 4);
+
+    // The raw keys are released once compressed
+    EXPECT_EQ(animation->GetChannel(0).GetSize(), 0u);
+}
+
+TEST(Animation, CompressionError)
+{
+    // Quantizing the key times and values adds a small error on top of the key reduction bounds
+    constexpr float_t QuantizationTolerance = 1e-4f;
+
+    const Pointer<Skeleton> skeleton = CreateSkeleton();
+    const Pointer<Animation> rawAnimation = CreateAnimation(skeleton);
+    const Pointer<Animation> animation = CreateAnimation(skeleton);
+
+    const AnimationCompressionSettings settings;
+    animation->Compress(settings);
+
+    float_t maxTranslationError = 0.f;
+    float_t maxRotationError = 0.f;
+    float_t maxScalingError = 0.f;
+
+    for (size_t i = 0; i < rawAnimation->GetChannelCount(); i++)
+    {
+        const List<Animation::KeyFrame>& keyFrames = rawAnimation->GetChannel(i);
+
+        for (size_t j = 0; j < keyFrames.GetSize(); j++)
+        {
+            Vector3 translation;
+            Quaternion rotation;
+            Vector3 scaling;
+            animation->SampleChannel(i, keyFrames[j].time / rawAnimation->GetFramerate(), &translation, &rotation, &scaling);
+
+            maxTranslationError = std::max(maxTranslationError, (translation - keyFrames[j].translation).Length());
+            maxRotationError = std::max(maxRotationError, AnimationCompression::AngleBetween(rotation, keyFrames[j].rotation.Normalized()));
+            maxScalingError = std::max(maxScalingError, (scaling - keyFrames[j].scaling).Length());
+        }
+    }
+
+    Logger::LogInfo("Animation compression error: translation {}, rotation {} rad, scaling {}", maxTranslationError, maxRotationError, maxScalingError);
+
+    EXPECT_LE(maxTranslationError, settings.maxTranslationError + QuantizationTolerance);
+    EXPECT_LE(maxRotationError, settings.maxRotationError + QuantizationTolerance);
+    EXPECT_LE(maxScalingError, settings.maxScalingError + QuantizationTolerance);
+
+    // The scaling never changes, so it must be stored as a constant and restored exactly
+    Vector3 scaling;
+    animation->SampleChannel(0, rawAnimation->GetDuration() * 0.5f, nullptr, nullptr, &scaling);
+    EXPECT_EQ(scaling, Vector3(1.f));
+}
+
+TEST(Animation, CompressionErrorLargeRange)
+{
+    // 65535 is a multiple of 15, so the key times fall exactly on the times quantized over the range of the track
+    constexpr uint32_t LargeRangeKeyCount = 16;
+    constexpr double_t Duration = 15.0;
+    constexpr float_t QuantizationTolerance = 1e-4f;
+
+    // Spans a few hundred units, so 16-bit values alone can't stay within the error bound
+    aiAnimation animationData;
+    animationData.mDuration = Duration;
+    animationData.mTicksPerSecond = 30.0;
+    animationData.mNumChannels = 1;
+    animationData.mChannels = new aiNodeAnim*[1];
+
+    aiNodeAnim* const channel = new aiNodeAnim;
+    channel->mNodeName = BoneName(0);
+    channel->mNumPositionKeys = LargeRangeKeyCount;
+    channel->mPositionKeys = new aiVectorKey[LargeRangeKeyCount];
+
+    for (uint32_t i = 0; i < LargeRangeKeyCount; i++)
+    {
+        const float_t value = static_cast<float_t>(i);
+        channel->mPositionKeys[i] = aiVectorKey(static_cast<double_t>(i), aiVector3D(100.f * std::sin(value * 0.4f), 60.f * std::cos(value * 0.3f), value * 20.f - 150.f));
+    }
+
+    channel->mNumRotationKeys = 1;
+    channel->mRotationKeys = new aiQuatKey[1];
+    channel->mRotationKeys[0] = aiQuatKey(0.0, aiQuaternion());
+    channel->mNumScalingKeys = 1;
+    channel->mScalingKeys = new aiVectorKey[1];
+    channel->mScalingKeys[0] = aiVectorKey(0.0, aiVector3D(1.f));
+
+    animationData.mChannels[0] = channel;
+
+    const Pointer<Animation> rawAnimation = Pointer<Animation>::New("largeRangeRaw");
+    rawAnimation->Load(animationData);
+    const Pointer<Animation> animation = Pointer<Animation>::New("largeRange");
+    animation->Load(animationData);
+
+    const AnimationCompressionSettings settings;
+    animation->Compress(settings);
+
+    const List<Animation::KeyFrame>& keyFrames = rawAnimation->GetChannel(0);
+    ASSERT_EQ(keyFrames.GetSize(), LargeRangeKeyCount);
+
+    float_t maxTranslationError = 0.f;
+    for (size_t i = 0; i < keyFrames.GetSize(); i++)
+    {
+        Vector3 translation;
+        animation->SampleChannel(0, keyFrames[i].time / rawAnimation->GetFramerate(), &translation, nullptr, nullptr);
+        maxTranslationError = std::max(maxTranslationError, (translation - keyFrames[i].translation).Length());
+    }
+
+    EXPECT_LE(maxTranslationError, settings.maxTranslationError + QuantizationTolerance);
+}
+
+TEST(Animation, CompressionLongClip)
+{
+    // More ticks than 16 bits can tell apart, with a key on every tick
+    constexpr uint32_t LongClipKeyCount = 100000;
+    constexpr float_t QuantizationTolerance = 1e-4f;
+
+    aiAnimation animationData;
+    animationData.mDuration = static_cast<double_t>(LongClipKeyCount - 1);
+    animationData.mTicksPerSecond = 30.0;
+    animationData.mNumChannels = 1;
+    animationData.mChannels = new aiNodeAnim*[1];
+
+    aiNodeAnim* const channel = new aiNodeAnim;
+    channel->mNodeName = BoneName(0);
+    channel->mNumPositionKeys = LongClipKeyCount;
+    channel->mPositionKeys = new aiVectorKey[LongClipKeyCount];
+
+    // Changes direction every key so none of them can be removed
+    for (uint32_t i = 0; i < LongClipKeyCount; i++)
+        channel->mPositionKeys[i] = aiVectorKey(static_cast<double_t>(i), aiVector3D(i % 2 == 0 ? 0.f : 1.f, 0.f, 0.f));
+
+    // The rotation only changes at the end of the clip, so its track has a long gap followed by keys a tick apart
+    constexpr uint32_t RotationKeyCount = 30;
+    channel->mNumRotationKeys = RotationKeyCount;
+    channel->mRotationKeys = new aiQuatKey[RotationKeyCount];
+    for (uint32_t i = 0; i < RotationKeyCount; i++)
+    {
+        const double_t time = static_cast<double_t>(LongClipKeyCount - RotationKeyCount + i);
+        channel->mRotationKeys[i] = aiQuatKey(time, aiQuaternion(aiVector3D(0.f, 1.f, 0.f), static_cast<float_t>(i % 2) * 0.5f));
+    }
+
+    channel->mNumScalingKeys = 1;
+    channel->mScalingKeys = new aiVectorKey[1];
+    channel->mScalingKeys[0] = aiVectorKey(0.0, aiVector3D(1.f));
+
+    animationData.mChannels[0] = channel;
+
+    const Pointer<Animation> rawAnimation = Pointer<Animation>::New("longClipRaw");
+    rawAnimation->Load(animationData);
+    const Pointer<Animation> animation = Pointer<Animation>::New("longClip");
+    animation->Load(animationData);
+
+    const AnimationCompressionSettings settings;
+    animation->Compress(settings);
+
+    const List<Animation::KeyFrame>& keyFrames = rawAnimation->GetChannel(0);
+    ASSERT_EQ(keyFrames.GetSize(), LongClipKeyCount);
+
+    float_t maxTranslationError = 0.f;
+    float_t maxRotationError = 0.f;
+
+    Animation::ChannelCursor cursor;
+    for (size_t i = 0; i < keyFrames.GetSize(); i++)
+    {
+        Vector3 translation;
+        Quaternion rotation;
+        animation->SampleChannel(0, keyFrames[i].time / rawAnimation->GetFramerate(), &cursor, &translation, &rotation, nullptr);
+
+        maxTranslationError = std::max(maxTranslationError, (translation - keyFrames[i].translation).Length());
+        maxRotationError = std::max(maxRotationError, AnimationCompression::AngleBetween(rotation, keyFrames[i].rotation.Normalized()));
+    }
+
+    EXPECT_LE(maxTranslationError, settings.maxTranslationError + QuantizationTolerance);
+    EXPECT_LE(maxRotationError, settings.maxRotationError + QuantizationTolerance);
+}
+
+TEST(Animation, SmallestThreeRotation)
+{
+    constexpr float_t Tolerance = 1e-4f;
+
+    const Quaternion rotations[] =
+    {
+        Quaternion::Identity(),
+        Quaternion(Vector3(0.f, 1.f, 0.f), -1.f).Normalized(),
+        Quaternion(Vector3(0.5f, -0.5f, 0.5f), -0.5f),
+        Quaternion(Vector3(0.1f, 0.7f, -0.3f), 0.2f).Normalized(),
+        Quaternion(Vector3(-0.9f, 0.1f, 0.f), 0.05f).Normalized()
+    };
+
+    for (const Quaternion& rotation : rotations)
+    {
+        uint16_t packed[AnimationCompression::PackedSize];
+        AnimationCompression::PackRotation(rotation, packed);
+
+        EXPECT_LE(AnimationCompression::AngleBetween(AnimationCompression::UnpackRotation(packed), rotation), Tolerance);
+    }
+}
+
+TEST(Animation, UpdateIntervals)
+{
+    const AnimationLodSettings settings;
+
+    EXPECT_EQ(AnimationSystem::ComputeUpdateInterval(0.f, true, settings), 1u);
+    EXPECT_EQ(AnimationSystem::ComputeUpdateInterval(settings.fullRateDistance, true, settings), 1u);
+    EXPECT_EQ(AnimationSystem::ComputeUpdateInterval(settings.minRateDistance * 2.f, true, settings), settings.maxUpdateInterval);
+    EXPECT_EQ(AnimationSystem::ComputeUpdateInterval(0.f, false, settings), settings.offscreenUpdateInterval);
+
+    // The interval must never decrease when going further away
+    uint32_t previousInterval = 1;
+    for (float_t distance = 0.f; distance < settings.minRateDistance * 1.5f; distance += 1.f)
+    {
+        const uint32_t interval = AnimationSystem::ComputeUpdateInterval(distance, true, settings);
+        EXPECT_GE(interval, previousInterval);
+        previousInterval = interval;
+    }
+}
+
+TEST(Animation, ParallelEvaluation)
+{
+    const Pointer<Skeleton> skeleton = CreateSkeleton();
+    const Pointer<Animation> animation = CreateAnimation(skeleton);
+
+    std::vector<Animator> serialAnimators(CharacterCount, Animator(animation));
+    std::vector<Animator> parallelAnimators(CharacterCount, Animator(animation));
+
+    JobSystem::Initialize();
+
+    auto&& start = std::chrono::system_clock::now();
+
+    for (uint32_t i = 0; i < KeyCount; i++)
+    {
+        for (Animator& animator : serialAnimators)
+            animator.Animate(FrameDuration);
+    }
+
+    const std::chrono::microseconds serialTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now() - start);
+    start = std::chrono::system_clock::now();
+
+    for (uint32_t i = 0; i < KeyCount; i++)
+    {
+        JobSystem::ParallelFor(parallelAnimators.size(), 4, [&](const size_t first, const size_t last)
+        {
+            for (size_t j = first; j < last; j++)
+                parallelAnimators[j].Animate(FrameDuration);
+        });
+    }
+
+    const std::chrono::microseconds parallelTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now() - start);
+
+    Logger::LogInfo(
+        "Animating {} characters for {} frames on {} threads: serial {}, parallel {}",
+        CharacterCount,
+        KeyCount,
+        JobSystem::GetMaxConcurrency(),
+        serialTime,
+        parallelTime
+    );
+
+    JobSystem::Destroy();
+
+    for (size_t i = 0; i < CharacterCount; i++)
+    {
+        const List<Matrix>& serialMatrices = serialAnimators[i].GetMatrices();
+        const List<Matrix>& parallelMatrices = parallelAnimators[i].GetMatrices();
+
+        ASSERT_EQ(serialMatrices.GetSize(), parallelMatrices.GetSize());
+        for (size_t j = 0; j < serialMatrices.GetSize(); j++)
+            EXPECT_EQ(serialMatrices[j], parallelMatrices[j]);
+    }
+}
+
+TEST(Animation, BlendMatchesScalar)
+{
+    const Pose a = CreatePose(BlendBoneCount, 0.f);
+    const Pose b = CreatePose(BlendBoneCount, 1.f);
+
+    BoneMask mask(BlendBoneCount);
+    for (size_t i = 0; i < BlendBoneCount; i += 3)
+        mask.SetWeight(i, 0.25f);
+
+    constexpr float_t Weight = 0.6f;
+
+    Pose result;
+    PoseBlending::Blend(a, b, Weight, &mask, &result);
+
+    ASSERT_EQ(result.GetBoneCount(), BlendBoneCount);
+
+    for (size_t i = 0; i < BlendBoneCount; i++)
+    {
+        const float_t t = Weight * mask.GetWeight(i);
+
+        const Vector3 translation = Vector3::Lerp(a.GetTranslation(i), b.GetTranslation(i), t);
+        const Quaternion rotation = AnimationCompression::Nlerp(a.GetRotation(i), b.GetRotation(i), t);
+
+        EXPECT_LE((result.GetTranslation(i) - translation).Length(), BlendTolerance);
+        EXPECT_LE(AnimationCompression::AngleBetween(result.GetRotation(i), rotation), 1e-3f);
+    }
+}
+
+TEST(Animation, BlendSignCorrection)
+{
+    Pose a(1);
+    Pose b(1);
+
+    const Quaternion rotation = Quaternion(Vector3(0.f, 0.6f, 0.f), 0.8f);
+    a.SetRotation(0, rotation);
+    b.SetRotation(0, -rotation);
+
+    // q and -q are the same rotation, so blending them must not go through a degenerate rotation
+    Pose result;
+    PoseBlending::Blend(a, b, 0.5f, nullptr, &result);
+
+    EXPECT_LE(AnimationCompression::AngleBetween(result.GetRotation(0), rotation), 1e-3f);
+}
+
+TEST(Animation, AdditiveRoundTrip)
+{
+    const Pose reference = CreatePose(BlendBoneCount, 0.f);
+    const Pose pose = CreatePose(BlendBoneCount, 0.5f);
+
+    Pose additive;
+    PoseBlending::ComputeAdditive(pose, reference, &additive);
+
+    Pose result;
+    PoseBlending::BlendAdditive(reference, additive, 1.f, nullptr, &result);
+
+    Pose unchanged;
+    PoseBlending::BlendAdditive(reference, additive, 0.f, nullptr, &unchanged);
+
+    for (size_t i = 0; i < BlendBoneCount; i++)
+    {
+        EXPECT_LE((result.GetTranslation(i) - pose.GetTranslation(i)).Length(), BlendTolerance);
+        EXPECT_LE(AnimationCompression::AngleBetween(result.GetRotation(i), pose.GetRotation(i)), 1e-3f);
+
+        EXPECT_LE((unchanged.GetTranslation(i) - reference.GetTranslation(i)).Length(), BlendTolerance);
+        EXPECT_LE(AnimationCompression::AngleBetween(unchanged.GetRotation(i), reference.GetRotation(i)), 1e-3f);
+    }
+}
+
+TEST(Animation, BlendWeighted)
+{
+    const Pose a = CreatePose(BlendBoneCount, 0.f);
+    const Pose b = CreatePose(BlendBoneCount, 1.f);
+    const Pose c = CreatePose(BlendBoneCount, 2.f);
+
+    const Pose* const poses[] = { &a, &b, &c };
+
+    // Only the weighted poses must contribute, and the weights don't need to be normalized
+    const float_t weights[] = { 2.f, 2.f, 0.f };
+
+    Pose weighted;
+    PoseBlending::BlendWeighted(poses, weights, 3, &weighted);
+
+    Pose halfway;
+    PoseBlending::Blend(a, b, 0.5f, nullptr, &halfway);
+
+    for (size_t i = 0; i < BlendBoneCount; i++)
+    {
+        EXPECT_LE((weighted.GetTranslation(i) - halfway.GetTranslation(i)).Length(), BlendTolerance);
+        EXPECT_LE(AnimationCompression::AngleBetween(weighted.GetRotation(i), halfway.GetRotation(i)), 1e-3f);
+    }
+}
+
+TEST(Animation, PoseResizeResetsPadding)
+{
+    constexpr size_t LargeBoneCount = 10;
+    constexpr size_t SmallBoneCount = 5;
+
+    Pose pose = CreatePose(LargeBoneCount, 1.f);
+
+    // Shrinking keeps the storage, the lanes past the last bone must not keep the previous transforms
+    pose.Resize(SmallBoneCount);
+    for (size_t i = SmallBoneCount; i < pose.GetPaddedBoneCount(); i++)
+    {
+        EXPECT_EQ(pose.GetTranslation(i), Vector3::Zero());
+        EXPECT_EQ(pose.GetRotation(i), Quaternion::Identity());
+    }
+
+    // Growing back within the storage gives identity bones
+    pose.Resize(LargeBoneCount);
+    for (size_t i = SmallBoneCount; i < pose.GetPaddedBoneCount(); i++)
+    {
+        EXPECT_EQ(pose.GetTranslation(i), Vector3::Zero());
+        EXPECT_EQ(pose.GetRotation(i), Quaternion::Identity());
+    }
+}
+
+TEST(Animation, ModelPoseMatchesMatrices)
+{
+    const Pose local = CreatePose(BlendBoneCount, 0.f);
+
+    // The first half has its parents before each group of bones, the second half is a chain done bone by bone
+    std::vector<int32_t> parents(BlendBoneCount);
+    for (size_t i = 0; i < BlendBoneCount; i++)
+        parents[i] = i == 0 ? -1 : static_cast<int32_t>(i < BlendBoneCount / 2 ? i / 8 : i - 1);
+
+    Pose model;
+    PoseBlending::ComputeModelPose(local, parents.data(), &model);
+
+    ASSERT_EQ(model.GetBoneCount(), BlendBoneCount);
+
+    std::vector<Matrix> matrices(BlendBoneCount);
+    for (size_t i = 0; i < BlendBoneCount; i++)
+    {
+        const Matrix localMatrix = Matrix::Trs(local.GetTranslation(i), local.GetRotation(i), Vector3(1.f));
+        matrices[i] = parents[i] == -1 ? localMatrix : matrices[parents[i]] * localMatrix;
+
+        const Matrix modelMatrix = Matrix::Trs(model.GetTranslation(i), model.GetRotation(i), Vector3(1.f));
+        for (size_t j = 0; j < 16; j++)
+            EXPECT_NEAR(modelMatrix.Raw()[j], matrices[i].Raw()[j], 1e-3f);
+    }
+}
+
+TEST(Animation, BlendThroughputBenchmark)
+{
+    const Pose a = CreatePose(BlendBoneCount, 0.f);
+    const Pose b = CreatePose(BlendBoneCount, 1.f);
+    Pose result(BlendBoneCount);
+
+    auto&& start = std::chrono::system_clock::now();
+
+    for (uint32_t i = 0; i < SampleCount; i++)
+    {
+        const float_t t = static_cast<float_t>(i) / static_cast<float_t>(SampleCount);
+
+        for (size_t j = 0; j < BlendBoneCount; j++)
+        {
+            result.SetTranslation(j, Vector3::Lerp(a.GetTranslation(j), b.GetTranslation(j), t));
+            result.SetRotation(j, Quaternion::Slerp(a.GetRotation(j), b.GetRotation(j), t));
+        }
+    }
+
+    const std::chrono::microseconds scalarTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now() - start);
+    start = std::chrono::system_clock::now();
+
+    for (uint32_t i = 0; i < SampleCount; i++)
+        PoseBlending::Blend(a, b, static_cast<float_t>(i) / static_cast<float_t>(SampleCount), nullptr, &result);
+
+    const std::chrono::microseconds simdTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now() - start);
+
+    const float_t blendedBones = static_cast<float_t>(BlendBoneCount) * static_cast<float_t>(SampleCount);
+    const float_t scalarThroughput = blendedBones / static_cast<float_t>(std::max<int64_t>(scalarTime.count(), 1));
+    const float_t simdThroughput = blendedBones / static_cast<float_t>(std::max<int64_t>(simdTime.count(), 1));
+
+    Logger::LogInfo("Blending {} bones {} times: scalar {:.1f} bones/us, SIMD {:.1f} bones/us", BlendBoneCount, SampleCount, scalarThroughput, simdThroughput);
+
+    EXPECT_GT(simdThroughput, 0.f);
+}
+
+TEST(Animation, SparseChannels)
+{
+    constexpr uint32_t RotationKeyCount = 5;
+    constexpr double_t Duration = 60.0;
+
+    aiAnimation animationData;
+    animationData.mDuration = Duration;
+    animationData.mTicksPerSecond = 30.0;
+    animationData.mNumChannels = 1;
+    animationData.mChannels = new aiNodeAnim*[1];
+
+    // Each property has its own keys, as exported by most tools when a property doesn't change often
+    aiNodeAnim* const channel = new aiNodeAnim;
+    channel->mNodeName = BoneName(0);
+
+    channel->mNumPositionKeys = 2;
+    channel->mPositionKeys = new aiVectorKey[2];
+    channel->mPositionKeys[0] = aiVectorKey(0.0, aiVector3D(0.f));
+    channel->mPositionKeys[1] = aiVectorKey(Duration, aiVector3D(0.f, 0.f, 6.f));
+
+    channel->mNumRotationKeys = RotationKeyCount;
+    channel->mRotationKeys = new aiQuatKey[RotationKeyCount];
+    for (uint32_t i = 0; i < RotationKeyCount; i++)
+        channel->mRotationKeys[i] = aiQuatKey(Duration * i / (RotationKeyCount - 1), aiQuaternion(aiVector3D(0.f, 1.f, 0.f), static_cast<float_t>(i) * 0.2f));
+
+    channel->mNumScalingKeys = 1;
+    channel->mScalingKeys = new aiVectorKey[1];
+    channel->mScalingKeys[0] = aiVectorKey(0.0, aiVector3D(2.f));
+
+    animationData.mChannels[0] = channel;
+
+    const Pointer<Animation> animation = Pointer<Animation>::New("sparse");
+    animation->Load(animationData);
+
+    ASSERT_EQ(animation->GetChannelCount(), 1u);
+    EXPECT_EQ(animation->GetChannel(0).GetSize(), RotationKeyCount);
+
+    // Halfway between the second and third rotation keys, and a quarter of the way between the two translation keys
+    const float_t time = static_cast<float_t>(Duration * 0.375 / animationData.mTicksPerSecond);
+
+    Vector3 translation;
+    Quaternion rotation;
+    Vector3 scaling;
+    animation->SampleChannel(0, time, &translation, &rotation, &scaling);
+
+    const Quaternion expectedRotation = AnimationCompression::Nlerp(
+        Quaternion(Vector3(0.f, std::sin(0.1f), 0.f), std::cos(0.1f)),
+        Quaternion(Vector3(0.f, std::sin(0.2f), 0.f), std::cos(0.2f)),
+        0.5f
+    );
+
+    EXPECT_LE((translation - Vector3(0.f, 0.f, 2.25f)).Length(), BlendTolerance);
+    EXPECT_LE(AnimationCompression::AngleBetween(rotation, expectedRotation), 1e-3f);
+    EXPECT_EQ(scaling, Vector3(2.f));
+}
+
+TEST(Animation, CursorSampling)
+{
+    const Pointer<Skeleton> skeleton = CreateSkeleton();
+    const Pointer<Animation> rawAnimation = CreateAnimation(skeleton);
+    const Pointer<Animation> compressedAnimation = CreateAnimation(skeleton);
+    compressedAnimation->Compress(AnimationCompressionSettings());
+
+    for (const Pointer<Animation>& animation : { rawAnimation, compressedAnimation })
+    {
+        const float_t duration = animation->GetDuration();
+
+        // Forward playback, backward playback and random seeks must give the same result as a search from scratch
+        std::vector<float_t> times;
+        for (uint32_t i = 0; i <= SampleCount; i++)
+            times.push_back(duration * static_cast<float_t>(i) / static_cast<float_t>(SampleCount));
+        for (uint32_t i = 0; i <= SampleCount; i++)
+            times.push_back(duration * static_cast<float_t>(SampleCount - i) / static_cast<float_t>(SampleCount));
+        for (uint32_t i = 0; i < SampleCount; i++)
+            times.push_back(duration * std::fmod(static_cast<float_t>(i) * 0.618034f, 1.f));
+
+        Animation::ChannelCursor cursor;
+
+        for (const float_t time : times)
+        {
+            Vector3 translation;
+            Quaternion rotation;
+            animation->SampleChannel(0, time, &cursor, &translation, &rotation, nullptr);
+
+            Vector3 expectedTranslation;
+            Quaternion expectedRotation;
+            animation->SampleChannel(0, time, &expectedTranslation, &expectedRotation, nullptr);
+
+            EXPECT_EQ(translation, expectedTranslation);
+            EXPECT_EQ(rotation, expectedRotation);
+        }
+    }
+}
+
+TEST(Animation, SkinningReference)
+{
+    const Matrix boneA = Matrix::Trs(Vector3(1.f, 2.f, 3.f), Quaternion::FromAxisAngle(Vector3(0.f, 1.f, 0.f), 0.9f), Vector3(1.f));
+    const Matrix boneB = Matrix::Trs(Vector3(-2.f, 0.f, 1.f), Quaternion::FromAxisAngle(Vector3(1.f, 0.f, 0.f), -0.4f), Vector3(1.f));
+    const Matrix palette[] = { boneA, boneB };
+
+    Vertex vertices[2];
+    vertices[0].position = Vector3(0.5f, -1.f, 2.f);
+    vertices[0].normal = Vector3(0.f, 0.f, 1.f);
+    vertices[0].boneIndices[0] = 0.f;
+    vertices[0].boneWeight[0] = 1.f;
+
+    vertices[1] = vertices[0];
+    vertices[1].boneIndices[1] = 1.f;
+    vertices[1].boneWeight[0] = 0.25f;
+    vertices[1].boneWeight[1] = 0.75f;
+
+    SkinnedVertex output[2];
+    SkinningPass::SkinVertices(vertices, 2, palette, 2, output);
+
+    const Vector3 single = boneA * vertices[0].position;
+    EXPECT_LE((static_cast<Vector3>(output[0].position) - single).Length(), 1e-4f);
+    EXPECT_FLOAT_EQ(output[0].position.w, 1.f);
+
+    const Vector3 rotatedNormal = Matrix::Trs(Vector3(0.f), Quaternion::FromAxisAngle(Vector3(0.f, 1.f, 0.f), 0.9f), Vector3(1.f)) * vertices[0].normal;
+    EXPECT_LE((static_cast<Vector3>(output[0].normal) - rotatedNormal).Length(), 1e-4f);
+    EXPECT_FLOAT_EQ(output[0].normal.w, 0.f);
+
+    const Vector3 blended = boneA * vertices[1].position * 0.25f + boneB * vertices[1].position * 0.75f;
+    EXPECT_LE((static_cast<Vector3>(output[1].position) - blended).Length(), 1e-4f);
+    EXPECT_NEAR(static_cast<Vector3>(output[1].normal).Length(), 1.f, 1e-4f);
+}
+
+TEST(Animation, SkinningReferenceBindPoseFallback)
+{
+    const Matrix palette[] = { Matrix::Trs(Vector3(4.f, 0.f, 0.f), Quaternion::Identity(), Vector3(1.f)) };
+
+    Vertex vertices[2];
+    vertices[0].position = Vector3(1.f, 2.f, 3.f);
+    vertices[0].normal = Vector3(0.f, 1.f, 0.f);
+
+    // References a bone the palette doesn't have, like the shaders it must stay in bind pose
+    vertices[1] = vertices[0];
+    vertices[1].boneIndices[0] = 3.f;
+    vertices[1].boneWeight[0] = 1.f;
+
+    SkinnedVertex output[2];
+    SkinningPass::SkinVertices(vertices, 2, palette, 1, output);
+
+    for (const SkinnedVertex& vertex : output)
+    {
+        EXPECT_LE((static_cast<Vector3>(vertex.position) - vertices[0].position).Length(), 1e-6f);
+        EXPECT_LE((static_cast<Vector3>(vertex.normal) - vertices[0].normal).Length(), 1e-6f);
+    }
+}
@@ -0,0 +1,748 @@
+#include "pch.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <Maths/matrix.hpp>
+#include <Maths/quaternion.hpp>
+
+#include "data_structure/octree.hpp"
+#include "rendering/camera.hpp"
+#include "rendering/frustum.hpp"
+#include "rendering/multi_view_culler.hpp"
+#include "rendering/occlusion_culler.hpp"
+#include "rendering/view_visibility.hpp"
+#include "resource/mesh.hpp"
+#include "scene/entity.hpp"
+#include "scene/component/static_mesh_renderer.hpp"
+#include "utils/bound.hpp"
+#include "utils/job_system.hpp"
+#include "utils/logger.hpp"
+
+namespace
+{
+    constexpr float_t Tolerance = 1e-4f;
+    constexpr uint32_t BenchmarkCasterCount = 8192;
+    constexpr uint32_t BenchmarkSampleCount = 20;
+    constexpr uint32_t BenchmarkOccludeeCount = 8192;
+
+    Camera CreateOrthographicCamera()
+    {
+        Camera camera;
+        camera.position = Vector3(0.f, 0.f, 10.f);
+        camera.front = -Vector3::UnitZ();
+        camera.up = Vector3::UnitY();
+        camera.right = Vector3::Cross(camera.front, camera.up).Normalized();
+        camera.near = 0.1f;
+        camera.far = 100.f;
+        camera.leftRight = { -5.f, 5.f };
+        camera.bottomtop = { -5.f, 5.f };
+        camera.isOrthographic = true;
+
+        return camera;
+    }
+
+    Camera CreatePerspectiveCamera()
+    {
+        Camera camera;
+        camera.position = Vector3::Zero();
+        camera.front = -Vector3::UnitZ();
+        camera.up = Vector3::UnitY();
+        camera.right = Vector3::Cross(camera.front, camera.up).Normalized();
+        camera.near = 0.1f;
+        camera.far = 100.f;
+        camera.fov = 60.f;
+
+        return camera;
+    }
+
+    // Meshes the octree says are visible, sorted to be compared regardless of the traversal order
+    std::vector<const StaticMeshRenderer*> GetExpectedMeshes(const std::vector<ObjectBounding<const StaticMeshRenderer>>& meshes, const Frustum& frustum, const MaterialType materialType)
+    {
+        std::vector<const StaticMeshRenderer*> result;
+        for (const ObjectBounding<const StaticMeshRenderer>& mesh : meshes)
+        {
+            if (mesh.handle->material.materialType == materialType && frustum.IsOnFrustum(mesh.bound))
+                result.push_back(mesh.handle);
+        }
+
+        std::ranges::sort(result);
+        return result;
+    }
+
+    // Views of a frame with 4 cascades, 20 spot lights and 10 point lights
+    std::vector<Frustum> CreateShadowFrusta()
+    {
+        std::mt19937 random(11);
+        std::uniform_real_distribution<float_t> position(-80.f, 80.f);
+        std::vector<Frustum> frusta;
+
+        for (uint32_t i = 0; i < 4; i++)
+        {
+            Camera camera = CreateOrthographicCamera();
+            camera.position = Vector3(0.f, 50.f, 0.f);
+            camera.front = -Vector3::UnitY();
+            camera.up = -Vector3::UnitZ();
+            camera.right = Vector3::Cross(camera.front, camera.up).Normalized();
+            camera.leftRight = { -10.f * static_cast<float_t>(i + 1), 10.f * static_cast<float_t>(i + 1) };
+            camera.bottomtop = camera.leftRight;
+
+            frusta.emplace_back().UpdateFromCamera(camera, 1.f);
+        }
+
+        for (uint32_t i = 0; i < 20; i++)
+        {
+            Camera camera = CreatePerspectiveCamera();
+            camera.position = Vector3(position(random), 10.f, position(random));
+            camera.front = Vector3(0.f, -1.f, 0.3f).Normalized();
+            camera.right = Vector3::Cross(camera.front, Vector3::UnitY()).Normalized();
+            camera.up = Vector3::Cross(camera.right, camera.front);
+            camera.far = 25.f;
+
+            frusta.emplace_back().UpdateFromCamera(camera, 1.f);
+        }
+
+        const std::array<Vector3, 6> faces = { Vector3::UnitX(), -Vector3::UnitX(), Vector3::UnitY(), -Vector3::UnitY(), Vector3::UnitZ(), -Vector3::UnitZ() };
+        for (uint32_t i = 0; i < 10; i++)
+        {
+            const Vector3 lightPosition = Vector3(position(random), 3.f, position(random));
+
+            for (const Vector3& face : faces)
+            {
+                Camera camera = CreatePerspectiveCamera();
+                camera.position = lightPosition;
+                camera.front = face;
+                camera.up = std::abs(face.y) > 0.5f ? Vector3::UnitZ() : Vector3::UnitY();
+                camera.right = Vector3::Cross(camera.front, camera.up).Normalized();
+                camera.fov = 90.f;
+                camera.far = 15.f;
+
+                frusta.emplace_back().UpdateFromCamera(camera, 1.f);
+            }
+        }
+
+        return frusta;
+    }
+
+    std::vector<Bound> CreateCasterBounds(const uint32_t count)
+    {
+        std::mt19937 random(5);
+        std::uniform_real_distribution<float_t> position(-100.f, 100.f);
+        std::uniform_real_distribution<float_t> size(0.5f, 4.f);
+
+        std::vector<Bound> bounds(count);
+        for (Bound& bound : bounds)
+            bound = Bound(Vector3(position(random), position(random) * 0.05f, position(random)), Vector3(size(random)));
+
+        return bounds;
+    }
+
+    // Culls each view on its own, as the shadow views did before MultiViewCuller
+    void CullPerView(const std::vector<Frustum>& frusta, const std::vector<Bound>& bounds, const std::vector<uint32_t>& candidates, std::vector<std::vector<uint32_t>>* const visible)
+    {
+        visible->resize(frusta.size());
+
+        for (size_t view = 0; view < frusta.size(); view++)
+        {
+            (*visible)[view].clear();
+
+            for (const uint32_t index : candidates)
+            {
+                if (frusta[view].IsOnFrustum(bounds[index]))
+                    (*visible)[view].push_back(index);
+            }
+        }
+    }
+
+    // Quad facing +Z, centered on the origin
+    void CreateWall(const float_t halfSize, std::vector<Vertex>* const vertices, std::vector<uint32_t>* const indices)
+    {
+        vertices->resize(4);
+        (*vertices)[0].position = Vector3(-halfSize, -halfSize, 0.f);
+        (*vertices)[1].position = Vector3(halfSize, -halfSize, 0.f);
+        (*vertices)[2].position = Vector3(halfSize, halfSize, 0.f);
+        (*vertices)[3].position = Vector3(-halfSize, halfSize, 0.f);
+
+        *indices = { 0, 1, 2, 0, 2, 3 };
+    }
+
+    Matrix GetViewProjection(const Camera& camera)
+    {
+        Matrix viewProjection;
+        camera.GetVp({ OcclusionCuller::Width, OcclusionCuller::Height }, &viewProjection);
+
+        return viewProjection;
+    }
+
+    // Checks that an occluded bound is behind the occluders on every pixel it covers
+    bool_t IsBehindOccluders(const OcclusionCuller& culler, const Matrix& viewProjection, const Bound& bound)
+    {
+        const Vector3 min = bound.GetMin();
+        const Vector3 max = bound.GetMax();
+        float_t minX = std::numeric_limits<float_t>::max(), maxX = std::numeric_limits<float_t>::lowest();
+        float_t minY = minX, maxY = maxX, minZ = minX;
+
+        for (uint32_t i = 0; i < 8; i++)
+        {
+            const Vector4 clip = viewProjection * Vector4(i & 1 ? max.x : min.x, i & 2 ? max.y : min.y, i & 4 ? max.z : min.z, 1.f);
+            if (clip.w <= 0.f)
+                return false;
+
+            const float_t x = (clip.x / clip.w * 0.5f + 0.5f) * static_cast<float_t>(OcclusionCuller::Width);
+            const float_t y = (clip.y / clip.w * 0.5f + 0.5f) * static_cast<float_t>(OcclusionCuller::Height);
+            minX = std::min(minX, x);
+            maxX = std::max(maxX, x);
+            minY = std::min(minY, y);
+            maxY = std::max(maxY, y);
+            minZ = std::min(minZ, clip.z / clip.w);
+        }
+
+        for (int32_t y = std::max(0, static_cast<int32_t>(std::floor(minY))); y <= std::min(OcclusionCuller::Height - 1, static_cast<int32_t>(std::floor(maxY))); y++)
+        {
+            for (int32_t x = std::max(0, static_cast<int32_t>(std::floor(minX))); x <= std::min(OcclusionCuller::Width - 1, static_cast<int32_t>(std::floor(maxX))); x++)
+            {
+                if (culler.GetDepth(x, y) >= minZ)
+                    return false;
+            }
+        }
+
+        return true;
+    }
+
+    std::vector<const StaticMeshRenderer*> Sorted(std::vector<const StaticMeshRenderer*> meshes)
+    {
+        std::ranges::sort(meshes);
+        return meshes;
+    }
+}
+
+TEST(Culling, TransformedBoundContainsCorners)
+{
+    const Bound bound(Vector3(1.f, 2.f, 3.f), Vector3(2.f, 4.f, 6.f));
+    const Matrix matrix = Matrix::Trs(Vector3(5.f, 0.f, -2.f), Quaternion::FromAxisAngle(Vector3(1.f, 1.f, 0.f).Normalized(), 0.7f), Vector3(1.5f, 1.f, 2.f));
+
+    const Bound transformed = Bound::GetAabbFromMatrix(bound, matrix);
+    const Vector3 min = transformed.GetMin();
+    const Vector3 max = transformed.GetMax();
+
+    for (uint32_t i = 0; i < 8; i++)
+    {
+        const Vector3 corner = bound.center + Vector3(
+            (i & 1) ? bound.extents.x : -bound.extents.x,
+            (i & 2) ? bound.extents.y : -bound.extents.y,
+            (i & 4) ? bound.extents.z : -bound.extents.z
+        );
+        const Vector3 point = static_cast<Vector3>(matrix * Vector4(corner.x, corner.y, corner.z, 1.f));
+
+        EXPECT_GE(point.x, min.x - Tolerance);
+        EXPECT_GE(point.y, min.y - Tolerance);
+        EXPECT_GE(point.z, min.z - Tolerance);
+        EXPECT_LE(point.x, max.x + Tolerance);
+        EXPECT_LE(point.y, max.y + Tolerance);
+        EXPECT_LE(point.z, max.z + Tolerance);
+    }
+}
+
+TEST(Culling, OrthographicFrustum)
+{
+    const Camera camera = CreateOrthographicCamera();
+
+    Frustum frustum;
+    frustum.UpdateFromCamera(camera, 1.f);
+
+    EXPECT_TRUE(frustum.IsOnFrustum(Bound(Vector3::Zero(), Vector3(1.f))));
+    // Straddling the right side of the box
+    EXPECT_TRUE(frustum.IsOnFrustum(Bound(Vector3(5.4f, 0.f, 0.f), Vector3(1.f))));
+
+    EXPECT_FALSE(frustum.IsOnFrustum(Bound(Vector3(20.f, 0.f, 0.f), Vector3(1.f))));
+    EXPECT_FALSE(frustum.IsOnFrustum(Bound(Vector3(0.f, -7.f, 0.f), Vector3(1.f))));
+    EXPECT_FALSE(frustum.IsOnFrustum(Bound(Vector3(0.f, 0.f, -200.f), Vector3(1.f))));
+    // Behind the camera
+    EXPECT_FALSE(frustum.IsOnFrustum(Bound(Vector3(0.f, 0.f, 20.f), Vector3(1.f))));
+}
+
+TEST(Culling, BoundSphereIntersection)
+{
+    const Bound bound(Vector3(0.f), Vector3(2.f));
+
+    EXPECT_TRUE(bound.IntersectSphere(Vector3(0.f), 0.1f));
+    EXPECT_TRUE(bound.IntersectSphere(Vector3(3.f, 0.f, 0.f), 2.5f));
+    EXPECT_FALSE(bound.IntersectSphere(Vector3(3.f, 0.f, 0.f), 1.5f));
+
+    // The corner is further than the faces
+    EXPECT_FALSE(bound.IntersectSphere(Vector3(2.f, 2.f, 2.f), 1.6f));
+    EXPECT_TRUE(bound.IntersectSphere(Vector3(2.f, 2.f, 2.f), 1.8f));
+}
+
+TEST(Culling, BoundConeIntersection)
+{
+    const Vector3 apex = Vector3(0.f);
+    const Vector3 direction = -Vector3::UnitZ();
+    constexpr float_t Angle = 30.f * Calc::Deg2Rad;
+    constexpr float_t Range = 10.f;
+
+    const Bound small(Vector3(0.f), Vector3(0.5f));
+
+    // On the axis
+    EXPECT_TRUE(Bound(Vector3(0.f, 0.f, -5.f), Vector3(0.5f)).IntersectCone(apex, direction, Angle, Range));
+    // Around the apex
+    EXPECT_TRUE(small.IntersectCone(apex, direction, Angle, Range));
+    // Beside the cone
+    EXPECT_FALSE(Bound(Vector3(5.f, 0.f, -5.f), Vector3(0.5f)).IntersectCone(apex, direction, Angle, Range));
+    // Behind the apex
+    EXPECT_FALSE(Bound(Vector3(0.f, 0.f, 5.f), Vector3(0.5f)).IntersectCone(apex, direction, Angle, Range));
+    // Past the range
+    EXPECT_FALSE(Bound(Vector3(0.f, 0.f, -12.f), Vector3(0.5f)).IntersectCone(apex, direction, Angle, Range));
+    // Overlapping the cone surface
+    EXPECT_TRUE(Bound(Vector3(3.5f, 0.f, -5.f), Vector3(2.f)).IntersectCone(apex, direction, Angle, Range));
+}
+
+TEST(Culling, ViewVisibilityBins)
+{
+    const Pointer<Mesh> mesh = Pointer<Mesh>::New("cube");
+    mesh->aabb = Bound(Vector3::Zero(), Vector3(1.f));
+
+    std::mt19937 random(3);
+    std::uniform_real_distribution<float_t> position(-60.f, 60.f);
+
+    std::vector<std::unique_ptr<Entity>> entities;
+    std::vector<ObjectBounding<const StaticMeshRenderer>> meshes;
+    for (uint32_t i = 0; i < 300; i++)
+    {
+        Entity* const entity = entities.emplace_back(std::make_unique<Entity>()).get();
+        entity->transform.worldMatrix = Matrix::Trs(Vector3(position(random), position(random), position(random)), Quaternion::Identity(), Vector3(1.f));
+
+        StaticMeshRenderer* const meshRenderer = entity->AddComponent<StaticMeshRenderer>();
+        meshRenderer->mesh = mesh;
+        meshRenderer->material.materialType = i % 3 == 0 ? MaterialType::Lit : MaterialType::Opaque;
+
+        ObjectBounding<const StaticMeshRenderer> data;
+        data.handle = meshRenderer;
+        meshRenderer->GetAabb(&data.bound);
+        meshes.push_back(data);
+    }
+
+    Octree<const StaticMeshRenderer> octree;
+    octree.Update(meshes);
+
+    Camera camera = CreatePerspectiveCamera();
+    Frustum frustum;
+    frustum.UpdateFromCamera(camera, 16.f / 9.f);
+
+    ViewVisibility visibility;
+    visibility.Compute(frustum, &octree, {});
+
+    EXPECT_EQ(Sorted(visibility.GetStaticMeshes(MaterialType::Opaque)), GetExpectedMeshes(meshes, frustum, MaterialType::Opaque));
+    EXPECT_EQ(Sorted(visibility.GetStaticMeshes(MaterialType::Lit)), GetExpectedMeshes(meshes, frustum, MaterialType::Lit));
+    EXPECT_FALSE(visibility.GetStaticMeshes(MaterialType::Opaque).empty());
+    EXPECT_LT(visibility.GetStats().visibleMeshes, meshes.size());
+
+    // The G-buffer, forward and picking passes all read the bins, the octree is only traversed once per view
+    EXPECT_EQ(visibility.GetStats().traversals, 1u);
+
+    camera.front = Vector3::UnitZ();
+    camera.right = Vector3::Cross(camera.front, camera.up).Normalized();
+    frustum.UpdateFromCamera(camera, 16.f / 9.f);
+    visibility.Compute(frustum, &octree, {});
+
+    EXPECT_EQ(Sorted(visibility.GetStaticMeshes(MaterialType::Opaque)), GetExpectedMeshes(meshes, frustum, MaterialType::Opaque));
+    EXPECT_EQ(Sorted(visibility.GetStaticMeshes(MaterialType::Lit)), GetExpectedMeshes(meshes, frustum, MaterialType::Lit));
+    EXPECT_EQ(visibility.GetStats().traversals, 2u);
+
+    visibility.ResetStats();
+    EXPECT_EQ(visibility.GetStats().traversals, 0u);
+}
+
+TEST(Culling, MultiViewMatchesPerView)
+{
+    const std::vector<Frustum> frusta = CreateShadowFrusta();
+    const std::vector<Bound> bounds = CreateCasterBounds(2000);
+
+    // Some bounds are not candidates, as the meshes without a valid mesh
+    std::vector<uint32_t> candidates;
+    for (uint32_t i = 0; i < bounds.size(); i++)
+    {
+        if (i % 7 != 0)
+            candidates.push_back(i);
+    }
+
+    // More than 64 views, so the masks span several words
+    ASSERT_EQ(frusta.size(), 84u);
+
+    MultiViewCuller culler;
+    culler.Cull(frusta, bounds, candidates);
+
+    std::vector<std::vector<uint32_t>> expected;
+    CullPerView(frusta, bounds, candidates, &expected);
+
+    size_t visibleCount = 0;
+    for (size_t view = 0; view < frusta.size(); view++)
+    {
+        EXPECT_EQ(culler.GetVisible(view), expected[view]);
+        visibleCount += expected[view].size();
+
+        for (size_t i = 0; i < candidates.size(); i++)
+            EXPECT_EQ(culler.IsVisible(i, view), frusta[view].IsOnFrustum(bounds[candidates[i]]));
+    }
+
+    const MultiViewCullerStats& stats = culler.GetStats();
+    EXPECT_GT(visibleCount, 0u);
+    EXPECT_EQ(stats.views, frusta.size());
+    EXPECT_EQ(stats.candidates, candidates.size());
+    EXPECT_GE(stats.boundTests, visibleCount);
+    EXPECT_LT(stats.boundTests, frusta.size() * candidates.size());
+}
+
+TEST(Culling, MultiViewEmpty)
+{
+    const std::vector<Frustum> frusta = CreateShadowFrusta();
+    const std::vector<Bound> bounds = CreateCasterBounds(10);
+
+    MultiViewCuller culler;
+    culler.Cull(frusta, bounds, {});
+
+    for (size_t view = 0; view < frusta.size(); view++)
+        EXPECT_TRUE(culler.GetVisible(view).empty());
+    EXPECT_EQ(culler.GetStats().boundTests, 0u);
+
+    culler.Cull({}, bounds, { 0, 1, 2 });
+    EXPECT_EQ(culler.GetStats().boundTests, 0u);
+}
+
+TEST(Culling, MultiViewBenchmark)
+{
+    const std::vector<Frustum> frusta = CreateShadowFrusta();
+    const std::vector<Bound> bounds = CreateCasterBounds(BenchmarkCasterCount);
+
+    std::vector<uint32_t> candidates(bounds.size());
+    for (uint32_t i = 0; i < candidates.size(); i++)
+        candidates[i] = i;
+
+    std::vector<std::vector<uint32_t>> perViewVisible;
+    auto&& start = std::chrono::system_clock::now();
+
+    for (uint32_t i = 0; i < BenchmarkSampleCount; i++)
+        CullPerView(frusta, bounds, candidates, &perViewVisible);
+
+    const std::chrono::microseconds perViewTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now() - start);
+
+    MultiViewCuller serialCuller;
+    start = std::chrono::system_clock::now();
+
+    for (uint32_t i = 0; i < BenchmarkSampleCount; i++)
+        serialCuller.Cull(frusta, bounds, candidates);
+
+    const std::chrono::microseconds serialTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now() - start);
+
+    JobSystem::Initialize();
+
+    MultiViewCuller parallelCuller;
+    start = std::chrono::system_clock::now();
+
+    for (uint32_t i = 0; i < BenchmarkSampleCount; i++)
+        parallelCuller.Cull(frusta, bounds, candidates);
+
+    const std::chrono::microseconds parallelTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now() - start);
+
+    JobSystem::Destroy();
+
+    const MultiViewCullerStats& stats = parallelCuller.GetStats();
+
+    Logger::LogInfo(
+        "Culling {} casters against {} views: per view {:.3f}ms, multi-view serial {:.3f}ms, multi-view parallel {:.3f}ms, {} bound tests instead of {}",
+        BenchmarkCasterCount,
+        frusta.size(),
+        static_cast<float_t>(perViewTime.count()) / 1000.f / BenchmarkSampleCount,
+        static_cast<float_t>(serialTime.count()) / 1000.f / BenchmarkSampleCount,
+        static_cast<float_t>(parallelTime.count()) / 1000.f / BenchmarkSampleCount,
+        stats.chunkTests + stats.boundTests,
+        frusta.size() * candidates.size()
+    );
+
+    EXPECT_LT(stats.chunkTests + stats.boundTests, frusta.size() * candidates.size());
+
+    for (size_t view = 0; view < frusta.size(); view++)
+    {
+        EXPECT_EQ(serialCuller.GetVisible(view), perViewVisible[view]);
+        EXPECT_EQ(parallelCuller.GetVisible(view), perViewVisible[view]);
+    }
+}
+
+TEST(Culling, OcclusionWall)
+{
+    const Camera camera = CreatePerspectiveCamera();
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    CreateWall(5.f, &vertices, &indices);
+
+    OcclusionCuller culler;
+    culler.Begin(GetViewProjection(camera));
+    culler.RasterizeOccluder(vertices, indices, Matrix::Trs(Vector3(0.f, 0.f, -10.f), Quaternion::Identity(), Vector3(1.f)));
+    culler.End();
+
+    EXPECT_EQ(culler.GetStats().occluders, 1u);
+    EXPECT_EQ(culler.GetStats().rasterizedTriangles, 2u);
+    // 256x128 down to 1x1
+    EXPECT_EQ(culler.GetLevelCount(), 9u);
+    EXPECT_LT(culler.GetDepth(OcclusionCuller::Width / 2, OcclusionCuller::Height / 2), OcclusionCuller::FarDepth);
+    EXPECT_EQ(culler.GetDepth(0, 0), OcclusionCuller::FarDepth);
+
+    // Behind the wall
+    EXPECT_TRUE(culler.IsOccluded(Bound(Vector3(0.f, 0.f, -20.f), Vector3(1.f))));
+    EXPECT_TRUE(culler.IsOccluded(Bound(Vector3(1.f, -1.f, -40.f), Vector3(4.f))));
+    // Wider than the wall
+    EXPECT_FALSE(culler.IsOccluded(Bound(Vector3(0.f, 0.f, -20.f), Vector3(30.f))));
+    // In front of the wall
+    EXPECT_FALSE(culler.IsOccluded(Bound(Vector3(0.f, 0.f, -5.f), Vector3(1.f))));
+    // Beside the wall
+    EXPECT_FALSE(culler.IsOccluded(Bound(Vector3(15.f, 0.f, -20.f), Vector3(1.f))));
+    // The wall itself
+    EXPECT_FALSE(culler.IsOccluded(Bound(Vector3(0.f, 0.f, -10.f), Vector3(10.f, 10.f, 0.f))));
+    // Crossing the camera plane, and behind the camera
+    EXPECT_FALSE(culler.IsOccluded(Bound(Vector3::Zero(), Vector3(1.f))));
+    EXPECT_FALSE(culler.IsOccluded(Bound(Vector3(0.f, 0.f, 20.f), Vector3(1.f))));
+
+    // Nothing is occluded once the occluders are cleared
+    culler.Begin(GetViewProjection(camera));
+    culler.End();
+    EXPECT_FALSE(culler.IsOccluded(Bound(Vector3(0.f, 0.f, -20.f), Vector3(1.f))));
+}
+
+TEST(Culling, OcclusionIsConservative)
+{
+    Camera camera = CreatePerspectiveCamera();
+    camera.position = Vector3(0.f, 1.f, 0.f);
+    const Matrix viewProjection = GetViewProjection(camera);
+
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    CreateWall(3.f, &vertices, &indices);
+
+    std::mt19937 random(9);
+    std::uniform_real_distribution<float_t> position(-30.f, 30.f);
+    std::uniform_real_distribution<float_t> depth(-60.f, -2.f);
+    std::uniform_real_distribution<float_t> size(0.1f, 5.f);
+    std::uniform_real_distribution<float_t> angle(-1.f, 1.f);
+
+    OcclusionCuller culler;
+    culler.Begin(viewProjection);
+    for (uint32_t i = 0; i < 20; i++)
+    {
+        const Quaternion rotation = Quaternion::FromAxisAngle(Vector3::UnitY(), angle(random));
+        culler.RasterizeOccluder(vertices, indices, Matrix::Trs(Vector3(position(random) * 0.3f, position(random) * 0.1f, depth(random) * 0.3f), rotation, Vector3(1.f)));
+    }
+    culler.End();
+
+    size_t occludedCount = 0;
+    for (uint32_t i = 0; i < 5000; i++)
+    {
+        const Bound bound(Vector3(position(random), position(random) * 0.2f, depth(random)), Vector3(size(random)));
+        if (!culler.IsOccluded(bound))
+            continue;
+
+        occludedCount++;
+        EXPECT_TRUE(IsBehindOccluders(culler, viewProjection, bound));
+    }
+
+    EXPECT_GT(occludedCount, 0u);
+}
+
+TEST(Culling, OcclusionCoversFullPixels)
+{
+    const Camera camera = CreatePerspectiveCamera();
+    const Matrix viewProjection = GetViewProjection(camera);
+
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    CreateWall(3.f, &vertices, &indices);
+
+    const Quaternion rotation = Quaternion::FromAxisAngle(Vector3::UnitY(), 0.5f) * Quaternion::FromAxisAngle(Vector3::UnitZ(), 0.3f);
+    const Matrix model = Matrix::Trs(Vector3(0.5f, 0.2f, -10.f), rotation, Vector3(1.f));
+
+    OcclusionCuller culler;
+    culler.Begin(viewProjection);
+    culler.RasterizeOccluder(vertices, indices, model);
+    culler.End();
+
+    std::array<Vector2, 4> corners;
+    for (size_t i = 0; i < corners.size(); i++)
+    {
+        const Vector4 clip = viewProjection * (model * Vector4(vertices[i].position.x, vertices[i].position.y, vertices[i].position.z, 1.f));
+        corners[i] = Vector2(
+            (clip.x / clip.w * 0.5f + 0.5f) * static_cast<float_t>(OcclusionCuller::Width),
+            (clip.y / clip.w * 0.5f + 0.5f) * static_cast<float_t>(OcclusionCuller::Height)
+        );
+    }
+
+    // Signed distance to the border of the projected wall, positive inside
+    const auto getDistance = [&](const float_t x, const float_t y) -> float_t
+    {
+        float_t distance = std::numeric_limits<float_t>::max();
+        for (size_t i = 0; i < corners.size(); i++)
+        {
+            const Vector2 from = corners[i];
+            const Vector2 to = corners[(i + 1) % corners.size()];
+            const float_t length = std::sqrt((to.x - from.x) * (to.x - from.x) + (to.y - from.y) * (to.y - from.y));
+            distance = std::min(distance, ((to.x - from.x) * (y - from.y) - (to.y - from.y) * (x - from.x)) / length);
+        }
+
+        return distance;
+    };
+
+    // The projected wall must be counterclockwise for the distances above
+    ASSERT_GT(getDistance((corners[0].x + corners[2].x) * 0.5f, (corners[0].y + corners[2].y) * 0.5f), 0.f);
+
+    size_t writtenCount = 0;
+    for (int32_t y = 0; y < OcclusionCuller::Height; y++)
+    {
+        for (int32_t x = 0; x < OcclusionCuller::Width; x++)
+        {
+            if (culler.GetDepth(x, y) < OcclusionCuller::FarDepth)
+            {
+                // No depth is written on partially covered pixels
+                writtenCount++;
+                for (uint32_t corner = 0; corner < 4; corner++)
+                    EXPECT_GE(getDistance(static_cast<float_t>(x + (corner & 1)), static_cast<float_t>(y + (corner >> 1))), -Tolerance);
+            }
+            else
+            {
+                // But every pixel well inside is, including those on the diagonal shared by the two triangles
+                EXPECT_LT(getDistance(static_cast<float_t>(x) + 0.5f, static_cast<float_t>(y) + 0.5f), 1.5f);
+            }
+        }
+    }
+
+    EXPECT_GT(writtenCount, 0u);
+}
+
+TEST(Culling, ViewVisibilityOcclusion)
+{
+    const Pointer<Mesh> mesh = Pointer<Mesh>::New("cube");
+    mesh->aabb = Bound(Vector3::Zero(), Vector3(1.f));
+
+    std::vector<std::unique_ptr<Entity>> entities;
+    std::vector<ObjectBounding<const StaticMeshRenderer>> meshes;
+    for (const float_t z : { -5.f, -20.f, -30.f })
+    {
+        Entity* const entity = entities.emplace_back(std::make_unique<Entity>()).get();
+        entity->transform.worldMatrix = Matrix::Trs(Vector3(0.f, 0.f, z), Quaternion::Identity(), Vector3(1.f));
+
+        StaticMeshRenderer* const meshRenderer = entity->AddComponent<StaticMeshRenderer>();
+        meshRenderer->mesh = mesh;
+
+        ObjectBounding<const StaticMeshRenderer> data;
+        data.handle = meshRenderer;
+        meshRenderer->GetAabb(&data.bound);
+        meshes.push_back(data);
+    }
+
+    Octree<const StaticMeshRenderer> octree;
+    octree.Update(meshes);
+
+    const Camera camera = CreatePerspectiveCamera();
+    Frustum frustum;
+    frustum.UpdateFromCamera(camera, 2.f);
+
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    CreateWall(5.f, &vertices, &indices);
+
+    OcclusionCuller culler;
+    culler.Begin(GetViewProjection(camera));
+    culler.RasterizeOccluder(vertices, indices, Matrix::Trs(Vector3(0.f, 0.f, -10.f), Quaternion::Identity(), Vector3(1.f)));
+    culler.End();
+
+    ViewVisibility visibility;
+    visibility.Compute(frustum, &octree, {}, &culler);
+
+    // Only the mesh in front of the wall is left
+    ASSERT_EQ(visibility.GetStaticMeshes(MaterialType::Opaque).size(), 1u);
+    EXPECT_EQ(visibility.GetStaticMeshes(MaterialType::Opaque)[0], meshes[0].handle);
+    EXPECT_EQ(visibility.GetStats().occludedMeshes, 2u);
+
+    visibility.Compute(frustum, &octree, {});
+    EXPECT_EQ(visibility.GetStaticMeshes(MaterialType::Opaque).size(), 3u);
+}
+
+TEST(Culling, OcclusionBenchmark)
+{
+    Camera camera = CreatePerspectiveCamera();
+    camera.position = Vector3(0.f, 1.f, 0.f);
+    const Matrix viewProjection = GetViewProjection(camera);
+
+    Frustum frustum;
+    frustum.UpdateFromCamera(camera, static_cast<float_t>(OcclusionCuller::Width) / static_cast<float_t>(OcclusionCuller::Height));
+
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    CreateWall(4.f, &vertices, &indices);
+
+    // Walls of the rooms in front of the camera, as in an interior level
+    std::vector<Matrix> walls;
+    for (int32_t x = -3; x <= 3; x++)
+    {
+        for (int32_t z = 1; z <= 4; z++)
+            walls.push_back(Matrix::Trs(Vector3(static_cast<float_t>(x) * 8.f, 1.f, static_cast<float_t>(z) * -10.f), Quaternion::Identity(), Vector3(1.f)));
+    }
+
+    std::mt19937 random(13);
+    std::uniform_real_distribution<float_t> position(-30.f, 30.f);
+    std::uniform_real_distribution<float_t> depth(-95.f, -1.f);
+    std::uniform_real_distribution<float_t> size(0.2f, 2.f);
+
+    std::vector<Bound> bounds(BenchmarkOccludeeCount);
+    for (Bound& bound : bounds)
+        bound = Bound(Vector3(position(random), 1.f + position(random) * 0.05f, depth(random)), Vector3(size(random)));
+
+    OcclusionCuller culler;
+    size_t inFrustumCount = 0;
+    size_t visibleCount = 0;
+    auto&& start = std::chrono::system_clock::now();
+
+    for (uint32_t i = 0; i < BenchmarkSampleCount; i++)
+    {
+        culler.Begin(viewProjection);
+        for (const Matrix& wall : walls)
+            culler.RasterizeOccluder(vertices, indices, wall);
+        culler.End();
+    }
+
+    const std::chrono::microseconds rasterizationTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now() - start);
+    start = std::chrono::system_clock::now();
+
+    for (uint32_t i = 0; i < BenchmarkSampleCount; i++)
+    {
+        inFrustumCount = 0;
+        visibleCount = 0;
+
+        for (const Bound& bound : bounds)
+        {
+            if (!frustum.IsOnFrustum(bound))
+                continue;
+
+            inFrustumCount++;
+            if (!culler.IsOccluded(bound))
+                visibleCount++;
+        }
+    }
+
+    const std::chrono::microseconds testTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now() - start);
+
+    Logger::LogInfo(
+        "Occlusion culling {} bounds behind {} walls: rasterization {:.3f}ms, tests {:.3f}ms, {} drawn instead of {} with frustum culling only",
+        BenchmarkOccludeeCount,
+        walls.size(),
+        static_cast<float_t>(rasterizationTime.count()) / 1000.f / BenchmarkSampleCount,
+        static_cast<float_t>(testTime.count()) / 1000.f / BenchmarkSampleCount,
+        visibleCount,
+        inFrustumCount
+    );
+
+    EXPECT_LT(visibleCount, inFrustumCount);
+}
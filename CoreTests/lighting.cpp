@@ -0,0 +1,223 @@
+#include "pch.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include <Maths/calc.hpp>
+
+#include "rendering/camera.hpp"
+#include "rendering/light/light_cluster_grid.hpp"
+#include "rendering/light/point_light.hpp"
+#include "rendering/light/spot_light.hpp"
+#include "rendering/render_systems/light_manager.hpp"
+#include "utils/job_system.hpp"
+#include "utils/logger.hpp"
+
+namespace
+{
+    constexpr float_t Aspect = 16.f / 9.f;
+    constexpr uint32_t BenchmarkLightCount = 4096;
+    constexpr uint32_t BenchmarkSampleCount = 20;
+
+    Camera CreateCamera()
+    {
+        Camera camera;
+        camera.position = Vector3(0.f, 2.f, 0.f);
+        camera.front = -Vector3::UnitZ();
+        camera.up = Vector3::UnitY();
+        camera.right = Vector3::UnitX();
+        camera.near = 0.1f;
+        camera.far = 200.f;
+        camera.fov = 60.f;
+
+        return camera;
+    }
+
+    std::vector<ClusteredLight> CreateLights(const uint32_t count, const float_t extent)
+    {
+        std::mt19937 random(42);
+        std::uniform_real_distribution<float_t> position(-extent, extent);
+        std::uniform_real_distribution<float_t> radius(0.5f, 5.f);
+
+        std::vector<ClusteredLight> lights(count);
+        for (ClusteredLight& light : lights)
+            light = { Vector3(position(random), position(random) * 0.1f, position(random)), radius(random) };
+
+        return lights;
+    }
+
+    bool_t ClusterContains(const LightClusterGrid& grid, const uint32_t cluster, const uint32_t light)
+    {
+        const LightClusterRange& range = grid.GetClusters()[cluster];
+        const std::vector<uint32_t>& indices = grid.GetLightIndices();
+
+        return std::find(indices.begin() + range.offset, indices.begin() + range.offset + range.count, light) != indices.begin() + range.offset + range.count;
+    }
+}
+
+TEST(Lighting, ClusterGridLightInFront)
+{
+    const Camera camera = CreateCamera();
+    const Vector3 lightPosition = camera.position + camera.front * 10.f;
+
+    LightClusterGrid grid;
+    grid.Build(camera, Aspect, { { lightPosition, 1.f } });
+
+    EXPECT_EQ(grid.GetClusters().size(), static_cast<size_t>(LightClusterGrid::ClusterCount));
+    EXPECT_TRUE(ClusterContains(grid, grid.GetClusterIndex(lightPosition), 0));
+    EXPECT_FALSE(ClusterContains(grid, grid.GetClusterIndex(camera.position + camera.front * 50.f), 0));
+    EXPECT_FALSE(ClusterContains(grid, grid.GetClusterIndex(lightPosition + camera.right * 8.f), 0));
+}
+
+TEST(Lighting, ClusterGridCullsLightsOutsideTheView)
+{
+    const Camera camera = CreateCamera();
+
+    LightClusterGrid grid;
+    grid.Build(camera, Aspect, {
+        { camera.position - camera.front * 10.f, 2.f },
+        { camera.position + camera.front * 10.f + camera.right * 100.f, 2.f },
+        { camera.position + camera.front * 500.f, 2.f }
+    });
+
+    EXPECT_TRUE(grid.GetLightIndices().empty());
+}
+
+TEST(Lighting, ClusterGridIsConservative)
+{
+    const Camera camera = CreateCamera();
+    const std::vector<ClusteredLight> lights = CreateLights(256, 60.f);
+
+    LightClusterGrid grid;
+    grid.Build(camera, Aspect, lights);
+
+    // Every visible point a light reaches must find the light in its cluster
+    std::mt19937 random(7);
+    std::uniform_real_distribution<float_t> unit(-1.f, 1.f);
+    const float_t tanHalfFovY = std::tan(camera.fov * Calc::Deg2Rad * 0.5f);
+
+    for (uint32_t i = 0; i < lights.size(); i++)
+    {
+        for (uint32_t j = 0; j < 32; j++)
+        {
+            const Vector3 offset = Vector3(unit(random), unit(random), unit(random)) * (lights[i].radius / std::sqrt(3.f));
+            const Vector3 point = lights[i].position + offset;
+
+            const Vector3 toPoint = point - camera.position;
+            const float_t depth = Vector3::Dot(toPoint, camera.front);
+            if (depth < camera.near || depth > camera.far)
+                continue;
+
+            const float_t screenX = Vector3::Dot(toPoint, camera.right) / (depth * tanHalfFovY * Aspect);
+            const float_t screenY = Vector3::Dot(toPoint, camera.up) / (depth * tanHalfFovY);
+            if (std::abs(screenX) > 1.f || std::abs(screenY) > 1.f)
+                continue;
+
+            EXPECT_TRUE(ClusterContains(grid, grid.GetClusterIndex(point), i));
+        }
+    }
+}
+
+TEST(Lighting, ClusterGridOrthographic)
+{
+    Camera camera = CreateCamera();
+    camera.isOrthographic = true;
+
+    LightClusterGrid grid;
+    grid.Build(camera, Aspect, CreateLights(10, 20.f));
+
+    ASSERT_EQ(grid.GetClusters().size(), 1u);
+    EXPECT_EQ(grid.GetClusters()[0].count, 10u);
+    EXPECT_EQ(grid.GetClusterIndex(Vector3(5.f, 0.f, -30.f)), 0u);
+}
+
+TEST(Lighting, SpotLightBounds)
+{
+    const Vector3 position = Vector3(1.f, 2.f, 3.f);
+    const Vector3 direction = Vector3(0.f, -1.f, 1.f).Normalized();
+    constexpr float_t Range = 10.f;
+
+    for (const float_t angle : { 10.f, 30.f, 45.f, 60.f, 80.f })
+    {
+        const ClusteredLight bounds = LightClusterGrid::GetSpotLightBounds(position, direction, angle * Calc::Deg2Rad, Range);
+
+        const Vector3 side = Vector3::Cross(direction, Vector3::UnitX()).Normalized();
+        const Vector3 edge = direction * std::cos(angle * Calc::Deg2Rad) + side * std::sin(angle * Calc::Deg2Rad);
+
+        EXPECT_LE((position - bounds.position).Length(), bounds.radius + 1e-4f);
+        EXPECT_LE((position + direction * Range - bounds.position).Length(), bounds.radius + 1e-4f);
+        EXPECT_LE((position + edge * Range - bounds.position).Length(), bounds.radius + 1e-4f);
+        EXPECT_LE(bounds.radius, Range + 1e-4f);
+    }
+}
+
+TEST(Lighting, LightRegistration)
+{
+    const size_t registeredCount = LightManager::GetRegisteredLights().size();
+
+    {
+        const PointLight pointLight;
+        const SpotLight spotLight;
+        const SpotLight copy = spotLight;
+
+        const std::vector<const Light*> lights = LightManager::GetRegisteredLights();
+        EXPECT_EQ(lights.size(), registeredCount + 3);
+        EXPECT_NE(std::ranges::find(lights, static_cast<const Light*>(&pointLight)), lights.end());
+        EXPECT_NE(std::ranges::find(lights, static_cast<const Light*>(&copy)), lights.end());
+    }
+
+    EXPECT_EQ(LightManager::GetRegisteredLights().size(), registeredCount);
+}
+
+TEST(Lighting, ClusterGridBenchmark)
+{
+    const Camera camera = CreateCamera();
+    const std::vector<ClusteredLight> lights = CreateLights(BenchmarkLightCount, 100.f);
+
+    LightClusterGrid serialGrid;
+    auto&& start = std::chrono::system_clock::now();
+
+    for (uint32_t i = 0; i < BenchmarkSampleCount; i++)
+        serialGrid.Build(camera, Aspect, lights);
+
+    const std::chrono::microseconds serialTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now() - start);
+
+    JobSystem::Initialize();
+
+    LightClusterGrid parallelGrid;
+    start = std::chrono::system_clock::now();
+
+    for (uint32_t i = 0; i < BenchmarkSampleCount; i++)
+        parallelGrid.Build(camera, Aspect, lights);
+
+    const std::chrono::microseconds parallelTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now() - start);
+
+    JobSystem::Destroy();
+
+    size_t maxLightsPerCluster = 0;
+    for (const LightClusterRange& cluster : parallelGrid.GetClusters())
+        maxLightsPerCluster = std::max<size_t>(maxLightsPerCluster, cluster.count);
+
+    Logger::LogInfo(
+        "Binning {} lights in {} clusters: serial {:.3f}ms, parallel {:.3f}ms, {} indices, at most {} lights per cluster instead of {}",
+        BenchmarkLightCount,
+        LightClusterGrid::ClusterCount,
+        static_cast<float_t>(serialTime.count()) / 1000.f / BenchmarkSampleCount,
+        static_cast<float_t>(parallelTime.count()) / 1000.f / BenchmarkSampleCount,
+        parallelGrid.GetLightIndices().size(),
+        maxLightsPerCluster,
+        BenchmarkLightCount
+    );
+
+    EXPECT_LT(maxLightsPerCluster, static_cast<size_t>(BenchmarkLightCount));
+    EXPECT_EQ(serialGrid.GetLightIndices(), parallelGrid.GetLightIndices());
+
+    for (size_t i = 0; i < serialGrid.GetClusters().size(); i++)
+    {
+        EXPECT_EQ(serialGrid.GetClusters()[i].offset, parallelGrid.GetClusters()[i].offset);
+        EXPECT_EQ(serialGrid.GetClusters()[i].count, parallelGrid.GetClusters()[i].count);
+    }
+}
@@ -0,0 +1,278 @@
+#include "pch.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+#include <Maths/calc.hpp>
+
+#include "rendering/camera.hpp"
+#include "rendering/lod_selector.hpp"
+#include "rendering/mesh_simplifier.hpp"
+#include "rendering/vertex.hpp"
+#include "resource/model.hpp"
+#include "utils/bound.hpp"
+#include "utils/logger.hpp"
+
+namespace
+{
+    constexpr uint32_t SphereSlices = 64;
+    constexpr uint32_t SphereStacks = 32;
+    constexpr uint32_t GridSize = 20;
+
+    Vertex CreateSphereVertex(const uint32_t slice, const uint32_t stack)
+    {
+        const float_t theta = Calc::Pi * static_cast<float_t>(stack) / static_cast<float_t>(SphereStacks);
+        const float_t phi = 2.f * Calc::Pi * static_cast<float_t>(slice % SphereSlices) / static_cast<float_t>(SphereSlices);
+
+        Vertex vertex;
+        vertex.position = Vector3(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi));
+
+        // The poles are a single position, whatever the slice
+        if (stack == 0 || stack == SphereStacks)
+            vertex.position = Vector3(0.f, stack == 0 ? 1.f : -1.f, 0.f);
+
+        vertex.normal = vertex.position;
+        return vertex;
+    }
+
+    // Every triangle has its own vertices, like the meshes loaded without joining the identical vertices
+    void CreateSphere(std::vector<Vertex>* const vertices, std::vector<uint32_t>* const indices)
+    {
+        const auto addTriangle = [&](const Vertex& a, const Vertex& b, const Vertex& c)
+        {
+            for (const Vertex& vertex : { a, b, c })
+            {
+                indices->push_back(static_cast<uint32_t>(vertices->size()));
+                vertices->push_back(vertex);
+            }
+        };
+
+        for (uint32_t stack = 0; stack < SphereStacks; stack++)
+        {
+            for (uint32_t slice = 0; slice < SphereSlices; slice++)
+            {
+                const Vertex a = CreateSphereVertex(slice, stack);
+                const Vertex b = CreateSphereVertex(slice + 1, stack);
+                const Vertex c = CreateSphereVertex(slice, stack + 1);
+                const Vertex d = CreateSphereVertex(slice + 1, stack + 1);
+
+                if (stack > 0)
+                    addTriangle(a, b, c);
+                if (stack < SphereStacks - 1)
+                    addTriangle(b, d, c);
+            }
+        }
+    }
+
+    void CreateGrid(std::vector<Vertex>* const vertices, std::vector<uint32_t>* const indices)
+    {
+        for (uint32_t y = 0; y <= GridSize; y++)
+        {
+            for (uint32_t x = 0; x <= GridSize; x++)
+            {
+                Vertex& vertex = vertices->emplace_back();
+                vertex.position = Vector3(static_cast<float_t>(x), 0.f, static_cast<float_t>(y));
+                vertex.normal = Vector3::UnitY();
+                vertex.textureCoord = Vector2(static_cast<float_t>(x), static_cast<float_t>(y)) / static_cast<float_t>(GridSize);
+            }
+        }
+
+        for (uint32_t y = 0; y < GridSize; y++)
+        {
+            for (uint32_t x = 0; x < GridSize; x++)
+            {
+                const uint32_t a = y * (GridSize + 1) + x;
+                const uint32_t c = a + GridSize + 1;
+                indices->insert(indices->end(), { a, c, a + 1, a + 1, c, c + 1 });
+            }
+        }
+    }
+
+    size_t CountInvertedTriangles(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices)
+    {
+        size_t count = 0;
+        for (size_t i = 0; i < indices.size(); i += 3)
+        {
+            const Vector3& a = vertices[indices[i]].position;
+            const Vector3& b = vertices[indices[i + 1]].position;
+            const Vector3& c = vertices[indices[i + 2]].position;
+
+            // The sphere is convex, every face must point away from its center
+            if (Vector3::Dot(Vector3::Cross(b - a, c - a), a + b + c) <= 0.f)
+                count++;
+        }
+
+        return count;
+    }
+
+    Camera CreateCamera()
+    {
+        Camera camera;
+        camera.position = Vector3::Zero();
+        camera.front = -Vector3::UnitZ();
+        camera.fov = 60.f;
+
+        return camera;
+    }
+}
+
+TEST(Lod, SimplifierReachesTarget)
+{
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    CreateSphere(&vertices, &indices);
+
+    for (const size_t divisor : { 2u, 4u, 16u })
+    {
+        const size_t targetIndexCount = indices.size() / divisor / 3 * 3;
+
+        std::vector<uint32_t> simplified;
+        MeshSimplifier::Simplify(vertices, indices, targetIndexCount, &simplified);
+
+        EXPECT_EQ(simplified.size() % 3, 0u);
+        EXPECT_LE(simplified.size(), targetIndexCount);
+        EXPECT_GT(simplified.size(), 0u);
+        EXPECT_EQ(CountInvertedTriangles(vertices, simplified), 0u);
+    }
+}
+
+TEST(Lod, SimplifierKeepsBorders)
+{
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    CreateGrid(&vertices, &indices);
+
+    std::vector<uint32_t> simplified;
+    MeshSimplifier::Simplify(vertices, indices, 0, &simplified);
+
+    EXPECT_LT(simplified.size(), indices.size());
+
+    std::vector<bool_t> used(vertices.size(), false);
+    for (const uint32_t index : simplified)
+        used[index] = true;
+
+    // The border vertices can't move, so the grid keeps its outline and its area
+    float_t area = 0.f;
+    for (size_t i = 0; i < simplified.size(); i += 3)
+    {
+        const Vector3& a = vertices[simplified[i]].position;
+        area += Vector3::Cross(vertices[simplified[i + 1]].position - a, vertices[simplified[i + 2]].position - a).Length() * 0.5f;
+    }
+
+    EXPECT_NEAR(area, static_cast<float_t>(GridSize * GridSize), 1e-2f);
+
+    for (uint32_t i = 0; i <= GridSize; i++)
+    {
+        EXPECT_TRUE(used[i]);
+        EXPECT_TRUE(used[GridSize * (GridSize + 1) + i]);
+        EXPECT_TRUE(used[i * (GridSize + 1)]);
+        EXPECT_TRUE(used[i * (GridSize + 1) + GridSize]);
+    }
+}
+
+TEST(Lod, CompactVertices)
+{
+    std::vector<Vertex> vertices(5);
+    for (size_t i = 0; i < vertices.size(); i++)
+        vertices[i].position = Vector3(static_cast<float_t>(i));
+
+    std::vector<Vertex> usedVertices;
+    std::vector<uint32_t> remappedIndices;
+    MeshSimplifier::CompactVertices(vertices, { 4, 1, 3, 3, 1, 4 }, &usedVertices, &remappedIndices);
+
+    ASSERT_EQ(usedVertices.size(), 3u);
+    EXPECT_EQ(usedVertices[0].position, vertices[4].position);
+    EXPECT_EQ(usedVertices[1].position, vertices[1].position);
+    EXPECT_EQ(usedVertices[2].position, vertices[3].position);
+    EXPECT_EQ(remappedIndices, (std::vector<uint32_t>{ 0, 1, 2, 2, 1, 0 }));
+}
+
+TEST(Lod, ScreenSize)
+{
+    Camera camera = CreateCamera();
+    const Bound bound(Vector3(0.f, 0.f, -10.f), Vector3(2.f));
+
+    const float_t near = LodSelector::ComputeScreenSize(camera, bound);
+    const float_t far = LodSelector::ComputeScreenSize(camera, Bound(Vector3(0.f, 0.f, -20.f), Vector3(2.f)));
+
+    EXPECT_NEAR(far, near * 0.5f, 1e-4f);
+    EXPECT_GT(LodSelector::ComputeScreenSize(camera, Bound(Vector3::Zero(), Vector3(2.f))), 1.f);
+
+    // An orthographic view has no perspective, only the size of the bound matters
+    camera.isOrthographic = true;
+    EXPECT_FLOAT_EQ(
+        LodSelector::ComputeScreenSize(camera, bound),
+        LodSelector::ComputeScreenSize(camera, Bound(Vector3(0.f, 0.f, -500.f), Vector3(2.f)))
+    );
+}
+
+TEST(Lod, ScreenSizeFromSeveralCameras)
+{
+    const Bound bound(Vector3(0.f, 0.f, -10.f), Vector3(2.f));
+    Camera near = CreateCamera();
+    Camera far = CreateCamera();
+    far.position = Vector3(0.f, 0.f, 30.f);
+
+    // The mesh gets the detail it needs in the view it is the largest in, whatever the order of the views
+    const float_t screenSize = LodSelector::ComputeScreenSize(near, bound);
+    EXPECT_FLOAT_EQ(LodSelector::ComputeScreenSize(std::vector<Camera>{ near, far }, bound), screenSize);
+    EXPECT_FLOAT_EQ(LodSelector::ComputeScreenSize(std::vector<Camera>{ far, near }, bound), screenSize);
+    EXPECT_EQ(LodSelector::ComputeScreenSize(std::vector<Camera>{}, bound), 0.f);
+}
+
+TEST(Lod, Hysteresis)
+{
+    const MeshLodSettings settings;
+    const float_t threshold = settings.screenSizes[0];
+
+    EXPECT_EQ(LodSelector::ComputeLod(1.f, 0, 4, settings), 0u);
+    EXPECT_EQ(LodSelector::ComputeLod(0.f, 0, 4, settings), 3u);
+    EXPECT_EQ(LodSelector::ComputeLod(0.f, 0, 2, settings), 1u);
+    EXPECT_EQ(LodSelector::ComputeLod(0.f, 0, 1, settings), 0u);
+
+    // Just below or above the threshold, a mesh keeps its level
+    EXPECT_EQ(LodSelector::ComputeLod(threshold * 0.95f, 0, 4, settings), 0u);
+    EXPECT_EQ(LodSelector::ComputeLod(threshold * 1.05f, 1, 4, settings), 1u);
+
+    // Past the margin, it switches
+    EXPECT_EQ(LodSelector::ComputeLod(threshold * (1.f - settings.hysteresis) * 0.99f, 0, 4, settings), 1u);
+    EXPECT_EQ(LodSelector::ComputeLod(threshold * (1.f + settings.hysteresis) * 1.01f, 1, 4, settings), 0u);
+}
+
+TEST(Lod, Chain)
+{
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    CreateSphere(&vertices, &indices);
+
+    // Built like Model::GenerateLods, each level simplified from the previous one
+    std::vector<uint32_t> levelIndices = indices;
+    std::vector<size_t> triangleCounts = { indices.size() / 3 };
+
+    auto&& start = std::chrono::system_clock::now();
+
+    while (triangleCounts.size() < Model::MaxLodCount)
+    {
+        std::vector<uint32_t> simplified;
+        MeshSimplifier::Simplify(vertices, levelIndices, levelIndices.size() / 2 / 3 * 3, &simplified);
+        triangleCounts.push_back(simplified.size() / 3);
+        levelIndices.swap(simplified);
+    }
+
+    const std::chrono::microseconds time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now() - start);
+
+    Logger::LogInfo(
+        "Simplifying a {} triangles sphere: {} -> {} -> {} triangles in {:.3f}ms",
+        triangleCounts[0],
+        triangleCounts[1],
+        triangleCounts[2],
+        triangleCounts[3],
+        static_cast<float_t>(time.count()) / 1000.f
+    );
+
+    for (size_t i = 1; i < triangleCounts.size(); i++)
+        EXPECT_LE(triangleCounts[i], triangleCounts[i - 1] / 2);
+
+    EXPECT_EQ(CountInvertedTriangles(vertices, levelIndices), 0u);
+}
@@ -0,0 +1,325 @@
+#include "pch.hpp"
+
+#include <chrono>
+#include <vector>
+
+#include "physics/physics_world.hpp"
+#include "rendering/vertex.hpp"
+#include "utils/job_system.hpp"
+#include "utils/logger.hpp"
+
+namespace
+{
+    constexpr uint32_t SampleCount = 128;
+    constexpr uint32_t PatchSize = 8;
+    constexpr uint32_t RayCount = 10000;
+
+    float_t TerrainHeight(const uint32_t x, const uint32_t y)
+    {
+        return (std::sin(static_cast<float_t>(x) * 0.2f) + std::cos(static_cast<float_t>(y) * 0.15f)) * 0.5f + 1.f;
+    }
+
+    std::chrono::microseconds CastRays(size_t* const hitCount)
+    {
+        constexpr float_t HalfExtent = static_cast<float_t>(SampleCount - 1) * 0.5f;
+
+        *hitCount = 0;
+        PhysicsWorld::RaycastResult result;
+
+        auto&& start = std::chrono::steady_clock::now();
+
+        for (uint32_t i = 0; i < RayCount; i++)
+        {
+            const float_t x = static_cast<float_t>(i % 100) / 100.f * (HalfExtent * 1.8f) - HalfExtent * 0.9f;
+            const float_t z = static_cast<float_t>(i / 100) / 100.f * (HalfExtent * 1.8f) - HalfExtent * 0.9f;
+
+            if (PhysicsWorld::Raycast(Vector3(x, 10.f, z), -Vector3::UnitY(), 20.f, &result))
+                (*hitCount)++;
+        }
+
+        return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    }
+}
+
+TEST(Physics, HeightFieldRaycastThroughput)
+{
+    PhysicsWorld::Initialize();
+
+    std::vector<float_t> samples(static_cast<size_t>(SampleCount) * SampleCount);
+    for (uint32_t y = 0; y < SampleCount; y++)
+    {
+        for (uint32_t x = 0; x < SampleCount; x++)
+            samples[y * SampleCount + x] = TerrainHeight(x, y);
+    }
+
+    const PhysicsWorld::BodyCreationInfo info = {
+        .rotation = Quaternion::Identity(),
+        .scaling = Vector3(1.f),
+        .isStatic = true
+    };
+
+    // Height field terrain, a single body
+    const uint32_t heightFieldBody = PhysicsWorld::CreateHeightField(info, {
+        .samples = samples.data(),
+        .sampleCount = SampleCount,
+        .blockSize = 4,
+        .cacheKey = "test_terrain"
+    });
+
+    size_t heightFieldHits = 0;
+    const std::chrono::microseconds heightFieldTime = CastRays(&heightFieldHits);
+
+    PhysicsWorld::DestroyBody(heightFieldBody);
+
+    // The same terrain split into convex hull patches, like it had to be done with mesh colliders
+    constexpr float_t HalfExtent = static_cast<float_t>(SampleCount - 1) * 0.5f;
+    std::vector<uint32_t> patchBodies;
+    std::vector<Vertex> vertices;
+
+    PhysicsWorld::BeginBodyBatch();
+
+    for (uint32_t patchY = 0; patchY + PatchSize < SampleCount; patchY += PatchSize)
+    {
+        for (uint32_t patchX = 0; patchX + PatchSize < SampleCount; patchX += PatchSize)
+        {
+            vertices.clear();
+
+            for (uint32_t y = patchY; y <= patchY + PatchSize; y++)
+            {
+                for (uint32_t x = patchX; x <= patchX + PatchSize; x++)
+                {
+                    vertices.push_back({ .position = Vector3(static_cast<float_t>(x) - HalfExtent, TerrainHeight(x, y), static_cast<float_t>(y) - HalfExtent) });
+                    vertices.push_back({ .position = Vector3(static_cast<float_t>(x) - HalfExtent, 0.f, static_cast<float_t>(y) - HalfExtent) });
+                }
+            }
+
+            patchBodies.push_back(PhysicsWorld::CreateConvexHull(info, vertices));
+        }
+    }
+
+    PhysicsWorld::EndBodyBatch();
+
+    size_t meshHits = 0;
+    const std::chrono::microseconds meshTime = CastRays(&meshHits);
+
+    for (const uint32_t body : patchBodies)
+        PhysicsWorld::DestroyBody(body);
+
+    Logger::LogInfo(
+        "Raycast throughput over {} rays: height field {} ({} hits, 1 body), convex patches {} ({} hits, {} bodies)",
+        RayCount,
+        heightFieldTime,
+        heightFieldHits,
+        meshTime,
+        meshHits,
+        patchBodies.size()
+    );
+
+    EXPECT_EQ(heightFieldHits, RayCount);
+    EXPECT_EQ(meshHits, RayCount);
+
+    PhysicsWorld::Destroy();
+    JobSystem::Destroy();
+}
+
+TEST(Physics, HeightFieldScaledEntity)
+{
+    constexpr uint32_t FlatSampleCount = 16;
+    constexpr float_t HeightTolerance = 0.01f;
+
+    PhysicsWorld::Initialize();
+
+    // A flat terrain with the material 0 on its left half and 1 on its right half
+    const std::vector<float_t> samples(static_cast<size_t>(FlatSampleCount) * FlatSampleCount, 1.f);
+
+    constexpr uint32_t CellCount = FlatSampleCount - 1;
+    std::vector<uint8_t> materialIndices(static_cast<size_t>(CellCount) * CellCount);
+    for (uint32_t y = 0; y < CellCount; y++)
+    {
+        for (uint32_t x = 0; x < CellCount; x++)
+            materialIndices[y * CellCount + x] = x < CellCount / 2 ? 0 : 1;
+    }
+
+    const PhysicsWorld::BodyCreationInfo info = {
+        .rotation = Quaternion::Identity(),
+        .scaling = Vector3(2.f, 3.f, 2.f),
+        .isStatic = true
+    };
+
+    const uint32_t body = PhysicsWorld::CreateHeightField(info, {
+        .samples = samples.data(),
+        .sampleCount = FlatSampleCount,
+        .blockSize = 4,
+        .materialIndices = materialIndices.data(),
+        .materialCount = 2,
+        .cacheKey = "test_scaled_terrain"
+    });
+
+    // The unscaled terrain spans [-7.5, 7.5] and is 1 unit high, the scaled one spans [-15, 15] and is 3 units high
+    PhysicsWorld::RaycastResult result;
+
+    ASSERT_TRUE(PhysicsWorld::Raycast(Vector3(12.f, 10.f, 0.f), -Vector3::UnitY(), 20.f, &result));
+    EXPECT_NEAR(result.point.y, 3.f, HeightTolerance);
+    EXPECT_EQ(result.materialIndex, 1u);
+
+    ASSERT_TRUE(PhysicsWorld::Raycast(Vector3(-12.f, 10.f, 0.f), -Vector3::UnitY(), 20.f, &result));
+    EXPECT_NEAR(result.point.y, 3.f, HeightTolerance);
+    EXPECT_EQ(result.materialIndex, 0u);
+
+    EXPECT_FALSE(PhysicsWorld::Raycast(Vector3(16.f, 10.f, 0.f), -Vector3::UnitY(), 20.f, &result));
+
+    PhysicsWorld::DestroyBody(body);
+
+    PhysicsWorld::Destroy();
+    JobSystem::Destroy();
+}
+
+TEST(Physics, SnapshotRoundTrip)
+{
+    constexpr float_t DeltaTime = 1.f / 60.f;
+    constexpr uint32_t SphereCount = 16;
+    constexpr uint32_t StepCount = 60;
+
+    PhysicsWorld::Initialize();
+
+    const uint32_t ground = PhysicsWorld::CreateBox({
+        .position = Vector3(0.f, -1.f, 0.f),
+        .rotation = Quaternion::Identity(),
+        .scaling = Vector3(50.f, 1.f, 50.f),
+        .isStatic = true
+    });
+
+    std::vector<uint32_t> spheres(SphereCount);
+    for (uint32_t i = 0; i < SphereCount; i++)
+    {
+        spheres[i] = PhysicsWorld::CreateSphere({
+            .position = Vector3(static_cast<float_t>(i % 4) * 0.9f, 2.f + static_cast<float_t>(i), static_cast<float_t>(i / 4) * 0.9f),
+            .rotation = Quaternion::Identity(),
+            .scaling = Vector3(1.f)
+        }, 0.5f);
+    }
+
+    // Let the spheres fall and start colliding before taking the snapshot
+    for (uint32_t i = 0; i < StepCount; i++)
+        PhysicsWorld::Update(DeltaTime);
+
+    std::vector<Vector3> snapshotPositions(SphereCount);
+    std::vector<Vector3> snapshotVelocities(SphereCount);
+    for (uint32_t i = 0; i < SphereCount; i++)
+    {
+        snapshotPositions[i] = PhysicsWorld::GetBodyPosition(spheres[i]);
+        snapshotVelocities[i] = PhysicsWorld::GetLinearVelocity(spheres[i]);
+    }
+
+    PhysicsWorld::TakeSnapshot();
+
+    for (uint32_t i = 0; i < StepCount; i++)
+        PhysicsWorld::Update(DeltaTime);
+
+    std::vector<Vector3> firstRunPositions(SphereCount);
+    for (uint32_t i = 0; i < SphereCount; i++)
+        firstRunPositions[i] = PhysicsWorld::GetBodyPosition(spheres[i]);
+
+    ASSERT_TRUE(PhysicsWorld::RestoreSnapshot());
+
+    // The restored state must be exactly the one that was saved
+    for (uint32_t i = 0; i < SphereCount; i++)
+    {
+        EXPECT_EQ(PhysicsWorld::GetBodyPosition(spheres[i]), snapshotPositions[i]);
+        EXPECT_EQ(PhysicsWorld::GetLinearVelocity(spheres[i]), snapshotVelocities[i]);
+    }
+
+    // And simulating from it again must give the same result, which is what deterministic replays rely on
+    for (uint32_t i = 0; i < StepCount; i++)
+        PhysicsWorld::Update(DeltaTime);
+
+    for (uint32_t i = 0; i < SphereCount; i++)
+        EXPECT_EQ(PhysicsWorld::GetBodyPosition(spheres[i]), firstRunPositions[i]);
+
+    for (const uint32_t sphere : spheres)
+        PhysicsWorld::DestroyBody(sphere);
+    PhysicsWorld::DestroyBody(ground);
+
+    PhysicsWorld::ClearSnapshot();
+    PhysicsWorld::Destroy();
+    JobSystem::Destroy();
+}
+
+TEST(Physics, CharacterBatchUpdate)
+{
+    constexpr float_t DeltaTime = 1.f / 60.f;
+    constexpr uint32_t CharacterSide = 24;
+    constexpr uint32_t StepCount = 120;
+    constexpr float_t Speed = 1.f;
+
+    PhysicsWorld::Initialize();
+
+    const uint32_t ground = PhysicsWorld::CreateBox({
+        .position = Vector3(0.f, -1.f, 0.f),
+        .rotation = Quaternion::Identity(),
+        .scaling = Vector3(100.f, 1.f, 100.f),
+        .isStatic = true
+    });
+
+    std::vector<JPH::CharacterVirtual*> characters;
+    for (uint32_t x = 0; x < CharacterSide; x++)
+    {
+        for (uint32_t z = 0; z < CharacterSide; z++)
+        {
+            characters.push_back(PhysicsWorld::CreateCharacterVirtual({
+                .position = Vector3(static_cast<float_t>(x) * 2.f - static_cast<float_t>(CharacterSide), 1.f, static_cast<float_t>(z) * 2.f - static_cast<float_t>(CharacterSide)),
+                .rotation = Quaternion::Identity()
+            }));
+        }
+    }
+
+    ASSERT_EQ(PhysicsWorld::GetCharacterCount(), characters.size());
+
+    std::vector<float_t> startX(characters.size());
+    for (size_t i = 0; i < characters.size(); i++)
+        startX[i] = characters[i]->GetPosition().GetX();
+
+    const Vector3 gravity = PhysicsWorld::GetGravity();
+    float_t totalTime = 0.f;
+
+    for (uint32_t i = 0; i < StepCount; i++)
+    {
+        for (JPH::CharacterVirtual* const character : characters)
+        {
+            Vector3 velocity = Vector3(Speed, 0.f, 0.f);
+            if (character->GetGroundState() != JPH::CharacterBase::EGroundState::OnGround)
+                velocity.y = character->GetLinearVelocity().GetY();
+            velocity += gravity * DeltaTime;
+
+            character->SetLinearVelocity(PhysicsWorld::ToJph(velocity));
+        }
+
+        PhysicsWorld::Update(DeltaTime);
+        totalTime += PhysicsWorld::GetCharacterUpdateTime();
+    }
+
+    const float_t frameTime = totalTime / StepCount;
+    Logger::LogInfo(
+        "{} characters updated in {:.3f}ms per frame, {:.2f}us per character",
+        characters.size(),
+        frameTime,
+        frameTime * 1000.f / static_cast<float_t>(characters.size())
+    );
+
+    // Every character should have landed and walked for the whole duration
+    const float_t expectedDistance = Speed * DeltaTime * StepCount;
+    for (size_t i = 0; i < characters.size(); i++)
+    {
+        EXPECT_EQ(characters[i]->GetGroundState(), JPH::CharacterBase::EGroundState::OnGround);
+        EXPECT_NEAR(characters[i]->GetPosition().GetX() - startX[i], expectedDistance, expectedDistance * 0.1f);
+    }
+
+    for (JPH::CharacterVirtual* const character : characters)
+        PhysicsWorld::DestroyCharacterVirtual(character);
+    PhysicsWorld::DestroyBody(ground);
+
+    EXPECT_EQ(PhysicsWorld::GetCharacterCount(), 0u);
+
+    PhysicsWorld::Destroy();
+    JobSystem::Destroy();
+}
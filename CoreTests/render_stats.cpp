@@ -0,0 +1,109 @@
+#include "pch.hpp"
+
+#include <string>
+
+#include "rendering/render_stats.hpp"
+
+namespace
+{
+    const PassRenderStats* FindPass(const FrameRenderStats& frameStats, const std::string& name)
+    {
+        for (const PassRenderStats& pass : frameStats.passes)
+        {
+            if (pass.name == name)
+                return &pass;
+        }
+
+        return nullptr;
+    }
+}
+
+TEST(RenderStats, NestedPasses)
+{
+    // Drop anything counted before this test
+    RenderStats::EndFrame();
+
+    RenderStats::AddStateChange();
+
+    RenderStats::BeginPass("Lights");
+    RenderStats::AddBufferUpload(64);
+
+    RenderStats::BeginPass("Shadows");
+    RenderStats::AddShaderBind();
+    RenderStats::AddDrawCall(12);
+    RenderStats::EndPass();
+
+    RenderStats::AddDrawCall(2);
+    RenderStats::EndPass();
+
+    RenderStats::EndFrame();
+
+    const FrameRenderStats& frameStats = RenderStats::GetLastFrame();
+    ASSERT_EQ(frameStats.passes.size(), 3u);
+    EXPECT_EQ(frameStats.passes[0].name, RenderStats::OtherPassName);
+    EXPECT_EQ(frameStats.passes[0].counters.stateChanges, 1u);
+
+    const PassRenderStats* const lights = FindPass(frameStats, "Lights");
+    ASSERT_NE(lights, nullptr);
+    EXPECT_EQ(lights->counters.drawCalls, 1u);
+    EXPECT_EQ(lights->counters.triangles, 2u);
+    EXPECT_EQ(lights->counters.shaderBinds, 0u);
+    EXPECT_EQ(lights->counters.bufferUploads, 1u);
+    EXPECT_EQ(lights->counters.uploadedBytes, 64u);
+
+    const PassRenderStats* const shadows = FindPass(frameStats, "Shadows");
+    ASSERT_NE(shadows, nullptr);
+    EXPECT_EQ(shadows->counters.drawCalls, 1u);
+    EXPECT_EQ(shadows->counters.triangles, 12u);
+    EXPECT_EQ(shadows->counters.shaderBinds, 1u);
+
+    EXPECT_EQ(frameStats.total.drawCalls, 2u);
+    EXPECT_EQ(frameStats.total.triangles, 14u);
+    EXPECT_EQ(frameStats.total.stateChanges, 1u);
+    EXPECT_EQ(frameStats.total.uploadedBytes, 64u);
+}
+
+TEST(RenderStats, MergesPassesByName)
+{
+    RenderStats::EndFrame();
+
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        RenderStats::BeginPass("GBuffer");
+        RenderStats::AddTextureBind();
+        RenderStats::AddDrawCall(1);
+        RenderStats::EndPass();
+    }
+
+    RenderStats::EndFrame();
+
+    const FrameRenderStats& frameStats = RenderStats::GetLastFrame();
+    const PassRenderStats* const gBuffer = FindPass(frameStats, "GBuffer");
+    ASSERT_NE(gBuffer, nullptr);
+    EXPECT_EQ(frameStats.passes.size(), 2u);
+    EXPECT_EQ(gBuffer->counters.drawCalls, 3u);
+    EXPECT_EQ(gBuffer->counters.textureBinds, 3u);
+
+    // The next frame starts from scratch
+    const uint64_t frame = frameStats.frame;
+    RenderStats::EndFrame();
+    EXPECT_EQ(RenderStats::GetLastFrame().frame, frame + 1);
+    EXPECT_EQ(RenderStats::GetLastFrame().total.drawCalls, 0u);
+}
+
+TEST(RenderStats, Json)
+{
+    RenderStats::EndFrame();
+
+    RenderStats::BeginPass("Forward");
+    RenderStats::AddDrawCall(42);
+    RenderStats::EndPass();
+
+    RenderStats::EndFrame();
+
+    const std::string json = RenderStats::ToJson(RenderStats::GetLastFrame());
+    EXPECT_NE(json.find("\"total\""), std::string::npos);
+    EXPECT_NE(json.find("\"name\": \"Forward\""), std::string::npos);
+    EXPECT_NE(json.find("\"drawCalls\": 1"), std::string::npos);
+    EXPECT_NE(json.find("\"triangles\": 42"), std::string::npos);
+}
@@ -0,0 +1,358 @@
+#include "pch.hpp"
+
+#include <algorithm>
+#include <array>
+
+#include "rendering/light/shadow_cache.hpp"
+#include "rendering/light/shadow_scheduler.hpp"
+
+namespace
+{
+    constexpr uint32_t CubeFaceCount = 6;
+
+    uint64_t Signature(const float_t lightPosition)
+    {
+        return ShadowCache::Hash(ShadowCache::SignatureSeed, &lightPosition, sizeof(lightPosition));
+    }
+}
+
+TEST(Shadow, CacheFirstFrameRendersEverything)
+{
+    ShadowCache cache;
+    cache.BeginFrame();
+
+    for (uint32_t i = 0; i < CubeFaceCount; i++)
+        EXPECT_EQ(cache.GetUpdate(i, Signature(0.f), false), ShadowCache::Update::Full);
+
+    EXPECT_EQ(cache.GetStats().fullUpdates, CubeFaceCount);
+    EXPECT_EQ(cache.GetStats().dynamicUpdates, 0u);
+    EXPECT_EQ(cache.GetStats().skippedUpdates, 0u);
+}
+
+TEST(Shadow, CacheSkipsUnchangedViews)
+{
+    ShadowCache cache;
+
+    cache.BeginFrame();
+    for (uint32_t i = 0; i < CubeFaceCount; i++)
+        (void)cache.GetUpdate(i, Signature(0.f), false);
+
+    for (size_t frame = 0; frame < 10; frame++)
+    {
+        cache.BeginFrame();
+        for (uint32_t i = 0; i < CubeFaceCount; i++)
+            EXPECT_EQ(cache.GetUpdate(i, Signature(0.f), false), ShadowCache::Update::None);
+
+        EXPECT_EQ(cache.GetStats().fullUpdates, 0u);
+        EXPECT_EQ(cache.GetStats().skippedUpdates, CubeFaceCount);
+    }
+}
+
+TEST(Shadow, CacheInvalidation)
+{
+    ShadowCache cache;
+
+    cache.BeginFrame();
+    (void)cache.GetUpdate(0, Signature(0.f), false);
+    (void)cache.GetUpdate(1, Signature(0.f), false);
+
+    // Moving the light or a static caster in range changes the signature of the view
+    cache.BeginFrame();
+    EXPECT_EQ(cache.GetUpdate(0, Signature(1.f), false), ShadowCache::Update::Full);
+    EXPECT_EQ(cache.GetUpdate(1, Signature(0.f), false), ShadowCache::Update::None);
+
+    cache.Invalidate();
+    cache.BeginFrame();
+    EXPECT_EQ(cache.GetUpdate(0, Signature(1.f), false), ShadowCache::Update::Full);
+    EXPECT_EQ(cache.GetUpdate(1, Signature(0.f), false), ShadowCache::Update::Full);
+}
+
+TEST(Shadow, CacheDynamicCasters)
+{
+    ShadowCache cache;
+
+    cache.BeginFrame();
+    EXPECT_EQ(cache.GetUpdate(0, Signature(0.f), true), ShadowCache::Update::Full);
+
+    // The base map stays valid while a dynamic caster moves in range
+    for (size_t frame = 0; frame < 5; frame++)
+    {
+        cache.BeginFrame();
+        EXPECT_EQ(cache.GetUpdate(0, Signature(0.f), true), ShadowCache::Update::Dynamic);
+        EXPECT_EQ(cache.GetStats().dynamicUpdates, 1u);
+    }
+
+    // Once more to erase it after it left, then nothing
+    cache.BeginFrame();
+    EXPECT_EQ(cache.GetUpdate(0, Signature(0.f), false), ShadowCache::Update::Dynamic);
+    cache.BeginFrame();
+    EXPECT_EQ(cache.GetUpdate(0, Signature(0.f), false), ShadowCache::Update::None);
+}
+
+TEST(Shadow, CacheSignature)
+{
+    constexpr float_t A[] = { 1.f, 2.f };
+    constexpr float_t B[] = { 2.f, 1.f };
+
+    EXPECT_EQ(ShadowCache::Hash(ShadowCache::SignatureSeed, A, sizeof(A)), ShadowCache::Hash(ShadowCache::SignatureSeed, A, sizeof(A)));
+    // The casters are hashed in a stable order, so the order is part of the signature
+    EXPECT_NE(ShadowCache::Hash(ShadowCache::SignatureSeed, A, sizeof(A)), ShadowCache::Hash(ShadowCache::SignatureSeed, B, sizeof(B)));
+}
+
+TEST(Shadow, CachePeekDoesNotUpdate)
+{
+    ShadowCache cache;
+    cache.BeginFrame();
+
+    EXPECT_EQ(cache.PeekUpdate(0, Signature(0.f), false), ShadowCache::Update::Full);
+    EXPECT_EQ(cache.PeekUpdate(0, Signature(0.f), false), ShadowCache::Update::Full);
+    EXPECT_EQ(cache.GetStats().fullUpdates, 0u);
+
+    (void)cache.GetUpdate(0, Signature(0.f), true);
+    EXPECT_EQ(cache.PeekUpdate(0, Signature(0.f), false), ShadowCache::Update::Dynamic);
+    EXPECT_EQ(cache.PeekUpdate(0, Signature(1.f), false), ShadowCache::Update::Full);
+}
+
+TEST(Shadow, CacheDropsUnusedViews)
+{
+    ShadowCache cache;
+
+    cache.BeginFrame();
+    for (uint32_t i = 0; i < CubeFaceCount; i++)
+        (void)cache.GetUpdate(i, Signature(0.f), false);
+
+    // The first view keeps being rendered, the second one is deferred, the others belong to a removed light
+    for (uint64_t frame = 0; frame <= ShadowCache::MaxUnusedFrames; frame++)
+    {
+        cache.BeginFrame();
+        (void)cache.GetUpdate(0, Signature(0.f), false);
+        cache.Touch(1);
+    }
+
+    EXPECT_EQ(cache.GetViewCount(), 2u);
+    EXPECT_EQ(cache.PeekUpdate(1, Signature(0.f), false), ShadowCache::Update::None);
+    EXPECT_EQ(cache.PeekUpdate(2, Signature(0.f), false), ShadowCache::Update::Full);
+}
+
+TEST(Shadow, SchedulerWithoutBudgetRendersEverything)
+{
+    ShadowScheduler scheduler;
+
+    for (size_t frame = 0; frame < 3; frame++)
+    {
+        scheduler.BeginFrame();
+        for (uint32_t i = 0; i < CubeFaceCount; i++)
+            (void)scheduler.Submit({ .viewId = i });
+        scheduler.Schedule({});
+
+        for (size_t i = 0; i < CubeFaceCount; i++)
+            EXPECT_TRUE(scheduler.IsScheduled(i));
+        EXPECT_EQ(scheduler.GetStats().deferredViews, 0u);
+    }
+}
+
+TEST(Shadow, SchedulerNewViewsIgnoreTheBudget)
+{
+    ShadowScheduler scheduler;
+
+    scheduler.BeginFrame();
+    for (uint32_t i = 0; i < CubeFaceCount; i++)
+        (void)scheduler.Submit({ .viewId = i });
+    scheduler.Schedule({ .maxViews = 1 });
+
+    EXPECT_EQ(scheduler.GetStats().scheduledViews, CubeFaceCount);
+}
+
+TEST(Shadow, SchedulerViewBudget)
+{
+    constexpr ShadowBudget Budget = { .maxViews = 2 };
+    ShadowScheduler scheduler;
+
+    scheduler.BeginFrame();
+    for (uint32_t i = 0; i < CubeFaceCount; i++)
+        (void)scheduler.Submit({ .viewId = i });
+    scheduler.Schedule(Budget);
+
+    // Every view keeps needing an update, they must all be rendered in turn
+    std::array<size_t, CubeFaceCount> updates = {};
+    for (size_t frame = 0; frame < 9; frame++)
+    {
+        scheduler.BeginFrame();
+        for (uint32_t i = 0; i < CubeFaceCount; i++)
+            (void)scheduler.Submit({ .viewId = i });
+        scheduler.Schedule(Budget);
+
+        EXPECT_EQ(scheduler.GetStats().scheduledViews, 2u);
+        EXPECT_EQ(scheduler.GetStats().deferredViews, CubeFaceCount - 2);
+
+        for (size_t i = 0; i < CubeFaceCount; i++)
+            updates[i] += scheduler.IsScheduled(i);
+    }
+
+    for (const size_t count : updates)
+        EXPECT_EQ(count, 3u);
+}
+
+TEST(Shadow, SchedulerCostBudget)
+{
+    ShadowScheduler scheduler;
+
+    scheduler.BeginFrame();
+    (void)scheduler.Submit({ .viewId = 0 });
+    (void)scheduler.Submit({ .viewId = 1 });
+    (void)scheduler.Submit({ .viewId = 2 });
+    scheduler.Schedule({});
+
+    scheduler.BeginFrame();
+    (void)scheduler.Submit({ .viewId = 0, .screenCoverage = 1.f, .cost = 8.f });
+    (void)scheduler.Submit({ .viewId = 1, .screenCoverage = 0.5f, .cost = 4.f });
+    (void)scheduler.Submit({ .viewId = 2, .screenCoverage = 0.f, .cost = 2.f });
+    scheduler.Schedule({ .maxCost = 10.f });
+
+    // The most covering view is taken first, the cheapest one still fits next to it
+    EXPECT_TRUE(scheduler.IsScheduled(0));
+    EXPECT_FALSE(scheduler.IsScheduled(1));
+    EXPECT_TRUE(scheduler.IsScheduled(2));
+    EXPECT_FLOAT_EQ(scheduler.GetStats().scheduledCost, 10.f);
+
+    // A view over the whole budget is still rendered when it is alone
+    scheduler.BeginFrame();
+    (void)scheduler.Submit({ .viewId = 1, .cost = 20.f });
+    scheduler.Schedule({ .maxCost = 10.f });
+    EXPECT_TRUE(scheduler.IsScheduled(0));
+}
+
+TEST(Shadow, SchedulerPriority)
+{
+    const ShadowViewRequest near = { .screenCoverage = 0.5f, .distance = 5.f };
+    const ShadowViewRequest far = { .screenCoverage = 0.5f, .distance = 50.f };
+    const ShadowViewRequest large = { .screenCoverage = 1.f, .distance = 5.f };
+
+    EXPECT_GT(ShadowScheduler::GetPriority(near, 1), ShadowScheduler::GetPriority(far, 1));
+    EXPECT_GT(ShadowScheduler::GetPriority(large, 1), ShadowScheduler::GetPriority(near, 1));
+    // Staleness makes a far view win eventually
+    EXPECT_GT(ShadowScheduler::GetPriority(far, 10), ShadowScheduler::GetPriority(near, 1));
+}
+
+TEST(Shadow, SchedulerUpdateInterval)
+{
+    ShadowScheduler scheduler;
+
+    size_t updates = 0;
+    for (size_t frame = 0; frame < 16; frame++)
+    {
+        scheduler.BeginFrame();
+        const size_t index = scheduler.Submit({ .viewId = 4, .updateInterval = 4 });
+        scheduler.Schedule({});
+
+        updates += scheduler.IsScheduled(index);
+    }
+
+    EXPECT_EQ(updates, 4u);
+}
+
+TEST(Shadow, SchedulerForget)
+{
+    ShadowScheduler scheduler;
+
+    scheduler.BeginFrame();
+    (void)scheduler.Submit({ .viewId = 0 });
+    (void)scheduler.Submit({ .viewId = 1 });
+    scheduler.Schedule({});
+
+    // A forgotten view is new again, so it goes before the budget
+    scheduler.Forget(1);
+    scheduler.BeginFrame();
+    (void)scheduler.Submit({ .viewId = 0, .screenCoverage = 1.f });
+    (void)scheduler.Submit({ .viewId = 1 });
+    scheduler.Schedule({ .maxViews = 1 });
+
+    EXPECT_FALSE(scheduler.IsScheduled(0));
+    EXPECT_TRUE(scheduler.IsScheduled(1));
+}
+
+TEST(Shadow, SchedulerViewportsShareAFrame)
+{
+    ShadowScheduler scheduler;
+
+    size_t updates = 0;
+    for (size_t frame = 0; frame < 8; frame++)
+    {
+        scheduler.BeginFrame();
+
+        // Two viewports rendered during the same frame
+        for (size_t viewport = 0; viewport < 2; viewport++)
+        {
+            if (viewport > 0)
+                scheduler.ClearRequests();
+
+            const size_t index = scheduler.Submit({ .viewId = 0, .updateInterval = 4 });
+            (void)scheduler.Submit({ .viewId = 1 });
+            scheduler.Schedule({});
+
+            updates += scheduler.IsScheduled(index);
+
+            // The second viewport reuses the map the first one rendered
+            if (viewport > 0)
+                EXPECT_FALSE(scheduler.IsScheduled(1));
+        }
+
+        // The stats cover the whole frame
+        EXPECT_EQ(scheduler.GetStats().scheduledViews, frame % 4 == 0 ? 2u : 1u);
+    }
+
+    // The interval counts frames, not viewports
+    EXPECT_EQ(updates, 2u);
+
+    // A forgotten view is rendered again within the frame
+    scheduler.ClearRequests();
+    scheduler.Forget(1);
+    const size_t index = scheduler.Submit({ .viewId = 1 });
+    scheduler.Schedule({});
+    EXPECT_TRUE(scheduler.IsScheduled(index));
+}
+
+TEST(Shadow, SchedulerIsDeterministic)
+{
+    const auto run = [](const bool_t reversed) -> std::vector<uint32_t>
+    {
+        ShadowScheduler scheduler;
+        std::vector<uint32_t> scheduledIds;
+
+        for (size_t frame = 0; frame < 8; frame++)
+        {
+            std::vector<ShadowViewRequest> requests;
+            for (uint32_t i = 0; i < 12; i++)
+            {
+                requests.push_back({
+                    .viewId = i,
+                    .screenCoverage = static_cast<float_t>(i % 3) / 2.f,
+                    .distance = static_cast<float_t>(i * 7 % 5),
+                    .cost = static_cast<float_t>(1 + i % 4),
+                    .updateInterval = 1 + i % 2
+                });
+            }
+
+            if (reversed)
+                std::ranges::reverse(requests);
+
+            scheduler.BeginFrame();
+            for (const ShadowViewRequest& request : requests)
+                (void)scheduler.Submit(request);
+            scheduler.Schedule({ .maxViews = 3, .maxCost = 6.f });
+
+            std::vector<uint32_t> frameIds;
+            for (size_t i = 0; i < requests.size(); i++)
+            {
+                if (scheduler.IsScheduled(i))
+                    frameIds.push_back(requests[i].viewId);
+            }
+            std::ranges::sort(frameIds);
+            scheduledIds.insert(scheduledIds.end(), frameIds.begin(), frameIds.end());
+        }
+
+        return scheduledIds;
+    };
+
+    EXPECT_EQ(run(false), run(true));
+}
@@ -0,0 +1,156 @@
+#include "pch.hpp"
+
+#include <format>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _DEBUG
+#include <crtdbg.h>
+#endif
+
+#include "utils/delegate.hpp"
+#include "utils/timeline.hpp"
+
+namespace
+{
+    using Log = std::vector<std::string>;
+
+    constexpr float_t StepDuration = 0.25f;
+    constexpr uint32_t PlaybackCount = 1000;
+
+#ifdef _DEBUG
+    std::thread::id countedThread;
+    size_t allocationCount = 0;
+
+    /// @brief Debug CRT hook counting the allocations made on the tested thread
+    int32_t CountAllocations(const int32_t allocationType, void*, size_t, int32_t, long, const unsigned char*, int32_t)
+    {
+        if ((allocationType == _HOOK_ALLOC || allocationType == _HOOK_REALLOC) && std::this_thread::get_id() == countedThread)
+            allocationCount++;
+
+        return 1;
+    }
+#endif
+}
+
+TEST(Timeline, EventOrder)
+{
+    Timeline<Log*> timeline(2.f);
+
+    // Added out of order, the timeline must sort them
+    timeline.SetEventDuration(1.f, 0.5f);
+    timeline.AddBeginEvent(1.f, [](Log* const log) -> void { log->emplace_back("begin B"); });
+    timeline.AddEndEvent(1.f, [](Log* const log) -> void { log->emplace_back("end B"); });
+
+    timeline.SetEventDuration(0.f, 0.5f);
+    timeline.AddBeginEvent(0.f, [](Log* const log) -> void { log->emplace_back("begin A"); });
+    timeline.AddBeginEvent(0.f, [](Log* const log) -> void { log->emplace_back("begin A 2"); });
+    timeline.AddUpdateEvent(0.f, [](const float_t t, Log* const log) -> void { log->push_back(std::format("update A {}", t)); });
+    timeline.AddEndEvent(0.f, [](Log* const log) -> void { log->emplace_back("end A"); });
+
+    // Ignored, happens after the end of the timeline
+    timeline.AddBeginEvent(3.f, [](Log* const log) -> void { log->emplace_back("begin C"); });
+
+    ASSERT_EQ(timeline.GetEvents().GetSize(), 2u);
+    EXPECT_EQ(timeline.GetEvents()[0].when, 0.f);
+    EXPECT_EQ(timeline.GetEvents()[1].when, 1.f);
+
+    Log log;
+    timeline.Start();
+
+    bool_t ended = false;
+    uint32_t stepCount = 0;
+    while (!ended)
+    {
+        ended = timeline.Advance(StepDuration, &log);
+        stepCount++;
+    }
+
+    EXPECT_EQ(stepCount, 8u);
+    EXPECT_EQ(log, (Log{ "begin A", "begin A 2", "update A 0.5", "end A", "begin B", "end B" }));
+}
+
+TEST(Timeline, Restart)
+{
+    Timeline<int32_t*> timeline(1.f);
+
+    timeline.SetEventDuration(0.f, 0.5f);
+    timeline.AddBeginEvent(0.f, [](int32_t* const count) -> void { (*count)++; });
+    timeline.AddEndEvent(0.f, [](int32_t* const count) -> void { (*count) += 10; });
+
+    int32_t count = 0;
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        timeline.Start();
+        while (!timeline.Advance(StepDuration, &count))
+        {
+        }
+    }
+
+    EXPECT_EQ(count, 33);
+}
+
+TEST(Timeline, Delegate)
+{
+    const std::shared_ptr<int32_t> value = std::make_shared<int32_t>(2);
+
+    Delegate<int32_t(int32_t)> multiply = [value](const int32_t x) -> int32_t { return x * *value; };
+    EXPECT_TRUE(multiply.IsBound());
+    EXPECT_EQ(multiply(3), 6);
+    EXPECT_EQ(value.use_count(), 2);
+
+    Delegate<int32_t(int32_t)> copy = multiply;
+    EXPECT_EQ(copy.Invoke(4), 8);
+    EXPECT_EQ(value.use_count(), 3);
+
+    Delegate<int32_t(int32_t)> moved = std::move(copy);
+    EXPECT_FALSE(copy.IsBound());  // NOLINT(bugprone-use-after-move, clang-diagnostic-unused-value)
+    EXPECT_EQ(moved(5), 10);
+    EXPECT_EQ(value.use_count(), 3);
+
+    moved.Reset();
+    multiply = Delegate<int32_t(int32_t)>();
+    EXPECT_FALSE(multiply.IsBound());
+    EXPECT_EQ(value.use_count(), 1);
+}
+
+TEST(Timeline, NoAllocations)
+{
+#ifndef _DEBUG
+    GTEST_SKIP() << "Allocation tracking requires the debug CRT";
+#else
+    Timeline<int32_t*> timeline(4.f);
+
+    for (uint32_t i = 0; i < 8; i++)
+    {
+        const float_t when = static_cast<float_t>(i) * 0.5f;
+        timeline.SetEventDuration(when, 0.5f);
+        timeline.AddBeginEvent(when, [](int32_t* const count) -> void { (*count)++; });
+        timeline.AddUpdateEvent(when, [](const float_t, int32_t* const count) -> void { (*count)++; });
+        timeline.AddEndEvent(when, [](int32_t* const count) -> void { (*count)++; });
+    }
+
+    int32_t count = 0;
+    timeline.Start();
+
+    countedThread = std::this_thread::get_id();
+    allocationCount = 0;
+
+    const _CRT_ALLOC_HOOK previousHook = _CrtSetAllocHook(CountAllocations);
+
+    for (uint32_t i = 0; i < PlaybackCount; i++)
+    {
+        timeline.Start();
+        while (!timeline.Advance(StepDuration / 2.f, &count))
+        {
+        }
+    }
+
+    _CrtSetAllocHook(previousHook);
+
+    EXPECT_EQ(allocationCount, 0u);
+    EXPECT_GT(count, 0);
+#endif
+}
@@ -1,11 +1,44 @@
 ﻿#include "pch.hpp"
 
+#include <atomic>
+
+#include "utils/job_system.hpp"
+
 TEST(Utils, IntToPointer)
 
 {
     EXPECT_EQ(Utils::IntToPointer<char*>(0), nullptr);
 }
 
+TEST(Utils, JobSystemThreadIndices)
+{
+    // Starting the job system again hands the indices out from 0 again
+    JobSystem::Destroy();
+    JobSystem::Initialize();
+
+    const size_t mainThreadIndex = JobSystem::GetThreadIndex();
+    EXPECT_EQ(mainThreadIndex, 0u);
+
+    const size_t maxConcurrency = JobSystem::GetMaxConcurrency();
+    std::atomic<bool_t> isValid = true;
+
+    for (size_t i = 0; i < 64; i++)
+    {
+        JobSystem::ParallelFor(maxConcurrency, 1, [&](const size_t, const size_t)
+        {
+            const size_t index = JobSystem::GetThreadIndex();
+
+            if (index >= maxConcurrency || JobSystem::GetThreadIndex() != index)
+                isValid = false;
+        });
+    }
+
+    EXPECT_TRUE(isValid);
+    EXPECT_EQ(JobSystem::GetThreadIndex(), mainThreadIndex);
+
+    JobSystem::Destroy();
+}
+
 TEST(Utils, HumanizeString)
 {
     EXPECT_EQ(Utils::HumanizeString("stringToHumanize"), "String To Humanize");
@@ -1,8 +1,8 @@
 ﻿#pragma once
 
 #include "definitions.hpp"
-#include "rendering/camera.hpp"
 #include "rendering/render_pass.hpp"
+#include "rendering/viewport.hpp"
 #include "resource/shader.hpp"
 #include "scene/entity.hpp"
 #include "world/skybox.hpp"
@@ -23,8 +23,8 @@ public:
     // Should be call on the Imgui editor window only
     void ResizeHandle(Vector2i newSize);
 
-    // Pixel pos in image current Window
-    bool_t GetEntityFromScreen(Vector2i pixelPos, XnorCore::Scene& scene,const XnorCore::Camera& pointOfView, XnorCore::Entity** entity);
+    // Pixel pos in image current Window, called after the viewport was rendered so that its visibility is reused
+    bool_t GetEntityFromScreen(Vector2i pixelPos, XnorCore::Scene& scene, const XnorCore::Viewport& viewport, XnorCore::Entity** entity);
 
 private:
     Editor* m_Editor = nullptr;
@@ -26,6 +26,9 @@ protected:
 
     bool EditTransform();
 
+    // Remembers the pixel clicked, the entity is picked once the viewport was rendered
+    void RequestEntitySelection();
+
     void SelectEntityOnScreen();
 
     PickingStrategy m_PickingStrategy;
@@ -34,6 +37,9 @@ private:
     EditorCamera m_EditorCamera;
     TransfromGizmo m_TransformGizmo;
     XnorCore::DrawGizmo m_DrawGizmo;
+
+    bool_t m_IsSelectionRequested = false;
+    Vector2i m_SelectionPixel;
 };
 
 END_XNOR_EDITOR
@@ -12,6 +12,7 @@ class Performance : public UiWindow
     static constexpr float_t GraphsHeight = 50.f;
     static constexpr uint32_t DefaultSampleCount = 50;
     static constexpr float_t MemoryArrayBoundsFactor = 1.1f;
+    static constexpr const char_t* RenderStatsFile = "render_stats.json";
     
 public:
     explicit Performance(Editor* editor, size_t sampleCount);
@@ -23,6 +24,8 @@ public:
     void SetSampleCount(size_t sampleCount);
 
 private:
+    static void DisplayRenderStats();
+    
     float_t m_UpdateInterval = 0.25f;
     
     size_t m_TotalSamples = 0;
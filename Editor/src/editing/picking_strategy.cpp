@@ -33,7 +33,7 @@ void PickingStrategy::ResizeHandle(const Vector2i newSize)
     }
 }
 
-bool_t PickingStrategy::GetEntityFromScreen(const Vector2i pixelPos, XnorCore::Scene& scene, const XnorCore::Camera& pointOfView,
+bool_t PickingStrategy::GetEntityFromScreen(const Vector2i pixelPos, XnorCore::Scene& scene, const XnorCore::Viewport& viewport,
     XnorCore::Entity** entity)
 {
     if (!m_Editor)
@@ -54,7 +54,7 @@ bool_t PickingStrategy::GetEntityFromScreen(const Vector2i pixelPos, XnorCore::S
     };
 
     if (XnorCore::World::scene != nullptr)
-        m_Editor->renderer.ZPass(*XnorCore::World::scene, pointOfView, beginInfo, m_ColorPass, m_PickingShaderStatic, m_PickingShaderSkinned, true);
+        m_Editor->renderer.ZPass(*XnorCore::World::scene, viewport, beginInfo, m_ColorPass, m_PickingShaderStatic, m_PickingShaderSkinned, true);
 
     m_PickingShaderStatic->Unuse();
 
@@ -9,6 +9,7 @@
 #include "csharp/dotnet_runtime.hpp"
 #include "file/file_manager.hpp"
 #include "input/time.hpp"
+#include "physics/physics_world.hpp"
 #include "reflection/filters.hpp"
 #include "resource/resource_manager.hpp"
 #include "resource/shader.hpp"
@@ -464,6 +465,9 @@ void Editor::StopPlaying()
 		DeserializeScene(data.currentScene.Get()->GetPath().generic_string());
 		XnorCore::World::scene->Initialize();
 	}
+
+	// A snapshot taken while playing refers to the bodies destroyed along with the previous scene
+	XnorCore::PhysicsWorld::ClearSnapshot();
 	
 	XnorCore::World::isPlaying = false;
 	
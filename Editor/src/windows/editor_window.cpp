@@ -10,6 +10,10 @@ using namespace XnorEditor;
 void EditorWindow::OnApplicationRendering()
 {
     RenderWindow::OnApplicationRendering();
+
+    // The picking pass reuses the visibility of the viewport, so it waits for the viewport to be rendered
+    SelectEntityOnScreen();
+
     m_DrawGizmo.DrawGizmos(*m_Viewport, m_Editor->data.selectedEntity);
 }
 
@@ -40,7 +44,7 @@ void EditorWindow::Display()
         m_EditorCamera.UpdateCamera();
 
         if (!isEditingTransform)
-            SelectEntityOnScreen();
+            RequestEntitySelection();
     }
 
 
@@ -93,7 +97,7 @@ bool EditorWindow::EditTransform()
     return m_TransformGizmo.Manipulate(*m_Editor->data.selectedEntity);
 }
 
-void EditorWindow::SelectEntityOnScreen()
+void EditorWindow::RequestEntitySelection()
 {
     if (ImGui::IsMouseClicked(ImGuiMouseButton_Left))
     {
@@ -107,13 +111,24 @@ void EditorWindow::SelectEntityOnScreen()
             return;
         }
 
-        XnorCore::Entity* ptr = nullptr;
-        if (m_PickingStrategy.GetEntityFromScreen(mousePosI, *XnorCore::World::scene, m_Editor->data.editorCam, &ptr))
-        {
-            m_Editor->data.selectedEntity = ptr;
-            return;
-        }
+        m_SelectionPixel = mousePosI;
+        m_IsSelectionRequested = true;
+    }
+}
 
-        m_Editor->data.selectedEntity = nullptr;
+void EditorWindow::SelectEntityOnScreen()
+{
+    if (!m_IsSelectionRequested)
+        return;
+
+    m_IsSelectionRequested = false;
+
+    XnorCore::Entity* ptr = nullptr;
+    if (m_PickingStrategy.GetEntityFromScreen(m_SelectionPixel, *XnorCore::World::scene, *m_Viewport, &ptr))
+    {
+        m_Editor->data.selectedEntity = ptr;
+        return;
     }
+
+    m_Editor->data.selectedEntity = nullptr;
 }
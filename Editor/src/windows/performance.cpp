@@ -11,6 +11,11 @@
 #include "imgui/imgui.h"
 #include "input/time.hpp"
 #include "Maths/calc.hpp"
+#include "physics/physics_world.hpp"
+#include "rendering/animation_system.hpp"
+#include "rendering/render_stats.hpp"
+#include "rendering/render_systems/light_manager.hpp"
+#include "rendering/render_systems/meshes_drawer.hpp"
 
 using namespace XnorEditor;
 
@@ -56,6 +61,79 @@ void Performance::Display()
     format = std::format("Memory: {:.2f}MB", m_LastMemory);
     ImGui::PlotLines("##memory", m_MemoryArray.data(), static_cast<int32_t>(std::min(m_TotalSamples, m_MemoryArray.size())), m_ArrayIndex,
         format.c_str(), m_LowestArrayMemory, m_HighestArrayMemory, ImVec2(available.x, GraphsHeight));
+
+    const size_t characterCount = XnorCore::PhysicsWorld::GetCharacterCount();
+    if (characterCount != 0)
+    {
+        const float_t characterTime = XnorCore::PhysicsWorld::GetCharacterUpdateTime();
+        ImGui::Text("Characters: %zu, %.3fms (%.2fus per character)", characterCount, characterTime, characterTime * 1000.f / static_cast<float_t>(characterCount));
+    }
+
+    const size_t animatedCount = XnorCore::AnimationSystem::GetAnimatedCount();
+    if (animatedCount != 0)
+        ImGui::Text("Animations: %zu evaluated out of %zu, %.3fms", XnorCore::AnimationSystem::GetEvaluatedCount(), animatedCount, XnorCore::AnimationSystem::GetUpdateTime());
+
+    ImGui::Checkbox("Skinning pass for the shadows", &XnorCore::MeshesDrawer::enableSkinningPass);
+
+    // 0 means no limit
+    XnorCore::ShadowBudget& shadowBudget = XnorCore::LightManager::shadowBudget;
+    ImGui::DragScalar("Shadow views per frame", ImGuiDataType_U32, &shadowBudget.maxViews, 0.1f);
+    ImGui::DragFloat("Shadow draws per frame", &shadowBudget.maxCost, 1.f, 0.f, std::numeric_limits<float_t>::max(), "%.0f");
+
+    DisplayRenderStats();
+}
+
+void Performance::DisplayRenderStats()
+{
+    if (!ImGui::CollapsingHeader("Render stats"))
+        return;
+
+    const XnorCore::FrameRenderStats& frameStats = XnorCore::RenderStats::GetLastFrame();
+
+    if (ImGui::Button("Save"))
+        XnorCore::RenderStats::SaveJson(RenderStatsFile);
+    ImGui::SameLine();
+    ImGui::Text("Frame %llu", frameStats.frame);
+
+    if (!ImGui::BeginTable("RenderStats", 8, ImGuiTableFlags_Borders | ImGuiTableFlags_Resizable | ImGuiTableFlags_RowBg))
+        return;
+
+    ImGui::TableSetupColumn("Pass");
+    ImGui::TableSetupColumn("Draws");
+    ImGui::TableSetupColumn("Triangles");
+    ImGui::TableSetupColumn("States");
+    ImGui::TableSetupColumn("Shaders");
+    ImGui::TableSetupColumn("Textures");
+    ImGui::TableSetupColumn("Uploads");
+    ImGui::TableSetupColumn("Uploaded KB");
+    ImGui::TableHeadersRow();
+
+    auto&& displayRow = [](const char_t* const name, const XnorCore::RenderCounters& counters)
+    {
+        ImGui::TableNextRow();
+        ImGui::TableNextColumn();
+        ImGui::TextUnformatted(name);
+        ImGui::TableNextColumn();
+        ImGui::Text("%llu", counters.drawCalls);
+        ImGui::TableNextColumn();
+        ImGui::Text("%llu", counters.triangles);
+        ImGui::TableNextColumn();
+        ImGui::Text("%llu", counters.stateChanges);
+        ImGui::TableNextColumn();
+        ImGui::Text("%llu", counters.shaderBinds);
+        ImGui::TableNextColumn();
+        ImGui::Text("%llu", counters.textureBinds);
+        ImGui::TableNextColumn();
+        ImGui::Text("%llu", counters.bufferUploads);
+        ImGui::TableNextColumn();
+        ImGui::Text("%.1f", static_cast<float_t>(counters.uploadedBytes) / 1024.f);
+    };
+
+    for (const XnorCore::PassRenderStats& pass : frameStats.passes)
+        displayRow(pass.name.c_str(), pass.counters);
+    displayRow("Total", frameStats.total);
+
+    ImGui::EndTable();
 }
 
 void Performance::SetSampleCount(const size_t sampleCount)
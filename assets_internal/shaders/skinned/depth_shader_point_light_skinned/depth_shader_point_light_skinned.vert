@@ -6,7 +6,6 @@ layout (location = 3) in vec3 aTangent;
 layout (location = 4) in vec3 aBitangent;
 layout (location = 5) in vec4 aBoneIndices;
 layout (location = 6) in vec4 aBoneWeights;
-#define MaxBones 100
 
 layout (std140, binding = 0) uniform CameraUniform
 {
@@ -24,11 +23,16 @@ layout (std140, binding = 1) uniform ModelUniform
     mat4 model;
     mat4 normalInvertMatrix;
     uint drawId;
+    // The draw id is 64 bits on the CPU side
+    uint drawIdHigh;
+    uint boneOffset;
+    uint boneCount;
 };
 
-layout (std140, binding = 5) uniform SkinnedBuffer
+// Skinning palettes of all the skinned meshes of the frame, this draw uses boneCount matrices from boneOffset
+layout (std430, binding = 5) readonly buffer SkinnedBuffer
 {
-    mat4 mat[MaxBones];
+    mat4 mat[];
 };
 
 
@@ -45,13 +49,13 @@ void main()
         if (idx == -1)
             continue;
 
-        if (idx >= MaxBones)
+        if (uint(idx) >= boneCount)
         {
             finalPosition = vec4(aPos, 1.0f);
             break;
         }
 
-        vec4 localPosition = mat[idx] * vec4(aPos ,1.0f);
+        vec4 localPosition = mat[boneOffset + uint(idx)] * vec4(aPos ,1.0f);
         finalPosition += localPosition * aBoneWeights[i];
     }
     vec4 fragpos = model * vec4(finalPosition.xyz, 1.0);
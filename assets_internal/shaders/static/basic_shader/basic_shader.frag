@@ -3,8 +3,7 @@
 
 out vec4 FragColor;
 
-const int MaxSpotLight = 50;
-const int MaxPointLight = 50;
+const int MaxSpotLightShadows = 50;
 const int DirectionalCascadeLevelAllocation = 12;
 const int DirectionalCascadeLevel = 4;
 
@@ -18,6 +17,7 @@ struct PointLightData
     vec3 position;
     float radius;
     bool isCastShadow;
+    int shadowIndex;
 };
 
 struct SpotLightData
@@ -29,6 +29,8 @@ struct SpotLightData
     vec3 direction;
     float outerCutOff;
     bool isCastShadow;
+    int shadowIndex;
+    float radius;
 };
 
 struct DirectionalData
@@ -43,15 +45,53 @@ struct DirectionalData
 
 layout (std430, binding = 2) uniform LightData
 {
-    int nbrOfPointLight;
-    int nbrOfSpotLight;
-    PointLightData pointLightData[MaxPointLight];
-    SpotLightData spotLightData[MaxSpotLight];
-    DirectionalData directionalData;
+    uint nbrOfPointLight;
+    uint nbrOfSpotLight;
+    uint nbrOfDirLight;
 
-    mat4 spothLightlightSpaceMatrix[MaxSpotLight];
+    mat4 spothLightlightSpaceMatrix[MaxSpotLightShadows];
     mat4 dirLightSpaceMatrix[DirectionalCascadeLevelAllocation];
-    int nbrOfDirLight;
+};
+
+layout (std430, binding = 8) readonly buffer PointLightBuffer
+{
+    PointLightData pointLightData[];
+};
+
+layout (std430, binding = 9) readonly buffer SpotLightBuffer
+{
+    SpotLightData spotLightData[];
+};
+
+// Only the first directional light casts shadows
+layout (std430, binding = 10) readonly buffer DirectionalLightBuffer
+{
+    DirectionalData directionalData[];
+};
+
+// Mirrors LightClusterGrid, see GetLightCluster
+layout (std430, binding = 11) readonly buffer LightClusterBuffer
+{
+    vec4 clusterCameraPosition;
+    vec4 clusterCameraRight;
+    vec4 clusterCameraUp;
+    vec4 clusterCameraFront;
+    float clusterTanHalfFovX;
+    float clusterTanHalfFovY;
+    float clusterNear;
+    float clusterSliceScale;
+    uint clusterTileCountX;
+    uint clusterTileCountY;
+    uint clusterSliceCount;
+    uint clusterPadding;
+    // Offset and count in lightIndices
+    uvec2 clusters[];
+};
+
+// Point lights first, then spot lights offset by nbrOfPointLight
+layout (std430, binding = 12) readonly buffer LightIndexBuffer
+{
+    uint lightIndices[];
 };
 
 layout (std140, binding = 0) uniform CameraUniform
@@ -75,6 +115,25 @@ in VS_OUT
 uniform vec3 color;
 uniform sampler2D diffuseTexture;
 
+uint GetClusterCell(float coordinate, uint count)
+{
+    return uint(clamp(floor(coordinate * float(count)), 0.0, float(count - 1)));
+}
+
+uvec2 GetLightCluster(vec3 fragPos)
+{
+    vec3 toFrag = fragPos - clusterCameraPosition.xyz;
+    float x = dot(toFrag, clusterCameraRight.xyz);
+    float y = dot(toFrag, clusterCameraUp.xyz);
+    float depth = max(dot(toFrag, clusterCameraFront.xyz), clusterNear);
+
+    uint tileX = GetClusterCell((x / (depth * clusterTanHalfFovX) + 1.0) * 0.5, clusterTileCountX);
+    uint tileY = GetClusterCell((y / (depth * clusterTanHalfFovY) + 1.0) * 0.5, clusterTileCountY);
+    uint slice = GetClusterCell(log(depth / clusterNear) * clusterSliceScale / float(clusterSliceCount), clusterSliceCount);
+
+    return clusters[(slice * clusterTileCountY + tileY) * clusterTileCountX + tileX];
+}
+
 vec3 CalcPointLight(PointLightData light, vec3 viewDir, vec3 fragPos, vec3 normal, vec3 albedo)
 {
     float distanceLightToFragment = distance(light.position, fragPos);
@@ -108,6 +167,9 @@ vec3 CalcPointLight(PointLightData light, vec3 viewDir, vec3 fragPos, vec3 norma
 
 vec3 CalcSpotLight(SpotLightData light, vec3 viewDir, vec3 fragPos, vec3 normal, vec3 albedo)
 {
+    if (distance(light.position, fragPos) > light.radius)
+        return vec3(0);
+
     vec3 lightDir = normalize(light.position - fragPos);
     // diffuse shading
     float diff = max(dot(normal, lightDir), 0.0);
@@ -161,16 +223,21 @@ void main()
     vec3 viewDir = normalize(cameraPos - fs_in.fragPos);
     vec3 albedo = vec3(texture(diffuseTexture, fs_in.texCoords));
 
-    vec3 finalColor = CalcDirLight(directionalData, viewDir, fs_in.fragPos, normal, albedo);
+    vec3 finalColor = vec3(0);
 
-    for (int i = 0; i < nbrOfPointLight; i++)
+    for (uint i = 0; i < nbrOfDirLight; i++)
     {
-        finalColor += CalcPointLight(pointLightData[i], viewDir, fs_in.fragPos, normal, albedo);
+        finalColor += CalcDirLight(directionalData[i], viewDir, fs_in.fragPos, normal, albedo);
     }
 
-    for (int i = 0; i < nbrOfSpotLight; i++)
+    uvec2 cluster = GetLightCluster(fs_in.fragPos);
+    for (uint i = cluster.x; i < cluster.x + cluster.y; i++)
     {
-        finalColor += CalcSpotLight(spotLightData[i], viewDir, fs_in.fragPos, normal, albedo);
+        uint lightIndex = lightIndices[i];
+        if (lightIndex < nbrOfPointLight)
+            finalColor += CalcPointLight(pointLightData[lightIndex], viewDir, fs_in.fragPos, normal, albedo);
+        else
+            finalColor += CalcSpotLight(spotLightData[lightIndex - nbrOfPointLight], viewDir, fs_in.fragPos, normal, albedo);
     }
 
     FragColor = vec4(finalColor, 1);
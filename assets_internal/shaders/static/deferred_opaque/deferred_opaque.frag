@@ -3,8 +3,7 @@
 
 out vec4 FragColor;
 
-const int MaxSpotLight = 50;
-const int MaxPointLight = 50;
+const int MaxSpotLightShadows = 50;
 const int DirectionalCascadeLevelAllocation = 12;
 const int DirectionalCascadeLevel = 4;
 
@@ -18,6 +17,7 @@ struct PointLightData
     vec3 position;
     float radius;
     bool isCastShadow;
+    int shadowIndex;
 };
 
 struct SpotLightData
@@ -29,6 +29,8 @@ struct SpotLightData
     vec3 direction;
     float outerCutOff;
     bool isCastShadow;
+    int shadowIndex;
+    float radius;
 };
 
 struct DirectionalData
@@ -43,16 +45,55 @@ struct DirectionalData
 
 layout (std430, binding = 2) uniform LightData
 {
-    int nbrOfPointLight;
-    int nbrOfSpotLight;
-    PointLightData pointLightData[MaxPointLight];
-    SpotLightData spotLightData[MaxSpotLight];
-    DirectionalData directionalData;
+    uint nbrOfPointLight;
+    uint nbrOfSpotLight;
+    uint nbrOfDirLight;
 
-    mat4 spothLightlightSpaceMatrix[MaxSpotLight];
+    mat4 spothLightlightSpaceMatrix[MaxSpotLightShadows];
     mat4 dirLightSpaceMatrix[DirectionalCascadeLevelAllocation];
-    int nbrOfDirLight;
 };
+
+layout (std430, binding = 8) readonly buffer PointLightBuffer
+{
+    PointLightData pointLightData[];
+};
+
+layout (std430, binding = 9) readonly buffer SpotLightBuffer
+{
+    SpotLightData spotLightData[];
+};
+
+// Only the first directional light casts shadows
+layout (std430, binding = 10) readonly buffer DirectionalLightBuffer
+{
+    DirectionalData directionalData[];
+};
+
+// Mirrors LightClusterGrid, see GetLightCluster
+layout (std430, binding = 11) readonly buffer LightClusterBuffer
+{
+    vec4 clusterCameraPosition;
+    vec4 clusterCameraRight;
+    vec4 clusterCameraUp;
+    vec4 clusterCameraFront;
+    float clusterTanHalfFovX;
+    float clusterTanHalfFovY;
+    float clusterNear;
+    float clusterSliceScale;
+    uint clusterTileCountX;
+    uint clusterTileCountY;
+    uint clusterSliceCount;
+    uint clusterPadding;
+    // Offset and count in lightIndices
+    uvec2 clusters[];
+};
+
+// Point lights first, then spot lights offset by nbrOfPointLight
+layout (std430, binding = 12) readonly buffer LightIndexBuffer
+{
+    uint lightIndices[];
+};
+
 layout (std140, binding = 0) uniform CameraUniform
 {
     mat4 view;
@@ -125,9 +166,9 @@ float DirLightShadowCalculation(vec4 fragPosWorldSpace, vec3 n, vec3 l)
 
     int layer = -1;
     
-    for (int i = 0; i < directionalData.cascadeCount; ++i)
+    for (int i = 0; i < directionalData[0].cascadeCount; ++i)
     {
-        if (depthValue < directionalData.cascadePlaneDistance[i])
+        if (depthValue < directionalData[0].cascadePlaneDistance[i])
         {
             layer = i;
             break;
@@ -135,7 +176,7 @@ float DirLightShadowCalculation(vec4 fragPosWorldSpace, vec3 n, vec3 l)
     }
     if (layer == -1)
     {
-        layer = directionalData.cascadeCount;
+        layer = directionalData[0].cascadeCount;
     }
     
     vec4 fragPosLightSpace = dirLightSpaceMatrix[layer] * vec4(fragPosWorldSpace.xyz, 1.0);
@@ -155,13 +196,13 @@ float DirLightShadowCalculation(vec4 fragPosWorldSpace, vec3 n, vec3 l)
     float bias = max(0.01 * (1.0 - dot(n, l)), 0.001);    
     // calculate bias (based on depth map resolution and slope)
     const float biasModifier = 0.9f;
-    if (layer == directionalData.cascadeCount)
+    if (layer == directionalData[0].cascadeCount)
     {
         bias *= 1 / (far * biasModifier);
     }
     else
     {
-        bias *= 1 / (directionalData.cascadePlaneDistance[layer] * biasModifier );
+        bias *= 1 / (directionalData[0].cascadePlaneDistance[layer] * biasModifier );
     }
 
     // PCF  
@@ -181,6 +222,25 @@ float DirLightShadowCalculation(vec4 fragPosWorldSpace, vec3 n, vec3 l)
     return shadow;
 }
 
+uint GetClusterCell(float coordinate, uint count)
+{
+    return uint(clamp(floor(coordinate * float(count)), 0.0, float(count - 1)));
+}
+
+uvec2 GetLightCluster(vec3 fragPos)
+{
+    vec3 toFrag = fragPos - clusterCameraPosition.xyz;
+    float x = dot(toFrag, clusterCameraRight.xyz);
+    float y = dot(toFrag, clusterCameraUp.xyz);
+    float depth = max(dot(toFrag, clusterCameraFront.xyz), clusterNear);
+
+    uint tileX = GetClusterCell((x / (depth * clusterTanHalfFovX) + 1.0) * 0.5, clusterTileCountX);
+    uint tileY = GetClusterCell((y / (depth * clusterTanHalfFovY) + 1.0) * 0.5, clusterTileCountY);
+    uint slice = GetClusterCell(log(depth / clusterNear) * clusterSliceScale / float(clusterSliceCount), clusterSliceCount);
+
+    return clusters[(slice * clusterTileCountY + tileY) * clusterTileCountX + tileX];
+}
+
 float ShadowCalculationSpolight(vec4 fragPosLightSpace, vec3 n, vec3 l, int index)
 {
     // perform perspective divide
@@ -285,109 +345,119 @@ vec3 ComputeIbl(float roughness,vec3 kD, float ao,vec3 albedo, vec3 N , vec3 R ,
 }
     
 
-vec3 ComputeSpotLight(vec3 baseColor,vec4 fragPos,vec3 v, vec3 n, float roughness, float metallic, vec3 f0)
+vec3 ComputeSpotLight(SpotLightData light, vec3 baseColor,vec4 fragPos,vec3 v, vec3 n, float roughness, float metallic, vec3 f0)
 {
-    vec3 outLo = vec3(0.f);
     vec3 fragposVec3 = vec3(fragPos.x, fragPos.y, fragPos.z);
+    float distance = length(light.position - fragposVec3);
 
-    for (int i = 0; i < nbrOfSpotLight; i++)
-    {
-        SpotLightData light = spotLightData[i];
-        float distance = length(light.position - fragposVec3);
-        
-        vec3 l = normalize(vec3(light.position - fragposVec3));
-        vec3 h = normalize(v + l);
+    if (distance > light.radius)
+        return vec3(0.f);
+    
+    vec3 l = normalize(vec3(light.position - fragposVec3));
+    vec3 h = normalize(v + l);
 
-        float theta = dot(l, normalize(-light.direction));
-        float epsilon = light.cutOff - light.outerCutOff;
-        float intensity = clamp((theta - light.outerCutOff) / epsilon, 0.0, 1.0);
+    float theta = dot(l, normalize(-light.direction));
+    float epsilon = light.cutOff - light.outerCutOff;
+    float intensity = clamp((theta - light.outerCutOff) / epsilon, 0.0, 1.0);
 
 
-        float attenuation = 1.0 / (distance * distance);
-        vec3 radiance = light.color * attenuation * light.intensity * intensity;
-        
-        float NoH = clamp(dot(n,h),0.0,1.0);
-        float VoH = clamp(dot(v,h),0.0,1.0);
-        
+    float attenuation = 1.0 / (distance * distance);
+    vec3 radiance = light.color * attenuation * light.intensity * intensity;
+    
+    float NoH = clamp(dot(n,h),0.0,1.0);
+    float VoH = clamp(dot(v,h),0.0,1.0);
+    
 
-        float ndf = SpecularD(NoH, roughness);
-        float g =  SpecularG(l, v, h, n, roughness);
-        vec3 f = SpecularF(VoH, f0, roughness);
+    float ndf = SpecularD(NoH, roughness);
+    float g =  SpecularG(l, v, h, n, roughness);
+    vec3 f = SpecularF(VoH, f0, roughness);
 
-        vec3 numerator = ndf * g * f;
-        float denominator = 4.0 * max(dot(n, v), 0.0) * max(dot(n, l), 0.0) + 0.0001;
-        
-        vec3 specular  = numerator / denominator;
-        vec3 kS = f;
-        vec3 kD = vec3(1.0) - kS;
-        kD *= 1.0 - metallic;
-        float NdotL = max(dot(n, l), 0.0);
-        
-        NdotL = max(dot(n, l), 0.0);
-        vec3 Lo = (kD * baseColor * InvPI + specular) * radiance * NdotL;
-        
-        if (light.isCastShadow) 
-        {
-            float shadow = ShadowCalculationSpolight(spothLightlightSpaceMatrix[i] * fragPos, n, l, i);
-            Lo *= ( 1.0 - shadow );
-        }
-        outLo += Lo;
+    vec3 numerator = ndf * g * f;
+    float denominator = 4.0 * max(dot(n, v), 0.0) * max(dot(n, l), 0.0) + 0.0001;
+    
+    vec3 specular  = numerator / denominator;
+    vec3 kS = f;
+    vec3 kD = vec3(1.0) - kS;
+    kD *= 1.0 - metallic;
+    float NdotL = max(dot(n, l), 0.0);
+    
+    NdotL = max(dot(n, l), 0.0);
+    vec3 Lo = (kD * baseColor * InvPI + specular) * radiance * NdotL;
+    
+    if (light.isCastShadow) 
+    {
+        float shadow = ShadowCalculationSpolight(spothLightlightSpaceMatrix[light.shadowIndex] * fragPos, n, l, light.shadowIndex);
+        Lo *= ( 1.0 - shadow );
     }
     
-    return outLo;
+    return Lo;
 }
 
-vec3 ComputePointLight(vec3 baseColor,vec3 fragPos,vec3 v, vec3 n, float roughness, float metallic, vec3 f0)
+vec3 ComputePointLight(PointLightData light, vec3 baseColor,vec3 fragPos,vec3 v, vec3 n, float roughness, float metallic, vec3 f0)
 {
-    vec3 outLo = vec3(0.f);
+    float distance = length(light.position - fragPos);
 
-    for (int i = 0; i < nbrOfPointLight; i++)
-    {
-        PointLightData light = pointLightData[i];
-        float distance = length(light.position - fragPos);
+    if(distance > light.radius)
+        return vec3(0.f);
 
-        if(distance > light.radius)
-        continue;
+    vec3 l = normalize(vec3(light.position - fragPos));
+    vec3 h = normalize(v + l);
 
-        vec3 l = normalize(vec3(light.position - fragPos));
-        vec3 h = normalize(v + l);
+    float attenuation = 1.0 / (distance * distance);
+    vec3 radiance = light.color * attenuation * light.intensity;
 
-        float attenuation = 1.0 / (distance * distance);
-        vec3 radiance = light.color * attenuation * light.intensity;
+    float NoH = clamp(dot(n,h),0.0,1.0);
+    float VoH = clamp(dot(v,h),0.0,1.0);
 
-        float NoH = clamp(dot(n,h),0.0,1.0);
-        float VoH = clamp(dot(v,h),0.0,1.0);
 
+    float ndf = SpecularD(NoH, roughness);
+    float g =  SpecularG(l, v, h, n, roughness);
+    vec3 f = SpecularF(VoH,f0,roughness);
 
-        float ndf = SpecularD(NoH, roughness);
-        float g =  SpecularG(l, v, h, n, roughness);
-        vec3 f = SpecularF(VoH,f0,roughness);
+    vec3 numerator = ndf * g * f;
+    float denominator = 4.0 * max(dot(n, v), 0.0) * max(dot(n, l), 0.0) + 0.0001;
 
-        vec3 numerator = ndf * g * f;
-        float denominator = 4.0 * max(dot(n, v), 0.0) * max(dot(n, l), 0.0) + 0.0001;
+    vec3 specular  = numerator / denominator;
+    vec3 kS = f;
+    vec3 kD = vec3(1.0) - kS;
+    kD *= 1.0 - metallic;
+    float NdotL = max(dot(n, l), 0.0);
 
-        vec3 specular  = numerator / denominator;
-        vec3 kS = f;
-        vec3 kD = vec3(1.0) - kS;
-        kD *= 1.0 - metallic;
-        float NdotL = max(dot(n, l), 0.0);
-
-        
-        NdotL = max(dot(n, l), 0.0);
-        vec3 Lo = (kD * baseColor * InvPI + specular) * radiance * NdotL;
+    
+    NdotL = max(dot(n, l), 0.0);
+    vec3 Lo = (kD * baseColor * InvPI + specular) * radiance * NdotL;
 
-        if (light.isCastShadow)
-        {
-            float shadow = ShadowCalculationPointLight(fragPos - light.position, fragPos, i);
-            Lo *= ( 1.0 - shadow );
-        }
-        outLo += Lo;
+    if (light.isCastShadow)
+    {
+        float shadow = ShadowCalculationPointLight(fragPos - light.position, fragPos, light.shadowIndex);
+        Lo *= ( 1.0 - shadow );
     }
 
-    return outLo;
+    return Lo;
 }
 
+vec3 ComputeDirectionalLight(DirectionalData light, vec3 baseColor, vec3 v, vec3 n, float roughness, float metallic, vec3 f0)
+{
+    vec3 l = normalize(light.direction);
+    vec3 h = normalize(v + l);
+
+    float NoH = clamp(dot(n,h),0.0,1.0);
+    float VoH = clamp(dot(v,h),0.0,1.0);
+
+    float ndf = SpecularD(NoH, roughness * roughness );
+    float g =  SpecularG(l, v, h, n, roughness);
+    vec3 f = SpecularF(VoH,f0,roughness);
+
+    vec3 radiance = light.color * light.intensity;
+    vec3 numerator = ndf * g * f;
+    float denominator = 4.0 * max(dot(n, v), 0.0) * max(dot(n, l), 0.0) + 0.0001;
+    vec3 specular  = numerator / denominator;
 
+    vec3 kD = (vec3(1.0) - f) * (1.0 - metallic);
+    float NdotL = max(dot(n, l), 0.0);
+
+    return (kD * baseColor * InvPI + specular) * radiance * NdotL;
+}
 
 
 void main()
@@ -422,7 +492,7 @@ void main()
     vec3 r = reflect(-v, n); 
 
     // Incident Light Unit Vector
-    vec3 l = normalize(directionalData.direction);
+    vec3 l = nbrOfDirLight > 0 ? normalize(directionalData[0].direction) : n;
     // half unit vector
     vec3 h = normalize(v + l);
     
@@ -435,9 +505,9 @@ void main()
 
     vec3 kD = vec3(0,0,0);
     
-    if (nbrOfDirLight == 1)
+    if (nbrOfDirLight > 0)
     {
-        vec3 radiance = directionalData.color * directionalData.intensity;
+        vec3 radiance = directionalData[0].color * directionalData[0].intensity;
         vec3 numerator = ndf * g * f;
         float denominator = 4.0 * max(dot(n, v), 0.0) * max(dot(n, l), 0.0) + 0.0001;
         vec3 specular  = numerator / denominator;
@@ -448,7 +518,7 @@ void main()
         float NdotL = max(dot(n, l), 0.0);
 
         vec3 LoDir = (kD * albedo * InvPI + specular) * radiance * NdotL;
-        if (directionalData.isDirlightCastShadow)
+        if (directionalData[0].isDirlightCastShadow)
         {
             float shadow = DirLightShadowCalculation(fragPosVec4, n, l);
             LoDir *= (1.0-shadow);
@@ -456,8 +526,19 @@ void main()
         Lo += LoDir;
     }
     
-    Lo += ComputePointLight(albedo, fragPos, v, n, roughness, metallic, F0);
-    Lo += ComputeSpotLight(albedo, fragPosVec4, v, n, roughness, metallic, F0);
+    for (uint i = 1; i < nbrOfDirLight; i++)
+        Lo += ComputeDirectionalLight(directionalData[i], albedo, v, n, roughness, metallic, F0);
+    
+    // Only the lights binned in the cluster of the fragment can reach it
+    uvec2 cluster = GetLightCluster(fragPos);
+    for (uint i = cluster.x; i < cluster.x + cluster.y; i++)
+    {
+        uint lightIndex = lightIndices[i];
+        if (lightIndex < nbrOfPointLight)
+            Lo += ComputePointLight(pointLightData[lightIndex], albedo, fragPos, v, n, roughness, metallic, F0);
+        else
+            Lo += ComputeSpotLight(spotLightData[lightIndex - nbrOfPointLight], albedo, fragPosVec4, v, n, roughness, metallic, F0);
+    }
     
     vec3 ambient = ComputeIbl(roughness, kD, ambientOcclusion, albedo, n, r, v, f);
     vec3 color = Lo + ambient + (emissiveColor * emissive);